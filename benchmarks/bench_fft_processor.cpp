@@ -0,0 +1,141 @@
+#include "audiovis/fft_processor.hpp"
+#include "audiovis/tone_tracker.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+std::vector<float> make_signal(std::size_t n) {
+    // Two tones plus a little broadband content, so no bin is trivially zero
+    std::vector<float> samples(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto t = static_cast<float>(i) / 48000.0f;
+        samples[i] = 0.5f * std::sin(2.0f * std::numbers::pi_v<float> * 440.0f * t) +
+                     0.25f * std::sin(2.0f * std::numbers::pi_v<float> * 5000.0f * t) +
+                     0.01f * std::sin(static_cast<float>(i * i));
+    }
+    return samples;
+}
+
+/// One magnitude spectrum. Arguments: fft_size, WindowFunction.
+void BM_FFTCompute(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    const auto window = static_cast<WindowFunction>(state.range(1));
+    FFTProcessor fft{{.fft_size = size, .window = window}};
+
+    const auto input = make_signal(size);
+    std::vector<float> output(fft.bin_count());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fft.compute(input, output));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FFTCompute)
+    ->ArgNames({"size", "window"})
+    ->ArgsProduct({benchmark::CreateRange(256, 65536, 2),
+                   {static_cast<int>(WindowFunction::Rectangular),
+                    static_cast<int>(WindowFunction::Hann),
+                    static_cast<int>(WindowFunction::Hamming),
+                    static_cast<int>(WindowFunction::Blackman),
+                    static_cast<int>(WindowFunction::FlatTop)}});
+
+/// Linear-magnitude output (sqrt path instead of dB).
+void BM_FFTComputeLinear(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    FFTProcessor fft{{.fft_size = size, .use_magnitude_db = false}};
+
+    const auto input = make_signal(size);
+    std::vector<float> output(fft.bin_count());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fft.compute(input, output));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FFTComputeLinear)->RangeMultiplier(4)->Range(256, 65536);
+
+/// Batched multi-channel transform. Arguments: fft_size, channels.
+void BM_FFTComputeBatch(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    const auto channels = static_cast<std::size_t>(state.range(1));
+    FFTProcessor fft{{.fft_size = size, .channels = channels}};
+
+    const auto input = make_signal(size);
+    const std::vector<SegmentedInput> inputs(channels, SegmentedInput{.head = input, .tail = {}});
+    std::vector<float> output(channels * fft.bin_count());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fft.compute_batch(inputs, output));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_FFTComputeBatch)
+    ->ArgNames({"size", "channels"})
+    ->ArgsProduct({{1024, 4096}, {1, 2, 8}});
+
+/// Constructing a processor, as every reconfiguration and resolution tier
+/// does. Plans and window tables come from the process-wide caches, so this
+/// is buffer allocation plus lookups. Arguments: fft_size, WindowFunction.
+void BM_FFTProcessorConstruct(benchmark::State& state) {
+    const FFTConfig config{.fft_size = static_cast<std::size_t>(state.range(0)),
+                           .window = static_cast<WindowFunction>(state.range(1))};
+    const FFTProcessor warm{config};  // Plan and (computed) window cached
+
+    for (auto _ : state) {
+        FFTProcessor fft{config};
+        benchmark::DoNotOptimize(&fft);
+    }
+}
+BENCHMARK(BM_FFTProcessorConstruct)
+    ->ArgNames({"size", "window"})
+    ->ArgsProduct({{2048, 8192},
+                   {static_cast<int>(WindowFunction::Hann),
+                    static_cast<int>(WindowFunction::Blackman)}});
+
+/// Band edge computation, run on every band layout change.
+void BM_ComputeLogBands(benchmark::State& state) {
+    const auto bands = static_cast<std::size_t>(state.range(0));
+    constexpr std::size_t kFFTSize = 4096;
+
+    for (auto _ : state) {
+        auto result =
+            compute_log_bands(kFFTSize / 2 + 1, bands, 20.0f, 20000.0f, 48000.0f, kFFTSize);
+        benchmark::DoNotOptimize(result.data());
+    }
+}
+BENCHMARK(BM_ComputeLogBands)->RangeMultiplier(4)->Range(16, 1024);
+
+/// One 512-sample hop through a sliding-DFT tone bank over a 4096-sample
+/// Hann window, magnitudes included; compare with BM_FFTCompute at 4096.
+/// Argument: tracked frequencies.
+void BM_ToneTrackerHop(benchmark::State& state) {
+    constexpr std::size_t kHop = 512;
+    ToneTrackerConfig config{.window_size = 4096};
+    for (std::int64_t t = 0; t < state.range(0); ++t) {
+        config.frequencies.push_back(50.0f + 300.0f * static_cast<float>(t));
+    }
+    ToneTracker tracker{config};
+
+    const auto input = make_signal(kHop);
+    std::vector<float> output(tracker.tone_count());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tracker.compute(input, output));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kHop));
+}
+BENCHMARK(BM_ToneTrackerHop)->ArgName("tones")->RangeMultiplier(4)->Range(1, 64);
+
+}  // namespace
+}  // namespace audiovis
@@ -0,0 +1,207 @@
+#include "audiovis/band_kernel.hpp"
+#include "audiovis/band_matrix.hpp"
+#include "audiovis/fft_processor.hpp"
+#include "audiovis/ring_buffer.hpp"
+#include "audiovis/spectrum_analyzer.hpp"
+#include "audiovis/synthetic_source.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <memory>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+
+/// Deterministic stand-in for the capture device: a slow sine sweep.
+class SyntheticFeed {
+public:
+    void fill(std::span<float> out) noexcept {
+        for (float& sample : out) {
+            sample = 0.5f * std::sin(phase_);
+            phase_ += 2.0f * std::numbers::pi_v<float> * frequency_ / kSampleRate;
+            if (phase_ > 2.0f * std::numbers::pi_v<float>) {
+                phase_ -= 2.0f * std::numbers::pi_v<float>;
+            }
+            frequency_ = frequency_ > 16000.0f ? 50.0f : frequency_ * 1.00001f;
+        }
+    }
+
+private:
+    float phase_ = 0.0f;
+    float frequency_ = 50.0f;
+};
+
+/// Mapping FFT bins to display bands. Arguments: band count, BandWeighting.
+void BM_BandMatrixApply(benchmark::State& state) {
+    constexpr std::size_t kFFTSize = 4096;
+    const BandMatrix matrix{{.num_bands = static_cast<std::size_t>(state.range(0)),
+                             .weighting = static_cast<BandWeighting>(state.range(1))},
+                            kFFTSize / 2 + 1, kFFTSize, kSampleRate};
+
+    std::vector<float> bins(kFFTSize / 2 + 1, 0.5f);
+    std::vector<float> bands(matrix.band_count());
+
+    for (auto _ : state) {
+        matrix.apply(bins, bands);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["nonzeros"] = static_cast<double>(matrix.nonzeros());
+}
+BENCHMARK(BM_BandMatrixApply)
+    ->ArgNames({"bands", "weighting"})
+    ->ArgsProduct({{64, 256, 1024},
+                   {static_cast<int>(BandWeighting::Rectangular),
+                    static_cast<int>(BandWeighting::Fractional),
+                    static_cast<int>(BandWeighting::Triangular)}});
+
+/// From one channel's complex FFT output to smoothed, peak-held bands:
+/// separate passes (whole-spectrum dB conversion, band matrix, smoothing)
+/// versus fused_bands(). Arguments: fft_size, fused (0 or 1).
+void BM_BandsFromSpectrum(benchmark::State& state) {
+    const auto fft_size = static_cast<std::size_t>(state.range(0));
+    const bool fused = state.range(1) != 0;
+    constexpr std::size_t kBands = 128;
+
+    FFTProcessor fft{{.fft_size = fft_size}};
+    const BandMatrix matrix{{.num_bands = kBands, .max_frequency = 16000.0f}, fft.bin_count(),
+                            fft_size, kSampleRate};
+    std::vector<float> samples(fft_size);
+    SyntheticFeed{}.fill(samples);
+    const SegmentedInput input{.head = samples, .tail = {}};
+    fft.transform_batch({&input, 1});
+
+    std::vector<float> magnitudes(fft.bin_count());
+    std::vector<float> raw(kBands);
+    std::vector<float> smoothed(kBands);
+    std::vector<float> peaks(kBands);
+    std::vector<float> out_magnitudes(kBands);
+    std::vector<float> out_peaks(kBands);
+    const BandLanes lanes{smoothed, peaks, out_magnitudes, out_peaks};
+    const BandSmoothing smoothing{.smoothing_factor = 0.7f, .peak_decay_rate = 0.95f};
+
+    for (auto _ : state) {
+        if (fused) {
+            fused_bands(fft, 0, matrix, smoothing, magnitudes, lanes);
+        } else {
+            fft.convert_bins(0, 0, magnitudes);
+            matrix.apply(magnitudes, raw);
+            smooth_bands(raw, smoothing, lanes);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BandsFromSpectrum)
+    ->ArgNames({"fft", "fused"})
+    ->ArgsProduct({{4096, 16384, 65536}, {0, 1}});
+
+/// One streaming STFT hop end to end, mirroring SpectrumAnalyzer::process_pending():
+/// capture-sized blocks into the ring, window in place, FFT, band mapping and
+/// smoothing, then slide by one hop. Arguments: fft_size, hop_size.
+void BM_AnalyzerPipelineHop(benchmark::State& state) {
+    const auto fft_size = static_cast<std::size_t>(state.range(0));
+    const auto hop = static_cast<std::size_t>(state.range(1));
+    constexpr std::size_t kCallbackFrames = 256;
+    constexpr std::size_t kBands = 64;
+    constexpr float kSmoothing = 0.7f;
+
+    RingBuffer<float> ring{fft_size * 4};
+    FFTProcessor fft{{.fft_size = fft_size}};
+    const BandMatrix bands{{.num_bands = kBands}, fft.bin_count(), fft_size, kSampleRate};
+
+    std::vector<float> callback(kCallbackFrames);
+    std::vector<float> magnitudes(fft.bin_count());
+    std::vector<float> raw(kBands);
+    std::vector<float> smoothed(kBands);
+    SyntheticFeed feed;
+
+    // Prime one window of history
+    while (ring.size() < fft_size) {
+        feed.fill(callback);
+        ring.try_push(callback);
+    }
+
+    for (auto _ : state) {
+        // Capture side: at least one hop of new audio
+        while (ring.size() < fft_size + hop) {
+            feed.fill(callback);
+            ring.try_push(callback);
+        }
+
+        // Analysis side
+        const auto region = ring.acquire_read(fft_size);
+        fft.compute(region.first, region.second, magnitudes);
+        bands.apply(magnitudes, raw);
+        for (std::size_t i = 0; i < kBands; ++i) {
+            smoothed[i] = (1.0f - kSmoothing) * raw[i] + kSmoothing * smoothed[i];
+        }
+        ring.commit_read(hop);
+        benchmark::DoNotOptimize(smoothed.data());
+    }
+
+    // One item per analyzed frame; the rate shows headroom over real time
+    state.SetItemsProcessed(state.iterations());
+    state.counters["realtime_x"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * static_cast<double>(hop) /
+            static_cast<double>(kSampleRate),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_AnalyzerPipelineHop)
+    ->ArgNames({"fft", "hop"})
+    ->Args({1024, 256})
+    ->Args({2048, 512})
+    ->Args({4096, 1024})
+    ->Args({8192, 2048});
+
+/// The real SpectrumAnalyzer fed by an endless SyntheticSource sweep: one hop
+/// of generated audio, then process_pending(). Includes source rendering and
+/// every channel. Arguments: fft_size, hop_size, channels, resolution_tiers.
+/// Four tiers at 2048 points resolve the bass like one 16384-point FFT.
+void BM_SpectrumAnalyzerStream(benchmark::State& state) {
+    const auto fft_size = static_cast<std::size_t>(state.range(0));
+    const auto hop = static_cast<std::size_t>(state.range(1));
+
+    auto owned = std::make_unique<SyntheticSource>(
+        SyntheticConfig{.channels = static_cast<std::uint32_t>(state.range(2)),
+                        .waveform = Waveform::Sweep,
+                        .block_frames = hop});
+    auto& source = *owned;
+    SpectrumAnalyzer analyzer{
+        std::move(owned),
+        {.fft_size = fft_size},
+        {.hop_size = hop, .resolution_tiers = static_cast<std::size_t>(state.range(3))}};
+    const SpectrumAnalyzer::FrameCallback discard;
+
+    source.produce(fft_size - hop);  // Prime history
+    for (int i = 0; i < 64; ++i) {   // Fill the deepest tier's window
+        source.produce(hop);
+        analyzer.process_pending(discard);
+    }
+    for (auto _ : state) {
+        source.produce(hop);
+        benchmark::DoNotOptimize(analyzer.process_pending(discard));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["realtime_x"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * static_cast<double>(hop) /
+            static_cast<double>(kSampleRate),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SpectrumAnalyzerStream)
+    ->ArgNames({"fft", "hop", "channels", "tiers"})
+    ->Args({2048, 512, 1, 1})
+    ->Args({2048, 512, 2, 1})
+    ->Args({4096, 1024, 2, 1})
+    ->Args({2048, 512, 1, 4})
+    ->Args({16384, 512, 1, 1});
+
+}  // namespace
+}  // namespace audiovis
@@ -0,0 +1,97 @@
+#include "audiovis/ring_buffer.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+constexpr std::size_t kCapacity = 1 << 16;
+
+/// Single-element push/pop round trip on one thread.
+void BM_RingBufferPushPopSingle(benchmark::State& state) {
+    RingBuffer<float> buffer{kCapacity};
+    float out = 0.0f;
+
+    for (auto _ : state) {
+        buffer.try_push(1.0f);
+        buffer.try_pop(out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RingBufferPushPopSingle);
+
+/// Block push followed by block pop, as the capture callback and analyzer do.
+void BM_RingBufferPushPopBlock(benchmark::State& state) {
+    const auto block = static_cast<std::size_t>(state.range(0));
+    RingBuffer<float> buffer{kCapacity};
+    const std::vector<float> in(block, 0.5f);
+    std::vector<float> out(block);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(buffer.try_push(in));
+        benchmark::DoNotOptimize(buffer.try_pop(out));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) *
+                            static_cast<std::int64_t>(sizeof(float)));
+}
+BENCHMARK(BM_RingBufferPushPopBlock)->RangeMultiplier(4)->Range(16, 16384);
+
+/// Non-consuming copy of the oldest `block` samples.
+void BM_RingBufferPeek(benchmark::State& state) {
+    const auto block = static_cast<std::size_t>(state.range(0));
+    RingBuffer<float> buffer{kCapacity};
+    const std::vector<float> fill(kCapacity / 2, 0.25f);
+    buffer.try_push(fill);
+    std::vector<float> out(block);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(buffer.peek(out));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RingBufferPeek)->RangeMultiplier(4)->Range(16, 16384);
+
+/// Producer and consumer on separate threads, moving `block`-sized chunks.
+/// Measures the consumer side; items/s is end-to-end SPSC throughput.
+void BM_RingBufferSpscThroughput(benchmark::State& state) {
+    const auto block = static_cast<std::size_t>(state.range(0));
+    RingBuffer<float> buffer{kCapacity};
+    std::atomic<bool> done{false};
+
+    std::thread producer{[&] {
+        const std::vector<float> in(block, 1.0f);
+        while (!done.load(std::memory_order_relaxed)) {
+            if (buffer.try_push(in) == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }};
+
+    std::vector<float> out(block);
+    std::int64_t items = 0;
+    for (auto _ : state) {
+        std::size_t got = 0;
+        while (got == 0) {
+            got = buffer.try_pop(out);
+        }
+        items += static_cast<std::int64_t>(got);
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    done.store(true, std::memory_order_relaxed);
+    producer.join();
+    state.SetItemsProcessed(items);
+}
+BENCHMARK(BM_RingBufferSpscThroughput)->RangeMultiplier(8)->Range(64, 4096)->UseRealTime();
+
+}  // namespace
+}  // namespace audiovis
@@ -0,0 +1,56 @@
+#include "audiovis/spectrogram.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+
+/// One minute of a slow sweep, shared by every run.
+const std::vector<float>& recording() {
+    static const std::vector<float> samples = [] {
+        std::vector<float> out(static_cast<std::size_t>(60 * kSampleRate));
+        double phase = 0.0;
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            phase += (50.0 + 0.25 * static_cast<double>(i) / 48.0) / 48000.0;
+            out[i] = static_cast<float>(0.5 * std::sin(2.0 * std::numbers::pi * phase));
+        }
+        return out;
+    }();
+    return samples;
+}
+
+/// Whole-recording spectrogram at band resolution. Wall-clock time, so the
+/// thread sweep shows scaling. Arguments: threads.
+void BM_SpectrogramEngine(benchmark::State& state) {
+    const SpectrogramEngine engine{{.fft = {.fft_size = 2048},
+                                    .hop_size = 512,
+                                    .threads = static_cast<std::size_t>(state.range(0))}};
+    const auto& samples = recording();
+
+    std::size_t frames = 0;
+    for (auto _ : state) {
+        const auto result = engine.compute(samples, kSampleRate);
+        frames = result.frames;
+        benchmark::DoNotOptimize(result.values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(frames));
+    state.counters["realtime_x"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * static_cast<double>(samples.size()) /
+            static_cast<double>(kSampleRate),
+        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SpectrogramEngine)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace audiovis
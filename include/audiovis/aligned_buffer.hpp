@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace audiovis {
+
+/// Where a buffer's pages are placed on a NUMA machine.
+enum class MemoryPlacement {
+    Local,       // Zeroed at allocation: pages land on the allocating thread's node
+    FirstTouch,  // Left unpopulated: each page lands on the node of the first thread to write it
+    Bind         // Bound to BufferPolicy::numa_node (mbind), then zeroed
+};
+
+/// How a large buffer, such as a capture ring or an FFT workspace, is backed.
+struct BufferPolicy {
+    bool huge_pages = false;              // Back with 2 MiB pages where the kernel allows
+    MemoryPlacement placement = MemoryPlacement::Local;
+    unsigned numa_node = 0;               // Node for MemoryPlacement::Bind
+    std::size_t alignment = 64;           // Power of two; never less than a cache line
+
+    bool operator==(const BufferPolicy&) const = default;
+};
+
+/// An owned block of raw memory, allocated according to a BufferPolicy.
+///
+/// The default policy is an aligned operator new plus a zero fill, which is
+/// what make_unique<T[]>() gives, but always at least cache-line aligned so
+/// SIMD kernels never straddle lines. Any other policy maps anonymous memory
+/// directly. With huge_pages the block is rounded up to whole 2 MiB pages and
+/// explicit hugetlbfs pages (MAP_HUGETLB) are tried first, falling back to a
+/// 2 MiB-aligned mapping advised for transparent hugepages; blocks smaller
+/// than a hugepage ignore the request rather than waste most of one. Bind
+/// sets an mbind(MPOL_BIND) policy before any page is touched.
+///
+/// As with apply_thread_policy(), what the kernel refuses is reported rather
+/// than thrown: the block is still allocated, from ordinary pages or without
+/// the binding, and notes() says why.
+///
+/// Memory always reads as zero. Local and Bind blocks are populated up front,
+/// so the real-time path takes no first-touch page fault; FirstTouch blocks
+/// are not, so they land beside the thread that writes them first (the
+/// producer for a ring, the analysis thread for an FFT workspace). Note that
+/// lock_process_memory() populates every page from the calling thread, so
+/// combine it with Bind rather than FirstTouch.
+class AlignedBuffer {
+public:
+    /// Size of an explicit or transparent hugepage.
+    static constexpr std::size_t kHugePageSize = std::size_t{2} << 20;
+
+    /// Constructs an empty buffer.
+    AlignedBuffer() noexcept = default;
+
+    /// Allocates `bytes` bytes as `policy` describes.
+    /// @throws std::invalid_argument if policy.alignment is not a power of two.
+    /// @throws std::bad_alloc if no memory can be allocated at all.
+    explicit AlignedBuffer(std::size_t bytes, const BufferPolicy& policy = {});
+
+    /// Releases the memory.
+    ~AlignedBuffer();
+
+    // Non-copyable, movable
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    AlignedBuffer(AlignedBuffer&& other) noexcept;
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept;
+
+    /// Returns the start of the block, aligned as requested (null if empty).
+    [[nodiscard]] void* data() const noexcept { return data_; }
+
+    /// Returns the block as an array of trivially copyable `T`.
+    template <typename T>
+    [[nodiscard]] T* as() const noexcept {
+        return static_cast<T*>(data_);
+    }
+
+    /// Returns the requested size in bytes.
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+    /// Returns true if the block is backed by hugepages: explicit ones, or a
+    /// transparent hugepage advice the kernel accepted.
+    [[nodiscard]] bool huge_pages() const noexcept { return huge_pages_; }
+
+    /// Returns true if the block is bound to the requested NUMA node.
+    [[nodiscard]] bool bound() const noexcept { return bound_; }
+
+    /// Why part of the policy was not applied; empty if all of it was.
+    [[nodiscard]] const std::string& notes() const noexcept { return notes_; }
+
+private:
+    void release() noexcept;
+
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t mapped_ = 0;              // Length of the mapping; 0 if from operator new
+    std::size_t alignment_ = 0;           // Alignment passed to operator new
+    bool huge_pages_ = false;
+    bool bound_ = false;
+    std::string notes_;
+};
+
+}  // namespace audiovis
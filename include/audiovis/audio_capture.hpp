@@ -1,16 +1,17 @@
 #pragma once
 
-#include "audiovis/ring_buffer.hpp"
+#include "audiovis/audio_source.hpp"
+#include "audiovis/seqlock.hpp"
 
 #include <portaudio.h>
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
-#include <functional>
-#include <memory>
 #include <span>
-#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace audiovis {
 
@@ -18,60 +19,58 @@ namespace audiovis {
 struct AudioConfig {
     std::uint32_t sample_rate = 48000;    // Samples per second
     std::uint32_t buffer_frames = 256;    // Frames per callback (latency tradeoff)
-    std::uint32_t channels = 1;           // Mono capture for visualization
-    float ring_buffer_seconds = 0.5f;     // History buffer duration
-};
-
-/// Audio capture statistics for monitoring.
-struct AudioStats {
-    std::uint64_t frames_captured = 0;
-    std::uint64_t overruns = 0;           // Ring buffer overflows
-    std::uint64_t callback_count = 0;
-    float peak_amplitude = 0.0f;
+    std::uint32_t channels = 1;           // Input channels (one ring buffer each)
+    float ring_buffer_seconds = 0.5f;     // History buffer duration (per channel)
+    BufferPolicy ring_buffers{};          // Backing of the channel rings
+    bool channel_rings = true;            // False: broadcast ring only (no analyzer reads)
 };
 
 /// Manages audio input capture via PortAudio.
 ///
 /// Runs the PortAudio callback in a real-time thread and writes captured
-/// samples into a lock-free ring buffer for consumption by the visualization
+/// samples into lock-free ring buffers for consumption by the visualization
 /// thread. The callback performs no allocations and no blocking operations.
-class AudioCapture {
+///
+/// Multi-channel input is deinterleaved in the callback into one planar ring
+/// buffer per channel (see AudioSource).
+///
+/// Statistics are accumulated in plain fields owned by the callback thread and
+/// published once per callback through a seqlock: the real-time path performs
+/// no atomic read-modify-write operations, and stats() always returns a
+/// consistent snapshot.
+class AudioCapture final : public AudioSource {
 public:
+    /// Number of callbacks the peak and RMS levels in AudioStats cover.
+    static constexpr std::size_t kLevelWindow = 64;
+
     /// Initializes PortAudio and opens the default input device.
     /// @throws std::runtime_error on PortAudio initialization failure.
     explicit AudioCapture(const AudioConfig& config = {});
 
     /// Stops capture and releases PortAudio resources.
-    ~AudioCapture();
-
-    // Non-copyable, non-movable (owns PortAudio stream)
-    AudioCapture(const AudioCapture&) = delete;
-    AudioCapture& operator=(const AudioCapture&) = delete;
-    AudioCapture(AudioCapture&&) = delete;
-    AudioCapture& operator=(AudioCapture&&) = delete;
+    ~AudioCapture() override;
 
     /// Starts audio capture. Idempotent if already running.
-    void start();
+    /// @throws std::logic_error if there are no channel rings and no broadcast ring.
+    void start() override;
 
     /// Stops audio capture. Idempotent if already stopped.
-    void stop();
+    void stop() override;
 
     /// Returns true if capture is currently active.
-    [[nodiscard]] bool is_running() const noexcept { return running_.load(std::memory_order_relaxed); }
-
-    /// Returns the configured sample rate.
-    [[nodiscard]] std::uint32_t sample_rate() const noexcept { return config_.sample_rate; }
+    [[nodiscard]] bool is_running() const noexcept override {
+        return running_.load(std::memory_order_relaxed);
+    }
 
-    /// Returns the number of channels (typically 1 for visualization).
-    [[nodiscard]] std::uint32_t channels() const noexcept { return config_.channels; }
+    /// Capture follows the device clock.
+    [[nodiscard]] bool is_realtime() const noexcept override { return true; }
 
-    /// Returns current capture statistics.
-    [[nodiscard]] AudioStats stats() const noexcept;
+    /// Returns a consistent snapshot of the capture statistics as of the most
+    /// recent callback. Lock-free; safe to call from any thread.
+    [[nodiscard]] AudioStats stats() const noexcept override;
 
-    /// Provides read access to the sample ring buffer.
-    /// Consumer thread should read from this to get captured audio.
-    [[nodiscard]] RingBuffer<float>& buffer() noexcept { return *ring_buffer_; }
-    [[nodiscard]] const RingBuffer<float>& buffer() const noexcept { return *ring_buffer_; }
+    /// Returns the name of the input device being used.
+    [[nodiscard]] const std::string& name() const noexcept override { return device_name_; }
 
     /// Returns the name of the input device being used.
     [[nodiscard]] const std::string& device_name() const noexcept { return device_name_; }
@@ -91,21 +90,28 @@ private:
         void* user_data
     );
 
-    /// Internal callback implementation.
+    /// Internal callback implementation. `samples` is frame-interleaved.
     void process_audio(std::span<const float> samples, unsigned long status_flags);
 
+    /// Statistics state written only by the callback thread.
+    struct alignas(64) CallbackState {
+        AudioStats totals;
+        std::array<float, kLevelWindow> block_peaks{};
+        std::array<float, kLevelWindow> block_energy{};  // Sum of squares per callback
+        std::array<std::size_t, kLevelWindow> block_samples{};
+        std::size_t level_index = 0;
+        std::chrono::steady_clock::time_point last_callback{};
+    };
+
     AudioConfig config_;
     std::string device_name_;
-    std::unique_ptr<RingBuffer<float>> ring_buffer_;
 
     PaStream* stream_ = nullptr;
     std::atomic<bool> running_{false};
 
-    // Statistics - updated atomically from callback
-    std::atomic<std::uint64_t> frames_captured_{0};
-    std::atomic<std::uint64_t> overruns_{0};
-    std::atomic<std::uint64_t> callback_count_{0};
-    std::atomic<float> peak_amplitude_{0.0f};
+    // Statistics - accumulated by the callback, published through the seqlock
+    CallbackState callback_state_;
+    SeqLock<AudioStats> stats_;
 };
 
 /// RAII guard for PortAudio library initialization.
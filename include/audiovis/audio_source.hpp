@@ -0,0 +1,150 @@
+#pragma once
+
+#include "audiovis/broadcast_ring.hpp"
+#include "audiovis/latency_histogram.hpp"
+#include "audiovis/ring_buffer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace audiovis {
+
+/// Audio capture statistics for monitoring.
+///
+/// Levels cover a sliding window of the most recent AudioCapture::kLevelWindow
+/// callbacks (about 0.34 s with the default 256-frame buffer at 48 kHz), so
+/// they fall back once the input goes quiet. Offline sources report frames
+/// and blocks produced; levels and timing stay zero.
+struct AudioStats {
+    std::uint64_t frames_captured = 0;    // Sample frames (one sample per channel)
+    std::uint64_t overruns = 0;           // Ring buffer overflows plus input overflows
+    std::uint64_t input_overflows = 0;    // Of which the device dropped before the callback
+    std::uint64_t callback_count = 0;     // Device callbacks, or blocks produced offline
+    float peak_amplitude = 0.0f;          // Peak |sample| over the level window
+    float rms_level = 0.0f;               // RMS over the level window
+    LatencyHistogram callback_duration;   // Time spent inside the callback
+    LatencyHistogram callback_interval;   // Time between successive callbacks (jitter)
+};
+
+/// A producer of multi-channel audio feeding the analysis pipeline.
+///
+/// Every source delivers its samples the same way: deinterleaved into one
+/// lock-free SPSC ring buffer per channel, written in lockstep so a consumer
+/// that reads and commits the same count from each stays frame-aligned. The
+/// source is the rings' single producer; SpectrumAnalyzer is their consumer.
+///
+/// Further consumers (a recorder, a network publisher, a second analyzer)
+/// attach through an optional broadcast ring instead: enable_broadcast()
+/// makes the source also write every frame, interleaved, into one
+/// BroadcastRing, and each consumer follows it with its own Reader. The
+/// producer copies each frame once however many readers there are and never
+/// waits for them; readers that fall a lap behind are skipped forward. A
+/// source built without channel rings feeds only the broadcast ring, for
+/// consumers such as a headless recorder where nothing reads the rings.
+///
+/// Real-time sources (AudioCapture) are driven by a device clock once
+/// started. Offline sources (files, generators) can also be started on their
+/// own producer thread, or pumped synchronously with produce() for
+/// deterministic, faster-than-real-time batch analysis.
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+
+    // Non-copyable, non-movable (owns ring buffers shared with the consumer)
+    AudioSource(const AudioSource&) = delete;
+    AudioSource& operator=(const AudioSource&) = delete;
+    AudioSource(AudioSource&&) = delete;
+    AudioSource& operator=(AudioSource&&) = delete;
+
+    /// Starts delivering samples. Idempotent if already running.
+    virtual void start() = 0;
+
+    /// Stops delivering samples. Idempotent if already stopped.
+    virtual void stop() = 0;
+
+    /// Returns true while samples are being delivered in the background.
+    [[nodiscard]] virtual bool is_running() const noexcept = 0;
+
+    /// Returns true if samples arrive on a device clock (and may be dropped
+    /// when the consumer falls behind), false for offline sources.
+    [[nodiscard]] virtual bool is_realtime() const noexcept = 0;
+
+    /// Returns current statistics. Safe to call from any thread.
+    [[nodiscard]] virtual AudioStats stats() const noexcept = 0;
+
+    /// Returns a human-readable description (device name, file path, ...).
+    [[nodiscard]] virtual const std::string& name() const noexcept = 0;
+
+    /// Offline sources: synchronously writes up to `max_frames` frames into the
+    /// rings from the calling thread, limited by free ring space. Must not be
+    /// mixed with start(). Real-time sources produce nothing here.
+    /// @return Frames written; 0 when the rings are full or the source has ended.
+    virtual std::size_t produce(std::size_t max_frames);
+
+    /// Returns true once a finite source has delivered its last sample.
+    [[nodiscard]] virtual bool at_end() const noexcept { return false; }
+
+    /// Returns the sample rate in Hz.
+    [[nodiscard]] std::uint32_t sample_rate() const noexcept { return sample_rate_; }
+
+    /// Returns the number of channels.
+    [[nodiscard]] std::uint32_t channels() const noexcept { return channels_; }
+
+    /// Provides read access to one channel's sample ring buffer.
+    /// Consumer thread should read from this to get captured audio.
+    /// @param channel Channel index, 0 to channels()-1
+    [[nodiscard]] RingBuffer<float>& buffer(std::size_t channel = 0) noexcept {
+        return *ring_buffers_[channel];
+    }
+    [[nodiscard]] const RingBuffer<float>& buffer(std::size_t channel = 0) const noexcept {
+        return *ring_buffers_[channel];
+    }
+
+    /// Creates the broadcast ring, holding at least `frames` frames of
+    /// channels() interleaved samples. Call before start(); the ring lives as
+    /// long as the source.
+    /// @throws std::logic_error if the source is running or the ring exists.
+    /// @throws std::invalid_argument if `frames` is zero.
+    BroadcastRing<float>& enable_broadcast(std::size_t frames);
+
+    /// Returns the broadcast ring, or null until enable_broadcast().
+    [[nodiscard]] const BroadcastRing<float>* broadcast() const noexcept {
+        return broadcast_.get();
+    }
+
+    /// Returns false if samples go to the broadcast ring only. The channel
+    /// rings then exist but stay empty.
+    [[nodiscard]] bool has_channel_rings() const noexcept { return channel_rings_; }
+
+protected:
+    /// Allocates one ring of `ring_capacity` samples per channel, backed as
+    /// `ring_policy` describes. Without `channel_rings`, only token one-sample
+    /// rings are allocated and push_interleaved() skips them.
+    /// @throws std::invalid_argument if channels or sample_rate is zero.
+    AudioSource(std::uint32_t sample_rate, std::uint32_t channels, std::size_t ring_capacity,
+                const BufferPolicy& ring_policy = {}, bool channel_rings = true);
+
+    /// Returns the number of frames every channel ring can accept.
+    [[nodiscard]] std::size_t writable_frames() const noexcept;
+
+    /// Deinterleaves frame-interleaved `samples` into the channel rings.
+    /// Every ring receives the same count, so they stay aligned on overflow.
+    /// The broadcast ring, if any, receives every frame regardless.
+    /// Real-time safe: no allocation, no locks.
+    /// @return True if every frame fit (always, without channel rings); false
+    ///         if the rings overflowed.
+    bool push_interleaved(std::span<const float> samples) noexcept;
+
+private:
+    std::uint32_t sample_rate_;
+    std::uint32_t channels_;
+    bool channel_rings_;
+    std::vector<std::unique_ptr<RingBuffer<float>>> ring_buffers_;  // One per channel
+    std::unique_ptr<BroadcastRing<float>> broadcast_;  // Interleaved fan-out; optional
+};
+
+}  // namespace audiovis
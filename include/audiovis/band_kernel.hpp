@@ -0,0 +1,52 @@
+#pragma once
+
+#include "audiovis/band_matrix.hpp"
+#include "audiovis/fft_processor.hpp"
+
+#include <cstddef>
+#include <span>
+
+namespace audiovis {
+
+/// Temporal smoothing and peak hold applied to display bands each frame.
+struct BandSmoothing {
+    float smoothing_factor = 0.0f;   // Weight of the previous value (0 = no smoothing)
+    float peak_decay_rate = 1.0f;    // Peak multiplier per frame while not rising
+};
+
+/// One channel's run of bands, one array per quantity (structure of arrays).
+/// All four spans cover the same bands.
+struct BandLanes {
+    std::span<float> smoothed;       // Smoothing state, updated in place
+    std::span<float> peaks;          // Peak hold state, updated in place
+    std::span<float> magnitudes_out; // Receives the smoothed values
+    std::span<float> peaks_out;      // Receives the peak values
+};
+
+/// Smooths raw band values into `lanes` and writes them out.
+/// @param raw One value per band of `lanes`.
+void smooth_bands(std::span<const float> raw, const BandSmoothing& smoothing,
+                  const BandLanes& lanes) noexcept;
+
+/// Goes from one channel's complex FFT output straight to smoothed,
+/// peak-held display bands in a single pass.
+///
+/// Walks the band matrix row by row. Each row's bins not already converted by
+/// an earlier row are taken from power to the FFT's magnitude scale (dB or
+/// linear) into `scratch`, then dotted with the row's weights, smoothed and
+/// peak-held while still in cache. Bins no band reads are never converted,
+/// and no whole-spectrum magnitude array is written and read back. The values
+/// equal FFTProcessor::compute_batch() followed by BandMatrix::apply() and
+/// smooth_bands(), up to rounding.
+///
+/// @param fft Processor holding the channel's last transform_batch().
+/// @param matrix Band matrix with fft.bin_count() columns; rows start in bin
+///               order, as every BandMatrix layout does.
+/// @param scratch At least fft.bin_count() floats, indexed by bin; only the
+///                bins a band reads are written.
+/// @param lanes One entry per band of `matrix`.
+void fused_bands(const FFTProcessor& fft, std::size_t channel, const BandMatrix& matrix,
+                 const BandSmoothing& smoothing, std::span<float> scratch,
+                 const BandLanes& lanes) noexcept;
+
+}  // namespace audiovis
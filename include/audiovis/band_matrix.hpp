@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace audiovis {
+
+/// Frequency axis along which display band edges are evenly spaced.
+enum class FrequencyScale {
+    Linear,       // Equal width in Hz
+    Logarithmic,  // Equal width in octaves
+    Mel,          // Equal width in mels (perceptual pitch)
+    ERB           // Equal width in equivalent rectangular bandwidths (auditory filters)
+};
+
+/// How FFT bins are weighted into each display band.
+enum class BandWeighting {
+    Rectangular,  // Plain average of the whole bins inside the band (compute_log_bands())
+    Fractional,   // Bins weighted by their overlap with the band; sub-bin bands interpolate
+    Triangular    // Overlapping triangular filters peaking at each band centre (filterbank)
+};
+
+/// Describes the display bands a BandMatrix maps FFT bins onto.
+struct BandLayout {
+    std::size_t num_bands = 64;
+    float min_frequency = 20.0f;          // Lower edge of the first band (Hz)
+    float max_frequency = 20000.0f;       // Upper edge of the last band (Hz)
+    FrequencyScale scale = FrequencyScale::Logarithmic;
+    BandWeighting weighting = BandWeighting::Fractional;
+};
+
+/// Converts a frequency in Hz to a position on the given scale.
+[[nodiscard]] float hz_to_scale(float hz, FrequencyScale scale) noexcept;
+
+/// Inverse of hz_to_scale().
+[[nodiscard]] float scale_to_hz(float value, FrequencyScale scale) noexcept;
+
+/// Sparse matrix mapping an FFT magnitude spectrum onto display bands.
+///
+/// Built once per band layout and stored in CSR form: row b lists the bins
+/// feeding band b and their weights, normalized so each row sums to one.
+/// Band values are therefore weighted averages and stay within the range of
+/// the input magnitudes. Every row covers a run of consecutive bins, so
+/// apply() evaluates each band as one dense SIMD dot product.
+///
+/// Unlike compute_log_bands(), bands narrower than one bin are not snapped to
+/// a whole bin: Fractional and Triangular weighting interpolate between the
+/// two nearest bins, so neighbouring low-frequency bands stay distinct.
+class BandMatrix {
+public:
+    /// Creates an empty matrix (no bands).
+    BandMatrix() = default;
+
+    /// Builds the matrix for a layout and FFT geometry.
+    /// @param bin_count Number of FFT magnitude bins (fft_size / 2 + 1)
+    /// @param fft_size FFT length the bins come from
+    /// @param sample_rate Audio sample rate (Hz)
+    /// @throws std::invalid_argument if the layout has no bands, min_frequency
+    ///         is not positive or not below max_frequency, or bin_count is 0.
+    BandMatrix(const BandLayout& layout, std::size_t bin_count, std::size_t fft_size,
+               float sample_rate);
+
+    /// Computes bands[b] = sum of weight * bins[column] over row b.
+    /// @param bins Magnitude spectrum; size must be >= bin_count().
+    /// @param bands Output; size must be >= band_count().
+    void apply(std::span<const float> bins, std::span<float> bands) const noexcept;
+
+    /// Returns the number of bands (matrix rows).
+    [[nodiscard]] std::size_t band_count() const noexcept {
+        return edges_.empty() ? 0 : edges_.size() - 1;
+    }
+
+    /// Returns the number of FFT bins (matrix columns).
+    [[nodiscard]] std::size_t bin_count() const noexcept { return bin_count_; }
+
+    /// Returns the number of stored weights.
+    [[nodiscard]] std::size_t nonzeros() const noexcept { return weights_.size(); }
+
+    /// Returns the band edge frequencies (Hz): band b spans [edges[b], edges[b + 1]).
+    [[nodiscard]] std::span<const float> band_edges() const noexcept { return edges_; }
+
+    /// CSR row offsets: row b's weights are [row_offsets[b], row_offsets[b + 1]).
+    [[nodiscard]] std::span<const std::size_t> row_offsets() const noexcept { return row_offsets_; }
+
+    /// CSR column (bin) index of each stored weight.
+    [[nodiscard]] std::span<const std::size_t> columns() const noexcept { return columns_; }
+
+    /// CSR weight values.
+    [[nodiscard]] std::span<const float> weights() const noexcept { return weights_; }
+
+private:
+    void append_row(std::size_t first_bin, std::span<const float> row_weights);
+
+    std::size_t bin_count_ = 0;
+    std::vector<float> edges_;
+    std::vector<std::size_t> row_offsets_{0};
+    std::vector<std::size_t> columns_;
+    std::vector<float> weights_;
+};
+
+}  // namespace audiovis
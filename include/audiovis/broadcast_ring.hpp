@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+namespace audiovis {
+
+/// Single-producer multi-consumer broadcast ring of fixed-size frames.
+///
+/// Where RingBuffer hands each element to one consumer, every Reader of a
+/// BroadcastRing sees the whole stream through its own cursor, so a
+/// recorder, a network publisher and a second analyzer can all follow one
+/// capture stream that the producer writes exactly once. The producer never
+/// waits for anyone: it always overwrites the oldest frame. A reader that
+/// falls more than capacity() frames behind is skipped forward to the oldest
+/// frame still intact, and its overrun counters record what it lost.
+///
+/// Readers copy frames out rather than reading ring storage in place, since
+/// the slots they read may be overwritten at any moment. The copy is
+/// validated seqlock style: the producer announces the frames it is about to
+/// overwrite before touching them, and a reader that finds its copy overlapped
+/// by such a claim discards the torn frames and counts them as skipped.
+/// Slots are relaxed atomics, so the optimistic reads are well-defined; on
+/// mainstream targets they compile to ordinary loads and stores.
+///
+/// A frame is `stride` elements, e.g. one interleaved sample per channel;
+/// positions and counts are in frames, so skipping never splits one.
+///
+/// Template parameter T must be trivially copyable and lock-free as an
+/// atomic (typically float for audio).
+template <typename T>
+    requires std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free
+class BroadcastRing {
+public:
+    class Reader;
+
+    /// Constructs a ring of at least `min_frames` frames of `stride` elements.
+    /// The frame capacity is rounded up to the next power of two.
+    explicit BroadcastRing(std::size_t min_frames, std::size_t stride = 1)
+        : capacity_{next_power_of_two(min_frames)}
+        , mask_{capacity_ - 1}
+        , stride_{std::max<std::size_t>(stride, 1)}
+        , slots_{std::make_unique<std::atomic<T>[]>(capacity_ * stride_)} {
+        assert(capacity_ > 0 && (capacity_ & mask_) == 0);
+    }
+
+    // Non-copyable, non-movable (readers point at it; atomics don't move safely)
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+    BroadcastRing(BroadcastRing&&) = delete;
+    BroadcastRing& operator=(BroadcastRing&&) = delete;
+
+    /// Returns the capacity in frames (always a power of two).
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    /// Returns the number of elements per frame.
+    [[nodiscard]] std::size_t stride() const noexcept { return stride_; }
+
+    /// Returns the number of frames written so far. Safe to call from any thread.
+    [[nodiscard]] std::size_t frames_written() const noexcept {
+        return write_pos_.load(std::memory_order_acquire);
+    }
+
+    // -------------------------------------------------------------------------
+    // Producer interface (call from one thread only)
+    // -------------------------------------------------------------------------
+
+    /// Appends the whole frames in `data` (a multiple of stride() elements),
+    /// overwriting the oldest. Wait-free and allocation-free: safe for
+    /// real-time audio callbacks.
+    void push(std::span<const T> data) noexcept {
+        assert(data.size() % stride_ == 0);
+        const auto frames = data.size() / stride_;
+
+        // At most one lap per step, so a claim never reaches past the frames
+        // a reader may have just seen published
+        for (std::size_t done = 0; done < frames;) {
+            const auto count = std::min(frames - done, capacity_);
+            const auto w = write_pos_.load(std::memory_order_relaxed);
+
+            // Claim the slots before overwriting them, so readers still
+            // copying their old contents can tell
+            claim_pos_.store(w + count, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (std::size_t f = 0; f < count; ++f) {
+                std::atomic<T>* slot = slots_.get() + ((w + f) & mask_) * stride_;
+                const T* frame = data.data() + (done + f) * stride_;
+                for (std::size_t e = 0; e < stride_; ++e) {
+                    slot[e].store(frame[e], std::memory_order_relaxed);
+                }
+            }
+
+            write_pos_.store(w + count, std::memory_order_release);
+            done += count;
+        }
+    }
+
+private:
+    static constexpr std::size_t next_power_of_two(std::size_t n) noexcept {
+        if (n == 0) return 1;
+        --n;
+        n |= n >> 1;
+        n |= n >> 2;
+        n |= n >> 4;
+        n |= n >> 8;
+        n |= n >> 16;
+        n |= n >> 32;
+        return n + 1;
+    }
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    const std::size_t stride_;
+    std::unique_ptr<std::atomic<T>[]> slots_;
+
+    // Producer-owned positions, on their own cache line (readers only load them)
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    alignas(kCacheLineSize) std::atomic<std::size_t> write_pos_{0};  // Frames published
+    std::atomic<std::size_t> claim_pos_{0};                          // Frames being written
+};
+
+/// One consumer's cursor into a BroadcastRing.
+///
+/// Starts at the newest frame: it sees what is written after it was created.
+/// Reading is for one thread only; lag() and the counters may be polled from
+/// any thread, e.g. for monitoring.
+template <typename T>
+    requires std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free
+class BroadcastRing<T>::Reader {
+public:
+    explicit Reader(const BroadcastRing& ring) noexcept
+        : ring_{&ring}, cursor_{ring.write_pos_.load(std::memory_order_acquire)} {}
+
+    // Non-copyable, non-movable (atomics don't move safely)
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+    Reader(Reader&&) = delete;
+    Reader& operator=(Reader&&) = delete;
+
+    /// Copies up to out.size() / stride() of the oldest unread frames into
+    /// `out`. If the producer has lapped this reader, it first skips forward
+    /// to the oldest intact frame. Lock-free and allocation-free.
+    /// @return Frames copied.
+    std::size_t read(std::span<T> out) noexcept {
+        const auto& ring = *ring_;
+        const auto stride = ring.stride_;
+        auto r = cursor_.load(std::memory_order_relaxed);
+        const auto w = ring.write_pos_.load(std::memory_order_acquire);
+        if (w - r > ring.capacity_) {
+            skip(r, w - ring.capacity_);
+        }
+
+        auto count = std::min(w - r, out.size() / stride);
+        for (std::size_t f = 0; f < count; ++f) {
+            const std::atomic<T>* slot = ring.slots_.get() + ((r + f) & ring.mask_) * stride;
+            T* frame = out.data() + f * stride;
+            for (std::size_t e = 0; e < stride; ++e) {
+                frame[e] = slot[e].load(std::memory_order_relaxed);
+            }
+        }
+
+        // Frames older than the producer's claim minus a lap may have been
+        // overwritten mid-copy: drop them, keep whatever is still intact
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto claim = ring.claim_pos_.load(std::memory_order_relaxed);
+        const auto intact = claim > ring.capacity_ ? claim - ring.capacity_ : 0;
+        if (intact > r) {
+            const auto torn = std::min(intact - r, count);
+            std::copy(out.begin() + static_cast<std::ptrdiff_t>(torn * stride),
+                      out.begin() + static_cast<std::ptrdiff_t>(count * stride), out.begin());
+            count -= torn;
+            skip(r, intact);
+        }
+
+        cursor_.store(r + count, std::memory_order_release);
+        frames_read_.store(frames_read_.load(std::memory_order_relaxed) + count,
+                           std::memory_order_relaxed);
+        return count;
+    }
+
+    /// Skips every unread frame: the next read() returns only new frames.
+    void skip_to_newest() noexcept {
+        cursor_.store(ring_->write_pos_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /// Returns how many frames this reader is behind the producer. Above
+    /// capacity() it has been lapped and will skip on its next read().
+    [[nodiscard]] std::size_t lag() const noexcept {
+        // Cursor first: it never passes the write position loaded after it
+        const auto r = cursor_.load(std::memory_order_acquire);
+        return ring_->write_pos_.load(std::memory_order_acquire) - r;
+    }
+
+    /// Returns how many times this reader was skipped forward.
+    [[nodiscard]] std::uint64_t overruns() const noexcept {
+        return overruns_.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the frames this reader lost to overruns.
+    [[nodiscard]] std::uint64_t frames_skipped() const noexcept {
+        return frames_skipped_.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the frames this reader has copied out.
+    [[nodiscard]] std::uint64_t frames_read() const noexcept {
+        return frames_read_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /// Moves `r` forward to `to`, recording one overrun.
+    void skip(std::size_t& r, std::size_t to) noexcept {
+        overruns_.store(overruns_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        frames_skipped_.store(frames_skipped_.load(std::memory_order_relaxed) + (to - r),
+                              std::memory_order_relaxed);
+        r = to;
+    }
+
+    const BroadcastRing* ring_;
+    std::atomic<std::size_t> cursor_;
+    std::atomic<std::uint64_t> overruns_{0};
+    std::atomic<std::uint64_t> frames_skipped_{0};
+    std::atomic<std::uint64_t> frames_read_{0};
+};
+
+}  // namespace audiovis
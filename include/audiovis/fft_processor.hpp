@@ -1,20 +1,24 @@
 #pragma once
 
+#include "audiovis/aligned_buffer.hpp"
+#include "audiovis/window_table.hpp"
+
 #include <cstddef>
 #include <memory>
 #include <span>
+#include <string>
 #include <vector>
 
 namespace audiovis {
 
-/// Window functions for spectral analysis.
-/// The choice of window affects frequency resolution vs. spectral leakage tradeoff.
-enum class WindowFunction {
-    Rectangular,  // No windowing - maximum resolution, maximum leakage
-    Hann,         // Good general purpose - moderate resolution and leakage
-    Hamming,      // Similar to Hann with slightly different sidelobe behavior
-    Blackman,     // Low leakage at cost of frequency resolution
-    FlatTop       // Accurate amplitude measurement, poor frequency resolution
+/// How hard FFTW searches for a fast plan.
+/// Higher rigor costs more time when a size is first planned but executes faster.
+/// Anything above Estimate benefits from a wisdom file (see load_fftw_wisdom()).
+enum class PlannerRigor {
+    Estimate,   // Heuristic only - instant, no measurements
+    Measure,    // Times a few candidate algorithms (typically well under a second)
+    Patient,    // Wider search, can take seconds for large sizes
+    Exhaustive  // Everything FFTW knows, can take minutes
 };
 
 /// Configuration for FFT processing.
@@ -24,16 +28,34 @@ struct FFTConfig {
     bool use_magnitude_db = true;             // Output in decibels
     float db_floor = -80.0f;                  // Minimum dB value (noise floor)
     float db_ceiling = 0.0f;                  // Maximum dB value (0 dB = full scale)
+    PlannerRigor planner = PlannerRigor::Estimate;  // FFTW planning effort
+    std::size_t channels = 1;                 // Signals transformed together per batch
+    BufferPolicy buffers{};                   // Backing of the FFTW input/output buffers
+};
+
+/// One channel's input signal, stored as `head` followed by `tail`.
+/// Matches the layout of a RingBuffer read region; `tail` is often empty.
+struct SegmentedInput {
+    std::span<const float> head;
+    std::span<const float> tail;
 };
 
 /// Computes FFT and extracts magnitude spectrum from audio samples.
 ///
 /// This class manages FFTW resources and provides a simple interface for
-/// real-time spectrum analysis. It maintains internal buffers for the window
-/// function and FFT input/output, so repeated calls don't allocate.
+/// real-time spectrum analysis. It maintains internal buffers for the FFT
+/// input/output, so repeated calls don't allocate.
+///
+/// FFTW plans come from a process-wide cache, so instances of the same size and
+/// planner rigor share a single plan and only the first one pays for planning.
+/// Window coefficients are likewise shared (see window_table()). Magnitudes
+/// are divided by the window's coherent gain, so a full-scale sinusoid reads
+/// full scale through any window.
 ///
 /// Thread safety: NOT thread-safe. Create separate instances for different threads,
 /// or protect access externally. Designed to be called from visualization thread only.
+/// Construction and set_config() may be called from any thread; the shared plan
+/// cache serializes access to the FFTW planner.
 class FFTProcessor {
 public:
     /// Constructs processor with given FFT configuration.
@@ -60,12 +82,55 @@ public:
     /// @return Number of magnitude values written (always bin_count() on success).
     std::size_t compute(std::span<const float> samples, std::span<float> output);
 
-    /// Returns the number of output magnitude bins (fft_size / 2 + 1).
+    /// Computes magnitude spectrum from a signal split across two segments.
+    ///
+    /// The input is treated as `head` followed by `tail`, matching the layout of
+    /// a RingBuffer read region, so callers can window straight out of ring
+    /// storage without first gathering the samples into a contiguous buffer.
+    /// Zero-padding and truncation behave as for the single-span overload.
+    std::size_t compute(std::span<const float> head, std::span<const float> tail,
+                        std::span<float> output);
+
+    /// Computes magnitude spectra for all channels with one batched FFT.
+    ///
+    /// All channels are windowed into one FFTW input block and transformed by a
+    /// single fftwf_plan_many_dft_r2c plan. The per-bin post-processing then
+    /// sweeps every channel's spectrum in one pass. The single-channel compute()
+    /// overloads require channels() == 1.
+    ///
+    /// @param inputs One signal per channel; inputs.size() must equal channels().
+    ///               Each is zero-padded or truncated as in compute().
+    /// @param output Channel-planar output: channel c occupies
+    ///               [c * bin_count(), (c + 1) * bin_count()).
+    ///               Must have capacity >= channels() * bin_count().
+    /// @return Number of values written (channels() * bin_count()).
+    std::size_t compute_batch(std::span<const SegmentedInput> inputs, std::span<float> output);
+
+    /// Windows and transforms all channels as compute_batch() does, but leaves
+    /// the complex spectra in the FFTW output buffer for spectrum() and
+    /// convert_bins(). For callers that only need some bins, e.g. a fused band
+    /// kernel, this skips the per-bin pass over the whole spectrum.
+    /// @param inputs As for compute_batch().
+    void transform_batch(std::span<const SegmentedInput> inputs);
+
+    /// Returns one channel's spectrum from the last transform as interleaved
+    /// (re, im) pairs, bin_count() of them, unnormalized as FFTW produces it.
+    [[nodiscard]] std::span<const float> spectrum(std::size_t channel) const noexcept;
+
+    /// Converts bins [first_bin, first_bin + out.size()) of one channel's last
+    /// transform to exactly the values compute_batch() would output for them.
+    void convert_bins(std::size_t channel, std::size_t first_bin,
+                      std::span<float> out) const noexcept;
+
+    /// Returns the number of output magnitude bins per channel (fft_size / 2 + 1).
     [[nodiscard]] std::size_t bin_count() const noexcept { return config_.fft_size / 2 + 1; }
 
     /// Returns the FFT size (number of input samples processed).
     [[nodiscard]] std::size_t fft_size() const noexcept { return config_.fft_size; }
 
+    /// Returns the number of channels transformed per compute_batch() call.
+    [[nodiscard]] std::size_t channels() const noexcept { return config_.channels; }
+
     /// Returns the frequency (Hz) corresponding to a given bin index.
     /// @param bin_index Index into magnitude output (0 to bin_count()-1)
     /// @param sample_rate The sample rate of the input audio
@@ -79,24 +144,49 @@ public:
     /// Provides access to configuration.
     [[nodiscard]] const FFTConfig& config() const noexcept { return config_; }
 
-    /// Updates configuration. Reallocates buffers if fft_size changes.
+    /// Returns the shared window table in use.
+    [[nodiscard]] const WindowTable& window() const noexcept { return *window_; }
+
+    /// Updates configuration. Reallocates buffers if fft_size, planner, channels or
+    /// the buffer policy changes.
     void set_config(const FFTConfig& config);
 
 private:
     void allocate_buffers();
-    void compute_window();
     void release();
 
+    /// Factor taking power to normalized power: a full-scale sinusoid reads 1.
+    [[nodiscard]] float power_scale() const noexcept;
+
     FFTConfig config_;
 
     // FFTW resources (opaque pointers to avoid including fftw3.h)
     struct FFTWData;
     std::unique_ptr<FFTWData> fftw_;
 
-    // Pre-computed window coefficients
-    std::vector<float> window_;
+    // Shared window coefficients, owned by the process-wide cache
+    const WindowTable* window_;
 };
 
+/// Loads FFTW wisdom from `path` and makes it the process-wide wisdom file.
+///
+/// From then on, whenever a measured plan (planner rigor above Estimate) has
+/// to be created because the wisdom did not already cover it, the accumulated
+/// wisdom is written back to `path`. Later launches then get measured plans
+/// without paying the planning cost again. Pass an empty path to stop saving.
+///
+/// @return True if existing wisdom was imported; false if the file is missing
+///         or unreadable (planning then starts from scratch).
+bool load_fftw_wisdom(const std::string& path);
+
+/// Returns the per-user wisdom file, $XDG_CACHE_HOME/audiovis/fftw_wisdom
+/// (falling back to ~/.cache), creating its directory if needed. Empty if
+/// neither variable is set or the directory cannot be created.
+[[nodiscard]] std::string default_wisdom_path();
+
+/// Returns the number of distinct plans in the process-wide plan cache.
+[[nodiscard]] std::size_t fftw_cached_plan_count();
+
 /// Utility: Generates logarithmically-spaced bin indices for display.
 /// Useful for mapping linear FFT bins to a logarithmic frequency axis.
 ///
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "audiovis/mapped_file.hpp"
+#include "audiovis/offline_source.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace audiovis {
+
+/// On-disk formats FileSource can read.
+enum class FileFormat {
+    Auto,        // WAV if the file starts with a RIFF/WAVE header, raw float otherwise
+    Wav,         // RIFF WAVE: 16/24/32-bit integer PCM or 32-bit float
+    RawFloat32   // Headerless little-endian float32, frame-interleaved
+};
+
+/// Configuration for reading a recording.
+struct FileSourceConfig {
+    std::string path;
+    FileFormat format = FileFormat::Auto;
+    std::uint32_t sample_rate = 48000;    // Raw files only (WAV carries its own)
+    std::uint32_t channels = 1;           // Raw files only (WAV carries its own)
+    std::size_t block_frames = 4096;      // Frames decoded per step
+    float ring_buffer_seconds = 0.5f;     // History buffer duration (per channel)
+};
+
+/// Streams a memory-mapped WAV or raw float recording into the pipeline with
+/// no real-time pacing, for headless and batch analysis.
+///
+/// Samples are decoded straight from the mapping into the channel rings as
+/// the consumer makes room, so hours of audio need no more memory than the
+/// rings themselves.
+class FileSource final : public OfflineSource {
+public:
+    /// Maps and parses the file.
+    /// @throws std::runtime_error if the file cannot be mapped or is not a
+    ///         supported WAV file; std::invalid_argument on bad raw parameters.
+    explicit FileSource(const FileSourceConfig& config);
+
+    ~FileSource() override;
+
+    [[nodiscard]] const std::string& name() const noexcept override { return path_; }
+
+    /// Returns the total number of frames in the file.
+    [[nodiscard]] std::size_t total_frames() const noexcept { return total_samples_ / channels(); }
+
+    /// Returns the file's duration in seconds.
+    [[nodiscard]] double duration_seconds() const noexcept {
+        return static_cast<double>(total_frames()) / static_cast<double>(sample_rate());
+    }
+
+    /// Random access: decodes frames starting at `first_frame` into
+    /// frame-interleaved `interleaved`, independent of the streaming position.
+    /// Only reads the mapping, so any number of threads may call this at once.
+    /// @return Frames written; fewer than requested at the end of the file.
+    std::size_t read_frames(std::size_t first_frame, std::span<float> interleaved) const noexcept;
+
+protected:
+    std::size_t render(std::span<float> interleaved) override;
+
+private:
+    /// How samples are encoded in the data region.
+    enum class Encoding { Int16, Int24, Int32, Float32 };
+
+    /// Result of parsing the header.
+    struct Layout {
+        std::uint32_t sample_rate;
+        std::uint32_t channels;
+        Encoding encoding;
+        std::span<const std::byte> data;  // Sample region within the mapping
+    };
+
+    // Parse the mapping first, then build the base from what the header says
+    FileSource(const FileSourceConfig& config, MappedFile&& file);
+    FileSource(const FileSourceConfig& config, MappedFile&& file, const Layout& layout);
+
+    static Layout parse(const FileSourceConfig& config, const MappedFile& file);
+    static Layout parse_wav(std::span<const std::byte> bytes);
+
+    MappedFile file_;
+    std::string path_;
+    Encoding encoding_;
+    std::span<const std::byte> data_;
+    std::size_t bytes_per_sample_;
+    std::size_t total_samples_;
+    std::size_t position_ = 0;            // Next sample index (interleaved)
+};
+
+}  // namespace audiovis
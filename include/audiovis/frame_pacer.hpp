@@ -0,0 +1,100 @@
+#pragma once
+
+#include "audiovis/latency_histogram.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace audiovis {
+
+/// Configuration for render loop pacing.
+struct PacerConfig {
+    double target_fps = 60.0;             // Preferred frame rate
+    double min_fps = 15.0;                // Backoff never goes below this
+    double budget_fraction = 0.9;         // Work above this share of a period is an overrun
+    std::uint32_t backoff_frames = 30;    // Consecutive overruns before lowering the rate
+    std::uint32_t recover_frames = 120;   // Consecutive light frames before raising it again
+};
+
+/// Frame timing collected over a reporting window.
+struct FrameTelemetry {
+    LatencyHistogram analysis;            // Time to obtain each frame's spectrum
+    LatencyHistogram render;              // Time to draw each frame
+    LatencyHistogram jitter;              // Wake-up lateness against the deadline
+    std::uint64_t frames = 0;
+    std::uint64_t dropped = 0;            // Deadlines skipped because a frame ran long
+    double fps = 0.0;                     // Pacing rate at the end of the window
+};
+
+/// Renders telemetry as one line of JSON (p50/p99 in microseconds), for logs
+/// and tooling.
+[[nodiscard]] std::string to_json(const FrameTelemetry& telemetry);
+
+/// Deadline-based frame scheduler for render loops.
+///
+/// Frames are due at absolute deadlines spaced one period apart, so sleep
+/// overshoot never accumulates: a late wake-up shortens the next sleep
+/// instead of delaying every later frame. A frame that overruns whole
+/// periods skips those deadlines (counted as dropped) rather than trying to
+/// catch up with a burst.
+///
+/// When frames keep exceeding their budget the rate backs off by steps down
+/// to min_fps, and it climbs back toward target_fps once frames are
+/// comfortably cheap at the higher rate.
+///
+/// Time is passed in explicitly, so the policy is deterministic to test;
+/// wait() is the only call that sleeps. Not thread-safe.
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @throws std::invalid_argument unless 0 < min_fps <= target_fps and
+    ///         0 < budget_fraction <= 1.
+    explicit FramePacer(const PacerConfig& config = {}, Clock::time_point start = Clock::now());
+
+    /// Returns when the next frame is due.
+    [[nodiscard]] Clock::time_point deadline() const noexcept { return deadline_; }
+
+    /// Sleeps until the next deadline (returns at once if it has passed).
+    void wait() const;
+
+    /// Marks the start of a frame; records how late it is against its deadline.
+    void begin_frame(Clock::time_point now) noexcept;
+
+    /// Marks the end of a frame and schedules the next deadline.
+    /// @param analysis, render Time the frame spent in each phase.
+    void end_frame(Clock::time_point now, Clock::duration analysis,
+                   Clock::duration render) noexcept;
+
+    /// Returns the current pacing rate.
+    [[nodiscard]] double fps() const noexcept { return fps_; }
+
+    /// Returns the current frame period.
+    [[nodiscard]] Clock::duration period() const noexcept { return period_; }
+
+    /// Returns telemetry accumulated since the last reset_window().
+    [[nodiscard]] const FrameTelemetry& window() const noexcept { return window_; }
+
+    /// Starts a new reporting window.
+    void reset_window() noexcept;
+
+    /// Returns totals since construction.
+    [[nodiscard]] std::uint64_t total_frames() const noexcept { return total_frames_; }
+    [[nodiscard]] std::uint64_t total_dropped() const noexcept { return total_dropped_; }
+
+private:
+    void set_fps(double fps) noexcept;
+
+    PacerConfig config_;
+    double fps_;
+    Clock::duration period_{};
+    Clock::time_point deadline_;
+    std::uint32_t overruns_ = 0;          // Consecutive frames over budget
+    std::uint32_t light_ = 0;             // Consecutive frames cheap enough to speed up
+    FrameTelemetry window_;
+    std::uint64_t total_frames_ = 0;
+    std::uint64_t total_dropped_ = 0;
+};
+
+}  // namespace audiovis
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+namespace audiovis {
+
+/// Streaming decimate-by-two with a linear-phase half-band FIR.
+///
+/// A half-band low-pass cuts off at a quarter of the input rate, so every
+/// tap at an even offset from the centre is zero and the centre tap is 1/2.
+/// The filter is evaluated in polyphase form, only at the output rate and
+/// folding the symmetric taps, which costs kTaps / 4 + 1 multiplies per
+/// output sample (6.5 per input).
+///
+/// The Kaiser-windowed design passes [0, kPassband) of the output Nyquist
+/// frequency with under 0.01 dB ripple and rejects more than 70 dB of what
+/// would alias into it. Cascading stages divides the rate by powers of two;
+/// each adds delay() input samples of group delay.
+///
+/// State carries across process() calls, so the output does not depend on
+/// how the input is split into blocks. Not thread-safe; allocation-free.
+class HalfBandDecimator {
+public:
+    static constexpr std::size_t kTaps = 47;                 // Filter length (4k - 1)
+    static constexpr std::size_t kSideTaps = (kTaps + 1) / 4;  // Distinct non-zero side taps
+    static constexpr float kPassband = 0.75f;               // Alias-free share of output Nyquist
+
+    HalfBandDecimator();
+
+    /// Filters `input` and writes every second sample of the result.
+    /// @param output Must hold at least output_size(input.size()) samples.
+    /// @return Samples written.
+    std::size_t process(std::span<const float> input, std::span<float> output) noexcept;
+
+    /// Returns the most samples process() can write for `input_size` inputs.
+    [[nodiscard]] static constexpr std::size_t output_size(std::size_t input_size) noexcept {
+        return (input_size + 1) / 2;
+    }
+
+    /// Returns the group delay in input samples.
+    [[nodiscard]] static constexpr std::size_t delay() noexcept { return (kTaps - 1) / 2; }
+
+    /// Returns the side tap at offset 2 * j + 1 from the centre.
+    [[nodiscard]] float side_tap(std::size_t j) const noexcept { return side_[j]; }
+
+    /// Clears the filter history.
+    void reset() noexcept;
+
+private:
+    std::array<float, kSideTaps> side_{};   // h[c +- (2j + 1)]; the centre tap is 0.5
+    std::array<float, 2 * kTaps> history_{};  // Each sample stored twice: any window is contiguous
+    std::size_t position_ = 0;              // Next write index in [0, kTaps)
+    bool odd_ = false;                      // The next input completes an output pair
+};
+
+}  // namespace audiovis
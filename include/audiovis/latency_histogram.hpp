@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace audiovis {
+
+/// Fixed-size log2 histogram of durations, for callback timing and jitter.
+///
+/// Bucket 0 counts durations under 1 us; bucket i > 0 counts [2^(i-1), 2^i) us.
+/// The last bucket also absorbs anything longer. Trivially copyable and
+/// allocation-free, so it can live inside a real-time thread's stats block.
+struct LatencyHistogram {
+    static constexpr std::size_t kBuckets = 24;  // Up to ~8 s before saturating
+
+    std::array<std::uint64_t, kBuckets> counts{};
+    std::uint64_t max_us = 0;                    // Longest duration recorded
+
+    /// Returns the bucket a duration falls into.
+    [[nodiscard]] static constexpr std::size_t bucket_for(std::chrono::microseconds d) noexcept {
+        const auto us = d.count() > 0 ? static_cast<std::uint64_t>(d.count()) : 0;
+        const auto bucket = static_cast<std::size_t>(64 - std::countl_zero(us));  // bit width
+        return bucket < kBuckets ? bucket : kBuckets - 1;
+    }
+
+    /// Returns the exclusive upper bound of a bucket (2^bucket us).
+    [[nodiscard]] static constexpr std::chrono::microseconds upper_bound(
+        std::size_t bucket) noexcept {
+        return std::chrono::microseconds{std::int64_t{1} << bucket};
+    }
+
+    /// Counts one duration.
+    constexpr void record(std::chrono::microseconds d) noexcept {
+        ++counts[bucket_for(d)];
+        const auto us = d.count() > 0 ? static_cast<std::uint64_t>(d.count()) : 0;
+        max_us = us > max_us ? us : max_us;
+    }
+
+    /// Returns the number of recorded durations.
+    [[nodiscard]] constexpr std::uint64_t total() const noexcept {
+        std::uint64_t sum = 0;
+        for (const auto count : counts) {
+            sum += count;
+        }
+        return sum;
+    }
+
+    /// Returns an upper bound for the q-th quantile (0 <= q <= 1), i.e. the upper
+    /// edge of the bucket holding it. Zero if nothing was recorded.
+    [[nodiscard]] constexpr std::chrono::microseconds percentile(double q) const noexcept {
+        const auto n = total();
+        if (n == 0) {
+            return std::chrono::microseconds{0};
+        }
+        const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(n - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return upper_bound(i);
+            }
+        }
+        return upper_bound(kBuckets - 1);
+    }
+};
+
+}  // namespace audiovis
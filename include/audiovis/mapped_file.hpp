@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace audiovis {
+
+/// Read-only memory mapping of a whole file (RAII).
+///
+/// The kernel pages the file in on demand, so even multi-gigabyte recordings
+/// open instantly and are read without intermediate copies. Move-only.
+class MappedFile {
+public:
+    /// Creates an empty mapping.
+    MappedFile() = default;
+
+    /// Maps `path` read-only.
+    /// @throws std::runtime_error if the file cannot be opened or mapped.
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /// Returns the mapped contents.
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return {data_, size_}; }
+
+    /// Returns the file size in bytes.
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+    /// Hints that the file will be read front to back.
+    void advise_sequential() const noexcept;
+
+private:
+    void release() noexcept;
+
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace audiovis
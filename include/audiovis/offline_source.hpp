@@ -0,0 +1,78 @@
+#pragma once
+
+#include "audiovis/audio_source.hpp"
+#include "audiovis/seqlock.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+
+/// Base for sources that generate or decode audio on demand rather than on a
+/// device clock.
+///
+/// Derived classes implement render(); this class turns it into ring buffer
+/// traffic with backpressure: nothing is ever dropped, a full ring simply
+/// pauses production until the consumer catches up. Runs either on its own
+/// producer thread after start(), as fast as the consumer allows, or
+/// synchronously through produce() - never both at once, as the rings have a
+/// single producer.
+///
+/// Derived destructors must call stop() so the producer thread never renders
+/// into a partially destroyed object.
+class OfflineSource : public AudioSource {
+public:
+    ~OfflineSource() override;
+
+    /// Launches the producer thread. Idempotent if already running.
+    void start() override;
+
+    /// Stops and joins the producer thread. Idempotent.
+    void stop() override;
+
+    /// Returns true while the producer thread is active. It exits on its own
+    /// once the source reaches its end.
+    [[nodiscard]] bool is_running() const noexcept override {
+        return running_.load(std::memory_order_acquire);
+    }
+
+    /// Offline sources run as fast as the consumer allows.
+    [[nodiscard]] bool is_realtime() const noexcept override { return false; }
+
+    [[nodiscard]] AudioStats stats() const noexcept override { return stats_.load(); }
+
+    std::size_t produce(std::size_t max_frames) override;
+
+    [[nodiscard]] bool at_end() const noexcept override {
+        return finished_.load(std::memory_order_acquire);
+    }
+
+protected:
+    /// @param block_frames Frames rendered per step (sizes the scratch buffer).
+    /// @throws std::invalid_argument on zero channels, sample rate or block size.
+    OfflineSource(std::uint32_t sample_rate, std::uint32_t channels, std::size_t ring_capacity,
+                  std::size_t block_frames);
+
+    /// Writes up to interleaved.size() / channels() frames, frame-interleaved.
+    /// Called from the producing thread only.
+    /// @return Frames written; 0 signals the end of the stream.
+    virtual std::size_t render(std::span<float> interleaved) = 0;
+
+private:
+    void producer_loop(const std::stop_token& stop);
+
+    std::size_t block_frames_;
+    std::vector<float> scratch_;          // One interleaved block
+    AudioStats totals_;                   // Producer-owned, published via stats_
+    SeqLock<AudioStats> stats_;
+    std::atomic<bool> finished_{false};
+    std::atomic<bool> running_{false};
+    std::jthread producer_;
+};
+
+}  // namespace audiovis
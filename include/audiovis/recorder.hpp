@@ -0,0 +1,181 @@
+#pragma once
+
+#include "audiovis/aligned_buffer.hpp"
+#include "audiovis/broadcast_ring.hpp"
+#include "audiovis/ring_buffer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+
+/// Configuration for Recorder.
+struct RecorderConfig {
+    std::string path_prefix = "recording";  // Files are <prefix>-0001.wav, <prefix>-0002.wav, ...
+    std::size_t block_bytes = std::size_t{1} << 20;  // Bytes per write (whole pages and frames)
+    std::size_t blocks = 8;               // Blocks buffered between the drain and writer threads
+    std::uint64_t max_file_bytes = 0;     // Rotate after this much audio data; 0 = the WAV limit
+    double max_file_seconds = 0.0;        // Rotate after this much audio; 0 = no limit
+    bool direct_io = true;                // O_DIRECT where the filesystem supports it
+    BufferPolicy buffers{};               // Backing of the blocks (always page aligned)
+    std::chrono::milliseconds poll_interval{5};  // How often idle threads look for work
+};
+
+/// Archives a capture stream to disk as 32-bit float WAV files, without ever
+/// stalling the producer.
+///
+/// The recorder follows an AudioSource's broadcast ring with its own Reader,
+/// so it never touches the capture callback or the analyzer's rings. A drain
+/// thread copies interleaved frames into large page-aligned blocks from a
+/// pre-allocated pool; a writer thread writes full blocks at page-aligned
+/// offsets, with O_DIRECT where the filesystem allows it (falling back to
+/// buffered writes otherwise), and hands them back. The two trade block
+/// indices through lock-free SPSC rings, so a write stuck on a slow disk only
+/// delays the writer: the drain keeps filling the other blocks, and once
+/// they are all in flight the broadcast ring holds the rest. buffered_seconds()
+/// gives the stall that rides out without losing audio; size blocks and the
+/// ring for the worst disk latency expected. Anything beyond that is skipped
+/// by the ring and counted in frames_lost(), never waited for.
+///
+/// Each file starts with a 4 KiB header (RIFF, a fmt chunk for IEEE float, a
+/// JUNK pad, then the data chunk header), so the samples themselves start
+/// page aligned. Headers are written when a file opens and rewritten with the
+/// final sizes when it closes; the data is plain interleaved little-endian
+/// float32, ready for WAV readers or a FLAC encoder. Files rotate at whole
+/// frames when max_file_bytes or max_file_seconds is reached, and always
+/// before the 4 GiB WAV limit.
+class Recorder {
+public:
+    /// Attaches to `ring` (whose stride is the channel count), opens the first
+    /// file and starts both threads. The ring must outlive the recorder.
+    /// @throws std::invalid_argument if the configuration is inconsistent.
+    /// @throws std::runtime_error if the first file cannot be created.
+    Recorder(const BroadcastRing<float>& ring, std::uint32_t sample_rate,
+             const RecorderConfig& config = {});
+
+    /// Closes the recorder; see close(). Errors are swallowed here.
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+    Recorder(Recorder&&) = delete;
+    Recorder& operator=(Recorder&&) = delete;
+
+    /// Records every frame the producer has written so far, writes it out,
+    /// finalizes the current file and stops both threads. Stop the source
+    /// first to record up to its last frame. Idempotent.
+    /// @throws std::runtime_error if a file could not be created or written.
+    void close();
+
+    /// Returns how long a disk stall the recorder rides out without losing
+    /// audio: its blocks plus the broadcast ring, in seconds.
+    [[nodiscard]] double buffered_seconds() const noexcept;
+
+    /// Returns the bytes per write (block_bytes after rounding).
+    [[nodiscard]] std::size_t block_bytes() const noexcept { return block_bytes_; }
+
+    /// Returns the frames written to disk so far.
+    [[nodiscard]] std::uint64_t frames_written() const noexcept {
+        return frames_written_.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the number of files created so far.
+    [[nodiscard]] std::uint64_t files() const noexcept {
+        return files_.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the frames lost because the broadcast ring lapped the recorder.
+    [[nodiscard]] std::uint64_t frames_lost() const noexcept { return reader_.frames_skipped(); }
+
+    /// Returns how often the drain found every block in flight and had to
+    /// leave frames in the ring.
+    [[nodiscard]] std::uint64_t block_waits() const noexcept {
+        return block_waits_.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the longest single block write.
+    [[nodiscard]] std::chrono::microseconds max_write_time() const noexcept {
+        return std::chrono::microseconds{max_write_us_.load(std::memory_order_relaxed)};
+    }
+
+    /// Returns true while writes bypass the page cache (O_DIRECT).
+    [[nodiscard]] bool direct_io() const noexcept {
+        return direct_io_.load(std::memory_order_relaxed);
+    }
+
+    /// Returns true once a file could not be created or written. The recorder
+    /// then keeps draining the ring but discards what it reads; close()
+    /// reports the error.
+    [[nodiscard]] bool failed() const noexcept {
+        return error_.load(std::memory_order_acquire) != 0;
+    }
+
+    /// Returns the path of file number `index` (1-based) for a prefix.
+    [[nodiscard]] static std::string file_path(const std::string& prefix, std::uint64_t index);
+
+private:
+    /// What the drain thread queued in a block.
+    struct BlockInfo {
+        std::size_t bytes = 0;     // Valid bytes from the start of the block
+        bool ends_file = false;    // Rotate after writing it
+        bool last = false;         // Finalize the file and stop after writing it
+    };
+
+    void drain_loop(const std::stop_token& stop);
+    std::size_t drain(std::size_t max_frames) noexcept;
+    void queue_block(bool ends_file, bool last) noexcept;
+    void write_loop() noexcept;
+    void write_block(std::uint32_t index) noexcept;
+    int open_file() noexcept;
+    void finish_file() noexcept;
+    int write_header() noexcept;
+    int write_at(const void* data, std::size_t size, std::uint64_t offset) noexcept;
+    void fail(int error) noexcept;
+    void check_failed() const;
+
+    RecorderConfig config_;
+    std::uint32_t sample_rate_;
+    std::size_t channels_;
+    std::size_t frame_bytes_;
+    std::size_t block_bytes_;
+    std::uint64_t frames_per_file_;
+    std::size_t ring_frames_;
+
+    std::vector<AlignedBuffer> blocks_;
+    std::vector<BlockInfo> info_;          // Filled in by the drain before queuing
+    RingBuffer<std::uint32_t> free_;       // Writer -> drain
+    RingBuffer<std::uint32_t> full_;       // Drain -> writer
+
+    // Drain state
+    BroadcastRing<float>::Reader reader_;
+    bool has_block_ = false;
+    std::uint32_t current_ = 0;
+    std::size_t fill_ = 0;                 // Bytes in the current block
+    std::uint64_t file_frames_ = 0;        // Frames queued for the current file
+
+    // Writer state
+    int fd_ = -1;                          // Current file; -1 between files
+    std::uint64_t file_index_ = 0;
+    std::uint64_t data_bytes_ = 0;         // Audio bytes in the current file
+    bool padded_ = false;                  // Last write was rounded up; truncate on finish
+    AlignedBuffer header_;
+
+    std::atomic<std::uint64_t> frames_written_{0};
+    std::atomic<std::uint64_t> files_{0};
+    std::atomic<std::uint64_t> block_waits_{0};
+    std::atomic<std::int64_t> max_write_us_{0};
+    std::atomic<bool> direct_io_{false};
+    std::atomic<std::uint64_t> error_file_{0};  // Index of the file that failed
+    std::atomic<int> error_{0};                 // errno of the first failure
+
+    std::jthread writer_;
+    std::jthread drain_;
+};
+
+}  // namespace audiovis
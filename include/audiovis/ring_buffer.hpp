@@ -1,9 +1,11 @@
 #pragma once
 
+#include "audiovis/aligned_buffer.hpp"
+
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstddef>
-#include <memory>
 #include <span>
 #include <type_traits>
 
@@ -16,17 +18,39 @@ namespace audiovis {
 /// pace. Uses acquire-release semantics for correct synchronization without
 /// full memory barriers.
 ///
+/// Storage is allocated through a BufferPolicy, so long histories can sit on
+/// hugepages and beside the thread that uses them (see AlignedBuffer).
+///
 /// Template parameter T should be trivially copyable (typically float for audio).
 template <typename T>
     requires std::is_trivially_copyable_v<T>
 class RingBuffer {
 public:
+    /// A contiguous view into ring storage, split in two at the wrap point.
+    ///
+    /// `first` always holds the oldest elements; `second` is non-empty only when
+    /// the region crosses the end of the underlying array. Logically the region
+    /// is `first` followed by `second`.
+    template <typename U>
+    struct Region {
+        std::span<U> first;
+        std::span<U> second;
+
+        [[nodiscard]] std::size_t size() const noexcept { return first.size() + second.size(); }
+        [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    };
+
+    using ReadRegion = Region<const T>;
+    using WriteRegion = Region<T>;
+
     /// Constructs a ring buffer with the given capacity.
     /// Capacity is rounded up to the next power of two for efficient modulo.
-    explicit RingBuffer(std::size_t min_capacity)
+    /// @throws std::invalid_argument if the policy's alignment is invalid.
+    explicit RingBuffer(std::size_t min_capacity, const BufferPolicy& policy = {})
         : capacity_{next_power_of_two(min_capacity)}
         , mask_{capacity_ - 1}
-        , buffer_{std::make_unique<T[]>(capacity_)} {
+        , storage_{capacity_ * sizeof(T), storage_policy(policy)}
+        , buffer_{storage_.as<T>()} {
         assert(capacity_ > 0 && (capacity_ & mask_) == 0);
     }
 
@@ -39,6 +63,9 @@ public:
     /// Returns the buffer capacity (always a power of two).
     [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
 
+    /// Returns the backing storage, e.g. to check which parts of the policy took.
+    [[nodiscard]] const AlignedBuffer& storage() const noexcept { return storage_; }
+
     /// Returns the number of elements available for reading.
     /// Safe to call from any thread.
     [[nodiscard]] std::size_t size() const noexcept {
@@ -80,17 +107,35 @@ public:
     /// Writes multiple elements from a span. Returns number of elements written.
     /// May write fewer than requested if buffer fills.
     std::size_t try_push(std::span<const T> data) noexcept {
+        const auto region = acquire_write(data.size());
+        const auto split = region.first.size();
+
+        std::copy_n(data.begin(), split, region.first.begin());
+        std::copy_n(data.begin() + static_cast<std::ptrdiff_t>(split), region.second.size(),
+                    region.second.begin());
+
+        commit_write(region.size());
+        return region.size();
+    }
+
+    /// Reserves up to `count` slots for writing without publishing them.
+    ///
+    /// The returned region may be smaller than requested if the buffer is nearly
+    /// full. Fill it in place, then call commit_write() with the number of
+    /// elements actually written. Nothing is visible to the consumer until then.
+    [[nodiscard]] WriteRegion acquire_write(std::size_t count) noexcept {
         const auto w = write_pos_.load(std::memory_order_relaxed);
         const auto r = read_pos_.load(std::memory_order_acquire);
         const auto avail = capacity_ - (w - r);
-        const auto to_write = std::min(avail, data.size());
-
-        for (std::size_t i = 0; i < to_write; ++i) {
-            buffer_[(w + i) & mask_] = data[i];
-        }
+        return make_region<T>(w, std::min(avail, count));
+    }
 
-        write_pos_.store(w + to_write, std::memory_order_release);
-        return to_write;
+    /// Publishes `count` elements previously filled through acquire_write().
+    /// `count` must not exceed the size of the most recently acquired region.
+    void commit_write(std::size_t count) noexcept {
+        const auto w = write_pos_.load(std::memory_order_relaxed);
+        assert(count <= capacity_ - (w - read_pos_.load(std::memory_order_acquire)));
+        write_pos_.store(w + count, std::memory_order_release);
     }
 
     /// Overwrites oldest data if buffer is full. Always succeeds.
@@ -127,32 +172,41 @@ public:
 
     /// Reads multiple elements into a span. Returns number of elements read.
     std::size_t try_pop(std::span<T> out) noexcept {
-        const auto r = read_pos_.load(std::memory_order_relaxed);
-        const auto w = write_pos_.load(std::memory_order_acquire);
-        const auto available = w - r;
-        const auto to_read = std::min(available, out.size());
-
-        for (std::size_t i = 0; i < to_read; ++i) {
-            out[i] = buffer_[(r + i) & mask_];
-        }
-
-        read_pos_.store(r + to_read, std::memory_order_release);
+        const auto to_read = peek(out);
+        commit_read(to_read);
         return to_read;
     }
 
     /// Peeks at data without consuming it. Copies up to `count` elements.
     /// Returns number of elements copied.
     std::size_t peek(std::span<T> out) const noexcept {
+        const auto region = acquire_read(out.size());
+        const auto split = region.first.size();
+
+        std::copy(region.first.begin(), region.first.end(), out.begin());
+        std::copy(region.second.begin(), region.second.end(),
+                  out.begin() + static_cast<std::ptrdiff_t>(split));
+
+        return region.size();
+    }
+
+    /// Exposes up to `count` of the oldest readable elements in place.
+    ///
+    /// The region stays valid and unchanged until commit_read() (or discard())
+    /// releases it; the producer cannot overwrite unconsumed slots. This lets the
+    /// consumer process samples directly from ring storage without a copy.
+    [[nodiscard]] ReadRegion acquire_read(std::size_t count) const noexcept {
         const auto r = read_pos_.load(std::memory_order_relaxed);
         const auto w = write_pos_.load(std::memory_order_acquire);
-        const auto available = w - r;
-        const auto to_copy = std::min(available, out.size());
-
-        for (std::size_t i = 0; i < to_copy; ++i) {
-            out[i] = buffer_[(r + i) & mask_];
-        }
+        return make_region<const T>(r, std::min(w - r, count));
+    }
 
-        return to_copy;
+    /// Consumes `count` elements previously exposed through acquire_read().
+    /// `count` may be smaller than the acquired region (e.g. to keep overlap).
+    void commit_read(std::size_t count) noexcept {
+        const auto r = read_pos_.load(std::memory_order_relaxed);
+        assert(count <= write_pos_.load(std::memory_order_acquire) - r);
+        read_pos_.store(r + count, std::memory_order_release);
     }
 
     /// Discards up to `count` elements. Returns number discarded.
@@ -173,6 +227,20 @@ public:
     }
 
 private:
+    /// Builds the (at most two) spans covering `count` slots starting at `pos`.
+    template <typename U>
+    [[nodiscard]] Region<U> make_region(std::size_t pos, std::size_t count) const noexcept {
+        const auto start = pos & mask_;
+        const auto head = std::min(count, capacity_ - start);
+        return Region<U>{.first = std::span<U>{buffer_ + start, head},
+                         .second = std::span<U>{buffer_, count - head}};
+    }
+
+    static BufferPolicy storage_policy(BufferPolicy policy) noexcept {
+        policy.alignment = std::max(policy.alignment, alignof(T));
+        return policy;
+    }
+
     static constexpr std::size_t next_power_of_two(std::size_t n) noexcept {
         if (n == 0) return 1;
         --n;
@@ -187,7 +255,8 @@ private:
 
     const std::size_t capacity_;
     const std::size_t mask_;
-    std::unique_ptr<T[]> buffer_;
+    AlignedBuffer storage_;
+    T* const buffer_;
 
     // Cache-line padding to prevent false sharing between producer and consumer.
     // Using explicit 64-byte alignment (common cache line size on x86-64 and ARM64)
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace audiovis {
+
+/// Single-writer, multi-reader sequence lock for small trivially copyable values.
+///
+/// The writer never waits and performs no read-modify-write operations: a
+/// store() is two sequence-counter stores around a run of plain (relaxed)
+/// word stores, which makes it safe to call from a real-time thread. Readers
+/// copy the value and retry if a store overlapped the copy, so load() always
+/// returns a consistent snapshot of one store().
+///
+/// The payload is kept as relaxed atomic words rather than raw bytes, so the
+/// optimistic reads are well-defined: on mainstream targets they compile to
+/// ordinary loads and stores.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock requires a trivially copyable type");
+    static_assert(std::is_default_constructible_v<T>,
+                  "SeqLock requires a default constructible type");
+
+public:
+    SeqLock() noexcept { store(T{}); }
+
+    explicit SeqLock(const T& initial) noexcept { store(initial); }
+
+    // Non-copyable, non-movable (atomics don't move safely)
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+    SeqLock(SeqLock&&) = delete;
+    SeqLock& operator=(SeqLock&&) = delete;
+
+    /// Publishes a new value. Wait-free; call from the single writer thread only.
+    void store(const T& value) noexcept {
+        std::array<Word, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        // Odd sequence marks a store in progress
+        const auto sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (std::size_t i = 0; i < kWords; ++i) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /// Returns the most recently stored value. Lock-free; spins only while a
+    /// store is in flight, which takes a handful of cache-line writes.
+    [[nodiscard]] T load() const noexcept {
+        std::array<Word, kWords> words{};
+        for (;;) {
+            const auto before = sequence_.load(std::memory_order_acquire);
+            if ((before & 1) != 0) {
+                continue;  // Writer mid-store
+            }
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+
+        T value{};
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    /// Returns the number of completed stores (including the initial one).
+    [[nodiscard]] std::uint64_t version() const noexcept {
+        return sequence_.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    using Word = std::uint64_t;
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+    // Own cache line(s), so the writer's stores don't disturb neighbouring data
+    alignas(64) std::atomic<std::uint64_t> sequence_{0};
+    std::array<std::atomic<Word>, kWords> data_{};
+};
+
+}  // namespace audiovis
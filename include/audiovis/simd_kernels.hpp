@@ -0,0 +1,74 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace audiovis::simd {
+
+/// Instruction sets the kernels below can run on.
+enum class Isa {
+    Scalar,  // Portable fallback
+    AVX2,    // x86-64 with AVX2 + FMA, selected at runtime via CPUID
+    NEON     // AArch64 Advanced SIMD, always available on that target
+};
+
+/// Returns the instruction set the kernels dispatch to on this machine.
+/// Detection runs once; the result is cached for the life of the process.
+[[nodiscard]] Isa active_isa() noexcept;
+
+/// Returns a human-readable name for an instruction set ("avx2", ...).
+[[nodiscard]] const char* isa_name(Isa isa) noexcept;
+
+/// Fast base-2 logarithm for positive, normal floats.
+///
+/// Splits x into exponent and mantissa, folds the mantissa into
+/// [sqrt(1/2), sqrt(2)) and evaluates a short atanh series. Absolute error is
+/// below 1e-6, i.e. far below what a spectrum display can show (~3e-6 dB).
+/// Zero, negative, denormal and non-finite inputs are not supported.
+[[nodiscard]] inline float fast_log2(float x) noexcept {
+    constexpr float kSqrt2 = 1.41421356f;
+    constexpr float kTwoOverLn2 = 2.88539008f;  // 2 / ln(2)
+
+    const auto bits = std::bit_cast<std::uint32_t>(x);
+    auto exponent = static_cast<float>(static_cast<std::int32_t>(bits >> 23) - 127);
+    auto mantissa = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f800000u);  // [1, 2)
+
+    if (mantissa > kSqrt2) {
+        mantissa *= 0.5f;
+        exponent += 1.0f;
+    }
+
+    // ln(m) = 2 * atanh(z) with z = (m - 1) / (m + 1), |z| < 0.172
+    const float z = (mantissa - 1.0f) / (mantissa + 1.0f);
+    const float z2 = z * z;
+    const float series = 1.0f + z2 * (1.0f / 3.0f + z2 * (1.0f / 5.0f + z2 * (1.0f / 7.0f)));
+    return exponent + kTwoOverLn2 * z * series;
+}
+
+/// out[i] = in[i] * window[i]. `out` may alias `in`.
+void apply_window(std::span<const float> in, const float* window, float* out) noexcept;
+
+/// out[i] = re[i]^2 + im[i]^2 for interleaved complex input (FFTW layout).
+/// `complex` holds 2 * out.size() floats.
+void power_spectrum(const float* complex, std::span<float> out) noexcept;
+
+/// Converts power values to decibels normalized into [0, 1].
+///
+/// Computes 10 * log10(power * scale + epsilon), clamps it to
+/// [db_floor, db_ceiling] and maps that range linearly onto [0, 1]. Working
+/// from power avoids a square root per bin: 20 * log10(|X|) == 10 * log10(|X|^2).
+/// `out` may alias `power`.
+void power_to_normalized_db(std::span<const float> power, float* out, float scale, float db_floor,
+                            float db_ceiling) noexcept;
+
+/// out[i] = sqrt(power[i] * scale). `out` may alias `power`.
+void power_to_magnitude(std::span<const float> power, float* out, float scale) noexcept;
+
+/// Returns the sum of a[i] * b[i]. `b` holds at least a.size() floats.
+/// Summation order differs between instruction sets, so results may differ
+/// in the last few bits.
+[[nodiscard]] float dot(std::span<const float> a, const float* b) noexcept;
+
+}  // namespace audiovis::simd
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "audiovis/band_matrix.hpp"
+#include "audiovis/fft_processor.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace audiovis {
+
+class FileSource;
+
+/// Column resolution of a computed spectrogram.
+enum class SpectrogramResolution {
+    Bins,   // One column per FFT bin (fft_size / 2 + 1)
+    Bands   // One column per band of SpectrogramConfig::bands
+};
+
+/// Configuration for offline spectrogram computation.
+struct SpectrogramConfig {
+    FFTConfig fft{};                      // Transform settings (channels is ignored)
+    std::size_t hop_size = 512;           // Samples between frames
+    SpectrogramResolution resolution = SpectrogramResolution::Bands;
+    BandLayout bands{};                   // Band layout for Bands resolution
+    std::size_t threads = 0;              // Worker threads (0 = hardware concurrency)
+    std::size_t chunk_frames = 32;        // Frames claimed per scheduling step
+};
+
+/// A time-frequency matrix: one row per STFT frame, oldest first.
+///
+/// Values match what FFTProcessor produces (normalized dB by default),
+/// mapped to bands when computed at band resolution. No temporal smoothing is
+/// applied.
+struct Spectrogram {
+    std::size_t frames = 0;               // Rows
+    std::size_t columns = 0;              // Bins or bands per row
+    std::size_t fft_size = 0;
+    std::size_t hop_size = 0;
+    float sample_rate = 0.0f;
+    SpectrogramResolution resolution = SpectrogramResolution::Bands;
+    std::vector<float> edges;             // columns + 1 column boundaries (Hz)
+    std::vector<float> values;            // Row-major, frames * columns
+
+    /// Returns one frame's values.
+    [[nodiscard]] std::span<const float> frame(std::size_t index) const noexcept {
+        return std::span<const float>{values}.subspan(index * columns, columns);
+    }
+
+    /// Returns the time (s) of a frame's first sample.
+    [[nodiscard]] double frame_time(std::size_t index) const noexcept {
+        return static_cast<double>(index * hop_size) / static_cast<double>(sample_rate);
+    }
+};
+
+/// Computes spectrograms of whole recordings, spreading frames over all cores.
+///
+/// STFT frames are independent, so the frame range is cut into chunks of
+/// `chunk_frames` that workers claim from a shared atomic counter until none
+/// are left; a worker that finishes early simply claims more, which balances
+/// load without a central queue. Each worker owns its FFTProcessor (they are
+/// not thread-safe) and scratch, and writes straight into its frames' rows of
+/// the result, so workers never contend beyond the counter. The band matrix
+/// is shared read-only. The calling thread works too.
+///
+/// Like SpectrumAnalyzer::analyze_all(), a trailing partial window is not
+/// analyzed: a signal of n samples yields (n - fft_size) / hop_size + 1 frames.
+class SpectrogramEngine {
+public:
+    /// @throws std::invalid_argument on a zero hop or chunk size, or an invalid
+    ///         FFT or band configuration.
+    explicit SpectrogramEngine(const SpectrogramConfig& config = {});
+
+    /// Analyzes a mono signal held in memory.
+    [[nodiscard]] Spectrogram compute(std::span<const float> samples, float sample_rate) const;
+
+    /// Analyzes a whole file, decoding each chunk straight from its mapping.
+    /// Multi-channel files are mixed down to mono.
+    [[nodiscard]] Spectrogram compute(const FileSource& file) const;
+
+    /// Returns the number of threads compute() uses, including the caller.
+    [[nodiscard]] std::size_t thread_count() const noexcept { return threads_; }
+
+    [[nodiscard]] const SpectrogramConfig& config() const noexcept { return config_; }
+
+private:
+    /// Fills `mono` with samples [first, first + mono.size()) of the signal.
+    /// Called concurrently from every worker; `scratch` is the worker's own,
+    /// allocated once with scratch_per_sample values per sample of a chunk.
+    using Reader = std::function<void(std::size_t first, std::span<float> mono,
+                                      std::span<float> scratch)>;
+
+    [[nodiscard]] Spectrogram run(std::size_t total_samples, float sample_rate,
+                                  std::size_t scratch_per_sample, const Reader& read) const;
+
+    SpectrogramConfig config_;
+    std::size_t threads_;
+};
+
+}  // namespace audiovis
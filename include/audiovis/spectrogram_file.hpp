@@ -0,0 +1,192 @@
+#pragma once
+
+#include "audiovis/mapped_file.hpp"
+#include "audiovis/ring_buffer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+
+struct Spectrogram;
+struct SpectrumData;
+class SpectrumAnalyzer;
+
+/// How magnitudes are stored in a spectrogram file.
+enum class SpectrogramEncoding : std::uint8_t {
+    Float32 = 0,  // Exact
+    Float16 = 1,  // IEEE half precision: ~3 significant digits, half the size
+    UInt8 = 2     // Linear 8-bit over [value_min, value_max]: a quarter of the size
+};
+
+/// What a spectrogram file describes: everything needed to interpret its frames.
+struct SpectrogramInfo {
+    float sample_rate = 0.0f;             // Rate fft_size and hop_size count at (after decimation)
+    std::size_t fft_size = 0;
+    std::size_t hop_size = 0;             // Samples between frames (0 = irregular, see timestamps)
+    std::size_t channels = 1;             // Spectra per frame, stored channel-planar
+    std::vector<float> edges;             // bands + 1 band boundaries (Hz)
+
+    /// Returns the number of bands (or bins) per channel.
+    [[nodiscard]] std::size_t bands() const noexcept {
+        return edges.empty() ? 0 : edges.size() - 1;
+    }
+
+    /// Returns the number of magnitudes in each frame.
+    [[nodiscard]] std::size_t values_per_frame() const noexcept { return channels * bands(); }
+};
+
+/// Describes the frames an analyzer produces with its current configuration.
+[[nodiscard]] SpectrogramInfo spectrogram_info(const SpectrumAnalyzer& analyzer);
+
+/// Describes an offline spectrogram.
+[[nodiscard]] SpectrogramInfo spectrogram_info(const Spectrogram& spectrogram);
+
+/// Per-frame metadata stored alongside the magnitudes.
+struct SpectrogramFrame {
+    std::chrono::nanoseconds time{0};     // Since the file's first frame
+    float rms_level = 0.0f;
+    float peak_level = 0.0f;
+};
+
+/// Configuration for SpectrogramWriter.
+struct SpectrogramWriterConfig {
+    SpectrogramEncoding encoding = SpectrogramEncoding::Float16;
+    float value_min = 0.0f;               // UInt8 range (analyzer output is 0..1)
+    float value_max = 1.0f;
+    std::size_t queue_frames = 1024;      // Frames buffered ahead of the disk
+};
+
+/// Appends spectrum frames to a spectrogram file without blocking the caller.
+///
+/// File layout (all little-endian): a header with the SpectrogramInfo, the
+/// encoding and the band edges, followed by fixed-size frame records (time,
+/// levels, magnitudes). Fixed records make any frame addressable in O(1), and
+/// with no frame count in the header a file cut short by a crash remains
+/// readable up to its last complete record.
+///
+/// append() encodes the frame into a pre-allocated record and pushes it onto
+/// a lock-free SPSC byte ring; a background thread drains the ring to disk.
+/// The caller never waits for I/O and never allocates: if the disk falls so
+/// far behind that the queue is full, the frame is dropped and counted.
+///
+/// append() and flush() must be called from one producer thread.
+class SpectrogramWriter {
+public:
+    /// Creates (or truncates) `path` and writes the header.
+    /// @throws std::invalid_argument if info has no bands, a header field does not fit in 32
+    ///         bits, or the UInt8 range is empty.
+    /// @throws std::runtime_error if the file cannot be created.
+    SpectrogramWriter(const std::string& path, const SpectrogramInfo& info,
+                      const SpectrogramWriterConfig& config = {});
+
+    /// Writes out everything queued and closes the file.
+    ~SpectrogramWriter();
+
+    SpectrogramWriter(const SpectrogramWriter&) = delete;
+    SpectrogramWriter& operator=(const SpectrogramWriter&) = delete;
+    SpectrogramWriter(SpectrogramWriter&&) = delete;
+    SpectrogramWriter& operator=(SpectrogramWriter&&) = delete;
+
+    /// Queues an analyzer frame. Its timestamp is stored relative to the first
+    /// SpectrumData appended.
+    /// @return False if the frame was dropped (queue full or size mismatch).
+    bool append(const SpectrumData& frame) noexcept;
+
+    /// Queues one frame of info.values_per_frame() magnitudes.
+    /// @return False if the frame was dropped (queue full or size mismatch).
+    bool append(std::span<const float> values, const SpectrogramFrame& frame) noexcept;
+
+    /// Blocks until every queued frame is on disk (in the kernel's page cache).
+    /// @throws std::runtime_error if a write failed.
+    void flush();
+
+    /// Flushes, stops the I/O thread and closes the file. Idempotent.
+    /// @throws std::runtime_error if a write failed.
+    void close();
+
+    /// Returns the number of frames accepted by append().
+    [[nodiscard]] std::uint64_t frames_queued() const noexcept { return frames_queued_; }
+
+    /// Returns the number of frames append() had to drop.
+    [[nodiscard]] std::uint64_t frames_dropped() const noexcept { return frames_dropped_; }
+
+    /// Returns the size of one frame record in bytes.
+    [[nodiscard]] std::size_t frame_stride() const noexcept { return record_.size(); }
+
+private:
+    void io_loop(const std::stop_token& stop);
+    void write_pending();
+    void check_failed() const;
+
+    SpectrogramInfo info_;
+    SpectrogramWriterConfig config_;
+    std::string path_;
+    int fd_ = -1;
+
+    std::vector<std::byte> record_;       // Producer scratch for one encoded frame
+    RingBuffer<std::byte> queue_;
+    std::optional<std::chrono::steady_clock::time_point> origin_;
+    std::uint64_t frames_queued_ = 0;
+    std::uint64_t frames_dropped_ = 0;
+    std::uint64_t bytes_queued_ = 0;      // Producer-side total
+
+    std::atomic<std::uint64_t> bytes_written_{0};
+    std::atomic<int> error_{0};           // errno of the first failed write
+    std::jthread io_;
+};
+
+/// Writes an offline spectrogram to `path` in one go.
+/// @throws std::runtime_error on I/O failure.
+void write_spectrogram(const std::string& path, const Spectrogram& spectrogram,
+                       const SpectrogramWriterConfig& config = {});
+
+/// Memory-maps a spectrogram file for random access.
+///
+/// frame_count() is fixed when the file is opened. Decoding a frame touches
+/// only that record's pages, so scrubbing a long session is cheap.
+class SpectrogramReader {
+public:
+    /// @throws std::runtime_error if the file cannot be mapped or is not a
+    ///         spectrogram file of a supported version.
+    explicit SpectrogramReader(const std::string& path);
+
+    [[nodiscard]] const SpectrogramInfo& info() const noexcept { return info_; }
+    [[nodiscard]] SpectrogramEncoding encoding() const noexcept { return encoding_; }
+
+    /// Returns the number of complete frames in the file.
+    [[nodiscard]] std::size_t frame_count() const noexcept { return frame_count_; }
+
+    /// Returns one frame's metadata, O(1).
+    [[nodiscard]] SpectrogramFrame frame(std::size_t index) const noexcept;
+
+    /// Decodes one frame's magnitudes into `values` (info().values_per_frame()
+    /// entries) and returns its metadata, O(1).
+    SpectrogramFrame read(std::size_t index, std::span<float> values) const noexcept;
+
+    /// Returns the index of the last frame at or before `time` (0 if none),
+    /// by binary search over the record timestamps.
+    [[nodiscard]] std::size_t find(std::chrono::nanoseconds time) const noexcept;
+
+private:
+    [[nodiscard]] std::span<const std::byte> record(std::size_t index) const noexcept;
+
+    MappedFile file_;
+    SpectrogramInfo info_;
+    SpectrogramEncoding encoding_ = SpectrogramEncoding::Float32;
+    float value_min_ = 0.0f;
+    float value_max_ = 1.0f;
+    std::size_t header_size_ = 0;
+    std::size_t stride_ = 0;
+    std::size_t frame_count_ = 0;
+};
+
+}  // namespace audiovis
@@ -1,15 +1,36 @@
 #pragma once
 
 #include "audiovis/audio_capture.hpp"
+#include "audiovis/audio_source.hpp"
+#include "audiovis/band_matrix.hpp"
 #include "audiovis/fft_processor.hpp"
+#include "audiovis/half_band_decimator.hpp"
+#include "audiovis/thread_policy.hpp"
+#include "audiovis/tone_tracker.hpp"
+#include "audiovis/triple_buffer.hpp"
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <span>
+#include <stop_token>
+#include <thread>
 #include <vector>
 
 namespace audiovis {
 
+/// How captured channels map to analyzed spectra.
+enum class ChannelMode {
+    PerChannel,  // One spectrum per captured channel
+    MidSide      // Stereo only: spectrum 0 = mid (L+R)/2, spectrum 1 = side (L-R)/2
+};
+
 /// Configuration for the spectrum analyzer display.
 struct AnalyzerConfig {
     std::size_t num_bands = 64;           // Number of frequency bands to display
@@ -17,92 +38,442 @@ struct AnalyzerConfig {
     float max_frequency = 20000.0f;       // Highest frequency (Hz)
     float smoothing_factor = 0.7f;        // Temporal smoothing (0 = none, 1 = max)
     float peak_decay_rate = 0.95f;        // How fast peak markers fall (per frame)
-    bool logarithmic_frequency = true;    // Log vs linear frequency axis
+    FrequencyScale frequency_scale = FrequencyScale::Logarithmic;  // Band spacing
+    BandWeighting band_weighting = BandWeighting::Fractional;      // Bin-to-band weights
+    std::size_t hop_size = 0;             // Samples between STFT frames (0 = newest window only)
+    bool use_worker_thread = false;       // Analyze on a dedicated thread
+    ChannelMode channel_mode = ChannelMode::PerChannel;  // Multi-channel handling
+    std::size_t resolution_tiers = 1;     // FFT tiers on 2x-decimated streams (1 = single FFT)
+    ThreadPolicy worker_policy{};         // Scheduling and cores for the worker thread
+    std::size_t decimation = 1;           // Pre-FFT rate divisor, a power of two (0 = auto)
+    std::vector<float> tracked_frequencies{};  // One band per tone (Hz, ascending); empty = FFT
 };
 
+/// Returns the largest power-of-two decimation (at most 128) whose alias-free
+/// passband still reaches `max_frequency` at `sample_rate`; 1 if none does.
+[[nodiscard]] std::size_t auto_decimation(float max_frequency, float sample_rate) noexcept;
+
 /// Represents the current state of spectrum analysis.
+///
+/// Multi-channel frames are stored channel-planar: channel c's bands occupy
+/// [c * band_count(), (c + 1) * band_count()) of `magnitudes` and `peaks`.
+/// For mono input this is simply one value per band.
 struct SpectrumData {
     std::vector<float> magnitudes;        // Current magnitude per band (0.0 to 1.0)
     std::vector<float> peaks;             // Peak hold values per band
+    std::size_t channel_count = 1;        // Spectra stored in this frame
     float rms_level = 0.0f;               // Overall RMS level (for VU meter)
     float peak_level = 0.0f;              // Recent peak level
     std::chrono::steady_clock::time_point timestamp;
+
+    /// Returns the number of bands per channel.
+    [[nodiscard]] std::size_t band_count() const noexcept {
+        return channel_count == 0 ? 0 : magnitudes.size() / channel_count;
+    }
+
+    /// Returns one channel's band magnitudes.
+    [[nodiscard]] std::span<const float> channel_magnitudes(std::size_t channel) const noexcept {
+        return std::span<const float>{magnitudes}.subspan(channel * band_count(), band_count());
+    }
+
+    /// Returns one channel's peak hold values.
+    [[nodiscard]] std::span<const float> channel_peaks(std::size_t channel) const noexcept {
+        return std::span<const float>{peaks}.subspan(channel * band_count(), band_count());
+    }
 };
 
-/// High-level spectrum analyzer combining audio capture and FFT processing.
+/// High-level spectrum analyzer combining an audio source and FFT processing.
 ///
 /// This class orchestrates the full pipeline: reading samples from the audio
-/// capture ring buffer, computing FFT, mapping to display bands, and applying
-/// temporal smoothing. It provides a simple interface for the visualization
-/// layer to retrieve ready-to-render spectrum data.
+/// source's ring buffers, computing FFT, mapping to display bands, and
+/// applying temporal smoothing. It provides a simple interface for the
+/// visualization layer to retrieve ready-to-render spectrum data.
+///
+/// The source is usually live capture (AudioCapture), but any AudioSource
+/// works: a FileSource or SyntheticSource runs the same pipeline headless,
+/// and analyze_all() drives such offline sources to completion.
+///
+/// Every captured channel is analyzed: the per-channel capture rings are
+/// windowed in place and transformed together by one batched FFT, producing
+/// one spectrum per channel (or mid/side spectra for stereo input).
+///
+/// With AnalyzerConfig::use_worker_thread set, a dedicated thread owned by the
+/// analyzer drains the capture ring at the audio rate and publishes finished
+/// frames through a lock-free triple buffer. update() then only picks up the
+/// newest published frame, so display cadence and render cost have no effect
+/// on analysis throughput. AnalyzerConfig::worker_policy can pin the worker
+/// to chosen cores and give it real-time scheduling; worker_policy_applied()
+/// reports what the kernel granted.
+///
+/// With AnalyzerConfig::resolution_tiers > 1 the analyzer runs a multi-
+/// resolution STFT. Tier k repeatedly half-band decimates the analyzed
+/// signals k times and transforms them at the same fft_size, so its bins are
+/// 2^k times narrower and its window 2^k times longer; it advances every
+/// 2^k-th frame, keeping the same overlap as tier 0. Each display band is
+/// taken from the finest tier whose alias-free passband still covers it, so
+/// the lows get the resolution of a 2^k times larger FFT while the highs
+/// keep tier 0's short window, for under twice the transform work of the
+/// single FFT. Bands served by a deeper tier read zero until that tier has
+/// seen a full window.
+///
+/// With AnalyzerConfig::decimation > 1 (or 0, which picks the largest factor
+/// max_frequency allows) the capture rings are drained through a cascade of
+/// half-band decimators before analysis, and frames are cut from the
+/// decimated stream. fft_size and hop_size then count decimated samples: a
+/// D-times decimated fft_size / D point FFT resolves like the full-rate
+/// fft_size point one for a D-th of the transform work and window memory,
+/// and the capture ring no longer has to hold a whole window. Frame
+/// timestamps account for the cascade's group delay.
+///
+/// With AnalyzerConfig::tracked_frequencies set the analyzer skips the FFT
+/// and follows just those frequencies with a ToneTracker, one band per
+/// frequency, over a sliding fft_size window. Every incoming sample updates
+/// each tone in constant time, so a frame costs only the samples that arrived
+/// since the previous one: a few dozen tones take a small fraction of a full
+/// transform, and the capture ring needs to hold just one hop. The bands
+/// behave like any others (smoothing, peaks, channels, decimation);
+/// band_edges() places each boundary halfway between neighbouring tones on a
+/// log scale. num_bands, the frequency range, scale and weighting do not
+/// apply, resolution_tiers must stay 1, and config().num_bands reads back as
+/// the number of tones. A reconfigured tracker starts from silence.
+///
+/// Everything derived from the FFT and analyzer settings (FFT processors,
+/// band matrices, tiers and working buffers) lives in one pipeline object.
+/// reconfigure() builds a replacement on a background thread and publishes
+/// it with an atomic pointer exchange; the analysis thread adopts it at the
+/// next frame boundary and hands the old one back to be freed, RCU style.
+/// Frames keep flowing throughout and the analysis path never allocates,
+/// plans or blocks for a change. The layout accessors (config(),
+/// fft_config(), fft_size(), band_edges(), tier_first_bands()) read the
+/// active pipeline: call them from the analysis thread, or once no
+/// reconfigure() is in flight.
 ///
 /// Usage:
 ///   SpectrumAnalyzer analyzer;
+///   SpectrumData data;
 ///   analyzer.start();
 ///   while (running) {
-///       auto data = analyzer.update();
+///       analyzer.update(data);
 ///       render(data.magnitudes);
 ///   }
 ///   analyzer.stop();
 class SpectrumAnalyzer {
 public:
-    /// Constructs analyzer with given configurations.
+    /// Constructs analyzer capturing from the audio device.
     explicit SpectrumAnalyzer(
         const AudioConfig& audio_config = {},
         const FFTConfig& fft_config = {},
         const AnalyzerConfig& analyzer_config = {}
     );
 
+    /// Constructs analyzer reading from any audio source. The FFT batches one
+    /// signal per source channel (fft_config.channels is ignored).
+    /// @throws std::invalid_argument if source is null or a config is invalid.
+    explicit SpectrumAnalyzer(
+        std::unique_ptr<AudioSource> source,
+        const FFTConfig& fft_config = {},
+        const AnalyzerConfig& analyzer_config = {}
+    );
+
     ~SpectrumAnalyzer();
 
     // Non-copyable, non-movable
     SpectrumAnalyzer(const SpectrumAnalyzer&) = delete;
     SpectrumAnalyzer& operator=(const SpectrumAnalyzer&) = delete;
 
-    /// Starts audio capture.
+    /// Starts the audio source, and the analysis worker if configured.
     void start();
 
-    /// Stops audio capture.
+    /// Stops the analysis worker (if any) and the audio source.
     void stop();
 
-    /// Returns true if capture is running.
+    /// Returns true if the source is running.
     [[nodiscard]] bool is_running() const noexcept;
 
+    /// Receives each analysis frame produced by process_pending().
+    using FrameCallback = std::function<void(const SpectrumData&)>;
+
     /// Updates analysis and returns current spectrum data.
-    /// Should be called once per frame from the visualization thread.
-    /// Returns empty data if no new samples are available.
+    /// Convenience wrapper around update(SpectrumData&) that allocates a fresh
+    /// frame on every call; prefer the in-place overload in render loops.
     [[nodiscard]] SpectrumData update();
 
-    /// Provides read access to the underlying audio capture for stats.
-    [[nodiscard]] const AudioCapture& audio() const noexcept { return *audio_; }
+    /// Updates analysis and writes the current spectrum into a caller-owned frame.
+    /// Should be called once per frame from the visualization thread.
+    ///
+    /// `out` is resized to channels() * num_bands only when its size differs, so
+    /// reusing the same frame across calls makes the steady state
+    /// allocation-free. If no new samples are available it receives the
+    /// previous smoothed state.
+    ///
+    /// With a non-zero hop_size this runs every STFT frame that has become due
+    /// since the last call and reports the newest one. While the worker thread
+    /// is running it never analyzes; it copies out the latest published frame
+    /// without blocking.
+    ///
+    /// @return True if `out` holds a frame that was not reported before.
+    bool update(SpectrumData& out);
+
+    /// Streaming STFT: analyzes every complete window available in the capture
+    /// ring, advancing by exactly hop_size samples per frame (or fft_size, i.e.
+    /// no overlap, when hop_size is 0).
+    ///
+    /// Consecutive windows overlap by fft_size - hop_size samples, so no audio
+    /// is skipped regardless of how often this is called. Smoothing and peak
+    /// decay advance once per analysis frame. Each frame carries a timestamp
+    /// derived from its position in the stream. Must not be called while the
+    /// worker thread is running.
+    ///
+    /// @param on_frame Invoked once per frame, oldest first. May be empty.
+    /// @return Number of frames analyzed.
+    std::size_t process_pending(const FrameCallback& on_frame);
+
+    /// Batch analysis: pumps an offline source synchronously on the calling
+    /// thread, running process_pending() as the rings fill, until the source
+    /// reaches its end. Deterministic and as fast as the CPU allows.
+    ///
+    /// A trailing partial window is not analyzed. An endless source (e.g. a
+    /// SyntheticSource without duration) never returns.
+    ///
+    /// @param on_frame Invoked once per frame, oldest first. May be empty.
+    /// @return Number of frames analyzed.
+    /// @throws std::logic_error if the source is real-time or already running,
+    ///         or the worker thread is active.
+    /// @throws std::invalid_argument if the ring cannot hold one hop's window.
+    std::size_t analyze_all(const FrameCallback& on_frame);
+
+    /// Returns true if the analysis worker thread is active.
+    [[nodiscard]] bool is_worker_running() const noexcept { return worker_.joinable(); }
+
+    /// Returns the scheduling the worker thread was last given, read back from
+    /// the kernel when it started (or when set_config() changed the policy).
+    [[nodiscard]] const AppliedThreadPolicy& worker_policy_applied() const noexcept {
+        return worker_policy_applied_;
+    }
+
+    /// Provides read access to the underlying audio source for stats.
+    [[nodiscard]] const AudioSource& audio() const noexcept { return *audio_; }
 
     /// Returns current analyzer configuration.
-    [[nodiscard]] const AnalyzerConfig& config() const noexcept { return analyzer_config_; }
+    [[nodiscard]] const AnalyzerConfig& config() const noexcept { return active_->config; }
+
+    /// Returns current FFT configuration.
+    [[nodiscard]] const FFTConfig& fft_config() const noexcept { return active_->fft_config; }
 
-    /// Updates analyzer configuration (does not affect audio or FFT config).
+    /// Changes FFT and analyzer settings without interrupting analysis.
+    ///
+    /// Validates on the calling thread, then builds the new pipeline on a
+    /// background thread. Whichever thread analyzes next (the worker, or the
+    /// caller of update(), process_pending() or analyze_all()) swaps it in
+    /// before its next frame. Smoothing and peak state carry over, resampled
+    /// if the band count changed (except to or from tone tracking). A call
+    /// made before the previous change was adopted supersedes it.
+    /// fft_config.channels is ignored, as in the constructor;
+    /// use_worker_thread and worker_policy are only applied by set_config().
+    ///
+    /// @throws std::invalid_argument if a config is invalid (see set_config()).
+    /// @throws Whatever building the previous request failed with; this
+    ///         request is then not applied.
+    void reconfigure(const FFTConfig& fft_config, const AnalyzerConfig& analyzer_config);
+
+    /// Returns true while a reconfigure() has been requested but not adopted.
+    [[nodiscard]] bool reconfigure_pending() const noexcept {
+        return settled_.load(std::memory_order_acquire) !=
+               requested_.load(std::memory_order_acquire);
+    }
+
+    /// Asks for `bands` display bands, e.g. one per column the renderer can
+    /// draw, so no work goes into bands that are never shown. The change goes
+    /// through reconfigure(): the new layout is built off the analysis thread
+    /// and adopted at a frame boundary with its state resampled. Does nothing
+    /// if that many bands are already in effect or requested, or while
+    /// tracking frequencies, whose bands are the tones.
+    /// @return True if a change was requested.
+    /// @throws std::invalid_argument if bands is zero.
+    /// @throws As reconfigure().
+    bool fit_bands(std::size_t bands);
+
+    /// Updates analyzer configuration (does not affect audio or FFT config)
+    /// and returns once it is in effect. The pipeline is built on the calling
+    /// thread and handed to a running worker at its next frame, so analysis
+    /// continues meanwhile. The worker is started or stopped afterwards if
+    /// use_worker_thread changed.
+    /// @throws std::invalid_argument if the band layout is invalid, streaming
+    ///         needs more history than the capture ring can hold, MidSide is
+    ///         requested for non-stereo input, or the tiers, decimation,
+    ///         tracked frequencies or worker policy are invalid.
     void set_config(const AnalyzerConfig& config);
 
+    /// Changes the FFT configuration, e.g. fft_size, and returns once it is
+    /// in effect; otherwise as set_config().
+    /// @throws std::invalid_argument if fft_size is not a power of two or the
+    ///         current analyzer settings do not fit it.
+    void set_fft_config(const FFTConfig& config);
+
+    /// Returns the number of spectra in each frame.
+    [[nodiscard]] std::size_t channels() const noexcept { return audio_->channels(); }
+
+    /// Returns the FFT (or tone tracker) window length in samples.
+    [[nodiscard]] std::size_t fft_size() const noexcept { return active_->fft_config.fft_size; }
+
+    /// Returns the num_bands + 1 band boundaries (Hz) of the current layout.
+    [[nodiscard]] std::span<const float> band_edges() const noexcept {
+        return active_->band_edges;
+    }
+
+    /// Returns the index of the first band of each resolution tier, finest
+    /// (most decimated) last; tier k serves bands [first[k], first[k - 1]).
+    /// Tier 0 serves up to num_bands. A tier that serves no bands repeats its
+    /// predecessor's index.
+    [[nodiscard]] std::vector<std::size_t> tier_first_bands() const;
+
     /// Returns the sample rate being used.
     [[nodiscard]] float sample_rate() const noexcept {
         return static_cast<float>(audio_->sample_rate());
     }
 
+    /// Returns the capture samples per analyzed sample (1 without decimation).
+    [[nodiscard]] std::size_t decimation() const noexcept { return active_->decimation; }
+
+    /// Returns the rate of the stream the FFT sees: sample_rate() / decimation().
+    [[nodiscard]] float analysis_rate() const noexcept {
+        return sample_rate() / static_cast<float>(active_->decimation);
+    }
+
 private:
-    void recompute_band_mapping();
-    float compute_band_magnitude(std::size_t band_index) const;
+    /// One decimated tier of a multi-resolution analysis.
+    struct ResolutionTier {
+        std::size_t first_band = 0;         // Bands [first_band, first_band + band_count)
+        std::size_t band_count = 0;
+        std::unique_ptr<FFTProcessor> fft;  // Null while the tier serves no bands
+        BandMatrix band_matrix;
+        std::vector<HalfBandDecimator> decimators;  // Per signal, fed by the tier above
+        std::vector<std::unique_ptr<RingBuffer<float>>> history;  // Newest fft_size samples
+        std::vector<float> decimated;       // This frame's new samples, fft_size per signal
+        std::size_t decimated_count = 0;
+        std::vector<SegmentedInput> inputs;
+        std::vector<float> magnitudes;
+    };
+
+    /// Everything derived from the FFT and analyzer configuration, all
+    /// pre-allocated. Built off the analysis thread and swapped in whole.
+    struct Pipeline {
+        AnalyzerConfig config;
+        FFTConfig fft_config;
+        std::unique_ptr<FFTProcessor> fft;      // Null when tracking tones
+        std::unique_ptr<ToneTracker> tracker;   // Tone tracking mode only
+        std::uint64_t generation = 0;          // reconfigure() request that built it
+        Pipeline* next_retired = nullptr;       // Link in the retired_ list
+
+        std::vector<float> magnitude_buffer;    // Raw FFT output, channel-planar
+        std::vector<float> band_buffer;         // Unsmoothed band values, channel-planar
+        std::vector<float> smoothed_magnitudes; // Temporally smoothed values
+        std::vector<float> peak_values;         // Peak hold per band
+        SpectrumData frame;                     // Scratch frame for streaming mode
+
+        // Pre-sized frames traded for published slots of the old size
+        std::array<SpectrumData, 3> spare_frames;
+        std::size_t spares_used = 0;
+
+        // Per-channel views into ring storage for the frame being analyzed
+        std::vector<RingBuffer<float>::ReadRegion> regions;
+        std::vector<SegmentedInput> fft_inputs;
+        std::vector<float> mid_side_buffer;     // Mid then side window (MidSide mode only)
+
+        // Band mapping: sparse weights from FFT bins to display bands
+        BandMatrix band_matrix;                 // Tier 0: bands [first_band, num_bands)
+        std::vector<float> band_edges;          // Whole layout
+        std::size_t first_band = 0;
+
+        std::vector<ResolutionTier> tiers;      // Decimation levels 1, 2, ...
+        bool tiers_primed = false;              // First window already fed to the cascade
+        std::size_t frame_index = 0;            // Schedules the slower tiers
+
+        // Pre-FFT decimation; frames read the capture rings directly when 1
+        std::size_t decimation = 1;             // Capture samples per analyzed sample
+        std::vector<HalfBandDecimator> decimators;  // Cascade stages, signal-major
+        std::vector<std::unique_ptr<RingBuffer<float>>> decimated;  // Per signal: analyzed stream
+        std::vector<float> decimator_scratch;
+        double decimator_delay = 0.0;           // Cascade group delay (s)
+    };
+
+    /// Builds a complete pipeline. Touches no shared state, so any thread may call it.
+    [[nodiscard]] std::unique_ptr<Pipeline> build_pipeline(const FFTConfig& fft_config,
+                                                           const AnalyzerConfig& config) const;
+    void map_bands(Pipeline& pipeline) const;
+
+    /// Swaps in a published pipeline, if any. Analysis thread only, at a
+    /// frame boundary; never allocates, frees or blocks.
+    bool adopt_pending() noexcept;
+    void adopt(std::unique_ptr<Pipeline> next) noexcept;
+
+    /// Shared body of set_config() and set_fft_config().
+    void apply_now(const FFTConfig& fft_config, const AnalyzerConfig& config);
+    void build_in_background(const std::stop_token& stop, const FFTConfig& fft_config,
+                             const AnalyzerConfig& config, std::uint64_t generation);
+    void reconfigure_locked(const FFTConfig& fft_config, const AnalyzerConfig& analyzer_config);
+    void stop_builder();
+    void free_retired() noexcept;
+
+    /// Resolves AnalyzerConfig::decimation against the capture rate.
+    [[nodiscard]] std::size_t decimation_for(const AnalyzerConfig& config) const noexcept;
+
+    /// Returns the ring channel `ch` is analyzed from: the capture ring, or
+    /// the pipeline's decimated copy of it.
+    [[nodiscard]] RingBuffer<float>& analysis_ring(Pipeline& pipeline, std::size_t ch) const;
+
+    /// Runs everything buffered in the capture rings through the pipeline's
+    /// decimators into its analysis rings, discarding the oldest analyzed
+    /// samples should they overflow. Does nothing without decimation.
+    void decimate_input(Pipeline& pipeline);
+
+    /// Samples buffered in every channel's analysis ring (they advance in lockstep).
+    [[nodiscard]] std::size_t buffered_samples(Pipeline& pipeline) const;
+
+    /// Exposes up to `count` samples of every channel in the pipeline's regions.
+    /// Returns the window length actually available in all channels.
+    std::size_t acquire_regions(Pipeline& pipeline, std::size_t count);
+
+    /// Consumes `count` samples from every channel's analysis ring.
+    void commit_regions(Pipeline& pipeline, std::size_t count);
+
+    /// Runs FFT, band mapping and smoothing over the window in the regions.
+    void analyze_frame(Pipeline& pipeline, std::size_t window, SpectrumData& result);
+
+    /// Feeds the newest `fresh` samples of the FFT inputs down the decimation
+    /// cascade and maps every tier that is due this frame into band_buffer.
+    static void analyze_tiers(Pipeline& pipeline, std::size_t fresh);
+
+    void validate(const FFTConfig& fft_config, const AnalyzerConfig& config) const;
+    void start_worker();
+    void stop_worker();
+    void worker_loop(const std::stop_token& stop);
+    void publish(const SpectrumData& frame);
+    static void prepare_frame(const Pipeline& pipeline, SpectrumData& frame);
+    static void copy_smoothed_state(const Pipeline& pipeline, SpectrumData& out);
+    static void copy_frame(const SpectrumData& from, SpectrumData& to);
 
-    std::unique_ptr<AudioCapture> audio_;
-    std::unique_ptr<FFTProcessor> fft_;
-    AnalyzerConfig analyzer_config_;
+    std::unique_ptr<AudioSource> audio_;
+    std::unique_ptr<Pipeline> active_;       // Owned by the analysis thread
 
-    // Internal buffers (pre-allocated to avoid runtime allocation)
-    std::vector<float> sample_buffer_;      // Samples for FFT input
-    std::vector<float> magnitude_buffer_;   // Raw FFT output
-    std::vector<float> smoothed_magnitudes_; // Temporally smoothed values
-    std::vector<float> peak_values_;        // Peak hold per band
+    // Reconfiguration handoff
+    std::atomic<Pipeline*> pending_{nullptr};  // Built, awaiting adoption (owning)
+    std::atomic<Pipeline*> retired_{nullptr};  // Replaced, awaiting release (owning list)
+    std::atomic<std::uint64_t> adoptions_{0};
+    std::atomic<std::uint64_t> requested_{0};  // Latest reconfigure() request
+    std::atomic<std::uint64_t> settled_{0};    // Latest request adopted or failed
+    std::mutex reconfigure_mutex_;           // Serializes callers; never taken by analysis
+    FFTConfig latest_fft_config_;            // Most recently requested settings
+    AnalyzerConfig latest_config_;
+    FFTConfig built_fft_config_;             // Most recent settings that built; read
+    AnalyzerConfig built_config_;            // only once the builder has been joined
+    std::exception_ptr build_error_;         // From the last background build
+    std::jthread builder_;
 
-    // Band mapping: which FFT bins contribute to each display band
-    std::vector<std::pair<std::size_t, std::size_t>> band_bins_;
+    // Worker thread hands frames to update() through here
+    TripleBuffer<SpectrumData> published_;
+    std::jthread worker_;
+    AppliedThreadPolicy worker_policy_applied_;
 };
 
 }  // namespace audiovis
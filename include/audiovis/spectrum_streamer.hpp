@@ -0,0 +1,211 @@
+#pragma once
+
+#include "audiovis/ring_buffer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+
+struct SpectrumData;
+
+/// How magnitudes are quantized on the wire. The value is the width in bytes.
+enum class StreamEncoding : std::uint8_t {
+    UInt8 = 1,    // 256 levels over [value_min, value_max]
+    UInt16 = 2    // 65536 levels over [value_min, value_max]
+};
+
+/// Configuration for SpectrumStreamer.
+struct SpectrumStreamerConfig {
+    std::string udp_address = "239.255.42.99";  // IPv4 multicast group or unicast host; empty = off
+    std::uint16_t udp_port = 5099;
+    int multicast_ttl = 1;                // Router hops for multicast (1 = local subnet)
+    std::optional<std::uint16_t> websocket_port{};  // TCP port to serve (0 = any free); none = off
+    StreamEncoding encoding = StreamEncoding::UInt8;
+    float value_min = 0.0f;               // Quantization range (analyzer output is 0..1)
+    float value_max = 1.0f;
+    bool delta = true;                    // Encode frames against the previous one
+    std::size_t keyframe_interval = 32;   // A full frame at least this often, for late joiners
+    std::size_t max_values = 4096;        // Largest frame accepted (channels * bands)
+    std::size_t max_packet_bytes = 1400;  // Datagram budget: fits a 1500-byte MTU
+    std::chrono::milliseconds send_interval{5};  // How long frames may wait to share a packet
+    std::size_t queue_frames = 64;        // Frames buffered ahead of the sender
+    std::size_t client_buffer_bytes = 256 * 1024;  // Per WebSocket client before it skips
+};
+
+/// Serves analyzer frames to remote dashboards over UDP (multicast or
+/// unicast) and WebSocket, without ever stalling the caller.
+///
+/// Wire format (all little-endian). Each UDP datagram, and each binary
+/// WebSocket message, is one packet: a 20-byte header (magic "AVSP", version,
+/// frame count, packet sequence, quantization range) followed by whole
+/// frames. A frame is a 32-byte header (frame sequence, flags, encoding,
+/// channels, bands per channel, payload size, time since the first frame,
+/// RMS and peak levels) and its magnitudes, channel-planar. A keyframe
+/// payload is the quantized values themselves. A delta frame stores each
+/// value's change from the previous frame as a zigzag LEB128 varint, with a
+/// zero followed by a count encoding a run of unchanged values, so quiet and
+/// slowly moving spectra shrink to a few bytes. Deltas are used only when
+/// they come out smaller than a keyframe. A frame larger than a packet goes
+/// out alone and is left to IP fragmentation.
+///
+/// publish() quantizes and encodes the frame into a pre-allocated record and
+/// pushes it onto a lock-free SPSC byte ring; the sender thread wakes every
+/// send_interval, packs whatever is queued into as few packets as fit and
+/// sends them. The caller never waits on the network and never allocates: if
+/// the sender falls behind far enough to fill the queue, the frame is dropped
+/// and counted, and the next one is encoded against the last frame queued.
+/// WebSocket clients are served from bounded per-client buffers on
+/// non-blocking sockets; a client that cannot keep up misses packets (and
+/// resynchronises at the next keyframe) rather than slowing anyone else.
+///
+/// publish() must be called from one producer thread.
+class SpectrumStreamer {
+public:
+    /// Opens the sockets and starts the sender thread.
+    /// @throws std::invalid_argument if the configuration is inconsistent, no
+    ///         transport is enabled, or udp_address is not an IPv4 address.
+    /// @throws std::runtime_error if a socket cannot be created or bound.
+    explicit SpectrumStreamer(const SpectrumStreamerConfig& config = {});
+
+    /// Sends everything queued and closes the sockets.
+    ~SpectrumStreamer();
+
+    SpectrumStreamer(const SpectrumStreamer&) = delete;
+    SpectrumStreamer& operator=(const SpectrumStreamer&) = delete;
+    SpectrumStreamer(SpectrumStreamer&&) = delete;
+    SpectrumStreamer& operator=(SpectrumStreamer&&) = delete;
+
+    /// Queues a frame for sending. Magnitudes only: receivers keep their own
+    /// peak hold. Its time is sent relative to the first frame published.
+    /// @return False if the frame was dropped (queue full or over max_values).
+    bool publish(const SpectrumData& frame) noexcept;
+
+    /// Blocks until every queued frame has been handed to the sockets.
+    void flush();
+
+    /// Sends whatever is queued, stops the sender thread and closes the
+    /// sockets. Idempotent.
+    void close();
+
+    /// Returns the bound WebSocket port (useful with port 0), or 0 if off.
+    [[nodiscard]] std::uint16_t websocket_port() const noexcept { return websocket_port_; }
+
+    /// Returns the number of frames accepted by publish().
+    [[nodiscard]] std::uint64_t frames_published() const noexcept { return frames_published_; }
+
+    /// Returns how many of them were delta encoded.
+    [[nodiscard]] std::uint64_t delta_frames() const noexcept { return delta_frames_; }
+
+    /// Returns the number of frames publish() had to drop.
+    [[nodiscard]] std::uint64_t frames_dropped() const noexcept { return frames_dropped_; }
+
+    /// Returns the number of packets built by the sender thread.
+    [[nodiscard]] std::uint64_t packets_sent() const noexcept {
+        return packets_sent_.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the number of WebSocket clients currently connected.
+    [[nodiscard]] std::size_t websocket_clients() const noexcept {
+        return websocket_clients_.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the number of packets WebSocket clients missed because their
+    /// buffers were full.
+    [[nodiscard]] std::uint64_t websocket_skipped() const noexcept {
+        return websocket_skipped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Client;
+
+    void send_loop(const std::stop_token& stop);
+    void send_pending();
+    void send_packet(std::span<const std::byte> packet);
+    void accept_clients();
+    void service_client(Client& client, short events);
+    void read_client(Client& client);
+    void flush_client(Client& client);
+    void close_client(Client& client) noexcept;
+
+    SpectrumStreamerConfig config_;
+    int udp_fd_ = -1;
+    int listen_fd_ = -1;
+    std::uint16_t websocket_port_ = 0;
+    std::uint32_t udp_host_ = 0;          // Destination address, network byte order
+
+    // Producer state
+    std::vector<std::byte> record_;       // Scratch for one encoded frame
+    std::vector<std::uint16_t> previous_; // Quantized values of the last frame queued
+    std::vector<std::uint16_t> current_;
+    std::size_t previous_values_ = 0;
+    std::size_t previous_channels_ = 0;
+    std::size_t since_keyframe_ = 0;
+    std::uint32_t sequence_ = 0;
+    std::optional<std::chrono::steady_clock::time_point> origin_;
+    std::uint64_t frames_published_ = 0;
+    std::uint64_t delta_frames_ = 0;
+    std::uint64_t frames_dropped_ = 0;
+    std::uint64_t bytes_queued_ = 0;
+
+    RingBuffer<std::byte> queue_;
+
+    // Sender state
+    std::vector<std::byte> staging_;      // Records popped from the queue
+    std::vector<std::byte> packet_;
+    std::uint32_t packet_sequence_ = 0;
+    std::vector<Client> clients_;
+    std::atomic<std::uint64_t> bytes_drained_{0};  // Consumer-side total
+    std::atomic<std::uint64_t> packets_sent_{0};
+    std::atomic<std::size_t> websocket_clients_{0};
+    std::atomic<std::uint64_t> websocket_skipped_{0};
+    std::jthread sender_;
+};
+
+/// One frame reconstructed by SpectrumStreamDecoder.
+struct StreamFrame {
+    std::uint32_t sequence = 0;
+    bool keyframe = false;
+    std::size_t channel_count = 1;
+    std::chrono::nanoseconds time{0};     // Since the stream's first frame
+    float rms_level = 0.0f;
+    float peak_level = 0.0f;
+    std::vector<float> magnitudes;        // Dequantized, channel-planar
+
+    /// Returns the number of bands per channel.
+    [[nodiscard]] std::size_t band_count() const noexcept {
+        return channel_count == 0 ? 0 : magnitudes.size() / channel_count;
+    }
+};
+
+/// Reassembles frames from SpectrumStreamer packets, for receivers and tests.
+///
+/// Delta frames only decode on top of the frame just before them; after a
+/// lost or skipped packet they are discarded (and counted) until the next
+/// keyframe arrives.
+class SpectrumStreamDecoder {
+public:
+    /// Decodes every frame in one packet, appending them to `frames`.
+    /// @return The number of frames appended.
+    /// @throws std::runtime_error if the packet is not a well-formed stream packet.
+    std::size_t decode(std::span<const std::byte> packet, std::vector<StreamFrame>& frames);
+
+    /// Returns the number of delta frames discarded for want of their base frame.
+    [[nodiscard]] std::uint64_t frames_skipped() const noexcept { return frames_skipped_; }
+
+private:
+    std::vector<std::uint16_t> values_;   // Quantized values of the last frame decoded
+    std::size_t channels_ = 0;
+    std::optional<std::uint32_t> sequence_;
+    std::uint64_t frames_skipped_ = 0;
+};
+
+}  // namespace audiovis
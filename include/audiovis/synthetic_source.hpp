@@ -0,0 +1,69 @@
+#pragma once
+
+#include "audiovis/offline_source.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace audiovis {
+
+/// Test signals SyntheticSource can generate.
+enum class Waveform {
+    Sine,         // Constant tone at `frequency`
+    WhiteNoise,   // Uniform noise in [-amplitude, amplitude)
+    Sweep         // Exponential chirp from `frequency` to `end_frequency`
+};
+
+/// Configuration for a generated test signal.
+struct SyntheticConfig {
+    std::uint32_t sample_rate = 48000;
+    std::uint32_t channels = 1;           // Every channel carries the same signal
+    Waveform waveform = Waveform::Sine;
+    float frequency = 1000.0f;            // Tone, or sweep start (Hz)
+    float end_frequency = 20000.0f;       // Sweep end (Hz)
+    float amplitude = 0.5f;
+    float duration_seconds = 0.0f;        // 0 = endless
+    float sweep_seconds = 10.0f;          // Sweep period; restarts afterwards
+    std::uint32_t seed = 1;               // Noise seed (non-zero)
+    std::size_t block_frames = 4096;      // Frames generated per step
+    float ring_buffer_seconds = 0.5f;     // History buffer duration (per channel)
+};
+
+/// Generates deterministic test signals, for headless testing, benchmarks and
+/// demos without an audio device.
+///
+/// Output is a pure function of the config: the same settings always produce
+/// the same samples, whether pumped with produce() or run on its thread.
+class SyntheticSource final : public OfflineSource {
+public:
+    /// @throws std::invalid_argument on non-positive frequencies or periods,
+    ///         frequencies above Nyquist, or a zero seed.
+    explicit SyntheticSource(const SyntheticConfig& config);
+
+    ~SyntheticSource() override;
+
+    [[nodiscard]] const std::string& name() const noexcept override { return name_; }
+
+    /// Returns the number of frames to generate, or 0 if endless.
+    [[nodiscard]] std::uint64_t total_frames() const noexcept { return total_frames_; }
+
+protected:
+    std::size_t render(std::span<float> interleaved) override;
+
+private:
+    [[nodiscard]] float next_sample() noexcept;
+
+    SyntheticConfig config_;
+    std::string name_;
+    std::uint64_t total_frames_;
+    std::uint64_t position_ = 0;          // Frames generated so far
+    double phase_ = 0.0;                  // Cycles, in [0, 1)
+    double increment_;                    // Cycles per sample
+    double sweep_ratio_ = 1.0;            // Per-sample frequency growth
+    std::uint64_t sweep_samples_ = 0;     // Samples per sweep period
+    std::uint32_t noise_state_;
+};
+
+}  // namespace audiovis
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+
+/// Kernel scheduling class for a thread.
+enum class SchedulingClass {
+    Normal,     // SCHED_OTHER: time-shared with everything else
+    Fifo,       // SCHED_FIFO: runs until it blocks or a higher priority preempts it
+    RoundRobin  // SCHED_RR: SCHED_FIFO with a time slice among equal priorities
+};
+
+/// Requested scheduling for one thread.
+struct ThreadPolicy {
+    SchedulingClass scheduling = SchedulingClass::Normal;
+    int priority = 0;                     // Real-time priority 1-99 (Fifo/RoundRobin only)
+    std::vector<unsigned> cpus{};         // Cores the thread may run on; empty = any
+
+    bool operator==(const ThreadPolicy&) const = default;
+};
+
+/// What the kernel actually granted a thread, read back after applying a policy.
+struct AppliedThreadPolicy {
+    SchedulingClass scheduling = SchedulingClass::Normal;
+    int priority = 0;
+    std::vector<unsigned> cpus{};         // Cores the thread may run on now
+    std::string notes{};                  // Why part of the request was refused; empty if none
+};
+
+/// Outcome of lock_process_memory().
+struct MemoryLock {
+    bool locked = false;
+    std::string notes;                    // Why locking failed; empty on success
+};
+
+/// Checks a policy against this machine.
+/// @throws std::invalid_argument if the priority is out of range for the
+///         scheduling class (or non-zero for Normal), or a CPU is listed twice
+///         or is not available to this process.
+/// @throws std::runtime_error if the process affinity cannot be read.
+void validate(const ThreadPolicy& policy);
+
+/// Applies `policy` to `thread` as far as the kernel permits and reports what
+/// took effect. Real-time scheduling usually needs CAP_SYS_NICE or an
+/// RLIMIT_RTPRIO grant; when refused the thread keeps its current class and
+/// `notes` says why. Never throws for a refusal.
+/// @throws std::invalid_argument if the policy is invalid (see validate()).
+AppliedThreadPolicy apply_thread_policy(std::thread::native_handle_type thread,
+                                        const ThreadPolicy& policy);
+
+/// Applies `policy` to the calling thread; otherwise as above.
+AppliedThreadPolicy apply_thread_policy(const ThreadPolicy& policy);
+
+/// Reads back the calling thread's current scheduling.
+[[nodiscard]] AppliedThreadPolicy current_thread_policy();
+
+/// Locks every current and future page of the process into RAM
+/// (mlockall(MCL_CURRENT | MCL_FUTURE)), so page faults never land on the
+/// real-time path. Call once the ring buffers and FFT buffers exist: their
+/// pages are populated and pinned immediately, and anything mapped later
+/// (thread stacks included) is pinned as it is mapped. Needs CAP_IPC_LOCK or
+/// a large enough RLIMIT_MEMLOCK; failure is reported, never thrown.
+MemoryLock lock_process_memory();
+
+/// Formats an applied policy for logs, e.g. "SCHED_FIFO priority 70, CPUs 2-3".
+[[nodiscard]] std::string describe(const AppliedThreadPolicy& applied);
+
+}  // namespace audiovis
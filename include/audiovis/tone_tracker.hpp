@@ -0,0 +1,109 @@
+#pragma once
+
+#include "audiovis/fft_processor.hpp"
+#include "audiovis/window_table.hpp"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace audiovis {
+
+/// Configuration for ToneTracker.
+struct ToneTrackerConfig {
+    std::vector<float> frequencies{};         // Tracked frequencies (Hz), each in (0, Nyquist)
+    float sample_rate = 48000.0f;
+    std::size_t window_size = 2048;           // Samples in the sliding window
+    WindowFunction window = WindowFunction::Hann;
+    bool use_magnitude_db = true;             // Output in decibels
+    float db_floor = -80.0f;                  // Minimum dB value (noise floor)
+    float db_ceiling = 0.0f;                  // Maximum dB value (0 dB = full scale)
+    std::size_t channels = 1;                 // Signals tracked side by side
+};
+
+/// Tracks the spectrum at a handful of chosen frequencies with a sliding DFT.
+///
+/// Where FFTProcessor transforms a whole window per frame, this keeps one
+/// running DFT term per tracked frequency and advances it by one sample at a
+/// time: each new sample is added, the sample leaving the window subtracted
+/// and the sum rotated, so a frame costs nothing beyond the samples that
+/// arrived since the last one. Frequencies need not sit on a bin of
+/// window_size; each term is the window's DTFT at exactly that frequency.
+///
+/// All window functions are cosine sums, so windowing is applied in the
+/// frequency domain: the tracker also runs the terms one and more DFT bins
+/// either side (three terms per frequency for Hann, nine for FlatTop) and
+/// combines them with the window's coefficients. The periodic form of the
+/// window is used, which differs from the symmetric tables FFTProcessor
+/// applies by one sample's worth of taper. Magnitudes are normalized as
+/// FFTProcessor's are: a full-scale sinusoid reads full scale.
+///
+/// The terms are kept in double precision and damped by a factor a hair
+/// below one per sample, so rounding error cannot accumulate however long
+/// the tracker runs; the damping tapers the window by under 0.01% at 65536
+/// samples. Until window_size samples have arrived the missing part of the
+/// window reads as silence.
+///
+/// Thread safety: NOT thread-safe. Allocation-free after construction.
+class ToneTracker {
+public:
+    /// Precomputes the twiddles and allocates the sample history.
+    /// @throws std::invalid_argument if no frequency is given, a frequency is
+    ///         outside (0, sample_rate / 2), or window_size or channels is zero.
+    explicit ToneTracker(const ToneTrackerConfig& config = {});
+
+    /// Advances every tracked frequency by `samples`. Requires channels() == 1.
+    void process(std::span<const float> samples) noexcept;
+
+    /// Advances every channel by its input, `head` followed by `tail`.
+    /// @param inputs One signal per channel; inputs.size() must equal channels().
+    void process_batch(std::span<const SegmentedInput> inputs) noexcept;
+
+    /// Writes the current magnitude of every tracked frequency, channel-planar:
+    /// channel c occupies [c * tone_count(), (c + 1) * tone_count()).
+    /// @param output Must have capacity >= channels() * tone_count().
+    ///               Values are in dB if use_magnitude_db is true, otherwise linear.
+    /// @return Number of values written.
+    std::size_t magnitudes(std::span<float> output) const noexcept;
+
+    /// Advances by `samples`, then writes the magnitudes; the single-channel
+    /// counterpart of FFTProcessor::compute().
+    std::size_t compute(std::span<const float> samples, std::span<float> output) noexcept;
+
+    /// Forgets every sample seen so far.
+    void reset() noexcept;
+
+    /// Returns the number of tracked frequencies.
+    [[nodiscard]] std::size_t tone_count() const noexcept { return config_.frequencies.size(); }
+
+    /// Returns the sliding window length in samples.
+    [[nodiscard]] std::size_t window_size() const noexcept { return config_.window_size; }
+
+    /// Returns the number of channels tracked.
+    [[nodiscard]] std::size_t channels() const noexcept { return config_.channels; }
+
+    /// Provides access to configuration.
+    [[nodiscard]] const ToneTrackerConfig& config() const noexcept { return config_; }
+
+private:
+    void advance(std::size_t channel, std::span<const float> samples) noexcept;
+
+    ToneTrackerConfig config_;
+    std::size_t terms_ = 1;                   // DFT terms per tracked frequency
+    float scale_ = 1.0f;                      // Power normalization
+
+    // One entry per term, tone-major
+    std::vector<double> rotate_re_;           // damping * e^{j w}
+    std::vector<double> rotate_im_;
+    std::vector<double> expire_re_;           // damping^N * e^{j w N}
+    std::vector<double> expire_im_;
+    std::vector<double> weights_;             // Window coefficient of each term
+
+    // Per channel: running terms and the window's samples
+    std::vector<double> state_re_;
+    std::vector<double> state_im_;
+    std::vector<float> history_;              // window_size samples per channel, circular
+    std::vector<std::size_t> position_;       // Oldest sample of each channel's window
+};
+
+}  // namespace audiovis
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "audiovis/latency_histogram.hpp"
+#include "audiovis/ring_buffer.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Set to 1 by the AUDIOVIS_ENABLE_TRACING CMake option
+#ifndef AUDIOVIS_TRACING
+#define AUDIOVIS_TRACING 0
+#endif
+
+namespace audiovis {
+
+/// Pipeline stages the tracer times.
+enum class TraceStage : std::uint8_t {
+    AnalyzerUpdate,   // SpectrumAnalyzer::update(), whole call
+    AnalyzeFrame,     // One STFT frame, ring read to smoothed bands
+    Decimate,         // Pre-FFT decimation of the capture rings
+    RingRead,         // Exposing the next window of every ring
+    FftCompute,       // Windowing and transform of every channel
+    Window,           // Window multiply into the FFTW input
+    FftExecute,       // fftwf_execute_dft_r2c()
+    Magnitude,        // Power spectrum and dB conversion of whole spectra
+    BandMapping,      // Spectrum (or tone tracker) to smoothed display bands
+    Smoothing,        // Temporal smoothing and peak hold outside the fused kernel
+    Render,           // TerminalRenderer::render(), whole frame
+    Draw              // Flushing the frame to the terminal
+};
+
+/// Number of TraceStage values.
+inline constexpr std::size_t kTraceStageCount = 12;
+
+/// Returns the stage's name in traces, e.g. "fft.execute".
+[[nodiscard]] const char* trace_stage_name(TraceStage stage) noexcept;
+
+/// One timed span.
+struct TraceEvent {
+    std::uint64_t start_ns = 0;           // Since the tracer's epoch
+    std::uint64_t duration_ns = 0;
+    std::uint32_t thread = 0;             // Tracer-assigned thread index, reused after exit
+    TraceStage stage = TraceStage::AnalyzerUpdate;
+};
+
+/// Timing of one stage over a window.
+struct TraceStageStats {
+    std::uint64_t count = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t max_ns = 0;
+    LatencyHistogram histogram{};         // Durations, for percentiles
+
+    /// Returns the mean duration in microseconds, 0 if nothing was recorded.
+    [[nodiscard]] double mean_us() const noexcept {
+        return count > 0 ? static_cast<double>(total_ns) / static_cast<double>(count) / 1e3 : 0.0;
+    }
+};
+
+/// Per-stage timing since the previous Tracer::roll().
+struct TraceWindow {
+    std::array<TraceStageStats, kTraceStageCount> stages{};
+    std::uint64_t dropped = 0;            // Events lost to full thread buffers
+
+    [[nodiscard]] const TraceStageStats& operator[](TraceStage stage) const noexcept {
+        return stages[static_cast<std::size_t>(stage)];
+    }
+};
+
+/// Formats a window as one JSON object, listing only stages that ran.
+/// E.g. {"dropped":0,"stages":{"fft.execute":{"count":94,"mean_us":8.1,
+/// "p50_us":8,"p99_us":16,"max_us":12},...}}.
+[[nodiscard]] std::string to_json(const TraceWindow& window);
+
+/// Process-wide collector for scoped pipeline timings.
+///
+/// Each recording thread gets its own SPSC event ring the first time it
+/// records, so the hot path is two clock reads and a ring push: no locks, no
+/// shared cache lines, no allocation. A full ring drops the event and counts
+/// it rather than waiting. A thread hands its ring back when it exits; once
+/// drained, the next new thread reuses it, so short-lived worker pools do not
+/// grow the tracer. One housekeeping thread calls collect()
+/// periodically (the renderer does, once a second) to drain every ring into
+/// rolling per-stage histograms and, while capture is on, into a list of
+/// events exported as Chrome trace JSON for chrome://tracing or Perfetto.
+///
+/// Timings are recorded through AUDIOVIS_TRACE_SCOPE, which compiles to
+/// nothing unless the AUDIOVIS_ENABLE_TRACING CMake option is on, so a
+/// regular build pays nothing. The tracer itself is always available, and
+/// ScopedTrace may be used directly.
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// True if the pipeline's AUDIOVIS_TRACE_SCOPE points are compiled in.
+    static constexpr bool kCompiledIn = AUDIOVIS_TRACING != 0;
+
+    /// Events each thread can buffer between collect() calls.
+    static constexpr std::size_t kThreadCapacity = 8192;
+
+    /// Most events held for export; later ones are counted as dropped.
+    static constexpr std::size_t kMaxCapturedEvents = std::size_t{1} << 20;
+
+    /// Returns the process-wide tracer.
+    static Tracer& instance();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /// Records a finished span from the calling thread. Lock-free and
+    /// allocation-free except for the thread's first event, which registers
+    /// its ring (one an exited thread left behind, if any).
+    void record(TraceStage stage, Clock::time_point start, Clock::time_point end) noexcept;
+
+    /// Drains every thread's ring into the current window and the capture.
+    /// Call from one thread at a time; never from a real-time thread.
+    /// @return Events drained.
+    std::size_t collect();
+
+    /// Collects, then returns the current window and starts the next one.
+    TraceWindow roll();
+
+    /// Starts or stops keeping collected events for export.
+    void set_capture(bool enabled);
+
+    /// Returns the events captured so far, in collection order.
+    [[nodiscard]] std::vector<TraceEvent> captured() const;
+
+    /// Collects, then formats the captured events as Chrome trace JSON.
+    [[nodiscard]] std::string chrome_trace_json();
+
+    /// Writes chrome_trace_json() to `path`.
+    /// @throws std::runtime_error if the file cannot be written.
+    void write_chrome_trace(const std::string& path);
+
+    /// Discards every pending and captured event and the current window.
+    void clear();
+
+private:
+    struct ThreadBuffer {
+        explicit ThreadBuffer(std::uint32_t thread_index) : index{thread_index} {}
+
+        RingBuffer<TraceEvent> events{kThreadCapacity};
+        std::atomic<std::uint64_t> dropped{0};   // Written by the owning thread only
+        std::uint32_t index;
+        bool retired = false;                    // Owner exited; freed once drained
+    };
+
+    /// Hands the calling thread's ring back when the thread exits.
+    struct ThreadSlot {
+        ThreadBuffer* buffer;
+        ~ThreadSlot();
+    };
+
+    Tracer();
+    ~Tracer() = default;
+
+    ThreadBuffer* register_thread() noexcept;
+    void release_thread(ThreadBuffer* buffer) noexcept;
+    std::size_t collect_locked();
+
+    const Clock::time_point epoch_;
+    mutable std::mutex mutex_;                        // Guards everything below
+    std::vector<std::unique_ptr<ThreadBuffer>> threads_;
+    std::vector<ThreadBuffer*> free_;                 // Drained, awaiting a new thread
+    TraceWindow window_;
+    std::uint64_t dropped_reported_ = 0;              // Ring drops already counted in a window
+    bool capture_ = false;
+    std::vector<TraceEvent> captured_;
+};
+
+/// Times its own lifetime as one span of `stage`.
+class ScopedTrace {
+public:
+    explicit ScopedTrace(TraceStage stage) noexcept
+        : stage_{stage}, start_{Tracer::Clock::now()} {}
+
+    ~ScopedTrace() { Tracer::instance().record(stage_, start_, Tracer::Clock::now()); }
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+    TraceStage stage_;
+    Tracer::Clock::time_point start_;
+};
+
+}  // namespace audiovis
+
+/// Times the rest of the enclosing scope as `stage` when tracing is compiled
+/// in; otherwise expands to nothing.
+#if AUDIOVIS_TRACING
+#define AUDIOVIS_TRACE_CONCAT_(a, b) a##b
+#define AUDIOVIS_TRACE_NAME_(line) AUDIOVIS_TRACE_CONCAT_(audiovis_trace_, line)
+#define AUDIOVIS_TRACE_SCOPE(stage) \
+    const ::audiovis::ScopedTrace AUDIOVIS_TRACE_NAME_(__LINE__) { ::audiovis::TraceStage::stage }
+#else
+#define AUDIOVIS_TRACE_SCOPE(stage) static_cast<void>(0)
+#endif
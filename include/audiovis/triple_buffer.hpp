@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace audiovis {
+
+/// Lock-free single-writer single-reader "latest value" exchange.
+///
+/// Holds three slots: one owned by the writer, one owned by the reader, and
+/// one in the middle that the two swap through with a single atomic exchange.
+/// The writer never waits for the reader and the reader never sees a partially
+/// written value, which makes it a good fit for handing finished frames from an
+/// analysis thread to a render thread that only cares about the newest one.
+/// Intermediate values are silently overwritten if the reader falls behind.
+///
+/// Neither side allocates or blocks, so T's copy assignment is never invoked
+/// by the exchange itself - slots are handed over by index.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    /// Initializes all three slots with `initial` (e.g. pre-sized frames).
+    explicit TripleBuffer(const T& initial) { reset(initial); }
+
+    // Non-copyable, non-movable (atomics don't move safely)
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+    TripleBuffer(TripleBuffer&&) = delete;
+    TripleBuffer& operator=(TripleBuffer&&) = delete;
+
+    /// Re-initializes every slot and drops any unread value.
+    /// NOT thread-safe: call only while neither side is active.
+    void reset(const T& value) {
+        for (auto& slot : slots_) {
+            slot = value;
+        }
+        write_index_ = 0;
+        middle_.store(1, std::memory_order_relaxed);
+        read_index_ = 2;
+    }
+
+    // -------------------------------------------------------------------------
+    // Writer interface (call from producer thread only)
+    // -------------------------------------------------------------------------
+
+    /// Returns the slot the writer may fill. Stable until the next publish().
+    [[nodiscard]] T& write_buffer() noexcept { return slots_[write_index_]; }
+
+    /// Makes the current write slot the latest value and takes a fresh slot.
+    /// Wait-free.
+    void publish() noexcept {
+        const auto previous =
+            middle_.exchange(write_index_ | kFreshBit, std::memory_order_acq_rel);
+        write_index_ = previous & kIndexMask;
+    }
+
+    // -------------------------------------------------------------------------
+    // Reader interface (call from consumer thread only)
+    // -------------------------------------------------------------------------
+
+    /// Acquires the latest published value, if any. Returns true if
+    /// read_buffer() now refers to a value that was not seen before.
+    /// Wait-free.
+    bool update() noexcept {
+        if ((middle_.load(std::memory_order_relaxed) & kFreshBit) == 0) {
+            return false;
+        }
+        const auto previous = middle_.exchange(read_index_, std::memory_order_acq_rel);
+        read_index_ = previous & kIndexMask;
+        return true;
+    }
+
+    /// Returns the most recently acquired value. Stable until the next update().
+    [[nodiscard]] const T& read_buffer() const noexcept { return slots_[read_index_]; }
+
+private:
+    static constexpr std::uint32_t kIndexMask = 0x3;
+    static constexpr std::uint32_t kFreshBit = 0x4;
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    std::array<T, 3> slots_{};
+
+    // Each side's private index lives on its own cache line, away from the
+    // shared middle index, so the two threads only contend on the exchange.
+    alignas(kCacheLineSize) std::uint32_t write_index_ = 0;
+    alignas(kCacheLineSize) std::atomic<std::uint32_t> middle_{1};
+    alignas(kCacheLineSize) std::uint32_t read_index_ = 2;
+};
+
+}  // namespace audiovis
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace audiovis {
+
+/// Window functions for spectral analysis.
+/// The choice of window affects frequency resolution vs. spectral leakage tradeoff.
+enum class WindowFunction {
+    Rectangular,  // No windowing - maximum resolution, maximum leakage
+    Hann,         // Good general purpose - moderate resolution and leakage
+    Hamming,      // Similar to Hann with slightly different sidelobe behavior
+    Blackman,     // Low leakage at cost of frequency resolution
+    FlatTop       // Accurate amplitude measurement, poor frequency resolution
+};
+
+/// Immutable coefficients of one window function at one length, with the
+/// gains needed to normalize spectra taken through it.
+///
+/// Tables come from a process-wide cache (see window_table()), so every
+/// FFTProcessor of the same window and size shares one copy. The Hann window
+/// at the common FFT sizes is generated at compile time, so fetching it needs
+/// no trigonometry at all; anything else is computed once, on first use, and
+/// kept until process exit. Thread-safe: tables never change after construction.
+class WindowTable {
+public:
+    /// Returns the coefficients, size() of them. Symmetric: w[i] == w[size() - 1 - i].
+    [[nodiscard]] std::span<const float> coefficients() const noexcept { return coefficients_; }
+
+    [[nodiscard]] std::size_t size() const noexcept { return coefficients_.size(); }
+    [[nodiscard]] WindowFunction function() const noexcept { return function_; }
+
+    /// Returns the mean coefficient. A sinusoid centred on a bin reads this
+    /// much of its amplitude; dividing by it restores the true amplitude.
+    [[nodiscard]] float coherent_gain() const noexcept { return coherent_gain_; }
+
+    /// Returns the mean squared coefficient. Broadband noise power reads this
+    /// much of its true power.
+    [[nodiscard]] float energy_gain() const noexcept { return energy_gain_; }
+
+    /// Returns the equivalent noise bandwidth in bins: how many bins of
+    /// broadband noise a single bin collects (1 for Rectangular, 1.5 for Hann).
+    [[nodiscard]] float noise_bandwidth() const noexcept {
+        return energy_gain_ / (coherent_gain_ * coherent_gain_);
+    }
+
+    /// Returns true if the table was generated at compile time.
+    [[nodiscard]] bool prebaked() const noexcept { return prebaked_; }
+
+    // Cached tables are shared by address
+    WindowTable(const WindowTable&) = delete;
+    WindowTable& operator=(const WindowTable&) = delete;
+
+private:
+    friend class WindowCache;
+
+    WindowTable(WindowFunction function, std::span<const float> coefficients, bool prebaked);
+
+    WindowFunction function_;
+    std::span<const float> coefficients_;  // Static storage or owned by the cache
+    float coherent_gain_ = 1.0f;
+    float energy_gain_ = 1.0f;
+    bool prebaked_;
+};
+
+/// Returns the shared table for `function` at `size` points, creating it if
+/// needed. The reference stays valid until process exit. Thread-safe.
+/// @throws std::invalid_argument if size is zero.
+[[nodiscard]] const WindowTable& window_table(WindowFunction function, std::size_t size);
+
+/// Returns the number of tables computed at run time so far (prebaked ones
+/// are not counted).
+[[nodiscard]] std::size_t window_cache_size();
+
+}  // namespace audiovis
@@ -0,0 +1,179 @@
+#include "audiovis/aligned_buffer.hpp"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace audiovis {
+
+namespace {
+
+/// Cache line size; the smallest alignment handed out.
+constexpr std::size_t kCacheLineSize = 64;
+
+/// Nodes an mbind() mask can name.
+constexpr unsigned kMaxNumaNodes = 1024;
+
+void append_note(std::string& notes, const std::string& note) {
+    if (!notes.empty()) {
+        notes += "; ";
+    }
+    notes += note;
+}
+
+std::size_t round_up(std::size_t n, std::size_t multiple) noexcept {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+/// Maps `length` bytes aligned to `alignment`, trimming an oversized mapping.
+/// `granule` is the page size of the mapping; `length` is a multiple of it.
+void* map_aligned(std::size_t length, std::size_t alignment, std::size_t granule, int flags) {
+    const auto extra = alignment > granule ? alignment : 0;
+    void* base = mmap(nullptr, length + extra, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+    if (extra == 0) {
+        return base;
+    }
+
+    // Head and tail are both multiples of the granule, so they unmap cleanly
+    auto* const start = static_cast<std::byte*>(base);
+    const auto address = reinterpret_cast<std::uintptr_t>(start);
+    const auto head = round_up(address, alignment) - address;
+    if (head > 0) {
+        munmap(start, head);
+    }
+    if (extra - head > 0) {
+        munmap(start + head + length, extra - head);
+    }
+    return start + head;
+}
+
+}  // namespace
+
+AlignedBuffer::AlignedBuffer(std::size_t bytes, const BufferPolicy& policy) : size_{bytes} {
+    if (policy.alignment == 0 || (policy.alignment & (policy.alignment - 1)) != 0) {
+        throw std::invalid_argument("Buffer alignment must be a power of two");
+    }
+    if (policy.placement == MemoryPlacement::Bind && policy.numa_node >= kMaxNumaNodes) {
+        throw std::invalid_argument("NUMA node is out of range");
+    }
+    if (bytes == 0) {
+        return;
+    }
+    const auto alignment = std::max(policy.alignment, kCacheLineSize);
+
+    bool huge = policy.huge_pages;
+    if (huge && bytes < kHugePageSize) {
+        append_note(notes_, "smaller than a hugepage, using ordinary pages");
+        huge = false;
+    }
+
+    // The default is what make_unique<T[]>() did, only aligned
+    if (!huge && policy.placement == MemoryPlacement::Local) {
+        alignment_ = alignment;
+        data_ = ::operator new(bytes, std::align_val_t{alignment});
+        std::memset(data_, 0, bytes);
+        return;
+    }
+
+    const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const auto granule = huge ? kHugePageSize : page;
+    mapped_ = round_up(bytes, granule);
+    if (huge) {
+        int flags = MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        flags |= 21 << MAP_HUGE_SHIFT;  // 2 MiB, whatever the default hugepage size
+#endif
+        data_ = map_aligned(mapped_, alignment, kHugePageSize, flags);
+        huge_pages_ = data_ != nullptr;
+        if (data_ == nullptr) {
+            // No hugetlbfs pool: take 2 MiB-aligned ordinary pages the kernel
+            // may promote to transparent hugepages
+            data_ = map_aligned(mapped_, std::max(alignment, kHugePageSize), page, 0);
+            if (data_ != nullptr) {
+                huge_pages_ = madvise(data_, mapped_, MADV_HUGEPAGE) == 0;
+                const std::string note =
+                    huge_pages_ ? "no hugetlbfs pages, using transparent hugepages"
+                                : std::string{"hugepages refused: "} + std::strerror(errno);
+                append_note(notes_, note);
+            }
+        }
+    } else {
+        data_ = map_aligned(mapped_, alignment, page, 0);
+    }
+    if (data_ == nullptr) {
+        mapped_ = 0;
+        throw std::bad_alloc{};
+    }
+
+    if (policy.placement == MemoryPlacement::Bind) {
+        std::array<unsigned long, kMaxNumaNodes / (8 * sizeof(unsigned long))> mask{};
+        constexpr auto kBits = 8 * sizeof(unsigned long);
+        mask[policy.numa_node / kBits] |= 1UL << (policy.numa_node % kBits);
+        // Raw syscall: the policy is all that is needed, not libnuma
+        bound_ = syscall(SYS_mbind, data_, mapped_, MPOL_BIND, mask.data(), kMaxNumaNodes + 1,
+                         0U) == 0;
+        if (!bound_) {
+            append_note(notes_, "NUMA binding refused: " + std::string{std::strerror(errno)});
+        }
+    }
+
+    // Fresh mappings read as zero; only FirstTouch leaves the pages for later
+    if (policy.placement != MemoryPlacement::FirstTouch) {
+        std::memset(data_, 0, mapped_);
+    }
+}
+
+AlignedBuffer::~AlignedBuffer() {
+    release();
+}
+
+AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept
+    : data_{std::exchange(other.data_, nullptr)},
+      size_{std::exchange(other.size_, 0)},
+      mapped_{std::exchange(other.mapped_, 0)},
+      alignment_{std::exchange(other.alignment_, 0)},
+      huge_pages_{std::exchange(other.huge_pages_, false)},
+      bound_{std::exchange(other.bound_, false)},
+      notes_{std::move(other.notes_)} {}
+
+AlignedBuffer& AlignedBuffer::operator=(AlignedBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        mapped_ = std::exchange(other.mapped_, 0);
+        alignment_ = std::exchange(other.alignment_, 0);
+        huge_pages_ = std::exchange(other.huge_pages_, false);
+        bound_ = std::exchange(other.bound_, false);
+        notes_ = std::move(other.notes_);
+    }
+    return *this;
+}
+
+void AlignedBuffer::release() noexcept {
+    if (data_ == nullptr) {
+        return;
+    }
+    if (mapped_ > 0) {
+        munmap(data_, mapped_);
+    } else {
+        ::operator delete(data_, std::align_val_t{alignment_});
+    }
+    data_ = nullptr;
+}
+
+}  // namespace audiovis
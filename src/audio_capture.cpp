@@ -31,13 +31,13 @@ PortAudioGuard::~PortAudioGuard() {
 // Global guard ensures PortAudio stays initialized for duration of program
 static PortAudioGuard g_portaudio_guard;
 
-AudioCapture::AudioCapture(const AudioConfig& config) : config_{config} {
-    // Calculate ring buffer size from duration
-    const auto buffer_samples = static_cast<std::size_t>(config_.ring_buffer_seconds *
-                                                         static_cast<float>(config_.sample_rate) *
-                                                         static_cast<float>(config_.channels));
-    ring_buffer_ = std::make_unique<RingBuffer<float>>(buffer_samples);
-
+AudioCapture::AudioCapture(const AudioConfig& config)
+    : AudioSource{config.sample_rate, config.channels,
+                  // Per-channel ring buffer size from duration
+                  static_cast<std::size_t>(config.ring_buffer_seconds *
+                                           static_cast<float>(config.sample_rate)),
+                  config.ring_buffers, config.channel_rings},
+      config_{config} {
     // Get default input device info
     PaDeviceIndex device = Pa_GetDefaultInputDevice();
     if (device == paNoDevice) {
@@ -82,6 +82,13 @@ void AudioCapture::start() {
     if (running_.load(std::memory_order_relaxed)) {
         return;  // Already running
     }
+    if (!has_channel_rings() && broadcast() == nullptr) {
+        throw std::logic_error("Capture without channel rings needs a broadcast ring");
+    }
+
+    // The stream is stopped, so the callback state is ours to touch. Forget
+    // the previous callback so the pause doesn't count as interval jitter.
+    callback_state_.last_callback = {};
 
     PaError err = Pa_StartStream(stream_);
     if (err != paNoError) {
@@ -102,10 +109,7 @@ void AudioCapture::stop() {
 }
 
 AudioStats AudioCapture::stats() const noexcept {
-    return AudioStats{.frames_captured = frames_captured_.load(std::memory_order_relaxed),
-                      .overruns = overruns_.load(std::memory_order_relaxed),
-                      .callback_count = callback_count_.load(std::memory_order_relaxed),
-                      .peak_amplitude = peak_amplitude_.load(std::memory_order_relaxed)};
+    return stats_.load();
 }
 
 int AudioCapture::audio_callback(const void* input, void* /*output*/, unsigned long frame_count,
@@ -123,34 +127,67 @@ int AudioCapture::audio_callback(const void* input, void* /*output*/, unsigned l
 }
 
 void AudioCapture::process_audio(std::span<const float> samples, unsigned long status_flags) {
+    using Clock = std::chrono::steady_clock;
+    const auto started = Clock::now();
+
+    auto& state = callback_state_;
+    auto& totals = state.totals;
+
+    // Callback cadence; the first callback after start() has no predecessor
+    if (state.last_callback != Clock::time_point{}) {
+        totals.callback_interval.record(
+            std::chrono::duration_cast<std::chrono::microseconds>(started - state.last_callback));
+    }
+    state.last_callback = started;
+
     // Check for input overflow (samples were dropped before reaching us)
     if ((status_flags & paInputOverflow) != 0) {
-        overruns_.fetch_add(1, std::memory_order_relaxed);
+        ++totals.input_overflows;
+        ++totals.overruns;
     }
 
-    // Track peak amplitude for level metering
+    // Track peak and energy for level metering
     float peak = 0.0f;
+    float energy = 0.0f;
     for (const float sample : samples) {
         peak = std::max(peak, std::abs(sample));
+        energy += sample * sample;
     }
 
-    // Update peak using atomic max operation
-    float current_peak = peak_amplitude_.load(std::memory_order_relaxed);
-    while (peak > current_peak &&
-           !peak_amplitude_.compare_exchange_weak(current_peak, peak, std::memory_order_relaxed)) {
-        // Retry if another update happened
-    }
-
-    // Write samples to ring buffer
-    std::size_t written = ring_buffer_->try_push(samples);
-    if (written < samples.size()) {
+    // Write samples to the ring buffers
+    const std::size_t frames = samples.size() / config_.channels;
+    if (!push_interleaved(samples)) {
         // Ring buffer full - count as overrun
-        overruns_.fetch_add(1, std::memory_order_relaxed);
+        ++totals.overruns;
     }
 
     // Update statistics
-    frames_captured_.fetch_add(samples.size(), std::memory_order_relaxed);
-    callback_count_.fetch_add(1, std::memory_order_relaxed);
+    totals.frames_captured += frames;
+    ++totals.callback_count;
+
+    // Slide the level window: replace the oldest callback's contribution
+    state.block_peaks[state.level_index] = peak;
+    state.block_energy[state.level_index] = energy;
+    state.block_samples[state.level_index] = samples.size();
+    state.level_index = (state.level_index + 1) % kLevelWindow;
+
+    float window_peak = 0.0f;
+    float window_energy = 0.0f;
+    std::size_t window_samples = 0;
+    for (std::size_t i = 0; i < kLevelWindow; ++i) {
+        window_peak = std::max(window_peak, state.block_peaks[i]);
+        window_energy += state.block_energy[i];
+        window_samples += state.block_samples[i];
+    }
+    totals.peak_amplitude = window_peak;
+    totals.rms_level =
+        window_samples > 0 ? std::sqrt(window_energy / static_cast<float>(window_samples)) : 0.0f;
+
+    totals.callback_duration.record(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started));
+
+    // Plain stores only: readers retry if they overlap this
+    stats_.store(totals);
 }
 
 std::vector<std::string> AudioCapture::list_input_devices() {
@@ -0,0 +1,90 @@
+#include "audiovis/audio_source.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace audiovis {
+
+AudioSource::AudioSource(std::uint32_t sample_rate, std::uint32_t channels,
+                         std::size_t ring_capacity, const BufferPolicy& ring_policy,
+                         bool channel_rings)
+    : sample_rate_{sample_rate}, channels_{channels}, channel_rings_{channel_rings} {
+    if (channels_ == 0) {
+        throw std::invalid_argument("Audio channel count must be at least one");
+    }
+    if (sample_rate_ == 0) {
+        throw std::invalid_argument("Audio sample rate must be positive");
+    }
+
+    // buffer() stays valid either way; unused rings just take no memory to speak of
+    const std::size_t capacity = channel_rings_ ? ring_capacity : 1;
+    ring_buffers_.reserve(channels_);
+    for (std::uint32_t ch = 0; ch < channels_; ++ch) {
+        ring_buffers_.push_back(std::make_unique<RingBuffer<float>>(capacity, ring_policy));
+    }
+}
+
+BroadcastRing<float>& AudioSource::enable_broadcast(std::size_t frames) {
+    if (is_running()) {
+        throw std::logic_error("Broadcast ring must be enabled before the source starts");
+    }
+    if (broadcast_) {
+        throw std::logic_error("Broadcast ring is already enabled");
+    }
+    if (frames == 0) {
+        throw std::invalid_argument("Broadcast ring needs room for at least one frame");
+    }
+    broadcast_ = std::make_unique<BroadcastRing<float>>(frames, channels_);
+    return *broadcast_;
+}
+
+std::size_t AudioSource::produce(std::size_t /*max_frames*/) {
+    return 0;
+}
+
+std::size_t AudioSource::writable_frames() const noexcept {
+    std::size_t frames = ring_buffers_[0]->available();
+    for (std::size_t ch = 1; ch < ring_buffers_.size(); ++ch) {
+        frames = std::min(frames, ring_buffers_[ch]->available());
+    }
+    return frames;
+}
+
+bool AudioSource::push_interleaved(std::span<const float> samples) noexcept {
+    const std::size_t channels = channels_;
+    const std::size_t frames = samples.size() / channels;
+
+    // One copy for every broadcast reader, whether or not the rings have room
+    if (broadcast_) {
+        broadcast_->push(samples.first(frames * channels));
+    }
+    if (!channel_rings_) {
+        return true;
+    }
+
+    if (channels == 1) {
+        // Mono: already planar, a straight block copy
+        return ring_buffers_[0]->try_push(samples) == samples.size();
+    }
+
+    // Deinterleave directly into each channel's ring storage. The count is
+    // clamped once for all rings: a consumer commits ring by ring, so their
+    // free space may differ for a moment, and writing each ring's own fill
+    // would leave the channels offset for good.
+    const std::size_t count = std::min(frames, writable_frames());
+    for (std::size_t ch = 0; ch < channels; ++ch) {
+        auto& ring = *ring_buffers_[ch];
+        const auto region = ring.acquire_write(count);
+        const float* src = samples.data() + ch;
+        for (const auto segment : {region.first, region.second}) {
+            for (float& dst : segment) {
+                dst = *src;
+                src += channels;
+            }
+        }
+        ring.commit_write(region.size());
+    }
+    return count == frames;
+}
+
+}  // namespace audiovis
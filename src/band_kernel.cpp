@@ -0,0 +1,76 @@
+#include "audiovis/band_kernel.hpp"
+
+#include "audiovis/simd_kernels.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace audiovis {
+
+namespace {
+
+/// Fewest bins converted per step: low bands read a bin or two each, and one
+/// call per band would cost more than the conversion itself.
+constexpr std::size_t kConvertChunk = 64;
+
+/// Exponential moving average, then peak hold with decay.
+inline void smooth_band(float raw, const BandSmoothing& smoothing, const BandLanes& lanes,
+                        std::size_t band) noexcept {
+    const float alpha = 1.0f - smoothing.smoothing_factor;
+    const float smoothed = alpha * raw + smoothing.smoothing_factor * lanes.smoothed[band];
+    float peak = lanes.peaks[band];
+    peak = smoothed > peak ? smoothed : peak * smoothing.peak_decay_rate;
+
+    lanes.smoothed[band] = smoothed;
+    lanes.peaks[band] = peak;
+    lanes.magnitudes_out[band] = smoothed;
+    lanes.peaks_out[band] = peak;
+}
+
+}  // namespace
+
+void smooth_bands(std::span<const float> raw, const BandSmoothing& smoothing,
+                  const BandLanes& lanes) noexcept {
+    for (std::size_t b = 0; b < raw.size(); ++b) {
+        smooth_band(raw[b], smoothing, lanes, b);
+    }
+}
+
+void fused_bands(const FFTProcessor& fft, std::size_t channel, const BandMatrix& matrix,
+                 const BandSmoothing& smoothing, std::span<float> scratch,
+                 const BandLanes& lanes) noexcept {
+    assert(matrix.bin_count() == fft.bin_count());
+    assert(scratch.size() >= fft.bin_count());
+    const auto offsets = matrix.row_offsets();
+    const auto columns = matrix.columns();
+    const auto weights = matrix.weights();
+
+    // Bins in [first_used, converted) are in scratch already. Rows start in
+    // bin order, so a row overlapping earlier ones only ever overlaps bins
+    // converted for them; converting ahead stops at the last bin any row reads.
+    const auto used_end = columns.empty() ? 0 : columns.back() + 1;
+    std::size_t converted = 0;
+    [[maybe_unused]] std::size_t previous_first = 0;
+    for (std::size_t b = 0; b < matrix.band_count(); ++b) {
+        const auto begin = offsets[b];
+        const auto count = offsets[b + 1] - begin;
+        float raw = 0.0f;
+        if (count > 0) {
+            // Columns within a row are consecutive
+            const auto first = columns[begin];
+            const auto end = first + count;
+            assert(first >= previous_first);
+            previous_first = first;
+            if (end > converted) {
+                const auto from = std::max(first, converted);
+                const auto to = std::max(end, std::min(used_end, from + kConvertChunk));
+                fft.convert_bins(channel, from, scratch.subspan(from, to - from));
+                converted = to;
+            }
+            raw = simd::dot(weights.subspan(begin, count), scratch.data() + first);
+        }
+        smooth_band(raw, smoothing, lanes, b);
+    }
+}
+
+}  // namespace audiovis
@@ -0,0 +1,201 @@
+#include "audiovis/band_matrix.hpp"
+
+#include "audiovis/simd_kernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace audiovis {
+
+namespace {
+
+/// Weights that linearly interpolate the spectrum at fractional bin `position`.
+/// Fills `out` and returns the first bin and the number of weights used.
+std::pair<std::size_t, std::size_t> interpolation_weights(float position, std::size_t bin_count,
+                                                          std::array<float, 2>& out) noexcept {
+    const float last = static_cast<float>(bin_count - 1);
+    const float clamped = std::clamp(position, 0.0f, last);
+    const auto first = static_cast<std::size_t>(clamped);
+
+    if (first + 1 >= bin_count) {
+        out = {1.0f, 0.0f};
+        return {bin_count - 1, 1};
+    }
+
+    const float t = clamped - static_cast<float>(first);
+    out = {1.0f - t, t};
+    return {first, 2};
+}
+
+}  // namespace
+
+float hz_to_scale(float hz, FrequencyScale scale) noexcept {
+    switch (scale) {
+        case FrequencyScale::Linear:
+            return hz;
+        case FrequencyScale::Logarithmic:
+            return std::log10(hz);
+        case FrequencyScale::Mel:
+            return 2595.0f * std::log10(1.0f + hz / 700.0f);
+        case FrequencyScale::ERB:
+            return 21.4f * std::log10(1.0f + 0.00437f * hz);
+    }
+    return hz;
+}
+
+float scale_to_hz(float value, FrequencyScale scale) noexcept {
+    switch (scale) {
+        case FrequencyScale::Linear:
+            return value;
+        case FrequencyScale::Logarithmic:
+            return std::pow(10.0f, value);
+        case FrequencyScale::Mel:
+            return 700.0f * (std::pow(10.0f, value / 2595.0f) - 1.0f);
+        case FrequencyScale::ERB:
+            return (std::pow(10.0f, value / 21.4f) - 1.0f) / 0.00437f;
+    }
+    return value;
+}
+
+BandMatrix::BandMatrix(const BandLayout& layout, std::size_t bin_count, std::size_t fft_size,
+                       float sample_rate)
+    : bin_count_{bin_count} {
+    if (layout.num_bands == 0) {
+        throw std::invalid_argument("Band layout must have at least one band");
+    }
+    if (!(layout.min_frequency > 0.0f) || !(layout.min_frequency < layout.max_frequency)) {
+        throw std::invalid_argument("Band layout needs 0 < min_frequency < max_frequency");
+    }
+    if (bin_count == 0) {
+        throw std::invalid_argument("Band matrix needs at least one FFT bin");
+    }
+
+    const auto num_bands = layout.num_bands;
+    const float scale_min = hz_to_scale(layout.min_frequency, layout.scale);
+    const float scale_max = hz_to_scale(layout.max_frequency, layout.scale);
+    const float step = (scale_max - scale_min) / static_cast<float>(num_bands);
+
+    // Band edges and centres, evenly spaced on the chosen scale
+    edges_.resize(num_bands + 1);
+    std::vector<float> centres(num_bands);
+    for (std::size_t b = 0; b <= num_bands; ++b) {
+        edges_[b] = scale_to_hz(scale_min + step * static_cast<float>(b), layout.scale);
+    }
+    edges_.front() = layout.min_frequency;  // Exact, despite the round trip
+    edges_.back() = layout.max_frequency;
+
+    const float bins_per_hz = static_cast<float>(fft_size) / sample_rate;
+    for (std::size_t b = 0; b < num_bands; ++b) {
+        centres[b] = bins_per_hz *
+                     scale_to_hz(scale_min + step * (static_cast<float>(b) + 0.5f), layout.scale);
+    }
+
+    row_offsets_.reserve(num_bands + 1);
+    std::vector<float> row;
+    std::array<float, 2> interpolated{};
+
+    for (std::size_t b = 0; b < num_bands; ++b) {
+        const float lo = bins_per_hz * edges_[b];
+        const float hi = bins_per_hz * edges_[b + 1];
+        row.clear();
+        std::size_t first = 0;
+
+        switch (layout.weighting) {
+            case BandWeighting::Rectangular: {
+                // Whole bins, matching compute_log_bands(): at least one per band
+                const auto last_bin = bin_count - 1;
+                first = std::min(static_cast<std::size_t>(lo), last_bin);
+                auto end = std::min(static_cast<std::size_t>(hi), last_bin);
+                if (end <= first) {
+                    end = first + 1;
+                }
+                end = std::min(end, bin_count);
+                row.assign(end - first, 1.0f);
+                break;
+            }
+
+            case BandWeighting::Fractional: {
+                if (hi - lo < 1.0f) {
+                    break;  // Narrower than a bin: interpolate below
+                }
+                // Bin k covers [k - 0.5, k + 0.5); weight by overlap with [lo, hi)
+                const auto k_begin = static_cast<std::size_t>(lo + 0.5f);
+                const auto k_end = std::min(static_cast<std::size_t>(hi + 0.5f) + 1, bin_count);
+                first = k_begin;
+                for (std::size_t k = k_begin; k < k_end; ++k) {
+                    const float bin = static_cast<float>(k);
+                    const float overlap = std::min(hi, bin + 0.5f) - std::max(lo, bin - 0.5f);
+                    row.push_back(std::max(0.0f, overlap));
+                }
+                break;
+            }
+
+            case BandWeighting::Triangular: {
+                // Rises from the previous band's centre, falls to the next one's
+                const float peak = centres[b];
+                const float left = b == 0 ? lo : centres[b - 1];
+                const float right = b + 1 == num_bands ? hi : centres[b + 1];
+                if (right - left < 2.0f) {
+                    break;  // Filter spacing below a bin: interpolate below
+                }
+                const auto k_begin = static_cast<std::size_t>(std::ceil(left));
+                const auto k_end = std::min(static_cast<std::size_t>(right) + 1, bin_count);
+                first = k_begin;
+                for (std::size_t k = k_begin; k < k_end; ++k) {
+                    const float bin = static_cast<float>(k);
+                    const float w = bin < peak ? (bin - left) / (peak - left)
+                                               : (right - bin) / (right - peak);
+                    row.push_back(std::max(0.0f, w));
+                }
+                break;
+            }
+        }
+
+        // Trim zero weights at either end so rows stay as short as possible
+        while (!row.empty() && row.back() <= 0.0f) {
+            row.pop_back();
+        }
+        std::size_t lead = 0;
+        while (lead < row.size() && row[lead] <= 0.0f) {
+            ++lead;
+        }
+
+        if (lead == row.size()) {
+            // Nothing usable (sub-bin band, or entirely above Nyquist)
+            const auto [bin, count] =
+                interpolation_weights(centres[b], bin_count, interpolated);
+            append_row(bin, std::span<const float>{interpolated}.first(count));
+        } else {
+            append_row(first + lead, std::span<const float>{row}.subspan(lead));
+        }
+    }
+}
+
+void BandMatrix::append_row(std::size_t first_bin, std::span<const float> row_weights) {
+    float total = 0.0f;
+    for (const float w : row_weights) {
+        total += w;
+    }
+
+    // Normalize so every band is a weighted average of its bins
+    for (std::size_t i = 0; i < row_weights.size(); ++i) {
+        columns_.push_back(first_bin + i);
+        weights_.push_back(row_weights[i] / total);
+    }
+    row_offsets_.push_back(weights_.size());
+}
+
+void BandMatrix::apply(std::span<const float> bins, std::span<float> bands) const noexcept {
+    const std::span<const float> weights{weights_};
+    for (std::size_t b = 0; b + 1 < row_offsets_.size(); ++b) {
+        const auto begin = row_offsets_[b];
+        const auto count = row_offsets_[b + 1] - begin;
+        // Columns within a row are consecutive, so each band is a dense dot product
+        bands[b] = simd::dot(weights.subspan(begin, count), bins.data() + columns_[begin]);
+    }
+}
+
+}  // namespace audiovis
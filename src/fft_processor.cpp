@@ -1,54 +1,196 @@
 #include "audiovis/fft_processor.hpp"
 
+#include "audiovis/simd_kernels.hpp"
+#include "audiovis/trace.hpp"
+
 #include <fftw3.h>
 
 #include <algorithm>
 #include <cassert>
 #include <cmath>
-#include <numbers>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <new>
 #include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
 
 namespace audiovis {
 
-/// Internal FFTW data structures (hidden from header).
-struct FFTProcessor::FFTWData {
-    fftwf_plan plan = nullptr;
-    float* input = nullptr;           // FFTW-aligned input buffer
-    fftwf_complex* output = nullptr;  // FFTW-aligned output buffer
+namespace {
+
+unsigned planner_flags(PlannerRigor rigor) {
+    switch (rigor) {
+        case PlannerRigor::Measure:
+            return FFTW_MEASURE;
+        case PlannerRigor::Patient:
+            return FFTW_PATIENT;
+        case PlannerRigor::Exhaustive:
+            return FFTW_EXHAUSTIVE;
+        case PlannerRigor::Estimate:
+            break;
+    }
+    return FFTW_ESTIMATE;
+}
 
-    ~FFTWData() {
-        if (plan != nullptr) {
-            fftwf_destroy_plan(plan);
+/// Process-wide cache of FFTW plans, keyed by (size, rigor, batch count).
+///
+/// FFTW's planner is not thread-safe, so every planner and wisdom call goes
+/// through one mutex. Executing a plan on other arrays via
+/// fftwf_execute_dft_r2c() is thread-safe, which is what lets instances on
+/// different threads share a plan. Plans live until process exit.
+class PlanCache {
+public:
+    static PlanCache& instance() {
+        static PlanCache cache;
+        return cache;
+    }
+
+    PlanCache(const PlanCache&) = delete;
+    PlanCache& operator=(const PlanCache&) = delete;
+
+    /// Returns the shared plan transforming `batch` contiguous signals of
+    /// `fft_size` samples at this rigor, creating it if needed.
+    fftwf_plan acquire(std::size_t fft_size, PlannerRigor rigor, std::size_t batch) {
+        const std::lock_guard lock{mutex_};
+
+        const auto key = std::make_tuple(fft_size, rigor, batch);
+        if (const auto it = plans_.find(key); it != plans_.end()) {
+            return it->second;
         }
-        if (input != nullptr) {
-            fftwf_free(input);
+
+        // Plan on scratch arrays: measuring overwrites them, and the plan is only
+        // ever run on each instance's own (identically aligned) buffers.
+        const int n = static_cast<int>(fft_size);
+        const auto bins = fft_size / 2 + 1;
+        float* in = fftwf_alloc_real(fft_size * batch);
+        fftwf_complex* out = fftwf_alloc_complex(bins * batch);
+        if (in == nullptr || out == nullptr) {
+            fftwf_free(in);
+            fftwf_free(out);
+            throw std::runtime_error("Failed to allocate FFTW planning buffers");
+        }
+
+        // Try wisdom first so a previously measured size plans instantly
+        const auto flags = planner_flags(rigor);
+        const bool measured = rigor != PlannerRigor::Estimate;
+        // One batched plan for all signals: signal k starts at in + k * fft_size
+        // and writes its spectrum to out + k * bins
+        const auto make_plan = [&](unsigned plan_flags) {
+            return fftwf_plan_many_dft_r2c(1, &n, static_cast<int>(batch), in, nullptr, 1, n, out,
+                                           nullptr, 1, static_cast<int>(bins), plan_flags);
+        };
+        fftwf_plan plan = nullptr;
+        if (measured) {
+            plan = make_plan(flags | FFTW_WISDOM_ONLY);
+        }
+        const bool learned = plan == nullptr && measured;
+        if (plan == nullptr) {
+            plan = make_plan(flags);
+        }
+
+        fftwf_free(in);
+        fftwf_free(out);
+
+        if (plan == nullptr) {
+            throw std::runtime_error("Failed to create FFTW plan");
         }
-        if (output != nullptr) {
-            fftwf_free(output);
+        plans_.emplace(key, plan);
+
+        // Persist new measurements right away so a crash doesn't lose them
+        if (learned && !wisdom_path_.empty()) {
+            fftwf_export_wisdom_to_filename(wisdom_path_.c_str());
+        }
+        return plan;
+    }
+
+    bool load_wisdom(const std::string& path) {
+        const std::lock_guard lock{mutex_};
+        wisdom_path_ = path;
+        return !path.empty() && fftwf_import_wisdom_from_filename(path.c_str()) != 0;
+    }
+
+    std::size_t size() {
+        const std::lock_guard lock{mutex_};
+        return plans_.size();
+    }
+
+private:
+    PlanCache() = default;
+
+    ~PlanCache() {
+        for (const auto& [key, plan] : plans_) {
+            fftwf_destroy_plan(plan);
         }
     }
+
+    std::mutex mutex_;
+    std::map<std::tuple<std::size_t, PlannerRigor, std::size_t>, fftwf_plan> plans_;
+    std::string wisdom_path_;
+};
+
+}  // namespace
+
+bool load_fftw_wisdom(const std::string& path) {
+    return PlanCache::instance().load_wisdom(path);
+}
+
+std::string default_wisdom_path() {
+    std::filesystem::path dir;
+    if (const char* cache = std::getenv("XDG_CACHE_HOME"); cache != nullptr && *cache != '\0') {
+        dir = cache;
+    } else if (const char* home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+        dir = std::filesystem::path{home} / ".cache";
+    } else {
+        return {};
+    }
+
+    dir /= "audiovis";
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    return ec ? std::string{} : (dir / "fftw_wisdom").string();
+}
+
+std::size_t fftw_cached_plan_count() {
+    return PlanCache::instance().size();
+}
+
+/// Internal FFTW data structures (hidden from header).
+struct FFTProcessor::FFTWData {
+    fftwf_plan plan = nullptr;        // Shared, owned by PlanCache
+    AlignedBuffer input_storage;
+    AlignedBuffer output_storage;
+    float* input = nullptr;           // SIMD-aligned input buffer
+    fftwf_complex* output = nullptr;  // SIMD-aligned output buffer
 };
 
 FFTProcessor::FFTProcessor(const FFTConfig& config)
-    : config_{config}, fftw_{std::make_unique<FFTWData>()} {
+    : config_{config},
+      fftw_{std::make_unique<FFTWData>()},
+      window_{&window_table(config.window, config.fft_size)} {
     if ((config_.fft_size & (config_.fft_size - 1)) != 0) {
         throw std::invalid_argument("FFT size must be a power of two");
     }
+    if (config_.channels == 0) {
+        throw std::invalid_argument("FFT channel count must be at least one");
+    }
 
     allocate_buffers();
-    compute_window();
 }
 
 FFTProcessor::~FFTProcessor() = default;
 
 FFTProcessor::FFTProcessor(FFTProcessor&& other) noexcept
-    : config_{other.config_}, fftw_{std::move(other.fftw_)}, window_{std::move(other.window_)} {}
+    : config_{other.config_}, fftw_{std::move(other.fftw_)}, window_{other.window_} {}
 
 FFTProcessor& FFTProcessor::operator=(FFTProcessor&& other) noexcept {
     if (this != &other) {
         config_ = other.config_;
         fftw_ = std::move(other.fftw_);
-        window_ = std::move(other.window_);
+        window_ = other.window_;
     }
     return *this;
 }
@@ -56,129 +198,152 @@ FFTProcessor& FFTProcessor::operator=(FFTProcessor&& other) noexcept {
 void FFTProcessor::allocate_buffers() {
     release();
 
-    const auto n = static_cast<int>(config_.fft_size);
-    const auto out_size = config_.fft_size / 2 + 1;
-
     fftw_ = std::make_unique<FFTWData>();
 
-    // Allocate FFTW-aligned buffers for SIMD optimization
-    fftw_->input = fftwf_alloc_real(static_cast<size_t>(n));
-    fftw_->output = fftwf_alloc_complex(out_size);
-
-    if (fftw_->input == nullptr || fftw_->output == nullptr) {
+    // One block per channel, at least cache-line aligned: FFTW only needs its
+    // SIMD alignment to match the planning buffers', which any multiple of it
+    // does. The policy zeroes (and so touches) every page now unless it asks
+    // for first touch, in which case the analysis thread places them.
+    try {
+        fftw_->input_storage = AlignedBuffer{
+            config_.fft_size * config_.channels * sizeof(float), config_.buffers};
+        fftw_->output_storage = AlignedBuffer{
+            bin_count() * config_.channels * sizeof(fftwf_complex), config_.buffers};
+    } catch (const std::bad_alloc&) {
         throw std::runtime_error("Failed to allocate FFTW buffers");
     }
+    fftw_->input = fftw_->input_storage.as<float>();
+    fftw_->output = fftw_->output_storage.as<fftwf_complex>();
 
-    // Create plan (FFTW_MEASURE is slower to plan but faster to execute)
-    // Use FFTW_ESTIMATE for faster startup at cost of slightly slower FFT
-    fftw_->plan = fftwf_plan_dft_r2c_1d(n, fftw_->input, fftw_->output, FFTW_ESTIMATE);
-
-    if (fftw_->plan == nullptr) {
-        throw std::runtime_error("Failed to create FFTW plan");
-    }
-
-    window_.resize(config_.fft_size);
+    // Shared plan from the process-wide cache; measured rigors are slow to plan
+    // the first time but are then reused across instances and (via wisdom) runs
+    fftw_->plan =
+        PlanCache::instance().acquire(config_.fft_size, config_.planner, config_.channels);
 }
 
-void FFTProcessor::compute_window() {
-    const auto n = config_.fft_size;
-    constexpr auto pi = std::numbers::pi_v<float>;
-
-    switch (config_.window) {
-        case WindowFunction::Rectangular:
-            std::fill(window_.begin(), window_.end(), 1.0f);
-            break;
+void FFTProcessor::release() {
+    fftw_.reset();
+}
 
-        case WindowFunction::Hann:
-            for (std::size_t i = 0; i < n; ++i) {
-                const auto x = static_cast<float>(i) / static_cast<float>(n - 1);
-                window_[i] = 0.5f * (1.0f - std::cos(2.0f * pi * x));
-            }
-            break;
+std::size_t FFTProcessor::compute(std::span<const float> samples, std::span<float> output) {
+    return compute(samples, {}, output);
+}
 
-        case WindowFunction::Hamming:
-            for (std::size_t i = 0; i < n; ++i) {
-                const auto x = static_cast<float>(i) / static_cast<float>(n - 1);
-                window_[i] = 0.54f - 0.46f * std::cos(2.0f * pi * x);
-            }
-            break;
+std::size_t FFTProcessor::compute(std::span<const float> head, std::span<const float> tail,
+                                  std::span<float> output) {
+    assert(config_.channels == 1);
+    const SegmentedInput input{.head = head, .tail = tail};
+    return compute_batch({&input, 1}, output);
+}
 
-        case WindowFunction::Blackman:
-            for (std::size_t i = 0; i < n; ++i) {
-                const auto x = static_cast<float>(i) / static_cast<float>(n - 1);
-                window_[i] =
-                    0.42f - 0.5f * std::cos(2.0f * pi * x) + 0.08f * std::cos(4.0f * pi * x);
-            }
-            break;
+std::size_t FFTProcessor::compute_batch(std::span<const SegmentedInput> inputs,
+                                        std::span<float> output) {
+    const auto num_bins = bin_count();
+    assert(output.size() >= num_bins * inputs.size());
+    transform_batch(inputs);
+    AUDIOVIS_TRACE_SCOPE(Magnitude);
+
+    // Power spectrum straight into the output; the dB/magnitude stage then
+    // runs in place. Working from re^2 + im^2 avoids a sqrt in dB mode.
+    // Output blocks are contiguous, so every stage covers all channels at once.
+    const auto bins = output.first(num_bins * inputs.size());
+    simd::power_spectrum(&fftw_->output[0][0], bins);
+
+    // DC and Nyquist bins don't need 2x scaling (0.5 in magnitude = 0.25 in power)
+    for (std::size_t channel = 0; channel < inputs.size(); ++channel) {
+        bins[channel * num_bins] *= 0.25f;
+        bins[channel * num_bins + num_bins - 1] *= 0.25f;
+    }
 
-        case WindowFunction::FlatTop:
-            for (std::size_t i = 0; i < n; ++i) {
-                const auto x = static_cast<float>(i) / static_cast<float>(n - 1);
-                window_[i] = 0.21557895f - 0.41663158f * std::cos(2.0f * pi * x) +
-                             0.277263158f * std::cos(4.0f * pi * x) -
-                             0.083578947f * std::cos(6.0f * pi * x) +
-                             0.006947368f * std::cos(8.0f * pi * x);
-            }
-            break;
+    if (config_.use_magnitude_db) {
+        // Convert to decibels, normalized to 0.0 - 1.0 range
+        simd::power_to_normalized_db(bins, bins.data(), power_scale(), config_.db_floor,
+                                     config_.db_ceiling);
+    } else {
+        simd::power_to_magnitude(bins, bins.data(), power_scale());
     }
-}
 
-void FFTProcessor::release() {
-    fftw_.reset();
+    return bins.size();
 }
 
-std::size_t FFTProcessor::compute(std::span<const float> samples, std::span<float> output) {
+void FFTProcessor::transform_batch(std::span<const SegmentedInput> inputs) {
     assert(fftw_ && fftw_->plan);
-    assert(output.size() >= bin_count());
-
+    assert(inputs.size() == config_.channels);
     const auto n = config_.fft_size;
-
-    // Copy samples to input buffer with windowing
-    // Zero-pad if fewer samples than FFT size
-    const auto copy_count = std::min(samples.size(), n);
-    const auto offset = n - copy_count;  // Right-align samples
-
-    // Zero the beginning if zero-padding needed
-    for (std::size_t i = 0; i < offset; ++i) {
-        fftw_->input[i] = 0.0f;
+    AUDIOVIS_TRACE_SCOPE(FftCompute);
+
+    for (std::size_t channel = 0; channel < inputs.size(); ++channel) {
+        AUDIOVIS_TRACE_SCOPE(Window);
+        auto head = inputs[channel].head;
+        auto tail = inputs[channel].tail;
+        float* const block = fftw_->input + channel * n;
+
+        // Copy samples to input buffer with windowing
+        // Zero-pad if fewer samples than FFT size
+        const auto total = head.size() + tail.size();
+        const auto copy_count = std::min(total, n);
+        const auto offset = n - copy_count;  // Right-align samples
+
+        // Zero the beginning if zero-padding needed
+        std::fill_n(block, offset, 0.0f);
+
+        // Only the newest copy_count samples are used; drop the rest from the front
+        const auto skip = total - copy_count;
+        const auto head_skip = std::min(skip, head.size());
+        head = head.subspan(head_skip);
+        tail = tail.subspan(skip - head_skip);
+
+        // Copy and apply window, one contiguous segment at a time
+        auto* dst = block + offset;
+        const float* win = window_->coefficients().data() + offset;
+        for (const auto segment : {head, tail}) {
+            simd::apply_window(segment, win, dst);
+            dst += segment.size();
+            win += segment.size();
+        }
     }
 
-    // Copy and apply window
-    for (std::size_t i = 0; i < copy_count; ++i) {
-        fftw_->input[offset + i] = samples[samples.size() - copy_count + i] * window_[offset + i];
-    }
+    // Execute all channels in one batched FFT (new-array execute: the plan is
+    // shared between instances)
+    AUDIOVIS_TRACE_SCOPE(FftExecute);
+    fftwf_execute_dft_r2c(fftw_->plan, fftw_->input, fftw_->output);
+}
 
-    // Execute FFT
-    fftwf_execute(fftw_->plan);
+std::span<const float> FFTProcessor::spectrum(std::size_t channel) const noexcept {
+    assert(channel < config_.channels);
+    return {&fftw_->output[channel * bin_count()][0], 2 * bin_count()};
+}
 
-    // Compute magnitudes
+void FFTProcessor::convert_bins(std::size_t channel, std::size_t first_bin,
+                                std::span<float> out) const noexcept {
     const auto num_bins = bin_count();
-    const auto scale = 2.0f / static_cast<float>(n);  // Normalize
-
-    for (std::size_t i = 0; i < num_bins; ++i) {
-        const float re = fftw_->output[i][0];
-        const float im = fftw_->output[i][1];
-        float magnitude = std::sqrt(re * re + im * im) * scale;
-
-        // DC and Nyquist bins don't need 2x scaling
-        if (i == 0 || i == num_bins - 1) {
-            magnitude *= 0.5f;
-        }
+    assert(first_bin + out.size() <= num_bins);
+    if (out.empty()) {
+        return;
+    }
+    simd::power_spectrum(spectrum(channel).data() + 2 * first_bin, out);
 
-        if (config_.use_magnitude_db) {
-            // Convert to decibels
-            constexpr float epsilon = 1e-10f;  // Avoid log(0)
-            float db = 20.0f * std::log10(magnitude + epsilon);
-            db = std::clamp(db, config_.db_floor, config_.db_ceiling);
+    // As in compute_batch(): DC and Nyquist carry no 2x
+    if (first_bin == 0) {
+        out.front() *= 0.25f;
+    }
+    if (first_bin + out.size() == num_bins) {
+        out.back() *= 0.25f;
+    }
 
-            // Normalize to 0.0 - 1.0 range
-            output[i] = (db - config_.db_floor) / (config_.db_ceiling - config_.db_floor);
-        } else {
-            output[i] = magnitude;
-        }
+    if (config_.use_magnitude_db) {
+        simd::power_to_normalized_db(out, out.data(), power_scale(), config_.db_floor,
+                                     config_.db_ceiling);
+    } else {
+        simd::power_to_magnitude(out, out.data(), power_scale());
     }
+}
 
-    return num_bins;
+float FFTProcessor::power_scale() const noexcept {
+    // Normalize: magnitude = sqrt(power) * 2 / (n * coherent gain), so power
+    // scales by the square; a full-scale sinusoid reads 1 through any window
+    const auto scale = 2.0f / (static_cast<float>(config_.fft_size) * window_->coherent_gain());
+    return scale * scale;
 }
 
 std::size_t FFTProcessor::frequency_to_bin(float frequency, float sample_rate) const noexcept {
@@ -188,13 +353,21 @@ std::size_t FFTProcessor::frequency_to_bin(float frequency, float sample_rate) c
 }
 
 void FFTProcessor::set_config(const FFTConfig& config) {
-    const bool size_changed = config.fft_size != config_.fft_size;
+    if (config.channels == 0) {
+        throw std::invalid_argument("FFT channel count must be at least one");
+    }
+
+    const bool plan_changed = config.fft_size != config_.fft_size ||
+                              config.planner != config_.planner ||
+                              config.channels != config_.channels ||
+                              config.buffers != config_.buffers;
+    const auto& window = window_table(config.window, config.fft_size);
     config_ = config;
+    window_ = &window;
 
-    if (size_changed) {
+    if (plan_changed) {
         allocate_buffers();
     }
-    compute_window();
 }
 
 std::vector<std::pair<std::size_t, std::size_t>> compute_log_bands(std::size_t bin_count,
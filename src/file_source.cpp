@@ -0,0 +1,193 @@
+#include "audiovis/file_source.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace audiovis {
+
+namespace {
+
+// WAV format tags
+constexpr std::uint16_t kFormatPcm = 1;
+constexpr std::uint16_t kFormatFloat = 3;
+constexpr std::uint16_t kFormatExtensible = 0xFFFE;
+
+/// Reads an unsigned little-endian integer of `N` bytes, independent of host order.
+template <std::size_t N>
+std::uint32_t read_le(std::span<const std::byte> bytes, std::size_t offset) noexcept {
+    std::uint32_t value = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+        value |= std::to_integer<std::uint32_t>(bytes[offset + i]) << (8 * i);
+    }
+    return value;
+}
+
+bool has_tag(std::span<const std::byte> bytes, std::size_t offset, const char* tag) noexcept {
+    return offset + 4 <= bytes.size() && std::memcmp(bytes.data() + offset, tag, 4) == 0;
+}
+
+}  // namespace
+
+FileSource::FileSource(const FileSourceConfig& config)
+    : FileSource{config, MappedFile{config.path}} {}
+
+FileSource::FileSource(const FileSourceConfig& config, MappedFile&& file)
+    : FileSource{config, std::move(file), parse(config, file)} {}
+
+FileSource::FileSource(const FileSourceConfig& config, MappedFile&& file, const Layout& layout)
+    : OfflineSource{layout.sample_rate, layout.channels,
+                    static_cast<std::size_t>(config.ring_buffer_seconds *
+                                             static_cast<float>(layout.sample_rate)),
+                    config.block_frames},
+      file_{std::move(file)},
+      path_{config.path},
+      encoding_{layout.encoding},
+      data_{layout.data},  // Moving the mapping does not move the pages
+      bytes_per_sample_{layout.encoding == Encoding::Int16   ? 2u
+                        : layout.encoding == Encoding::Int24 ? 3u
+                                                             : 4u},
+      total_samples_{data_.size() / bytes_per_sample_ / layout.channels * layout.channels} {
+    file_.advise_sequential();
+}
+
+FileSource::~FileSource() {
+    stop();
+}
+
+FileSource::Layout FileSource::parse(const FileSourceConfig& config, const MappedFile& file) {
+    const auto bytes = file.bytes();
+    const bool riff = has_tag(bytes, 0, "RIFF") && has_tag(bytes, 8, "WAVE");
+
+    switch (config.format) {
+        case FileFormat::Wav:
+            return parse_wav(bytes);
+        case FileFormat::Auto:
+            if (riff) {
+                return parse_wav(bytes);
+            }
+            break;
+        case FileFormat::RawFloat32:
+            break;
+    }
+
+    if (config.channels == 0 || config.sample_rate == 0) {
+        throw std::invalid_argument("Raw audio needs a positive sample rate and channel count");
+    }
+    return Layout{.sample_rate = config.sample_rate,
+                  .channels = config.channels,
+                  .encoding = Encoding::Float32,
+                  .data = bytes};
+}
+
+FileSource::Layout FileSource::parse_wav(std::span<const std::byte> bytes) {
+    if (!has_tag(bytes, 0, "RIFF") || !has_tag(bytes, 8, "WAVE")) {
+        throw std::runtime_error("Not a RIFF/WAVE file");
+    }
+
+    bool have_format = false;
+    std::uint16_t format = 0;
+    std::uint16_t bits = 0;
+    Layout layout{};
+
+    // Walk the chunk list: 4-byte id, 4-byte size, payload padded to even length
+    std::size_t offset = 12;
+    while (offset + 8 <= bytes.size()) {
+        const auto chunk_size = static_cast<std::size_t>(read_le<4>(bytes, offset + 4));
+        const auto payload = offset + 8;
+        const auto available = std::min(chunk_size, bytes.size() - payload);
+
+        if (has_tag(bytes, offset, "fmt ")) {
+            if (available < 16) {
+                throw std::runtime_error("Truncated WAV format chunk");
+            }
+            format = static_cast<std::uint16_t>(read_le<2>(bytes, payload));
+            layout.channels = read_le<2>(bytes, payload + 2);
+            layout.sample_rate = read_le<4>(bytes, payload + 4);
+            bits = static_cast<std::uint16_t>(read_le<2>(bytes, payload + 14));
+            if (format == kFormatExtensible && available >= 26) {
+                // The real tag opens the sub-format GUID
+                format = static_cast<std::uint16_t>(read_le<2>(bytes, payload + 24));
+            }
+            have_format = true;
+        } else if (has_tag(bytes, offset, "data")) {
+            if (!have_format) {
+                throw std::runtime_error("WAV data chunk precedes format chunk");
+            }
+            // Streaming writers leave the size at 0 or 0xFFFFFFFF; read to EOF
+            layout.data = bytes.subspan(payload, chunk_size == 0 ? bytes.size() - payload
+                                                                 : available);
+            break;
+        }
+
+        offset = payload + chunk_size + (chunk_size & 1);
+    }
+
+    if (!have_format || layout.data.data() == nullptr) {
+        throw std::runtime_error("WAV file has no format or data chunk");
+    }
+    if (layout.channels == 0 || layout.sample_rate == 0) {
+        throw std::runtime_error("WAV file has no channels or sample rate");
+    }
+
+    if (format == kFormatPcm && bits == 16) {
+        layout.encoding = Encoding::Int16;
+    } else if (format == kFormatPcm && bits == 24) {
+        layout.encoding = Encoding::Int24;
+    } else if (format == kFormatPcm && bits == 32) {
+        layout.encoding = Encoding::Int32;
+    } else if (format == kFormatFloat && bits == 32) {
+        layout.encoding = Encoding::Float32;
+    } else {
+        throw std::runtime_error("Unsupported WAV encoding (format " + std::to_string(format) +
+                                 ", " + std::to_string(bits) + " bits)");
+    }
+    return layout;
+}
+
+std::size_t FileSource::render(std::span<float> interleaved) {
+    const auto frames = read_frames(position_ / channels(), interleaved);
+    position_ += frames * channels();
+    return frames;
+}
+
+std::size_t FileSource::read_frames(std::size_t first_frame,
+                                    std::span<float> interleaved) const noexcept {
+    const std::size_t channels = this->channels();
+    const auto first = std::min(first_frame * channels, total_samples_);
+    const auto count = std::min(interleaved.size() / channels * channels, total_samples_ - first);
+    const auto src = data_.subspan(first * bytes_per_sample_);
+
+    // Sign-extend by parking the sample in the top bits of an int32
+    switch (encoding_) {
+        case Encoding::Int16:
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto raw = static_cast<std::int32_t>(read_le<2>(src, 2 * i) << 16);
+                interleaved[i] = static_cast<float>(raw) * (1.0f / 2147483648.0f);
+            }
+            break;
+        case Encoding::Int24:
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto raw = static_cast<std::int32_t>(read_le<3>(src, 3 * i) << 8);
+                interleaved[i] = static_cast<float>(raw) * (1.0f / 2147483648.0f);
+            }
+            break;
+        case Encoding::Int32:
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto raw = static_cast<std::int32_t>(read_le<4>(src, 4 * i));
+                interleaved[i] = static_cast<float>(raw) * (1.0f / 2147483648.0f);
+            }
+            break;
+        case Encoding::Float32:
+            for (std::size_t i = 0; i < count; ++i) {
+                interleaved[i] = std::bit_cast<float>(read_le<4>(src, 4 * i));
+            }
+            break;
+    }
+
+    return count / channels;
+}
+
+}  // namespace audiovis
@@ -0,0 +1,115 @@
+#include "audiovis/frame_pacer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+
+namespace audiovis {
+
+namespace {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+constexpr double kBackoffStep = 0.75;     // Rate multiplier per backoff step
+constexpr double kHeadroom = 0.5;         // Share of the faster period a light frame may use
+
+FramePacer::Clock::duration period_for(double fps) noexcept {
+    return duration_cast<FramePacer::Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+}
+
+}  // namespace
+
+std::string to_json(const FrameTelemetry& telemetry) {
+    const auto p = [](const LatencyHistogram& histogram, double q) {
+        return static_cast<long long>(histogram.percentile(q).count());
+    };
+
+    std::array<char, 384> text{};
+    std::snprintf(text.data(), text.size(),
+                  "{\"fps\":%.2f,\"frames\":%llu,\"dropped\":%llu,"
+                  "\"analysis_us\":{\"p50\":%lld,\"p99\":%lld},"
+                  "\"render_us\":{\"p50\":%lld,\"p99\":%lld},"
+                  "\"jitter_us\":{\"p50\":%lld,\"p99\":%lld,\"max\":%llu}}",
+                  telemetry.fps, static_cast<unsigned long long>(telemetry.frames),
+                  static_cast<unsigned long long>(telemetry.dropped),
+                  p(telemetry.analysis, 0.5), p(telemetry.analysis, 0.99),
+                  p(telemetry.render, 0.5), p(telemetry.render, 0.99),
+                  p(telemetry.jitter, 0.5), p(telemetry.jitter, 0.99),
+                  static_cast<unsigned long long>(telemetry.jitter.max_us));
+    return text.data();
+}
+
+FramePacer::FramePacer(const PacerConfig& config, Clock::time_point start)
+    : config_{config}, fps_{config.target_fps} {
+    if (!(config_.min_fps > 0.0) || !(config_.min_fps <= config_.target_fps)) {
+        throw std::invalid_argument("Frame pacer needs 0 < min_fps <= target_fps");
+    }
+    if (!(config_.budget_fraction > 0.0) || config_.budget_fraction > 1.0) {
+        throw std::invalid_argument("Frame pacer budget fraction must be in (0, 1]");
+    }
+    set_fps(fps_);
+    deadline_ = start + period_;
+}
+
+void FramePacer::wait() const {
+    std::this_thread::sleep_until(deadline_);
+}
+
+void FramePacer::set_fps(double fps) noexcept {
+    fps_ = fps;
+    period_ = period_for(fps);
+    window_.fps = fps;
+}
+
+void FramePacer::begin_frame(Clock::time_point now) noexcept {
+    window_.jitter.record(duration_cast<microseconds>(now - deadline_));
+}
+
+void FramePacer::end_frame(Clock::time_point now, Clock::duration analysis,
+                           Clock::duration render) noexcept {
+    window_.analysis.record(duration_cast<microseconds>(analysis));
+    window_.render.record(duration_cast<microseconds>(render));
+    ++window_.frames;
+    ++total_frames_;
+
+    // Adapt the rate to how much of the budget frames actually need
+    const auto work = std::chrono::duration<double>(analysis + render).count();
+    const auto period = std::chrono::duration<double>(period_).count();
+    if (work > config_.budget_fraction * period) {
+        light_ = 0;
+        if (++overruns_ >= config_.backoff_frames && fps_ > config_.min_fps) {
+            set_fps(std::max(config_.min_fps, fps_ * kBackoffStep));
+            overruns_ = 0;
+        }
+    } else {
+        overruns_ = 0;
+        const double faster = std::min(config_.target_fps, fps_ / kBackoffStep);
+        if (fps_ < config_.target_fps && work < kHeadroom / faster) {
+            if (++light_ >= config_.recover_frames) {
+                set_fps(faster);
+                light_ = 0;
+            }
+        } else {
+            light_ = 0;
+        }
+    }
+
+    // Next absolute deadline; skip any this frame has already run past
+    deadline_ += period_;
+    if (now >= deadline_) {
+        const auto missed = static_cast<std::uint64_t>((now - deadline_) / period_) + 1;
+        deadline_ += period_ * static_cast<Clock::rep>(missed);
+        window_.dropped += missed;
+        total_dropped_ += missed;
+    }
+}
+
+void FramePacer::reset_window() noexcept {
+    window_ = FrameTelemetry{};
+    window_.fps = fps_;
+}
+
+}  // namespace audiovis
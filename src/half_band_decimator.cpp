@@ -0,0 +1,79 @@
+#include "audiovis/half_band_decimator.hpp"
+
+#include <cmath>
+#include <numbers>
+
+namespace audiovis {
+
+namespace {
+
+constexpr double kKaiserBeta = 7.86;    // About 80 dB sidelobes
+
+/// Zeroth-order modified Bessel function of the first kind, by its series.
+double bessel_i0(double x) noexcept {
+    double sum = 1.0;
+    double term = 1.0;
+    const double quarter_x2 = 0.25 * x * x;
+    for (int k = 1; k < 64 && term > 1e-12 * sum; ++k) {
+        term *= quarter_x2 / static_cast<double>(k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+}  // namespace
+
+HalfBandDecimator::HalfBandDecimator() {
+    // Windowed sinc with cutoff at a quarter of the input rate; only odd
+    // offsets from the centre survive, and they are scaled to sum to 1/2 so
+    // the DC gain is exactly one
+    constexpr auto half_length = static_cast<double>(delay());
+    double sum = 0.0;
+    for (std::size_t j = 0; j < kSideTaps; ++j) {
+        const auto offset = static_cast<double>(2 * j + 1);
+        const double x = std::numbers::pi * offset / 2.0;
+        const double ratio = offset / half_length;
+        const double window =
+            bessel_i0(kKaiserBeta * std::sqrt(1.0 - ratio * ratio)) / bessel_i0(kKaiserBeta);
+        const double tap = 0.5 * std::sin(x) / x * window;
+        side_[j] = static_cast<float>(tap);
+        sum += 2.0 * tap;
+    }
+    for (float& tap : side_) {
+        tap = static_cast<float>(static_cast<double>(tap) * 0.5 / sum);
+    }
+}
+
+std::size_t HalfBandDecimator::process(std::span<const float> input,
+                                       std::span<float> output) noexcept {
+    constexpr std::size_t centre = delay();
+    std::size_t written = 0;
+
+    for (const float sample : input) {
+        history_[position_] = sample;
+        history_[position_ + kTaps] = sample;
+        position_ = position_ + 1 == kTaps ? 0 : position_ + 1;
+
+        odd_ = !odd_;
+        if (odd_) {
+            continue;  // Outputs fall on every second input only
+        }
+
+        // The oldest of the last kTaps samples sits at position_
+        const float* window = history_.data() + position_;
+        float acc = 0.5f * window[centre];
+        for (std::size_t j = 0; j < kSideTaps; ++j) {
+            acc += side_[j] * (window[centre - 2 * j - 1] + window[centre + 2 * j + 1]);
+        }
+        output[written++] = acc;
+    }
+    return written;
+}
+
+void HalfBandDecimator::reset() noexcept {
+    history_.fill(0.0f);
+    position_ = 0;
+    odd_ = false;
+}
+
+}  // namespace audiovis
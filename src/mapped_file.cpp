@@ -0,0 +1,82 @@
+#include "audiovis/mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace audiovis {
+
+namespace {
+
+std::runtime_error mapping_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw mapping_error("Failed to open", path);
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        const auto error = mapping_error("Failed to stat", path);
+        ::close(fd);
+        throw error;
+    }
+
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ > 0) {
+        void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            const auto error = mapping_error("Failed to map", path);
+            ::close(fd);
+            throw error;
+        }
+        data_ = static_cast<const std::byte*>(mapping);
+    }
+
+    // The mapping keeps the file referenced; the descriptor is no longer needed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(other.size_, 0)} {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+void MappedFile::advise_sequential() const noexcept {
+    if (data_ != nullptr) {
+        // Purely advisory; failure changes nothing
+        ::madvise(const_cast<std::byte*>(data_), size_, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::release() noexcept {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<std::byte*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+}  // namespace audiovis
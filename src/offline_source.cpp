@@ -0,0 +1,76 @@
+#include "audiovis/offline_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace audiovis {
+
+OfflineSource::OfflineSource(std::uint32_t sample_rate, std::uint32_t channels,
+                             std::size_t ring_capacity, std::size_t block_frames)
+    : AudioSource{sample_rate, channels, ring_capacity}, block_frames_{block_frames} {
+    if (block_frames_ == 0) {
+        throw std::invalid_argument("Offline source block size must be positive");
+    }
+    scratch_.resize(block_frames_ * channels);
+}
+
+OfflineSource::~OfflineSource() {
+    stop();
+}
+
+void OfflineSource::start() {
+    if (producer_.joinable()) {
+        return;  // Already running
+    }
+    running_.store(true, std::memory_order_release);
+    producer_ = std::jthread{[this](const std::stop_token& stop) { producer_loop(stop); }};
+}
+
+void OfflineSource::stop() {
+    if (producer_.joinable()) {
+        producer_.request_stop();
+        producer_.join();
+    }
+    running_.store(false, std::memory_order_release);
+}
+
+void OfflineSource::producer_loop(const std::stop_token& stop) {
+    while (!stop.stop_requested() && !at_end()) {
+        if (produce(block_frames_) == 0 && !at_end()) {
+            // Rings full: give the consumer a moment instead of spinning
+            std::this_thread::sleep_for(std::chrono::microseconds{200});
+        }
+    }
+    running_.store(false, std::memory_order_release);
+}
+
+std::size_t OfflineSource::produce(std::size_t max_frames) {
+    const std::size_t channels = this->channels();
+    std::size_t produced = 0;
+
+    while (produced < max_frames && !at_end()) {
+        const auto frames = std::min({block_frames_, max_frames - produced, writable_frames()});
+        if (frames == 0) {
+            break;  // Backpressure: wait for the consumer
+        }
+
+        const auto rendered = render(std::span<float>{scratch_}.first(frames * channels));
+        if (rendered == 0) {
+            finished_.store(true, std::memory_order_release);
+            break;
+        }
+
+        // Cannot overflow: space was checked above and only we write
+        push_interleaved(std::span<const float>{scratch_}.first(rendered * channels));
+        produced += rendered;
+
+        totals_.frames_captured += rendered;
+        ++totals_.callback_count;
+        stats_.store(totals_);
+    }
+
+    return produced;
+}
+
+}  // namespace audiovis
@@ -0,0 +1,393 @@
+#include "audiovis/recorder.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace audiovis {
+
+namespace {
+
+constexpr std::size_t kPageSize = 4096;       // Alignment O_DIRECT needs for offsets and sizes
+
+// WAV header padded to one page, all fields little-endian
+constexpr std::size_t kHeaderSize = kPageSize;
+constexpr std::size_t kJunkOffset = 36;       // After RIFF/WAVE and a 16-byte fmt chunk
+constexpr std::size_t kDataOffset = kHeaderSize - 8;
+constexpr std::uint16_t kFormatFloat = 3;     // WAVE_FORMAT_IEEE_FLOAT
+constexpr std::uint64_t kMaxDataBytes = 0xFFFFFFFFu - kHeaderSize;  // RIFF sizes are 32-bit
+
+template <std::size_t N>
+void put_le(std::byte* out, std::uint64_t value) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        out[i] = static_cast<std::byte>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void put_tag(std::byte* out, const char (&tag)[5]) noexcept {
+    std::memcpy(out, tag, 4);
+}
+
+std::size_t round_up(std::size_t value, std::size_t unit) noexcept {
+    return (value + unit - 1) / unit * unit;
+}
+
+std::runtime_error file_error(const std::string& what, const std::string& path, int error) {
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(error));
+}
+
+}  // namespace
+
+Recorder::Recorder(const BroadcastRing<float>& ring, std::uint32_t sample_rate,
+                   const RecorderConfig& config)
+    : config_{config},
+      sample_rate_{sample_rate},
+      channels_{ring.stride()},
+      frame_bytes_{sizeof(float) * ring.stride()},
+      block_bytes_{0},
+      frames_per_file_{0},
+      ring_frames_{ring.capacity()},
+      free_{std::max<std::size_t>(config.blocks, 1)},
+      full_{std::max<std::size_t>(config.blocks, 1)},
+      reader_{ring} {
+    if (sample_rate_ == 0) {
+        throw std::invalid_argument("Recorder sample rate must be positive");
+    }
+    if (config_.blocks < 2 || config_.block_bytes == 0) {
+        throw std::invalid_argument("Recorder needs at least two non-empty blocks");
+    }
+    if (!(config_.max_file_seconds >= 0.0)) {
+        throw std::invalid_argument("Recorder max_file_seconds must not be negative");
+    }
+    if (config_.path_prefix.empty()) {
+        throw std::invalid_argument("Recorder path prefix must not be empty");
+    }
+
+    // Whole pages for O_DIRECT, whole frames so none straddles two blocks
+    block_bytes_ = round_up(config_.block_bytes, std::lcm(kPageSize, frame_bytes_));
+
+    const auto max_bytes = config_.max_file_bytes == 0
+                               ? kMaxDataBytes
+                               : std::min<std::uint64_t>(config_.max_file_bytes, kMaxDataBytes);
+    frames_per_file_ = max_bytes / frame_bytes_;
+    if (config_.max_file_seconds > 0.0) {
+        // Compared as doubles first: a huge or infinite duration does not convert
+        const double frames = std::floor(config_.max_file_seconds * sample_rate_);
+        if (frames < static_cast<double>(frames_per_file_)) {
+            frames_per_file_ = static_cast<std::uint64_t>(std::max(frames, 1.0));
+        }
+    }
+    if (frames_per_file_ == 0) {
+        throw std::invalid_argument("Recorder max_file_bytes is smaller than one frame");
+    }
+
+    auto policy = config_.buffers;
+    policy.alignment = std::max(policy.alignment, kPageSize);
+    blocks_.reserve(config_.blocks);
+    for (std::size_t i = 0; i < config_.blocks; ++i) {
+        blocks_.emplace_back(block_bytes_, policy);
+        free_.try_push(static_cast<std::uint32_t>(i));
+    }
+    info_.resize(config_.blocks);
+    header_ = AlignedBuffer{kHeaderSize, {.alignment = kPageSize}};
+
+    // Fail here rather than on the writer thread if the path is unusable
+    if (const int error = open_file(); error != 0) {
+        const auto path = file_path(config_.path_prefix, 1);
+        if (fd_ >= 0) {
+            // Created, but the header could not be written
+            ::close(fd_);
+            ::unlink(path.c_str());
+        }
+        throw file_error("Failed to create", path, error);
+    }
+
+    writer_ = std::jthread{[this] { write_loop(); }};
+    drain_ = std::jthread{[this](const std::stop_token& stop) { drain_loop(stop); }};
+}
+
+Recorder::~Recorder() {
+    try {
+        close();
+    } catch (...) {
+        // Destructor cannot report it; close() explicitly to observe errors
+    }
+}
+
+void Recorder::close() {
+    if (drain_.joinable()) {
+        drain_.request_stop();
+        drain_.join();
+    }
+    if (writer_.joinable()) {
+        writer_.join();  // Returns after the drain's last block
+    }
+    check_failed();
+}
+
+double Recorder::buffered_seconds() const noexcept {
+    const auto frames = blocks_.size() * (block_bytes_ / frame_bytes_) + ring_frames_;
+    return static_cast<double>(frames) / sample_rate_;
+}
+
+std::string Recorder::file_path(const std::string& prefix, std::uint64_t index) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%04llu.wav", static_cast<unsigned long long>(index));
+    return prefix + suffix;
+}
+
+// -----------------------------------------------------------------------------
+// Drain thread
+// -----------------------------------------------------------------------------
+
+void Recorder::drain_loop(const std::stop_token& stop) {
+    while (!stop.stop_requested()) {
+        if (drain(std::numeric_limits<std::size_t>::max()) == 0) {
+            std::this_thread::sleep_for(config_.poll_interval);
+        }
+    }
+
+    // What the producer had written by close(); from here on the writer is
+    // waited for, since nothing else is left to protect
+    for (auto remaining = reader_.lag(); remaining > 0;) {
+        const auto frames = drain(remaining);
+        if (frames == 0 && reader_.lag() == 0) {
+            break;
+        }
+        if (frames == 0) {
+            std::this_thread::sleep_for(config_.poll_interval);
+        }
+        remaining -= std::min(frames, remaining);
+    }
+    while (!has_block_) {
+        if (free_.try_pop(current_)) {
+            has_block_ = true;
+            fill_ = 0;
+        } else {
+            std::this_thread::sleep_for(config_.poll_interval);
+        }
+    }
+    queue_block(false, true);
+}
+
+std::size_t Recorder::drain(std::size_t max_frames) noexcept {
+    std::size_t total = 0;
+    while (total < max_frames) {
+        if (!has_block_) {
+            if (!free_.try_pop(current_)) {
+                // Every block is in flight: the broadcast ring holds the rest
+                if (reader_.lag() > 0) {
+                    block_waits_.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            }
+            has_block_ = true;
+            fill_ = 0;
+        }
+
+        // Frames are read straight into the block, never past the file limit
+        const auto want = std::min({(block_bytes_ - fill_) / frame_bytes_,
+                                    frames_per_file_ - file_frames_,
+                                    max_frames - total});
+        float* out = blocks_[current_].as<float>() + fill_ / sizeof(float);
+        const auto frames = reader_.read({out, want * channels_});
+        fill_ += frames * frame_bytes_;
+        file_frames_ += frames;
+        total += frames;
+
+        const bool ends_file = file_frames_ == frames_per_file_;
+        if (fill_ == block_bytes_ || ends_file) {
+            queue_block(ends_file, false);
+        }
+        if (frames < want) {
+            break;
+        }
+    }
+    return total;
+}
+
+void Recorder::queue_block(bool ends_file, bool last) noexcept {
+    info_[current_] = {.bytes = fill_, .ends_file = ends_file, .last = last};
+    // The queue holds every block, so this cannot fail
+    full_.try_push(current_);
+    has_block_ = false;
+    if (ends_file) {
+        file_frames_ = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Writer thread
+// -----------------------------------------------------------------------------
+
+void Recorder::write_loop() noexcept {
+    for (;;) {
+        std::uint32_t index = 0;
+        if (!full_.try_pop(index)) {
+            std::this_thread::sleep_for(config_.poll_interval);
+            continue;
+        }
+        const bool last = info_[index].last;
+        write_block(index);
+        free_.try_push(index);
+        if (last) {
+            return;
+        }
+    }
+}
+
+void Recorder::write_block(std::uint32_t index) noexcept {
+    const auto& info = info_[index];
+    if (info.bytes > 0 && !failed()) {
+        if (fd_ < 0) {
+            if (const int error = open_file(); error != 0) {
+                fail(error);
+            }
+        }
+        if (fd_ >= 0) {
+            // Only a file's last block is partial; pad it to a page, truncate later
+            assert(!padded_);
+            const auto size = round_up(info.bytes, kPageSize);
+            auto* data = blocks_[index].as<std::byte>();
+            std::memset(data + info.bytes, 0, size - info.bytes);
+
+            const auto start = std::chrono::steady_clock::now();
+            const int error = write_at(data, size, kHeaderSize + data_bytes_);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+            if (elapsed.count() > max_write_us_.load(std::memory_order_relaxed)) {
+                max_write_us_.store(elapsed.count(), std::memory_order_relaxed);
+            }
+
+            if (error != 0) {
+                fail(error);
+            } else {
+                data_bytes_ += info.bytes;
+                padded_ = size != info.bytes;
+                frames_written_.fetch_add(info.bytes / frame_bytes_, std::memory_order_relaxed);
+            }
+        }
+    }
+    if ((info.ends_file || info.last) && fd_ >= 0) {
+        finish_file();  // The next file opens with its first block
+    }
+}
+
+int Recorder::open_file() noexcept {
+    const auto path = file_path(config_.path_prefix, file_index_ + 1);
+    constexpr int kFlags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    int fd = -1;
+    bool direct = false;
+    if (config_.direct_io) {
+        fd = ::open(path.c_str(), kFlags | O_DIRECT, 0644);
+        direct = fd >= 0;
+    }
+    // tmpfs and some network filesystems refuse O_DIRECT outright
+    if (fd < 0) {
+        fd = ::open(path.c_str(), kFlags, 0644);
+    }
+    if (fd < 0) {
+        return errno;
+    }
+
+    fd_ = fd;
+    ++file_index_;
+    files_.store(file_index_, std::memory_order_relaxed);
+    direct_io_.store(direct, std::memory_order_relaxed);
+    data_bytes_ = 0;
+    padded_ = false;
+    return write_header();
+}
+
+void Recorder::finish_file() noexcept {
+    int error = 0;
+    if (padded_ && ::ftruncate(fd_, static_cast<off_t>(kHeaderSize + data_bytes_)) != 0) {
+        error = errno;
+    }
+    if (error == 0) {
+        error = write_header();
+    }
+    if (error == 0 && ::fdatasync(fd_) != 0) {
+        error = errno;
+    }
+    if (::close(fd_) != 0 && error == 0) {
+        error = errno;
+    }
+    if (error != 0) {
+        fail(error);
+    }
+    fd_ = -1;
+    padded_ = false;
+}
+
+int Recorder::write_header() noexcept {
+    auto* out = header_.as<std::byte>();
+    std::memset(out, 0, kHeaderSize);
+    put_tag(out, "RIFF");
+    put_le<4>(out + 4, kHeaderSize - 8 + data_bytes_);
+    put_tag(out + 8, "WAVE");
+    put_tag(out + 12, "fmt ");
+    put_le<4>(out + 16, 16);
+    put_le<2>(out + 20, kFormatFloat);
+    put_le<2>(out + 22, channels_);
+    put_le<4>(out + 24, sample_rate_);
+    put_le<4>(out + 28, std::uint64_t{sample_rate_} * frame_bytes_);
+    put_le<2>(out + 32, frame_bytes_);
+    put_le<2>(out + 34, 32);
+    // Readers skip unknown chunks, so a JUNK chunk pads the samples onto a page
+    put_tag(out + kJunkOffset, "JUNK");
+    put_le<4>(out + kJunkOffset + 4, kDataOffset - kJunkOffset - 8);
+    put_tag(out + kDataOffset, "data");
+    put_le<4>(out + kDataOffset + 4, data_bytes_);
+    return write_at(out, kHeaderSize, 0);
+}
+
+int Recorder::write_at(const void* data, std::size_t size, std::uint64_t offset) noexcept {
+    const auto* bytes = static_cast<const std::byte*>(data);
+    while (size > 0) {
+        const auto written = ::pwrite(fd_, bytes, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Some filesystems accept O_DIRECT at open but not on write
+            if (errno == EINVAL && direct_io_.load(std::memory_order_relaxed)) {
+                const int flags = ::fcntl(fd_, F_GETFL);
+                if (flags >= 0 && ::fcntl(fd_, F_SETFL, flags & ~O_DIRECT) == 0) {
+                    direct_io_.store(false, std::memory_order_relaxed);
+                    continue;
+                }
+            }
+            return errno;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+        offset += static_cast<std::uint64_t>(written);
+    }
+    return 0;
+}
+
+void Recorder::fail(int error) noexcept {
+    if (error_.load(std::memory_order_relaxed) == 0) {
+        error_file_.store(fd_ < 0 ? file_index_ + 1 : file_index_, std::memory_order_relaxed);
+        error_.store(error, std::memory_order_release);
+    }
+}
+
+void Recorder::check_failed() const {
+    if (const int error = error_.load(std::memory_order_acquire); error != 0) {
+        const auto index = error_file_.load(std::memory_order_relaxed);
+        throw file_error("Failed to write", file_path(config_.path_prefix, index), error);
+    }
+}
+
+}  // namespace audiovis
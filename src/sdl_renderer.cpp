@@ -0,0 +1,422 @@
+#include "audiovis/frame_pacer.hpp"
+#include "audiovis/spectrum_analyzer.hpp"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace audiovis {
+
+/// Windowed spectrum visualizer on SDL2's accelerated 2D renderer.
+///
+/// The upper part of the window shows one bar per band with a peak marker;
+/// the lower part is a scrolling spectrogram of the recent past. Both are
+/// built for hundreds of bands at high refresh rates, so no per-bar or
+/// per-pixel calls are made:
+///
+/// - Bars and peak markers are quads in one vertex array whose x positions,
+///   colours and index buffer are fixed per layout. Each frame rewrites only
+///   the vertex heights and top colours, then draws every quad with a single
+///   SDL_RenderGeometry call.
+/// - The spectrogram lives in a streaming texture used as a ring of columns.
+///   Each frame uploads one new column (SDL_UpdateTexture on a 1-pixel-wide
+///   rect) and draws the ring in two copies split at the write cursor, so
+///   the texture is never re-uploaded in full after creation.
+///
+/// Frames present with vsync; if the driver cannot provide it, FramePacer
+/// paces the loop at 60 FPS instead.
+class SdlRenderer {
+public:
+    explicit SdlRenderer(bool fullscreen) {
+        if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+            throw std::runtime_error(std::string{"Failed to initialize SDL: "} + SDL_GetError());
+        }
+
+        Uint32 flags = SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
+        if (fullscreen) {
+            flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
+        }
+        window_ = SDL_CreateWindow("audiovis", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                   1280, 720, flags);
+        if (window_ == nullptr) {
+            const std::string error = SDL_GetError();
+            SDL_Quit();
+            throw std::runtime_error("Failed to create window: " + error);
+        }
+
+        renderer_ = SDL_CreateRenderer(window_, -1,
+                                       SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        if (renderer_ == nullptr) {
+            const std::string error = SDL_GetError();
+            SDL_DestroyWindow(window_);
+            SDL_Quit();
+            throw std::runtime_error("Failed to create renderer: " + error);
+        }
+
+        SDL_RendererInfo info{};
+        SDL_GetRendererInfo(renderer_, &info);
+        vsync_ = (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+
+        build_palette();
+        update_size();
+    }
+
+    ~SdlRenderer() {
+        if (history_ != nullptr) {
+            SDL_DestroyTexture(history_);
+        }
+        SDL_DestroyRenderer(renderer_);
+        SDL_DestroyWindow(window_);
+        SDL_Quit();
+    }
+
+    SdlRenderer(const SdlRenderer&) = delete;
+    SdlRenderer& operator=(const SdlRenderer&) = delete;
+
+    /// Main render loop. Blocks until the window is closed, q or Escape is
+    /// pressed, or SIGINT/SIGTERM arrives (SDL turns those into SDL_QUIT).
+    void run(SpectrumAnalyzer& analyzer) {
+        using Clock = FramePacer::Clock;
+
+        analyzer.start();
+
+        FramePacer pacer;
+        auto window_start = Clock::now();
+        std::uint64_t window_frames = 0;
+
+        while (running_) {
+            if (!vsync_) {
+                pacer.wait();
+                pacer.begin_frame(Clock::now());
+            }
+            const auto frame_start = Clock::now();
+
+            handle_events();
+
+            // New frames only; between analyzer frames the picture stands
+            if (analyzer.update(data_) && data_.band_count() > 0) {
+                if (data_.band_count() != layout_bands_) {
+                    layout(data_.band_count());
+                }
+                update_bars(data_);
+                push_history(data_);
+            }
+            const auto render_start = Clock::now();
+            draw();
+
+            const auto frame_end = Clock::now();
+            if (!vsync_) {
+                pacer.end_frame(frame_end, render_start - frame_start, frame_end - render_start);
+            }
+
+            // Frame rate in the title bar, once a second
+            ++window_frames;
+            if (frame_end - window_start >= std::chrono::seconds(1)) {
+                const std::chrono::duration<double> seconds = frame_end - window_start;
+                std::array<char, 64> title{};
+                std::snprintf(title.data(), title.size(), "audiovis - %zu bands, %.0f fps",
+                              layout_bands_, static_cast<double>(window_frames) / seconds.count());
+                SDL_SetWindowTitle(window_, title.data());
+                window_start = frame_end;
+                window_frames = 0;
+            }
+        }
+
+        analyzer.stop();
+    }
+
+    void stop() { running_ = false; }
+
+private:
+    static constexpr float kBarShare = 0.6f;      // Window height given to the bars
+    static constexpr float kPeakThickness = 2.0f; // Pixels
+    static constexpr int kVerticesPerQuad = 4;
+    static constexpr int kIndicesPerQuad = 6;
+    static constexpr SDL_Color kPeakColor{255, 255, 255, 255};
+
+    void handle_events() {
+        SDL_Event event;
+        while (SDL_PollEvent(&event) != 0) {
+            if (event.type == SDL_QUIT) {
+                running_ = false;
+            } else if (event.type == SDL_KEYDOWN) {
+                const auto key = event.key.keysym.sym;
+                if (key == SDLK_q || key == SDLK_ESCAPE) {
+                    running_ = false;
+                }
+            } else if (event.type == SDL_WINDOWEVENT &&
+                       event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                update_size();
+                if (layout_bands_ > 0) {
+                    layout(layout_bands_);
+                }
+            }
+        }
+    }
+
+    /// Reads the drawable size in pixels (larger than the window on HiDPI).
+    void update_size() {
+        SDL_GetRendererOutputSize(renderer_, &width_, &height_);
+        width_ = std::max(width_, 1);
+        height_ = std::max(height_, 2);
+        bars_height_ = static_cast<float>(height_) * kBarShare;
+    }
+
+    /// Blue through cyan, green and yellow to red, from near-black at zero
+    /// so quiet spectrogram cells recede into the background.
+    void build_palette() {
+        struct Stop {
+            float at;
+            SDL_Color color;
+        };
+        constexpr std::array<Stop, 6> stops{{{0.0f, {0, 0, 24, 255}},
+                                             {0.3f, {0, 64, 255, 255}},
+                                             {0.5f, {0, 224, 255, 255}},
+                                             {0.7f, {0, 255, 64, 255}},
+                                             {0.9f, {255, 224, 0, 255}},
+                                             {1.0f, {255, 32, 0, 255}}}};
+
+        const auto lerp = [](Uint8 a, Uint8 b, float t) {
+            return static_cast<Uint8>(static_cast<float>(a) +
+                                      (static_cast<float>(b) - static_cast<float>(a)) * t + 0.5f);
+        };
+
+        for (std::size_t i = 0; i < palette_.size(); ++i) {
+            const float level = static_cast<float>(i) / static_cast<float>(palette_.size() - 1);
+            std::size_t s = 1;
+            while (s + 1 < stops.size() && level > stops[s].at) {
+                ++s;
+            }
+            const auto& lo = stops[s - 1];
+            const auto& hi = stops[s];
+            const float t = std::clamp((level - lo.at) / (hi.at - lo.at), 0.0f, 1.0f);
+            palette_[i] = {lerp(lo.color.r, hi.color.r, t), lerp(lo.color.g, hi.color.g, t),
+                           lerp(lo.color.b, hi.color.b, t), 255};
+            pixels_[i] = 0xFF000000u | (Uint32{palette_[i].r} << 16) |
+                         (Uint32{palette_[i].g} << 8) | Uint32{palette_[i].b};
+        }
+    }
+
+    [[nodiscard]] std::size_t palette_index(float level) const noexcept {
+        const float scaled =
+            std::clamp(level, 0.0f, 1.0f) * static_cast<float>(palette_.size() - 1);
+        return static_cast<std::size_t>(scaled + 0.5f);
+    }
+
+    /// Fixes bar x positions, vertex colours and indices for a band count and
+    /// window size, and starts a fresh, blank spectrogram texture.
+    void layout(std::size_t bands) {
+        layout_bands_ = bands;
+
+        // Quad q occupies vertices [4q, 4q + 4): top-left, top-right,
+        // bottom-right, bottom-left. Bars come first, then peak markers.
+        const std::size_t quads = 2 * bands;
+        vertices_.assign(quads * kVerticesPerQuad, SDL_Vertex{});
+        indices_.resize(quads * kIndicesPerQuad);
+        for (std::size_t q = 0; q < quads; ++q) {
+            const int v = static_cast<int>(q) * kVerticesPerQuad;
+            int* index = &indices_[q * kIndicesPerQuad];
+            index[0] = v;
+            index[1] = v + 1;
+            index[2] = v + 2;
+            index[3] = v;
+            index[4] = v + 2;
+            index[5] = v + 3;
+        }
+
+        const float slot = static_cast<float>(width_) / static_cast<float>(bands);
+        const float gap = slot >= 3.0f ? 1.0f : 0.0f;
+        for (std::size_t b = 0; b < bands; ++b) {
+            const float x0 = static_cast<float>(b) * slot;
+            const float x1 = x0 + slot - gap;
+            for (const std::size_t q : {b, bands + b}) {
+                SDL_Vertex* quad = &vertices_[q * kVerticesPerQuad];
+                quad[0].position = {x0, bars_height_};
+                quad[1].position = {x1, bars_height_};
+                quad[2].position = {x1, bars_height_};
+                quad[3].position = {x0, bars_height_};
+                const SDL_Color base = q < bands ? palette_[0] : kPeakColor;
+                for (int corner = 0; corner < kVerticesPerQuad; ++corner) {
+                    quad[corner].color = base;
+                }
+            }
+        }
+
+        // One texel per band vertically, one column per frame horizontally
+        if (history_ != nullptr) {
+            SDL_DestroyTexture(history_);
+        }
+        history_columns_ = width_;
+        history_rows_ = static_cast<int>(bands);
+        history_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888,
+                                     SDL_TEXTUREACCESS_STREAMING, history_columns_, history_rows_);
+        if (history_ == nullptr) {
+            throw std::runtime_error(std::string{"Failed to create texture: "} + SDL_GetError());
+        }
+        const std::vector<Uint32> blank(
+            static_cast<std::size_t>(history_columns_) * bands, pixels_[0]);
+        SDL_UpdateTexture(history_, nullptr, blank.data(),
+                          history_columns_ * static_cast<int>(sizeof(Uint32)));
+        column_.assign(bands, pixels_[0]);
+        cursor_ = 0;
+    }
+
+    /// Rewrites bar and peak heights; x positions and indices stay put.
+    void update_bars(const SpectrumData& data) {
+        const auto magnitudes = data.channel_magnitudes(0);
+        const auto peaks = data.channel_peaks(0);
+        const float bottom = bars_height_;
+        const float scale = bars_height_ - kPeakThickness;
+
+        for (std::size_t b = 0; b < layout_bands_; ++b) {
+            const float level = std::clamp(magnitudes[b], 0.0f, 1.0f);
+            SDL_Vertex* bar = &vertices_[b * kVerticesPerQuad];
+            const float top = bottom - level * scale;
+            bar[0].position.y = top;
+            bar[1].position.y = top;
+            bar[0].color = palette_[palette_index(level)];
+            bar[1].color = bar[0].color;
+
+            // The marker sits on top of the held peak, never inside the bar
+            const float peak = std::max(std::clamp(peaks[b], 0.0f, 1.0f), level);
+            SDL_Vertex* marker = &vertices_[(layout_bands_ + b) * kVerticesPerQuad];
+            const float base = bottom - peak * scale;
+            marker[0].position.y = base - kPeakThickness;
+            marker[1].position.y = base - kPeakThickness;
+            marker[2].position.y = base;
+            marker[3].position.y = base;
+        }
+    }
+
+    /// Uploads the newest frame as one texture column. Low bands go at the
+    /// bottom, so texture row 0 holds the highest band.
+    void push_history(const SpectrumData& data) {
+        const auto magnitudes = data.channel_magnitudes(0);
+        for (std::size_t b = 0; b < layout_bands_; ++b) {
+            column_[layout_bands_ - 1 - b] = pixels_[palette_index(magnitudes[b])];
+        }
+
+        const SDL_Rect rect{cursor_, 0, 1, history_rows_};
+        SDL_UpdateTexture(history_, &rect, column_.data(), static_cast<int>(sizeof(Uint32)));
+        cursor_ = (cursor_ + 1) % history_columns_;
+    }
+
+    /// One geometry call for every bar and peak, two copies for the
+    /// spectrogram ring (oldest columns left of the cursor split).
+    void draw() {
+        SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
+        SDL_RenderClear(renderer_);
+
+        if (layout_bands_ > 0) {
+            SDL_RenderGeometry(renderer_, nullptr, vertices_.data(),
+                               static_cast<int>(vertices_.size()), indices_.data(),
+                               static_cast<int>(indices_.size()));
+
+            const int top = static_cast<int>(bars_height_) + 1;
+            const int height = height_ - top;
+            const int older = history_columns_ - cursor_;
+            const SDL_Rect older_src{cursor_, 0, older, history_rows_};
+            const SDL_Rect older_dst{0, top, older, height};
+            SDL_RenderCopy(renderer_, history_, &older_src, &older_dst);
+            if (cursor_ > 0) {
+                const SDL_Rect newer_src{0, 0, cursor_, history_rows_};
+                const SDL_Rect newer_dst{older, top, cursor_, height};
+                SDL_RenderCopy(renderer_, history_, &newer_src, &newer_dst);
+            }
+        }
+
+        SDL_RenderPresent(renderer_);  // Blocks until the next vblank with vsync
+    }
+
+    SDL_Window* window_ = nullptr;
+    SDL_Renderer* renderer_ = nullptr;
+    bool vsync_ = false;
+    bool running_ = true;
+    SpectrumData data_;
+
+    int width_ = 0;                       // Drawable size in pixels
+    int height_ = 0;
+    float bars_height_ = 0.0f;
+
+    // Colour map shared by bars and spectrogram
+    std::array<SDL_Color, 256> palette_{};
+    std::array<Uint32, 256> pixels_{};    // Same, packed ARGB8888
+
+    // Bars: two quads per band (bar, peak marker), drawn in one call
+    std::size_t layout_bands_ = 0;
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_;
+
+    // Spectrogram: ring of texture columns, newest at cursor_ - 1
+    SDL_Texture* history_ = nullptr;
+    int history_columns_ = 0;
+    int history_rows_ = 0;
+    int cursor_ = 0;
+    std::vector<Uint32> column_;          // Staging for one column upload
+};
+
+}  // namespace audiovis
+
+static void print_usage(const char* program) {
+    std::fprintf(stderr,
+                 "Usage: %s [--fullscreen]\n"
+                 "  --fullscreen  Fill the current display\n",
+                 program);
+}
+
+int main(int argc, char** argv) {
+    bool fullscreen = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string{argv[i]} == "--fullscreen") {
+            fullscreen = true;
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    try {
+        audiovis::AudioConfig audio_cfg{
+            .sample_rate = 48000, .buffer_frames = 512, .channels = 1, .ring_buffer_seconds = 0.5f};
+
+        // Measured plans are cached across launches, so only the first run pays
+        audiovis::load_fftw_wisdom(audiovis::default_wisdom_path());
+
+        audiovis::FFTConfig fft_cfg{.fft_size = 4096,
+                                    .window = audiovis::WindowFunction::Hann,
+                                    .use_magnitude_db = true,
+                                    .db_floor = -60.0f,
+                                    .db_ceiling = 0.0f,
+                                    .planner = audiovis::PlannerRigor::Measure};
+
+        // Many narrow bands for large displays; a 256-sample hop yields
+        // 187 frames/s, so every refresh up to 144 Hz gets a fresh spectrum
+        using audiovis::BandWeighting;
+        using audiovis::FrequencyScale;
+        audiovis::AnalyzerConfig analyzer_cfg{.num_bands = 512,
+                                              .min_frequency = 20.0f,
+                                              .max_frequency = 16000.0f,
+                                              .smoothing_factor = 0.5f,
+                                              .peak_decay_rate = 0.95f,
+                                              .frequency_scale = FrequencyScale::Logarithmic,
+                                              .band_weighting = BandWeighting::Fractional,
+                                              .hop_size = 256,
+                                              .use_worker_thread = true};
+
+        audiovis::SpectrumAnalyzer analyzer{audio_cfg, fft_cfg, analyzer_cfg};
+        audiovis::SdlRenderer renderer{fullscreen};
+        renderer.run(analyzer);
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+}
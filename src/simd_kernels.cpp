@@ -0,0 +1,334 @@
+#include "audiovis/simd_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUDIOVIS_SIMD_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIOVIS_SIMD_NEON 1
+#endif
+
+namespace audiovis::simd {
+
+namespace {
+
+constexpr float kEpsilon = 1e-20f;           // Power floor, i.e. (1e-10 magnitude)^2
+constexpr float kTenLog10Of2 = 3.01029996f;  // 10 * log10(2): converts log2 to dB of power
+
+/// Per-call constants for the dB normalize stage.
+struct DbParams {
+    float scale;
+    float db_floor;
+    float inv_range;  // 1 / (db_ceiling - db_floor)
+};
+
+DbParams make_db_params(float scale, float db_floor, float db_ceiling) noexcept {
+    return DbParams{
+        .scale = scale, .db_floor = db_floor, .inv_range = 1.0f / (db_ceiling - db_floor)};
+}
+
+// -----------------------------------------------------------------------------
+// Scalar kernels (also used for the tails of the vector loops)
+// -----------------------------------------------------------------------------
+
+void window_scalar(const float* in, const float* window, float* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = in[i] * window[i];
+    }
+}
+
+void power_scalar(const float* complex, float* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        const float re = complex[2 * i];
+        const float im = complex[2 * i + 1];
+        out[i] = re * re + im * im;
+    }
+}
+
+void db_scalar(const float* power, float* out, std::size_t n, const DbParams& p) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        const float db = kTenLog10Of2 * fast_log2(power[i] * p.scale + kEpsilon);
+        out[i] = std::clamp((db - p.db_floor) * p.inv_range, 0.0f, 1.0f);
+    }
+}
+
+void magnitude_scalar(const float* power, float* out, std::size_t n, float scale) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = std::sqrt(power[i] * scale);
+    }
+}
+
+float dot_scalar(const float* a, const float* b, std::size_t n) noexcept {
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// -----------------------------------------------------------------------------
+// AVX2 + FMA kernels (compiled for the target, selected at runtime)
+// -----------------------------------------------------------------------------
+//
+// The scalar tails are legacy SSE code, so every kernel clears the upper YMM
+// halves before its tail. Otherwise each call pays an AVX/SSE state
+// transition, which dominates the many short calls fused_bands() makes.
+
+#ifdef AUDIOVIS_SIMD_X86
+
+#define AUDIOVIS_AVX2 __attribute__((target("avx2,fma")))
+
+AUDIOVIS_AVX2 void window_avx2(const float* in, const float* window, float* out,
+                               std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i,
+                         _mm256_mul_ps(_mm256_loadu_ps(in + i), _mm256_loadu_ps(window + i)));
+    }
+    _mm256_zeroupper();
+    window_scalar(in + i, window + i, out + i, n - i);
+}
+
+AUDIOVIS_AVX2 void power_avx2(const float* complex, float* out, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // Two registers of [re0 im0 re1 im1 ...]; square, then add pairs
+        const __m256 a = _mm256_loadu_ps(complex + 2 * i);
+        const __m256 b = _mm256_loadu_ps(complex + 2 * i + 8);
+        const __m256 sums = _mm256_hadd_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b));
+        // hadd interleaves 128-bit lanes: [a01 a23 b01 b23 | a45 a67 b45 b67]
+        const __m256d ordered = _mm256_permute4x64_pd(_mm256_castps_pd(sums), 0xd8);
+        _mm256_storeu_ps(out + i, _mm256_castpd_ps(ordered));
+    }
+    _mm256_zeroupper();
+    power_scalar(complex + 2 * i, out + i, n - i);
+}
+
+/// Vector version of fast_log2(); see the scalar one for the derivation.
+AUDIOVIS_AVX2 __m256 log2_avx2(__m256 x) noexcept {
+    const __m256i bits = _mm256_castps_si256(x);
+    __m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+    __m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+
+    const __m256 fold = _mm256_cmp_ps(mantissa, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+    mantissa = _mm256_blendv_ps(mantissa, _mm256_mul_ps(mantissa, _mm256_set1_ps(0.5f)), fold);
+    exponent = _mm256_add_epi32(exponent,
+                                _mm256_and_si256(_mm256_castps_si256(fold), _mm256_set1_epi32(1)));
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 z = _mm256_div_ps(_mm256_sub_ps(mantissa, one), _mm256_add_ps(mantissa, one));
+    const __m256 z2 = _mm256_mul_ps(z, z);
+    __m256 series = _mm256_fmadd_ps(z2, _mm256_set1_ps(1.0f / 7.0f), _mm256_set1_ps(1.0f / 5.0f));
+    series = _mm256_fmadd_ps(z2, series, _mm256_set1_ps(1.0f / 3.0f));
+    series = _mm256_fmadd_ps(z2, series, one);
+
+    return _mm256_fmadd_ps(_mm256_set1_ps(2.88539008f), _mm256_mul_ps(z, series),
+                           _mm256_cvtepi32_ps(exponent));
+}
+
+AUDIOVIS_AVX2 void db_avx2(const float* power, float* out, std::size_t n,
+                           const DbParams& p) noexcept {
+    const __m256 scale = _mm256_set1_ps(p.scale);
+    const __m256 epsilon = _mm256_set1_ps(kEpsilon);
+    // (10*log10(2) * log2(x) - floor) * inv_range, folded into one FMA
+    const __m256 gain = _mm256_set1_ps(kTenLog10Of2 * p.inv_range);
+    const __m256 offset = _mm256_set1_ps(-p.db_floor * p.inv_range);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 x = _mm256_fmadd_ps(_mm256_loadu_ps(power + i), scale, epsilon);
+        const __m256 normalized = _mm256_fmadd_ps(log2_avx2(x), gain, offset);
+        _mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_max_ps(normalized, zero), one));
+    }
+    _mm256_zeroupper();
+    db_scalar(power + i, out + i, n - i, p);
+}
+
+AUDIOVIS_AVX2 void magnitude_avx2(const float* power, float* out, std::size_t n,
+                                  float scale) noexcept {
+    const __m256 s = _mm256_set1_ps(scale);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(_mm256_mul_ps(_mm256_loadu_ps(power + i), s)));
+    }
+    _mm256_zeroupper();
+    magnitude_scalar(power + i, out + i, n - i, scale);
+}
+
+AUDIOVIS_AVX2 float dot_avx2(const float* a, const float* b, std::size_t n) noexcept {
+    __m256 acc = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc);
+    }
+    // Horizontal sum: fold 256 -> 128 -> 64 -> 32 bits
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    const float vector_sum = _mm_cvtss_f32(sum);
+    _mm256_zeroupper();
+    return vector_sum + dot_scalar(a + i, b + i, n - i);
+}
+
+#undef AUDIOVIS_AVX2
+
+#endif  // AUDIOVIS_SIMD_X86
+
+// -----------------------------------------------------------------------------
+// NEON kernels (baseline on AArch64, no runtime check needed)
+// -----------------------------------------------------------------------------
+
+#ifdef AUDIOVIS_SIMD_NEON
+
+void window_neon(const float* in, const float* window, float* out, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vmulq_f32(vld1q_f32(in + i), vld1q_f32(window + i)));
+    }
+    window_scalar(in + i, window + i, out + i, n - i);
+}
+
+void power_neon(const float* complex, float* out, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // De-interleaving load: val[0] = re, val[1] = im
+        const float32x4x2_t c = vld2q_f32(complex + 2 * i);
+        vst1q_f32(out + i, vfmaq_f32(vmulq_f32(c.val[0], c.val[0]), c.val[1], c.val[1]));
+    }
+    power_scalar(complex + 2 * i, out + i, n - i);
+}
+
+/// Vector version of fast_log2(); see the scalar one for the derivation.
+float32x4_t log2_neon(float32x4_t x) noexcept {
+    const uint32x4_t bits = vreinterpretq_u32_f32(x);
+    int32x4_t exponent =
+        vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127));
+    float32x4_t mantissa = vreinterpretq_f32_u32(
+        vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffffu)), vdupq_n_u32(0x3f800000u)));
+
+    const uint32x4_t fold = vcgtq_f32(mantissa, vdupq_n_f32(1.41421356f));
+    mantissa = vbslq_f32(fold, vmulq_n_f32(mantissa, 0.5f), mantissa);
+    exponent = vsubq_s32(exponent, vreinterpretq_s32_u32(fold));  // fold lanes are all-ones (-1)
+
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t z = vdivq_f32(vsubq_f32(mantissa, one), vaddq_f32(mantissa, one));
+    const float32x4_t z2 = vmulq_f32(z, z);
+    float32x4_t series = vfmaq_f32(vdupq_n_f32(1.0f / 5.0f), z2, vdupq_n_f32(1.0f / 7.0f));
+    series = vfmaq_f32(vdupq_n_f32(1.0f / 3.0f), z2, series);
+    series = vfmaq_f32(one, z2, series);
+
+    return vfmaq_f32(vcvtq_f32_s32(exponent), vdupq_n_f32(2.88539008f), vmulq_f32(z, series));
+}
+
+void db_neon(const float* power, float* out, std::size_t n, const DbParams& p) noexcept {
+    const float32x4_t scale = vdupq_n_f32(p.scale);
+    const float32x4_t epsilon = vdupq_n_f32(kEpsilon);
+    const float32x4_t gain = vdupq_n_f32(kTenLog10Of2 * p.inv_range);
+    const float32x4_t offset = vdupq_n_f32(-p.db_floor * p.inv_range);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t x = vfmaq_f32(epsilon, vld1q_f32(power + i), scale);
+        const float32x4_t normalized = vfmaq_f32(offset, log2_neon(x), gain);
+        vst1q_f32(out + i, vminq_f32(vmaxq_f32(normalized, zero), one));
+    }
+    db_scalar(power + i, out + i, n - i, p);
+}
+
+void magnitude_neon(const float* power, float* out, std::size_t n, float scale) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vsqrtq_f32(vmulq_n_f32(vld1q_f32(power + i), scale)));
+    }
+    magnitude_scalar(power + i, out + i, n - i, scale);
+}
+
+float dot_neon(const float* a, const float* b, std::size_t n) noexcept {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = vfmaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    return vaddvq_f32(acc) + dot_scalar(a + i, b + i, n - i);
+}
+
+#endif  // AUDIOVIS_SIMD_NEON
+
+// -----------------------------------------------------------------------------
+// Runtime dispatch
+// -----------------------------------------------------------------------------
+
+struct KernelTable {
+    Isa isa;
+    void (*window)(const float*, const float*, float*, std::size_t) noexcept;
+    void (*power)(const float*, float*, std::size_t) noexcept;
+    void (*db)(const float*, float*, std::size_t, const DbParams&) noexcept;
+    void (*magnitude)(const float*, float*, std::size_t, float) noexcept;
+    float (*dot)(const float*, const float*, std::size_t) noexcept;
+};
+
+KernelTable select_kernels() noexcept {
+#if defined(AUDIOVIS_SIMD_X86)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {Isa::AVX2, window_avx2, power_avx2, db_avx2, magnitude_avx2, dot_avx2};
+    }
+#elif defined(AUDIOVIS_SIMD_NEON)
+    return {Isa::NEON, window_neon, power_neon, db_neon, magnitude_neon, dot_neon};
+#endif
+    return {Isa::Scalar, window_scalar, power_scalar, db_scalar, magnitude_scalar,
+            dot_scalar};
+}
+
+const KernelTable& kernels() noexcept {
+    static const KernelTable table = select_kernels();
+    return table;
+}
+
+}  // namespace
+
+Isa active_isa() noexcept {
+    return kernels().isa;
+}
+
+const char* isa_name(Isa isa) noexcept {
+    switch (isa) {
+        case Isa::AVX2:
+            return "avx2";
+        case Isa::NEON:
+            return "neon";
+        case Isa::Scalar:
+            break;
+    }
+    return "scalar";
+}
+
+void apply_window(std::span<const float> in, const float* window, float* out) noexcept {
+    kernels().window(in.data(), window, out, in.size());
+}
+
+void power_spectrum(const float* complex, std::span<float> out) noexcept {
+    kernels().power(complex, out.data(), out.size());
+}
+
+void power_to_normalized_db(std::span<const float> power, float* out, float scale, float db_floor,
+                            float db_ceiling) noexcept {
+    kernels().db(power.data(), out, power.size(), make_db_params(scale, db_floor, db_ceiling));
+}
+
+void power_to_magnitude(std::span<const float> power, float* out, float scale) noexcept {
+    kernels().magnitude(power.data(), out, power.size(), scale);
+}
+
+float dot(std::span<const float> a, const float* b) noexcept {
+    return kernels().dot(a.data(), b, a.size());
+}
+
+}  // namespace audiovis::simd
@@ -0,0 +1,178 @@
+#include "audiovis/spectrogram.hpp"
+
+#include "audiovis/file_source.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+namespace audiovis {
+
+namespace {
+
+std::size_t resolve_threads(std::size_t requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+}  // namespace
+
+SpectrogramEngine::SpectrogramEngine(const SpectrogramConfig& config)
+    : config_{config}, threads_{resolve_threads(config.threads)} {
+    config_.fft.channels = 1;
+    if (config_.hop_size == 0) {
+        throw std::invalid_argument("Spectrogram hop size must be positive");
+    }
+    if (config_.chunk_frames == 0) {
+        throw std::invalid_argument("Spectrogram chunk size must be positive");
+    }
+    // Validates the FFT settings and warms the shared plan cache
+    [[maybe_unused]] const FFTProcessor probe{config_.fft};
+}
+
+Spectrogram SpectrogramEngine::compute(std::span<const float> samples, float sample_rate) const {
+    return run(samples.size(), sample_rate, 0,
+               [samples](std::size_t first, std::span<float> mono, std::span<float>) {
+                   std::copy_n(samples.begin() + static_cast<std::ptrdiff_t>(first), mono.size(),
+                               mono.begin());
+               });
+}
+
+Spectrogram SpectrogramEngine::compute(const FileSource& file) const {
+    const std::size_t channels = file.channels();
+    return run(file.total_frames(), static_cast<float>(file.sample_rate()),
+               channels == 1 ? 0 : channels,
+               [&file, channels](std::size_t first, std::span<float> mono,
+                                 std::span<float> scratch) {
+                   if (channels == 1) {
+                       file.read_frames(first, mono);
+                       return;
+                   }
+                   // One chunk's worth of interleaved frames, then average
+                   const auto interleaved = scratch.first(mono.size() * channels);
+                   file.read_frames(first, interleaved);
+                   const float scale = 1.0f / static_cast<float>(channels);
+                   for (std::size_t i = 0; i < mono.size(); ++i) {
+                       float sum = 0.0f;
+                       for (std::size_t ch = 0; ch < channels; ++ch) {
+                           sum += interleaved[i * channels + ch];
+                       }
+                       mono[i] = sum * scale;
+                   }
+               });
+}
+
+Spectrogram SpectrogramEngine::run(std::size_t total_samples, float sample_rate,
+                                   std::size_t scratch_per_sample, const Reader& read) const {
+    if (!(sample_rate > 0.0f)) {
+        throw std::invalid_argument("Spectrogram sample rate must be positive");
+    }
+
+    const auto fft_size = config_.fft.fft_size;
+    const auto hop = config_.hop_size;
+    const auto bins = fft_size / 2 + 1;
+
+    Spectrogram result;
+    result.fft_size = fft_size;
+    result.hop_size = hop;
+    result.sample_rate = sample_rate;
+    result.resolution = config_.resolution;
+
+    std::optional<BandMatrix> bands;
+    if (config_.resolution == SpectrogramResolution::Bands) {
+        bands.emplace(config_.bands, bins, fft_size, sample_rate);
+        result.columns = bands->band_count();
+        result.edges.assign(bands->band_edges().begin(), bands->band_edges().end());
+    } else {
+        // Bin k covers (k -/+ 0.5) * resolution, clipped to [0, Nyquist]
+        const float resolution = sample_rate / static_cast<float>(fft_size);
+        result.columns = bins;
+        result.edges.resize(bins + 1);
+        result.edges.front() = 0.0f;
+        for (std::size_t k = 1; k < bins; ++k) {
+            result.edges[k] = (static_cast<float>(k) - 0.5f) * resolution;
+        }
+        result.edges.back() = sample_rate / 2.0f;
+    }
+
+    result.frames = total_samples >= fft_size ? (total_samples - fft_size) / hop + 1 : 0;
+    result.values.assign(result.frames * result.columns, 0.0f);
+    if (result.frames == 0) {
+        return result;
+    }
+
+    const auto chunk = config_.chunk_frames;
+    const auto chunks = (result.frames + chunk - 1) / chunk;
+    const auto workers = std::min(threads_, chunks);
+
+    // Plan on this thread; each worker then owns its processor outright
+    std::vector<FFTProcessor> processors;
+    processors.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        processors.emplace_back(config_.fft);
+    }
+
+    std::atomic<std::size_t> next_chunk{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    const auto work = [&](FFTProcessor& fft) {
+        try {
+            // A chunk's frames overlap, so its samples are read once, contiguously
+            std::vector<float> samples((chunk - 1) * hop + fft_size);
+            std::vector<float> magnitudes(bands ? bins : 0);
+            std::vector<float> scratch(samples.size() * scratch_per_sample);
+
+            for (;;) {
+                const auto index = next_chunk.fetch_add(1, std::memory_order_relaxed);
+                if (index >= chunks) {
+                    break;
+                }
+                const auto first = index * chunk;
+                const auto count = std::min(chunk, result.frames - first);
+                const auto window = std::span<float>{samples}.first((count - 1) * hop + fft_size);
+                read(first * hop, window, scratch);
+
+                for (std::size_t f = 0; f < count; ++f) {
+                    const auto input = std::span<const float>{window}.subspan(f * hop, fft_size);
+                    const auto row = std::span<float>{result.values}.subspan(
+                        (first + f) * result.columns, result.columns);
+                    if (bands) {
+                        fft.compute(input, magnitudes);
+                        bands->apply(magnitudes, row);
+                    } else {
+                        fft.compute(input, row);
+                    }
+                }
+            }
+        } catch (...) {
+            const std::lock_guard lock{error_mutex};
+            if (!error) {
+                error = std::current_exception();
+            }
+            next_chunk.store(chunks, std::memory_order_relaxed);  // Others wind down
+        }
+    };
+
+    {
+        std::vector<std::jthread> pool;
+        pool.reserve(workers - 1);
+        for (std::size_t i = 1; i < workers; ++i) {
+            pool.emplace_back([&work, &processors, i] { work(processors[i]); });
+        }
+        work(processors[0]);
+    }  // Joins the pool
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return result;
+}
+
+}  // namespace audiovis
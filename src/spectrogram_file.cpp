@@ -0,0 +1,476 @@
+#include "audiovis/spectrogram_file.hpp"
+
+#include "audiovis/spectrogram.hpp"
+#include "audiovis/spectrum_analyzer.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace audiovis {
+
+namespace {
+
+// Header layout, all fields little-endian
+constexpr char kMagic[4] = {'A', 'V', 'S', 'G'};
+constexpr std::uint16_t kVersion = 1;
+constexpr std::size_t kFixedHeaderSize = 48;  // Band edges follow
+constexpr std::size_t kRecordHeaderSize = 16; // i64 time, f32 rms, f32 peak
+
+std::size_t bytes_per_value(SpectrogramEncoding encoding) noexcept {
+    switch (encoding) {
+        case SpectrogramEncoding::Float32:
+            return 4;
+        case SpectrogramEncoding::Float16:
+            return 2;
+        case SpectrogramEncoding::UInt8:
+            return 1;
+    }
+    return 4;
+}
+
+/// Bytes per frame record, or 0 if it would overflow.
+std::size_t record_size(const SpectrogramInfo& info, SpectrogramEncoding encoding) noexcept {
+    constexpr auto kMax = std::numeric_limits<std::size_t>::max();
+    const std::size_t bands = info.bands();
+    const std::size_t width = bytes_per_value(encoding);
+    if (bands != 0 && info.channels > (kMax - kRecordHeaderSize) / width / bands) {
+        return 0;
+    }
+    return kRecordHeaderSize + info.values_per_frame() * width;
+}
+
+template <std::size_t N>
+void put_le(std::byte* out, std::uint64_t value) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        out[i] = static_cast<std::byte>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+template <std::size_t N>
+std::uint64_t get_le(const std::byte* in) noexcept {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+        value |= std::to_integer<std::uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+void put_f32(std::byte* out, float value) noexcept {
+    put_le<4>(out, std::bit_cast<std::uint32_t>(value));
+}
+
+std::uint32_t get_u32(const std::byte* in) noexcept {
+    return static_cast<std::uint32_t>(get_le<4>(in));
+}
+
+float get_f32(const std::byte* in) noexcept {
+    return std::bit_cast<float>(get_u32(in));
+}
+
+/// IEEE 754 binary32 to binary16, round to nearest even.
+std::uint16_t float_to_half(float value) noexcept {
+    const auto bits = std::bit_cast<std::uint32_t>(value);
+    const auto sign = (bits >> 16) & 0x8000u;
+    const auto exponent = static_cast<int>((bits >> 23) & 0xFF);
+    auto mantissa = bits & 0x7FFFFFu;
+
+    if (exponent == 0xFF) {
+        return static_cast<std::uint16_t>(sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u));
+    }
+    const int half_exponent = exponent - 127 + 15;
+    if (half_exponent >= 31) {
+        return static_cast<std::uint16_t>(sign | 0x7C00u);  // Overflow to infinity
+    }
+
+    std::uint32_t half = 0;
+    std::uint32_t shift = 13;
+    if (half_exponent <= 0) {
+        if (half_exponent < -10) {
+            return static_cast<std::uint16_t>(sign);  // Underflow to zero
+        }
+        // Subnormal: make the implicit bit explicit and shift it into place
+        mantissa |= 0x800000u;
+        shift = static_cast<std::uint32_t>(14 - half_exponent);
+        half = mantissa >> shift;
+    } else {
+        half = (static_cast<std::uint32_t>(half_exponent) << 10) | (mantissa >> shift);
+    }
+
+    // A carry out of the mantissa correctly bumps the exponent
+    const auto remainder = mantissa & ((1u << shift) - 1);
+    const auto halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1u) != 0)) {
+        ++half;
+    }
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+float half_to_float(std::uint16_t half) noexcept {
+    const std::uint32_t sign = (half & 0x8000u) << 16;
+    const std::uint32_t exponent = (half >> 10) & 0x1Fu;
+    const std::uint32_t mantissa = half & 0x3FFu;
+
+    if (exponent == 0) {
+        const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign != 0 ? -magnitude : magnitude;
+    }
+    if (exponent == 31) {
+        return std::bit_cast<float>(sign | 0x7F800000u | (mantissa << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+bool write_all(int fd, const std::byte* data, std::size_t size) noexcept {
+    while (size > 0) {
+        const auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+std::runtime_error file_error(const std::string& what, const std::string& path, int error) {
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(error));
+}
+
+}  // namespace
+
+SpectrogramInfo spectrogram_info(const SpectrumAnalyzer& analyzer) {
+    const auto& config = analyzer.config();
+    const auto edges = analyzer.band_edges();
+
+    // Without a hop, update() analyzes whatever window is newest
+    std::size_t hop = config.hop_size;
+    if (hop == 0 && config.use_worker_thread) {
+        hop = analyzer.fft_size();
+    }
+    return SpectrogramInfo{.sample_rate = analyzer.analysis_rate(),
+                           .fft_size = analyzer.fft_size(),
+                           .hop_size = hop,
+                           .channels = analyzer.channels(),
+                           .edges = {edges.begin(), edges.end()}};
+}
+
+SpectrogramInfo spectrogram_info(const Spectrogram& spectrogram) {
+    return SpectrogramInfo{.sample_rate = spectrogram.sample_rate,
+                           .fft_size = spectrogram.fft_size,
+                           .hop_size = spectrogram.hop_size,
+                           .channels = 1,
+                           .edges = spectrogram.edges};
+}
+
+// -----------------------------------------------------------------------------
+// Writer
+// -----------------------------------------------------------------------------
+
+SpectrogramWriter::SpectrogramWriter(const std::string& path, const SpectrogramInfo& info,
+                                     const SpectrogramWriterConfig& config)
+    : info_{info},
+      config_{config},
+      path_{path},
+      record_(record_size(info, config.encoding)),
+      queue_{record_size(info, config.encoding) * std::max<std::size_t>(config.queue_frames, 1)} {
+    if (info_.bands() == 0 || info_.channels == 0) {
+        throw std::invalid_argument("Spectrogram file needs at least one band and channel");
+    }
+    if (record_.empty()) {
+        throw std::invalid_argument("Spectrogram frame size overflows");
+    }
+    if (config_.encoding == SpectrogramEncoding::UInt8 &&
+        !(config_.value_min < config_.value_max)) {
+        throw std::invalid_argument("UInt8 spectrogram needs value_min < value_max");
+    }
+
+    const auto header_size = kFixedHeaderSize + 4 * info_.edges.size();
+    constexpr std::size_t kMaxField = std::numeric_limits<std::uint32_t>::max();
+    if (info_.edges.size() > (kMaxField - kFixedHeaderSize) / 4 || record_.size() > kMaxField ||
+        info_.fft_size > kMaxField || info_.hop_size > kMaxField || info_.channels > kMaxField) {
+        throw std::invalid_argument("Spectrogram header field does not fit in 32 bits");
+    }
+
+    std::array<std::byte, kFixedHeaderSize> fixed{};
+    std::memcpy(fixed.data(), kMagic, 4);
+    put_le<2>(&fixed[4], kVersion);
+    put_le<1>(&fixed[6], static_cast<std::uint8_t>(config_.encoding));
+    put_le<4>(&fixed[8], header_size);
+    put_le<4>(&fixed[12], record_.size());
+    put_f32(&fixed[16], info_.sample_rate);
+    put_le<4>(&fixed[20], info_.fft_size);
+    put_le<4>(&fixed[24], info_.hop_size);
+    put_le<4>(&fixed[28], info_.channels);
+    put_le<4>(&fixed[32], info_.bands());
+    put_f32(&fixed[36], config_.value_min);
+    put_f32(&fixed[40], config_.value_max);
+
+    std::vector<std::byte> header;
+    header.reserve(header_size);
+    header.insert(header.end(), fixed.begin(), fixed.end());
+    for (const float edge : info_.edges) {
+        std::array<std::byte, 4> value{};
+        put_f32(value.data(), edge);
+        header.insert(header.end(), value.begin(), value.end());
+    }
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw file_error("Failed to create", path, errno);
+    }
+    if (!write_all(fd_, header.data(), header.size())) {
+        const auto error = file_error("Failed to write", path, errno);
+        ::close(fd_);
+        throw error;
+    }
+
+    io_ = std::jthread{[this](const std::stop_token& stop) { io_loop(stop); }};
+}
+
+SpectrogramWriter::~SpectrogramWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructor cannot report it; close() explicitly to observe errors
+    }
+}
+
+bool SpectrogramWriter::append(const SpectrumData& frame) noexcept {
+    if (!origin_) {
+        origin_ = frame.timestamp;
+    }
+    const SpectrogramFrame meta{
+        .time = std::chrono::duration_cast<std::chrono::nanoseconds>(frame.timestamp - *origin_),
+        .rms_level = frame.rms_level,
+        .peak_level = frame.peak_level};
+    return append(frame.magnitudes, meta);
+}
+
+bool SpectrogramWriter::append(std::span<const float> values,
+                               const SpectrogramFrame& frame) noexcept {
+    if (values.size() != info_.values_per_frame() || queue_.available() < record_.size()) {
+        ++frames_dropped_;
+        return false;
+    }
+
+    std::byte* out = record_.data();
+    put_le<8>(out, static_cast<std::uint64_t>(frame.time.count()));
+    put_f32(out + 8, frame.rms_level);
+    put_f32(out + 12, frame.peak_level);
+    out += kRecordHeaderSize;
+
+    switch (config_.encoding) {
+        case SpectrogramEncoding::Float32:
+            for (const float v : values) {
+                put_f32(out, v);
+                out += 4;
+            }
+            break;
+        case SpectrogramEncoding::Float16:
+            for (const float v : values) {
+                put_le<2>(out, float_to_half(v));
+                out += 2;
+            }
+            break;
+        case SpectrogramEncoding::UInt8: {
+            const float scale = 255.0f / (config_.value_max - config_.value_min);
+            for (const float v : values) {
+                const float q = std::clamp((v - config_.value_min) * scale, 0.0f, 255.0f);
+                *out++ = static_cast<std::byte>(std::lround(q));
+            }
+            break;
+        }
+    }
+
+    // Space was checked above and only this thread produces
+    queue_.try_push(record_);
+    bytes_queued_ += record_.size();
+    ++frames_queued_;
+    return true;
+}
+
+void SpectrogramWriter::io_loop(const std::stop_token& stop) {
+    while (!stop.stop_requested()) {
+        if (queue_.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{2});
+            continue;
+        }
+        write_pending();
+    }
+    write_pending();  // Whatever was queued before the stop
+}
+
+void SpectrogramWriter::write_pending() {
+    const auto region = queue_.acquire_read(queue_.size());
+    if (error_.load(std::memory_order_relaxed) == 0) {
+        for (const auto segment : {region.first, region.second}) {
+            if (!write_all(fd_, segment.data(), segment.size())) {
+                error_.store(errno, std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+    // Failed bytes are consumed too, so neither append() nor flush() get stuck
+    queue_.commit_read(region.size());
+    bytes_written_.fetch_add(region.size(), std::memory_order_release);
+}
+
+void SpectrogramWriter::flush() {
+    while (io_.joinable() && bytes_written_.load(std::memory_order_acquire) < bytes_queued_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    check_failed();
+}
+
+void SpectrogramWriter::close() {
+    if (io_.joinable()) {
+        io_.request_stop();
+        io_.join();
+    }
+    if (fd_ >= 0) {
+        if (::close(fd_) != 0 && error_.load(std::memory_order_relaxed) == 0) {
+            error_.store(errno, std::memory_order_relaxed);
+        }
+        fd_ = -1;
+    }
+    check_failed();
+}
+
+void SpectrogramWriter::check_failed() const {
+    if (const int error = error_.load(std::memory_order_relaxed); error != 0) {
+        throw file_error("Failed to write", path_, error);
+    }
+}
+
+void write_spectrogram(const std::string& path, const Spectrogram& spectrogram,
+                       const SpectrogramWriterConfig& config) {
+    SpectrogramWriter writer{path, spectrogram_info(spectrogram), config};
+    for (std::size_t i = 0; i < spectrogram.frames; ++i) {
+        const SpectrogramFrame meta{.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::duration<double>(spectrogram.frame_time(i)))};
+        while (!writer.append(spectrogram.frame(i), meta)) {
+            writer.flush();  // Queue full: let the disk catch up
+        }
+    }
+    writer.close();
+}
+
+// -----------------------------------------------------------------------------
+// Reader
+// -----------------------------------------------------------------------------
+
+SpectrogramReader::SpectrogramReader(const std::string& path) : file_{path} {
+    const auto bytes = file_.bytes();
+    const auto invalid = [&path](const std::string& why) {
+        return std::runtime_error("Invalid spectrogram file '" + path + "': " + why);
+    };
+
+    if (bytes.size() < kFixedHeaderSize || std::memcmp(bytes.data(), kMagic, 4) != 0) {
+        throw invalid("bad magic");
+    }
+    const std::byte* in = bytes.data();
+    if (get_le<2>(in + 4) != kVersion) {
+        throw invalid("unsupported version " + std::to_string(get_le<2>(in + 4)));
+    }
+    const auto encoding = get_le<1>(in + 6);
+    if (encoding > static_cast<std::uint8_t>(SpectrogramEncoding::UInt8)) {
+        throw invalid("unknown encoding");
+    }
+    encoding_ = static_cast<SpectrogramEncoding>(encoding);
+
+    header_size_ = get_u32(in + 8);
+    stride_ = get_u32(in + 12);
+    info_.sample_rate = get_f32(in + 16);
+    info_.fft_size = get_u32(in + 20);
+    info_.hop_size = get_u32(in + 24);
+    info_.channels = get_u32(in + 28);
+    const std::size_t bands = get_u32(in + 32);  // Widened before any arithmetic
+    value_min_ = get_f32(in + 36);
+    value_max_ = get_f32(in + 40);
+
+    // The edges must fit in the file before anything is sized from the count
+    if (bands == 0 || info_.channels == 0 ||
+        bands + 1 > (bytes.size() - kFixedHeaderSize) / 4 ||
+        header_size_ != kFixedHeaderSize + 4 * (bands + 1)) {
+        throw invalid("inconsistent header");
+    }
+    info_.edges.resize(bands + 1);
+    for (std::size_t i = 0; i <= bands; ++i) {
+        info_.edges[i] = get_f32(in + kFixedHeaderSize + 4 * i);
+    }
+    if (stride_ == 0 || stride_ != record_size(info_, encoding_)) {
+        throw invalid("inconsistent frame size");
+    }
+
+    // A partially written trailing record (e.g. after a crash) is ignored
+    frame_count_ = (bytes.size() - header_size_) / stride_;
+}
+
+std::span<const std::byte> SpectrogramReader::record(std::size_t index) const noexcept {
+    return file_.bytes().subspan(header_size_ + index * stride_, stride_);
+}
+
+SpectrogramFrame SpectrogramReader::frame(std::size_t index) const noexcept {
+    const std::byte* in = record(index).data();
+    return SpectrogramFrame{
+        .time = std::chrono::nanoseconds{static_cast<std::int64_t>(get_le<8>(in))},
+        .rms_level = get_f32(in + 8),
+        .peak_level = get_f32(in + 12)};
+}
+
+SpectrogramFrame SpectrogramReader::read(std::size_t index,
+                                         std::span<float> values) const noexcept {
+    const std::byte* in = record(index).data() + kRecordHeaderSize;
+    const auto count = std::min(values.size(), info_.values_per_frame());
+
+    switch (encoding_) {
+        case SpectrogramEncoding::Float32:
+            for (std::size_t i = 0; i < count; ++i) {
+                values[i] = get_f32(in + 4 * i);
+            }
+            break;
+        case SpectrogramEncoding::Float16:
+            for (std::size_t i = 0; i < count; ++i) {
+                values[i] = half_to_float(static_cast<std::uint16_t>(get_le<2>(in + 2 * i)));
+            }
+            break;
+        case SpectrogramEncoding::UInt8: {
+            const float step = (value_max_ - value_min_) / 255.0f;
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto level = std::to_integer<std::uint8_t>(in[i]);
+                values[i] = value_min_ + step * static_cast<float>(level);
+            }
+            break;
+        }
+    }
+    return frame(index);
+}
+
+std::size_t SpectrogramReader::find(std::chrono::nanoseconds time) const noexcept {
+    // First frame later than `time`, then step back one
+    std::size_t low = 0;
+    std::size_t high = frame_count_;
+    while (low < high) {
+        const auto mid = low + (high - low) / 2;
+        if (frame(mid).time <= time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low > 0 ? low - 1 : 0;
+}
+
+}  // namespace audiovis
@@ -1,156 +1,976 @@
 #include "audiovis/spectrum_analyzer.hpp"
 
+#include "audiovis/band_kernel.hpp"
+#include "audiovis/trace.hpp"
+
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
+#include <functional>
+#include <numbers>
 #include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 
 namespace audiovis {
 
+namespace {
+
+/// The FFT batches one signal per source channel in every channel mode.
+FFTConfig batched_config(FFTConfig config, const AudioSource& source) {
+    config.channels = source.channels();
+    return config;
+}
+
+/// Largest resolution_tiers accepted (the deepest tier is decimated by 128).
+constexpr std::size_t kMaxResolutionTiers = 8;
+
+/// Largest pre-FFT decimation accepted.
+constexpr std::size_t kMaxDecimation = 128;
+
+/// Capture samples run through the decimators per step (the scratch holds half).
+constexpr std::size_t kDecimationChunk = 2048;
+
+/// Highest frequency still alias-free after decimating `rate` by `factor`.
+float decimated_passband(float rate, std::size_t factor) noexcept {
+    return HalfBandDecimator::kPassband * rate / static_cast<float>(2 * factor);
+}
+
+/// Highest frequency the configuration displays.
+float top_frequency(const AnalyzerConfig& config) noexcept {
+    return config.tracked_frequencies.empty() ? config.max_frequency
+                                              : config.tracked_frequencies.back();
+}
+
+/// Samples one frame consumes: a window, or with tone tracking just a hop.
+std::size_t frame_samples(const FFTConfig& fft_config, const AnalyzerConfig& config) noexcept {
+    if (config.tracked_frequencies.empty()) {
+        return fft_config.fft_size;
+    }
+    return config.hop_size > 0 ? config.hop_size : fft_config.fft_size;
+}
+
+/// Validates the source before anything dereferences it.
+std::unique_ptr<AudioSource> require_source(std::unique_ptr<AudioSource> source) {
+    if (!source) {
+        throw std::invalid_argument("Spectrum analyzer needs an audio source");
+    }
+    return source;
+}
+
+/// Carries per-band state from one layout to another, channel by channel:
+/// each new band takes the value of the old band holding its centre, and
+/// bands outside the old range start from silence. `from_edges` and
+/// `to_edges` bound the bands of one channel.
+void resample_bands(std::span<const float> from, std::span<const float> from_edges,
+                    std::span<float> to, std::span<const float> to_edges) noexcept {
+    const auto from_bands = from_edges.size() - 1;
+    const auto to_bands = to_edges.size() - 1;
+    const auto channels = to.size() / to_bands;
+    for (std::size_t ch = 0; ch < channels && (ch + 1) * from_bands <= from.size(); ++ch) {
+        std::size_t old = 0;
+        for (std::size_t b = 0; b < to_bands; ++b) {
+            const float centre = 0.5f * (to_edges[b] + to_edges[b + 1]);
+            while (old < from_bands && from_edges[old + 1] <= centre) {
+                ++old;
+            }
+            const bool inside = old < from_bands && from_edges[old] <= centre;
+            to[ch * to_bands + b] = inside ? from[ch * from_bands + old] : 0.0f;
+        }
+    }
+}
+
+}  // namespace
+
+std::size_t auto_decimation(float max_frequency, float sample_rate) noexcept {
+    std::size_t factor = 1;
+    while (factor < kMaxDecimation &&
+           max_frequency <= decimated_passband(sample_rate, 2 * factor)) {
+        factor *= 2;
+    }
+    return factor;
+}
+
 SpectrumAnalyzer::SpectrumAnalyzer(const AudioConfig& audio_config, const FFTConfig& fft_config,
                                    const AnalyzerConfig& analyzer_config)
-    : audio_{std::make_unique<AudioCapture>(audio_config)},
-      fft_{std::make_unique<FFTProcessor>(fft_config)},
-      analyzer_config_{analyzer_config} {
-    // Pre-allocate buffers
-    sample_buffer_.resize(fft_->fft_size());
-    magnitude_buffer_.resize(fft_->bin_count());
-    smoothed_magnitudes_.resize(analyzer_config_.num_bands, 0.0f);
-    peak_values_.resize(analyzer_config_.num_bands, 0.0f);
+    : SpectrumAnalyzer{std::make_unique<AudioCapture>(audio_config), fft_config,
+                       analyzer_config} {}
+
+SpectrumAnalyzer::SpectrumAnalyzer(std::unique_ptr<AudioSource> source,
+                                   const FFTConfig& fft_config,
+                                   const AnalyzerConfig& analyzer_config)
+    : audio_{require_source(std::move(source))},
+      latest_fft_config_{batched_config(fft_config, *audio_)},
+      latest_config_{analyzer_config},
+      built_fft_config_{latest_fft_config_},
+      built_config_{latest_config_} {
+    validate(latest_fft_config_, latest_config_);
 
-    recompute_band_mapping();
+    // Pre-allocate buffers
+    active_ = build_pipeline(latest_fft_config_, latest_config_);
+    published_.reset(active_->frame);
 }
 
 SpectrumAnalyzer::~SpectrumAnalyzer() {
     stop();
+    stop_builder();
+    delete pending_.exchange(nullptr);
+    free_retired();
 }
 
 void SpectrumAnalyzer::start() {
     audio_->start();
+    if (active_->config.use_worker_thread) {
+        start_worker();
+    }
 }
 
 void SpectrumAnalyzer::stop() {
+    stop_worker();
     audio_->stop();
 }
 
+void SpectrumAnalyzer::start_worker() {
+    if (worker_.joinable()) {
+        return;  // Already running
+    }
+    // Slots may still be sized for an earlier layout
+    published_.reset(active_->frame);
+    worker_ = std::jthread{[this](const std::stop_token& stop) { worker_loop(stop); }};
+    worker_policy_applied_ =
+        apply_thread_policy(worker_.native_handle(), active_->config.worker_policy);
+}
+
+void SpectrumAnalyzer::stop_worker() {
+    if (worker_.joinable()) {
+        worker_.request_stop();
+        worker_.join();
+    }
+}
+
+void SpectrumAnalyzer::worker_loop(const std::stop_token& stop) {
+    const FrameCallback on_frame = [this](const SpectrumData& frame) { publish(frame); };
+
+    while (!stop.stop_requested()) {
+        if (process_pending(on_frame) == 0) {
+            // Ring ran dry: wait roughly half a hop before looking again
+            const auto& config = active_->config;
+            const auto hop = config.hop_size > 0 ? config.hop_size : fft_size();
+            std::this_thread::sleep_for(std::chrono::duration<double>(
+                static_cast<double>(hop) / 2.0 / static_cast<double>(analysis_rate())));
+        }
+    }
+}
+
+void SpectrumAnalyzer::publish(const SpectrumData& frame) {
+    auto& slot = published_.write_buffer();
+    if (slot.magnitudes.size() != frame.magnitudes.size()) {
+        // Sized for the previous layout: trade it for a spare of the new size.
+        // The old slot leaves with this pipeline when it is retired.
+        auto& pipeline = *active_;
+        if (pipeline.spares_used < pipeline.spare_frames.size()) {
+            std::swap(slot, pipeline.spare_frames[pipeline.spares_used++]);
+        } else {
+            prepare_frame(pipeline, slot);
+        }
+    }
+    // Slots are pre-sized, so this copy reuses their storage
+    copy_frame(frame, slot);
+    published_.publish();
+}
+
 bool SpectrumAnalyzer::is_running() const noexcept {
     return audio_->is_running();
 }
 
-void SpectrumAnalyzer::set_config(const AnalyzerConfig& config) {
-    const bool bands_changed =
-        config.num_bands != analyzer_config_.num_bands ||
-        config.min_frequency != analyzer_config_.min_frequency ||
-        config.max_frequency != analyzer_config_.max_frequency ||
-        config.logarithmic_frequency != analyzer_config_.logarithmic_frequency;
+std::unique_ptr<SpectrumAnalyzer::Pipeline> SpectrumAnalyzer::build_pipeline(
+    const FFTConfig& fft_config, const AnalyzerConfig& config) const {
+    auto pipeline = std::make_unique<Pipeline>();
+    auto& p = *pipeline;
+    p.config = config;
+    p.fft_config = fft_config;
+    const bool tracking = !config.tracked_frequencies.empty();
+    if (tracking) {
+        p.config.num_bands = config.tracked_frequencies.size();
+    } else {
+        p.fft = std::make_unique<FFTProcessor>(fft_config);
+        p.magnitude_buffer.assign(fft_config.channels * p.fft->bin_count(), 0.0f);
+    }
 
-    analyzer_config_ = config;
+    const auto channels = fft_config.channels;
+    const auto values = channels * p.config.num_bands;
+    p.band_buffer.assign(values, 0.0f);
+    p.smoothed_magnitudes.assign(values, 0.0f);
+    p.peak_values.assign(values, 0.0f);
 
-    if (bands_changed) {
-        smoothed_magnitudes_.resize(config.num_bands, 0.0f);
-        peak_values_.resize(config.num_bands, 0.0f);
-        recompute_band_mapping();
+    p.regions.assign(channels, {});
+    p.fft_inputs.assign(channels, {});
+    const bool mid_side = config.channel_mode == ChannelMode::MidSide;
+    const auto window = std::max(fft_config.fft_size, frame_samples(fft_config, config));
+    p.mid_side_buffer.assign(mid_side ? 2 * window : 0, 0.0f);
+
+    p.decimation = decimation_for(config);
+    if (p.decimation > 1) {
+        // History now lives here at the decimated rate: a window (or hop)
+        // plus whatever one drain of a full capture ring can add
+        const auto stages = static_cast<std::size_t>(std::countr_zero(p.decimation));
+        const auto capacity = std::max(fft_config.fft_size, config.hop_size) +
+                              audio_->buffer().capacity() / p.decimation + 1;
+        p.decimators.assign(channels * stages, HalfBandDecimator{});
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            p.decimated.push_back(std::make_unique<RingBuffer<float>>(capacity));
+        }
+        p.decimator_scratch.assign(HalfBandDecimator::output_size(kDecimationChunk), 0.0f);
+
+        // Stage s delays by delay() samples of its input rate, rate / 2^s
+        p.decimator_delay = static_cast<double>(HalfBandDecimator::delay()) *
+                            static_cast<double>(p.decimation - 1) /
+                            static_cast<double>(audio_->sample_rate());
     }
+
+    if (tracking) {
+        p.tracker = std::make_unique<ToneTracker>(ToneTrackerConfig{
+            .frequencies = config.tracked_frequencies,
+            .sample_rate = sample_rate() / static_cast<float>(p.decimation),
+            .window_size = fft_config.fft_size,
+            .window = fft_config.window,
+            .use_magnitude_db = fft_config.use_magnitude_db,
+            .db_floor = fft_config.db_floor,
+            .db_ceiling = fft_config.db_ceiling,
+            .channels = channels});
+    }
+    map_bands(p);
+
+    prepare_frame(p, p.frame);
+    std::fill(p.frame.magnitudes.begin(), p.frame.magnitudes.end(), 0.0f);
+    std::fill(p.frame.peaks.begin(), p.frame.peaks.end(), 0.0f);
+    p.spare_frames.fill(p.frame);
+    return pipeline;
 }
 
-void SpectrumAnalyzer::recompute_band_mapping() {
-    if (analyzer_config_.logarithmic_frequency) {
-        band_bins_ = compute_log_bands(
-            fft_->bin_count(), analyzer_config_.num_bands, analyzer_config_.min_frequency,
-            analyzer_config_.max_frequency, sample_rate(), fft_->fft_size());
+bool SpectrumAnalyzer::adopt_pending() noexcept {
+    if (pending_.load(std::memory_order_relaxed) == nullptr) {
+        return false;
+    }
+    adopt(std::unique_ptr<Pipeline>{pending_.exchange(nullptr, std::memory_order_acquire)});
+    return true;
+}
+
+void SpectrumAnalyzer::adopt(std::unique_ptr<Pipeline> next) noexcept {
+    if (!next) {
+        return;  // Taken back by a superseding request
+    }
+    // Same bands, same meaning: keep the display continuous across the swap.
+    // A new band count over the same spectrum (e.g. the display was resized)
+    // is resampled instead; tones are not comparable with spectrum bands.
+    if (next->smoothed_magnitudes.size() == active_->smoothed_magnitudes.size()) {
+        std::ranges::copy(active_->smoothed_magnitudes, next->smoothed_magnitudes.begin());
+        std::ranges::copy(active_->peak_values, next->peak_values.begin());
+    } else if (!next->tracker && !active_->tracker) {
+        resample_bands(active_->smoothed_magnitudes, active_->band_edges,
+                       next->smoothed_magnitudes, next->band_edges);
+        resample_bands(active_->peak_values, active_->band_edges, next->peak_values,
+                       next->band_edges);
+    }
+    // Same decimation: hand the decimated stream over with its filter state,
+    // as the capture ring does for undecimated pipelines
+    if (next->decimation > 1 && next->decimation == active_->decimation &&
+        next->decimators.size() == active_->decimators.size()) {
+        std::ranges::copy(active_->decimators, next->decimators.begin());
+        for (std::size_t ch = 0; ch < next->decimated.size(); ++ch) {
+            auto& from = *active_->decimated[ch];
+            auto& to = *next->decimated[ch];
+            from.discard(from.size() - std::min(from.size(), to.capacity()));
+            const auto region = from.acquire_read(from.size());
+            to.try_push(region.first);
+            to.try_push(region.second);
+        }
+    }
+
+    const auto generation = next->generation;
+    std::swap(active_, next);
+
+    // Never freed here: the builder or the control thread reaps the list
+    Pipeline* old = next.release();
+    old->next_retired = retired_.load(std::memory_order_relaxed);
+    while (!retired_.compare_exchange_weak(old->next_retired, old, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+    }
+    settled_.store(generation, std::memory_order_release);
+    settled_.notify_all();
+}
+
+void SpectrumAnalyzer::set_config(const AnalyzerConfig& config) {
+    const std::scoped_lock lock{reconfigure_mutex_};
+    apply_now(latest_fft_config_, config);
+}
+
+void SpectrumAnalyzer::set_fft_config(const FFTConfig& config) {
+    const std::scoped_lock lock{reconfigure_mutex_};
+    apply_now(batched_config(config, *audio_), latest_config_);
+}
+
+void SpectrumAnalyzer::apply_now(const FFTConfig& fft_config, const AnalyzerConfig& config) {
+    validate(fft_config, config);
+    const bool policy_changed = config.worker_policy != latest_config_.worker_policy;
+
+    // Anything still in flight is superseded
+    stop_builder();
+    build_error_ = nullptr;
+    delete pending_.exchange(nullptr, std::memory_order_acq_rel);
+
+    auto next = build_pipeline(fft_config, config);
+    next->generation = requested_.load(std::memory_order_relaxed) + 1;
+    requested_.store(next->generation, std::memory_order_release);
+    latest_fft_config_ = built_fft_config_ = fft_config;
+    latest_config_ = built_config_ = config;
+
+    if (worker_.joinable()) {
+        // Hand it over at the worker's next frame and wait until it is in use
+        const auto generation = next->generation;
+        pending_.store(next.release(), std::memory_order_release);
+        for (auto seen = settled_.load(std::memory_order_acquire); seen != generation;
+             seen = settled_.load(std::memory_order_acquire)) {
+            settled_.wait(seen, std::memory_order_acquire);
+        }
     } else {
-        // Linear frequency mapping
-        band_bins_.clear();
-        band_bins_.reserve(analyzer_config_.num_bands);
+        adopt(std::move(next));
+    }
+    free_retired();
 
-        const auto bins_per_band = fft_->bin_count() / analyzer_config_.num_bands;
-        for (std::size_t i = 0; i < analyzer_config_.num_bands; ++i) {
-            const auto start = i * bins_per_band;
-            const auto end = (i + 1) * bins_per_band;
-            band_bins_.emplace_back(start, std::min(end, fft_->bin_count()));
+    if (!active_->config.use_worker_thread) {
+        stop_worker();
+    } else if (worker_.joinable()) {
+        if (policy_changed) {
+            worker_policy_applied_ =
+                apply_thread_policy(worker_.native_handle(), active_->config.worker_policy);
         }
+    } else if (audio_->is_running()) {
+        start_worker();
     }
 }
 
-float SpectrumAnalyzer::compute_band_magnitude(std::size_t band_index) const {
-    const auto& [bin_start, bin_end] = band_bins_[band_index];
+void SpectrumAnalyzer::reconfigure(const FFTConfig& fft_config,
+                                   const AnalyzerConfig& analyzer_config) {
+    const std::scoped_lock lock{reconfigure_mutex_};
+    reconfigure_locked(fft_config, analyzer_config);
+}
 
-    if (bin_start >= bin_end) {
-        return 0.0f;
+bool SpectrumAnalyzer::fit_bands(std::size_t bands) {
+    if (bands == 0) {
+        throw std::invalid_argument("Band count must be positive");
+    }
+    const std::scoped_lock lock{reconfigure_mutex_};
+    if (!latest_config_.tracked_frequencies.empty() || latest_config_.num_bands == bands) {
+        return false;
     }
+    AnalyzerConfig config = latest_config_;
+    config.num_bands = bands;
+    reconfigure_locked(latest_fft_config_, config);
+    return true;
+}
 
-    // Average the magnitudes in this band
-    float sum = 0.0f;
-    for (std::size_t i = bin_start; i < bin_end; ++i) {
-        sum += magnitude_buffer_[i];
+void SpectrumAnalyzer::reconfigure_locked(const FFTConfig& fft_config,
+                                          const AnalyzerConfig& analyzer_config) {
+    stop_builder();
+    if (build_error_) {
+        // That request never took effect
+        latest_fft_config_ = built_fft_config_;
+        latest_config_ = built_config_;
+        std::rethrow_exception(std::exchange(build_error_, nullptr));
     }
 
-    return sum / static_cast<float>(bin_end - bin_start);
+    const auto fft = batched_config(fft_config, *audio_);
+    AnalyzerConfig config = analyzer_config;
+    config.use_worker_thread = latest_config_.use_worker_thread;
+    config.worker_policy = latest_config_.worker_policy;
+    validate(fft, config);
+
+    const auto generation = requested_.load(std::memory_order_relaxed) + 1;
+    builder_ = std::jthread{[this, fft, config, generation](const std::stop_token& stop) {
+        build_in_background(stop, fft, config, generation);
+    }};
+    requested_.store(generation, std::memory_order_release);
+    latest_fft_config_ = fft;
+    latest_config_ = config;
 }
 
-SpectrumData SpectrumAnalyzer::update() {
-    SpectrumData result;
-    result.timestamp = std::chrono::steady_clock::now();
-    result.magnitudes.resize(analyzer_config_.num_bands);
-    result.peaks.resize(analyzer_config_.num_bands);
+void SpectrumAnalyzer::build_in_background(const std::stop_token& stop,
+                                           const FFTConfig& fft_config,
+                                           const AnalyzerConfig& config,
+                                           std::uint64_t generation) {
+    std::unique_ptr<Pipeline> next;
+    try {
+        next = build_pipeline(fft_config, config);
+    } catch (...) {
+        build_error_ = std::current_exception();
+        settled_.store(generation, std::memory_order_release);
+        settled_.notify_all();
+        return;
+    }
+    if (stop.stop_requested()) {
+        return;  // Superseded while building
+    }
+    next->generation = generation;
+    built_fft_config_ = fft_config;
+    built_config_ = config;
+    delete pending_.exchange(next.release(), std::memory_order_acq_rel);
 
-    // Read available samples from ring buffer
-    auto& buffer = audio_->buffer();
-    const auto available = buffer.size();
-    const auto needed = fft_->fft_size();
+    // Free what the analysis thread retires until this pipeline is in use
+    while (!stop.stop_requested() && settled_.load(std::memory_order_acquire) < generation) {
+        free_retired();
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    free_retired();
+}
 
-    if (available < needed / 4) {
-        // Not enough samples yet - return previous smoothed state
-        result.magnitudes = smoothed_magnitudes_;
-        result.peaks = peak_values_;
-        return result;
+void SpectrumAnalyzer::stop_builder() {
+    if (builder_.joinable()) {
+        builder_.request_stop();
+        builder_.join();
     }
+    // Its pipeline may still be adopted after this; the next reap (another
+    // request, set_config() or the destructor) frees what that retires
+    free_retired();
+}
 
-    // Read samples (taking the most recent if more than needed)
-    if (available > needed) {
-        buffer.discard(available - needed);
+void SpectrumAnalyzer::free_retired() noexcept {
+    for (Pipeline* p = retired_.exchange(nullptr, std::memory_order_acquire); p != nullptr;) {
+        delete std::exchange(p, p->next_retired);
+    }
+}
+
+void SpectrumAnalyzer::validate(const FFTConfig& fft_config, const AnalyzerConfig& config) const {
+    if (fft_config.fft_size == 0 || (fft_config.fft_size & (fft_config.fft_size - 1)) != 0) {
+        throw std::invalid_argument("FFT size must be a power of two");
+    }
+    const auto& tones = config.tracked_frequencies;
+    if (tones.empty()) {
+        if (config.num_bands == 0) {
+            throw std::invalid_argument("Analyzer needs at least one band");
+        }
+        if (!(config.min_frequency > 0.0f) || !(config.min_frequency < config.max_frequency)) {
+            throw std::invalid_argument("Analyzer needs 0 < min_frequency < max_frequency");
+        }
+    } else {
+        if (!(tones.front() > 0.0f) || std::adjacent_find(tones.begin(), tones.end(),
+                                                          std::greater_equal<>{}) != tones.end()) {
+            throw std::invalid_argument("Tracked frequencies must be positive and ascending");
+        }
+        if (config.resolution_tiers != 1) {
+            throw std::invalid_argument("Tone tracking does not use resolution tiers");
+        }
+    }
+    if (config.decimation > kMaxDecimation ||
+        (config.decimation & (config.decimation - 1)) != 0) {
+        throw std::invalid_argument("Decimation must be 0 (auto) or a power of two up to 128");
+    }
+    const auto decimation = decimation_for(config);
+    if (decimation > 1 && top_frequency(config) > decimated_passband(sample_rate(), decimation)) {
+        throw std::invalid_argument("max_frequency lies above the decimated passband");
+    }
+    if (!tones.empty() && !(tones.back() < sample_rate() / static_cast<float>(2 * decimation))) {
+        throw std::invalid_argument("Tracked frequencies must lie below Nyquist");
+    }
+    // Undecimated streaming keeps a frame's samples in the capture ring
+    const bool streaming = config.hop_size > 0 || config.use_worker_thread;
+    if (streaming && decimation == 1 &&
+        audio_->buffer().capacity() < frame_samples(fft_config, config)) {
+        throw std::invalid_argument("Ring buffer is too small to hold one FFT window");
+    }
+    if (config.channel_mode == ChannelMode::MidSide && audio_->channels() != 2) {
+        throw std::invalid_argument("Mid/side analysis requires stereo input");
+    }
+    audiovis::validate(config.worker_policy);
+    if (config.resolution_tiers == 0 || config.resolution_tiers > kMaxResolutionTiers) {
+        throw std::invalid_argument("Analyzer resolution tiers must be between 1 and 8");
+    }
+    // The decimators need the stream without gaps: every sample, exactly once
+    if (config.resolution_tiers > 1 &&
+        (config.hop_size == 0 || config.hop_size > fft_config.fft_size)) {
+        throw std::invalid_argument("Multi-resolution analysis needs 0 < hop_size <= fft_size");
+    }
+}
+
+void SpectrumAnalyzer::map_bands(Pipeline& p) const {
+    const auto& config = p.config;
+    if (p.tracker) {
+        // Each tone's band reaches geometrically halfway to its neighbours;
+        // the outer edges mirror the inner ones (an octave for a lone tone)
+        const auto& tones = config.tracked_frequencies;
+        const auto count = tones.size();
+        p.band_edges.assign(count + 1, 0.0f);
+        for (std::size_t b = 1; b < count; ++b) {
+            p.band_edges[b] = std::sqrt(tones[b - 1] * tones[b]);
+        }
+        const float first = tones.front();
+        const float last = tones.back();
+        p.band_edges[0] = count > 1 ? first * first / p.band_edges[1]
+                                    : first / std::numbers::sqrt2_v<float>;
+        p.band_edges[count] = count > 1 ? last * last / p.band_edges[count - 1]
+                                        : last * std::numbers::sqrt2_v<float>;
+        return;
     }
+    const BandLayout layout{.num_bands = config.num_bands,
+                            .min_frequency = config.min_frequency,
+                            .max_frequency = config.max_frequency,
+                            .scale = config.frequency_scale,
+                            .weighting = config.band_weighting};
+    const auto fft_size = p.fft->fft_size();
+    const auto bins = p.fft->bin_count();
+    const float analysis_rate = sample_rate() / static_cast<float>(p.decimation);
+    BandMatrix full{layout, bins, fft_size, analysis_rate};
+    p.band_edges.assign(full.band_edges().begin(), full.band_edges().end());
 
-    const auto read_count = buffer.peek({sample_buffer_.data(), sample_buffer_.size()});
+    // Bands [begin, end) of the layout; its edges are the same frequencies
+    const auto sub_layout = [&](std::size_t begin, std::size_t end) {
+        BandLayout sub = layout;
+        sub.num_bands = end - begin;
+        sub.min_frequency = p.band_edges[begin];
+        sub.max_frequency = p.band_edges[end];
+        return sub;
+    };
 
-    // Compute RMS and peak level from raw samples
+    // Tier k's bands lie at or below its alias-free limit and above tier
+    // k + 1's, so each tier serves a contiguous run, deeper tiers lower down
+    const auto levels = config.resolution_tiers;
+    const auto num_bands = config.num_bands;
+    std::array<std::size_t, kMaxResolutionTiers> first{};
+    for (std::size_t level = 0; level + 1 < levels; ++level) {
+        const float limit = decimated_passband(analysis_rate, std::size_t{1} << (level + 1));
+        std::size_t covered = 0;
+        while (covered < num_bands && p.band_edges[covered + 1] <= limit) {
+            ++covered;
+        }
+        first[level] = covered;
+    }
+
+    p.first_band = first[0];
+    if (p.first_band == 0) {
+        p.band_matrix = std::move(full);
+    } else if (p.first_band < num_bands) {
+        p.band_matrix = BandMatrix{sub_layout(p.first_band, num_bands), bins, fft_size,
+                                   analysis_rate};
+    }
+
+    // Keep decimation levels down to the deepest one serving any band
+    std::size_t deepest = 0;
+    for (std::size_t level = 1; level < levels; ++level) {
+        if (first[level] < first[level - 1]) {
+            deepest = level;
+        }
+    }
+
+    const auto signals = p.fft->channels();
+    p.tiers.resize(deepest);
+    for (std::size_t level = 1; level <= deepest; ++level) {
+        auto& tier = p.tiers[level - 1];
+        tier.first_band = first[level];
+        tier.band_count = first[level - 1] - first[level];
+        tier.decimators.assign(signals, HalfBandDecimator{});
+        for (std::size_t ch = 0; ch < signals; ++ch) {
+            tier.history.push_back(std::make_unique<RingBuffer<float>>(fft_size));
+        }
+        tier.decimated.assign(signals * fft_size, 0.0f);
+        tier.inputs.assign(signals, {});
+
+        if (tier.band_count > 0) {
+            const float rate = analysis_rate / static_cast<float>(std::size_t{1} << level);
+            tier.fft = std::make_unique<FFTProcessor>(p.fft->config());
+            tier.band_matrix =
+                BandMatrix{sub_layout(tier.first_band, first[level - 1]), bins, fft_size, rate};
+            tier.magnitudes.assign(signals * bins, 0.0f);
+        }
+    }
+}
+
+std::vector<std::size_t> SpectrumAnalyzer::tier_first_bands() const {
+    std::vector<std::size_t> first{active_->first_band};
+    for (const auto& tier : active_->tiers) {
+        first.push_back(tier.first_band);
+    }
+    return first;
+}
+
+std::size_t SpectrumAnalyzer::decimation_for(const AnalyzerConfig& config) const noexcept {
+    return config.decimation == 0 ? auto_decimation(top_frequency(config), sample_rate())
+                                  : config.decimation;
+}
+
+RingBuffer<float>& SpectrumAnalyzer::analysis_ring(Pipeline& pipeline, std::size_t ch) const {
+    return pipeline.decimation > 1 ? *pipeline.decimated[ch] : audio_->buffer(ch);
+}
+
+void SpectrumAnalyzer::decimate_input(Pipeline& p) {
+    if (p.decimation == 1) {
+        return;
+    }
+    AUDIOVIS_TRACE_SCOPE(Decimate);
+    std::size_t count = audio_->buffer(0).size();
+    for (std::size_t ch = 1; ch < audio_->channels(); ++ch) {
+        count = std::min(count, audio_->buffer(ch).size());
+    }
+
+    const auto stages = p.decimators.size() / p.decimated.size();
+    const std::span<float> scratch{p.decimator_scratch};
+    for (std::size_t ch = 0; ch < p.decimated.size(); ++ch) {
+        auto& capture = audio_->buffer(ch);
+        auto& out = *p.decimated[ch];
+        const std::span<HalfBandDecimator> cascade{p.decimators.data() + ch * stages, stages};
+
+        const auto region = capture.acquire_read(count);
+        for (const auto segment : {region.first, region.second}) {
+            for (std::size_t pos = 0; pos < segment.size(); pos += kDecimationChunk) {
+                const auto chunk =
+                    segment.subspan(pos, std::min(kDecimationChunk, segment.size() - pos));
+                // Later stages run in place: each output lands behind its inputs
+                auto produced = cascade[0].process(chunk, scratch);
+                for (std::size_t stage = 1; stage < stages; ++stage) {
+                    produced = cascade[stage].process(scratch.first(produced), scratch);
+                }
+                out.discard(produced > out.available() ? produced - out.available() : 0);
+                out.try_push(std::span<const float>{scratch.first(produced)});
+            }
+        }
+        capture.commit_read(count);
+    }
+}
+
+std::size_t SpectrumAnalyzer::buffered_samples(Pipeline& pipeline) const {
+    std::size_t available = analysis_ring(pipeline, 0).size();
+    for (std::size_t ch = 1; ch < audio_->channels(); ++ch) {
+        available = std::min(available, analysis_ring(pipeline, ch).size());
+    }
+    return available;
+}
+
+std::size_t SpectrumAnalyzer::acquire_regions(Pipeline& pipeline, std::size_t count) {
+    AUDIOVIS_TRACE_SCOPE(RingRead);
+    std::size_t window = count;
+    for (std::size_t ch = 0; ch < pipeline.regions.size(); ++ch) {
+        pipeline.regions[ch] = analysis_ring(pipeline, ch).acquire_read(count);
+        window = std::min(window, pipeline.regions[ch].size());
+    }
+    return window;
+}
+
+void SpectrumAnalyzer::commit_regions(Pipeline& pipeline, std::size_t count) {
+    for (std::size_t ch = 0; ch < audio_->channels(); ++ch) {
+        analysis_ring(pipeline, ch).commit_read(count);
+    }
+}
+
+void SpectrumAnalyzer::analyze_frame(Pipeline& p, std::size_t window, SpectrumData& result) {
+    AUDIOVIS_TRACE_SCOPE(AnalyzeFrame);
+    const auto& config = p.config;
+    const auto channels = p.regions.size();
+
+    // Compute RMS and peak level from raw samples of every channel
     float sum_squares = 0.0f;
     float peak = 0.0f;
-    for (std::size_t i = 0; i < read_count; ++i) {
-        const float s = sample_buffer_[i];
-        sum_squares += s * s;
-        peak = std::max(peak, std::abs(s));
+    for (auto& region : p.regions) {
+        // Trim each channel to the common window
+        const auto head = std::min(window, region.first.size());
+        region.first = region.first.first(head);
+        region.second = region.second.first(window - head);
+
+        for (const auto segment : {region.first, region.second}) {
+            for (const float s : segment) {
+                sum_squares += s * s;
+                peak = std::max(peak, std::abs(s));
+            }
+        }
     }
-    result.rms_level = std::sqrt(sum_squares / static_cast<float>(read_count));
+    result.rms_level = std::sqrt(sum_squares / static_cast<float>(window * channels));
     result.peak_level = peak;
 
-    // Compute FFT
-    fft_->compute({sample_buffer_.data(), read_count},
-                  {magnitude_buffer_.data(), magnitude_buffer_.size()});
+    if (config.channel_mode == ChannelMode::MidSide) {
+        // Each output mixes both rings, so this mode needs one copy
+        const std::span<float> mid{p.mid_side_buffer.data(), window};
+        const std::span<float> side{p.mid_side_buffer.data() + p.mid_side_buffer.size() / 2,
+                                    window};
 
-    // Map to display bands and apply smoothing
-    for (std::size_t i = 0; i < analyzer_config_.num_bands; ++i) {
-        const float raw = compute_band_magnitude(i);
+        const auto gather = [](const RingBuffer<float>::ReadRegion& region, std::span<float> out) {
+            std::copy(region.second.begin(), region.second.end(),
+                      std::copy(region.first.begin(), region.first.end(), out.begin()));
+        };
+        gather(p.regions[0], mid);
+        gather(p.regions[1], side);
 
-        // Temporal smoothing (exponential moving average)
-        const float alpha = 1.0f - analyzer_config_.smoothing_factor;
-        smoothed_magnitudes_[i] =
-            alpha * raw + analyzer_config_.smoothing_factor * smoothed_magnitudes_[i];
+        for (std::size_t i = 0; i < window; ++i) {
+            const float left = mid[i];
+            const float right = side[i];
+            mid[i] = 0.5f * (left + right);
+            side[i] = 0.5f * (left - right);
+        }
+        p.fft_inputs[0] = {.head = mid, .tail = {}};
+        p.fft_inputs[1] = {.head = side, .tail = {}};
+    } else {
+        // Window straight out of each channel's ring storage
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            p.fft_inputs[ch] = {.head = p.regions[ch].first, .tail = p.regions[ch].second};
+        }
+    }
 
-        // Peak hold with decay
-        if (smoothed_magnitudes_[i] > peak_values_[i]) {
-            peak_values_[i] = smoothed_magnitudes_[i];
-        } else {
-            peak_values_[i] *= analyzer_config_.peak_decay_rate;
+    // Transform all channels at once, then go from each channel's complex
+    // spectrum straight to smoothed, peak-held bands in one fused pass (see
+    // fused_bands()). Tracked tones advance by just the window's fresh samples
+    // and are the bands themselves.
+    const auto num_bands = config.num_bands;
+    const auto tier_bands = p.band_matrix.band_count();
+    const BandSmoothing smoothing{.smoothing_factor = config.smoothing_factor,
+                                  .peak_decay_rate = config.peak_decay_rate};
+    const auto lanes = [&](std::size_t first, std::size_t count) {
+        return BandLanes{
+            .smoothed = std::span<float>{p.smoothed_magnitudes}.subspan(first, count),
+            .peaks = std::span<float>{p.peak_values}.subspan(first, count),
+            .magnitudes_out = std::span<float>{result.magnitudes}.subspan(first, count),
+            .peaks_out = std::span<float>{result.peaks}.subspan(first, count)};
+    };
+    if (p.tracker) {
+        {
+            AUDIOVIS_TRACE_SCOPE(BandMapping);
+            p.tracker->process_batch(p.fft_inputs);
+            p.tracker->magnitudes(p.band_buffer);
         }
+        AUDIOVIS_TRACE_SCOPE(Smoothing);
+        smooth_bands(p.band_buffer, smoothing, lanes(0, p.band_buffer.size()));
+        return;
+    }
+    if (tier_bands > 0) {
+        const auto bins = p.fft->bin_count();
+        p.fft->transform_batch(p.fft_inputs);
+        AUDIOVIS_TRACE_SCOPE(BandMapping);
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            fused_bands(*p.fft, ch, p.band_matrix, smoothing,
+                        std::span<float>{p.magnitude_buffer}.subspan(ch * bins, bins),
+                        lanes(ch * num_bands + p.first_band, tier_bands));
+        }
+    }
 
-        result.magnitudes[i] = smoothed_magnitudes_[i];
-        result.peaks[i] = peak_values_[i];
+    // Lower bands from the decimated tiers; the first frame primes them with
+    // its whole window, later ones with the hop they advanced by
+    if (!p.tiers.empty()) {
+        analyze_tiers(p, p.tiers_primed ? config.hop_size : window);
+        p.tiers_primed = true;
+
+        AUDIOVIS_TRACE_SCOPE(Smoothing);
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            smooth_bands(std::span<const float>{p.band_buffer}.subspan(ch * num_bands,
+                                                                       p.first_band),
+                         smoothing, lanes(ch * num_bands, p.first_band));
+        }
     }
+}
 
-    // Consume samples we've processed
-    buffer.discard(read_count);
+void SpectrumAnalyzer::analyze_tiers(Pipeline& p, std::size_t fresh) {
+    const auto signals = p.fft_inputs.size();
+    const auto fft_size = p.fft->fft_size();
+    const auto bins = p.fft->bin_count();
+    const auto num_bands = p.config.num_bands;
+
+    for (std::size_t level = 0; level < p.tiers.size(); ++level) {
+        auto& tier = p.tiers[level];
+
+        // Decimate this frame's new samples from the tier above and slide
+        // them into the tier's window
+        for (std::size_t ch = 0; ch < signals; ++ch) {
+            const std::span<float> out{tier.decimated.data() + ch * fft_size, fft_size};
+            auto& decimator = tier.decimators[ch];
+            std::size_t written = 0;
+            if (level == 0) {
+                const auto& input = p.fft_inputs[ch];
+                const auto skip = input.head.size() + input.tail.size() - fresh;
+                const auto head_skip = std::min(skip, input.head.size());
+                written = decimator.process(input.head.subspan(head_skip), out);
+                written += decimator.process(input.tail.subspan(skip - head_skip),
+                                             out.subspan(written));
+            } else {
+                const auto& above = p.tiers[level - 1];
+                written = decimator.process(
+                    {above.decimated.data() + ch * fft_size, above.decimated_count}, out);
+            }
 
+            auto& history = *tier.history[ch];
+            history.discard(history.size() + written > fft_size
+                                ? history.size() + written - fft_size
+                                : 0);
+            history.try_push(std::span<const float>{out.data(), written});
+            tier.decimated_count = written;
+        }
+
+        // Tier k advances every 2^k frames: the same overlap as tier 0
+        const std::size_t period = std::size_t{2} << level;
+        if (!tier.fft || tier.history[0]->size() < fft_size || p.frame_index % period != 0) {
+            continue;
+        }
+        for (std::size_t ch = 0; ch < signals; ++ch) {
+            const auto region = tier.history[ch]->acquire_read(fft_size);
+            tier.inputs[ch] = {.head = region.first, .tail = region.second};
+        }
+        tier.fft->compute_batch(tier.inputs, tier.magnitudes);
+        for (std::size_t ch = 0; ch < signals; ++ch) {
+            tier.band_matrix.apply(
+                std::span<const float>{tier.magnitudes}.subspan(ch * bins, bins),
+                std::span<float>{p.band_buffer}.subspan(ch * num_bands + tier.first_band,
+                                                        tier.band_count));
+        }
+    }
+    ++p.frame_index;
+}
+
+std::size_t SpectrumAnalyzer::process_pending(const FrameCallback& on_frame) {
+    // Frame boundary: the one place a reconfigured pipeline is swapped in
+    adopt_pending();
+    auto& p = *active_;
+    const auto window = frame_samples(p.fft_config, p.config);
+    const auto hop = p.config.hop_size > 0 ? p.config.hop_size : p.fft_config.fft_size;
+    const auto now = std::chrono::steady_clock::now();
+    const auto rate = static_cast<double>(audio_->sample_rate()) /
+                      static_cast<double>(p.decimation);
+
+    // Snapshot once so a fast producer cannot keep this loop running forever
+    decimate_input(p);
+    auto available = buffered_samples(p);
+    std::size_t frames = 0;
+
+    while (available >= std::max(window, hop)) {
+        analyze_frame(p, acquire_regions(p, window), p.frame);
+
+        // Stamp each frame with when its last sample was captured, so frames
+        // emitted together in a batch still carry distinct, evenly spaced times
+        const auto pending = static_cast<double>(available - window) / rate + p.decimator_delay;
+        p.frame.timestamp = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                      std::chrono::duration<double>(pending));
+
+        // Slide forward by one hop; the rest of the window is reused as history
+        commit_regions(p, hop);
+        available -= hop;
+        ++frames;
+
+        if (on_frame) {
+            on_frame(p.frame);
+        }
+    }
+
+    return frames;
+}
+
+std::size_t SpectrumAnalyzer::analyze_all(const FrameCallback& on_frame) {
+    if (audio_->is_realtime()) {
+        throw std::logic_error("analyze_all() needs an offline audio source");
+    }
+    if (audio_->is_running() || worker_.joinable()) {
+        throw std::logic_error("analyze_all() cannot run alongside background threads");
+    }
+    adopt_pending();
+    const auto& config = active_->config;
+    const auto window = frame_samples(active_->fft_config, config);
+    const auto hop = config.hop_size > 0 ? config.hop_size : active_->fft_config.fft_size;
+    if (active_->decimation == 1 && audio_->buffer().capacity() < std::max(window, hop)) {
+        throw std::invalid_argument("Ring buffer is too small to hold one FFT window");
+    }
+
+    std::size_t frames = 0;
+    for (;;) {
+        // Fill the rings, then drain every window they now hold
+        const auto produced = audio_->produce(audio_->buffer().capacity());
+        frames += process_pending(on_frame);
+        if (produced == 0 && audio_->at_end()) {
+            break;
+        }
+    }
+    return frames;
+}
+
+SpectrumData SpectrumAnalyzer::update() {
+    SpectrumData result;
+    update(result);
     return result;
 }
 
+bool SpectrumAnalyzer::update(SpectrumData& out) {
+    AUDIOVIS_TRACE_SCOPE(AnalyzerUpdate);
+    if (worker_.joinable()) {
+        // Analysis happens on the worker; just pick up its newest frame. The
+        // slot's size follows the worker's layout, which may have just changed.
+        const bool fresh = published_.update();
+        const auto& slot = published_.read_buffer();
+        out.magnitudes.resize(slot.magnitudes.size());
+        out.peaks.resize(slot.peaks.size());
+        copy_frame(slot, out);
+        return fresh;
+    }
+
+    adopt_pending();
+    auto& p = *active_;
+
+    // Only the first call (or one after a band count change) allocates
+    prepare_frame(p, out);
+
+    if (p.config.hop_size > 0) {
+        // Streaming STFT: run every frame that is due, report the newest
+        if (process_pending(nullptr) > 0) {
+            copy_frame(p.frame, out);
+            return true;
+        }
+        copy_smoothed_state(p, out);
+        return false;
+    }
+
+    // Read available samples from the ring buffers
+    decimate_input(p);
+    const auto available = buffered_samples(p);
+    const auto needed = p.fft_config.fft_size;
+
+    // The tone tracker holds its own history and can use any fresh samples
+    if (available < (p.tracker ? 1 : needed / 4)) {
+        // Not enough samples yet - return previous smoothed state
+        copy_smoothed_state(p, out);
+        return false;
+    }
+
+    // Read samples (taking the most recent if more than needed)
+    if (available > needed) {
+        for (std::size_t ch = 0; ch < audio_->channels(); ++ch) {
+            analysis_ring(p, ch).discard(available - needed);
+        }
+    }
+
+    // Window straight out of ring storage - no intermediate copy
+    const auto window = acquire_regions(p, needed);
+    out.timestamp = std::chrono::steady_clock::now();
+    analyze_frame(p, window, out);
+
+    // Consume samples we've processed
+    commit_regions(p, window);
+
+    return true;
+}
+
+void SpectrumAnalyzer::prepare_frame(const Pipeline& pipeline, SpectrumData& frame) {
+    const auto channels = pipeline.fft_config.channels;
+    frame.channel_count = channels;
+    frame.magnitudes.resize(channels * pipeline.config.num_bands);
+    frame.peaks.resize(channels * pipeline.config.num_bands);
+}
+
+void SpectrumAnalyzer::copy_frame(const SpectrumData& from, SpectrumData& to) {
+    // Element-wise copies into pre-sized storage, never a reallocation
+    std::copy(from.magnitudes.begin(), from.magnitudes.end(), to.magnitudes.begin());
+    std::copy(from.peaks.begin(), from.peaks.end(), to.peaks.begin());
+    to.channel_count = from.channel_count;
+    to.rms_level = from.rms_level;
+    to.peak_level = from.peak_level;
+    to.timestamp = from.timestamp;
+}
+
+void SpectrumAnalyzer::copy_smoothed_state(const Pipeline& pipeline, SpectrumData& out) {
+    std::ranges::copy(pipeline.smoothed_magnitudes, out.magnitudes.begin());
+    std::ranges::copy(pipeline.peak_values, out.peaks.begin());
+    out.timestamp = std::chrono::steady_clock::now();
+}
+
 }  // namespace audiovis
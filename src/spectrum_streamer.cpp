@@ -0,0 +1,843 @@
+#include "audiovis/spectrum_streamer.hpp"
+
+#include "audiovis/spectrum_analyzer.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace audiovis {
+
+namespace {
+
+// Wire layout, all fields little-endian
+constexpr char kMagic[4] = {'A', 'V', 'S', 'P'};
+constexpr std::uint8_t kVersion = 1;
+constexpr std::size_t kPacketHeaderSize = 20;  // Magic, version, count, sequence, range
+constexpr std::size_t kFrameHeaderSize = 32;
+constexpr std::uint8_t kDeltaFlag = 0x01;
+constexpr std::size_t kMaxFramesPerPacket = 255;
+constexpr std::size_t kMaxDecodedValues = std::size_t{1} << 20;
+
+constexpr std::size_t kMaxRequestBytes = 8192;  // WebSocket handshake
+constexpr std::size_t kMaxClientMessage = 4096; // Anything bigger from a client is hostile
+constexpr std::size_t kMaxClients = 64;
+
+struct Socket {
+    int fd = -1;
+    ~Socket() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+template <std::size_t N>
+void put_le(std::byte* out, std::uint64_t value) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        out[i] = static_cast<std::byte>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+template <std::size_t N>
+std::uint64_t get_le(const std::byte* in) noexcept {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+        value |= std::to_integer<std::uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+void put_f32(std::byte* out, float value) noexcept {
+    put_le<4>(out, std::bit_cast<std::uint32_t>(value));
+}
+
+float get_f32(const std::byte* in) noexcept {
+    return std::bit_cast<float>(static_cast<std::uint32_t>(get_le<4>(in)));
+}
+
+std::uint32_t levels(StreamEncoding encoding) noexcept {
+    return encoding == StreamEncoding::UInt16 ? 0xFFFFu : 0xFFu;
+}
+
+std::size_t varint_size(std::uint32_t value) noexcept {
+    std::size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+void put_varint(std::byte*& out, std::uint32_t value) noexcept {
+    while (value >= 0x80) {
+        *out++ = static_cast<std::byte>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<std::byte>(value);
+}
+
+/// Reads a varint of at most 32 bits; false if it runs past `end`.
+bool get_varint(const std::byte*& in, const std::byte* end, std::uint32_t& value) noexcept {
+    value = 0;
+    for (unsigned shift = 0; shift < 35 && in < end; shift += 7) {
+        const auto byte = std::to_integer<std::uint32_t>(*in++);
+        value |= (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Encodes `current` against `previous` into at most `limit` bytes: a zigzag
+/// varint per changed value, and 0 followed by (run length - 1) for a run of
+/// unchanged ones. Returns the bytes written, or 0 if it would not fit.
+std::size_t encode_delta(std::span<const std::uint16_t> current,
+                         std::span<const std::uint16_t> previous, std::byte* out,
+                         std::size_t limit) noexcept {
+    std::byte* const begin = out;
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < current.size();) {
+        const int delta = int{current[i]} - int{previous[i]};
+        if (delta == 0) {
+            std::size_t run = 1;
+            while (i + run < current.size() && current[i + run] == previous[i + run]) {
+                ++run;
+            }
+            const auto count = static_cast<std::uint32_t>(run - 1);
+            used += 1 + varint_size(count);
+            if (used >= limit) {
+                return 0;
+            }
+            put_varint(out, 0);
+            put_varint(out, count);
+            i += run;
+        } else {
+            const auto zigzag = delta > 0 ? static_cast<std::uint32_t>(delta) << 1
+                                          : (static_cast<std::uint32_t>(-delta) << 1) - 1;
+            used += varint_size(zigzag);
+            if (used >= limit) {
+                return 0;
+            }
+            put_varint(out, zigzag);
+            ++i;
+        }
+    }
+    return static_cast<std::size_t>(out - begin);
+}
+
+std::runtime_error socket_error(const std::string& what, int error) {
+    return std::runtime_error(what + ": " + std::strerror(error));
+}
+
+// -----------------------------------------------------------------------------
+// WebSocket handshake (RFC 6455): SHA-1 of the key plus a fixed GUID, base64
+// -----------------------------------------------------------------------------
+
+std::array<std::uint8_t, 20> sha1(std::string_view message) {
+    std::array<std::uint32_t, 5> h{0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u,
+                                   0xC3D2E1F0u};
+
+    // Message, 0x80, zero padding, then the bit length big-endian in 64 bits
+    std::string data{message};
+    data += '\x80';
+    while (data.size() % 64 != 56) {
+        data += '\0';
+    }
+    const std::uint64_t bits = std::uint64_t{message.size()} * 8;
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        data += static_cast<char>((bits >> shift) & 0xFF);
+    }
+
+    for (std::size_t chunk = 0; chunk < data.size(); chunk += 64) {
+        std::array<std::uint32_t, 80> w{};
+        for (std::size_t i = 0; i < 16; ++i) {
+            for (std::size_t j = 0; j < 4; ++j) {
+                const auto byte = static_cast<unsigned char>(data[chunk + 4 * i + j]);
+                w[i] = (w[i] << 8) | std::uint32_t{byte};
+            }
+        }
+        for (std::size_t i = 16; i < 80; ++i) {
+            w[i] = std::rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        auto [a, b, c, d, e] = h;
+        for (std::size_t i = 0; i < 80; ++i) {
+            std::uint32_t f = 0;
+            std::uint32_t k = 0;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999u;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1u;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDCu;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6u;
+            }
+            const std::uint32_t next = std::rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = std::rotl(b, 30);
+            b = a;
+            a = next;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::array<std::uint8_t, 20> digest{};
+    for (std::size_t i = 0; i < 20; ++i) {
+        digest[i] = static_cast<std::uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+    }
+    return digest;
+}
+
+std::string base64(std::span<const std::uint8_t> bytes) {
+    constexpr std::string_view kAlphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string text;
+    for (std::size_t i = 0; i < bytes.size(); i += 3) {
+        const std::size_t n = std::min<std::size_t>(3, bytes.size() - i);
+        std::uint32_t group = std::uint32_t{bytes[i]} << 16;
+        if (n > 1) {
+            group |= std::uint32_t{bytes[i + 1]} << 8;
+        }
+        if (n > 2) {
+            group |= std::uint32_t{bytes[i + 2]};
+        }
+        for (std::size_t j = 0; j < 4; ++j) {
+            text += j <= n ? kAlphabet[(group >> (18 - 6 * j)) & 0x3F] : '=';
+        }
+    }
+    return text;
+}
+
+/// Returns the Sec-WebSocket-Key of an upgrade request, or empty if absent.
+std::string websocket_key(std::string_view request) {
+    constexpr std::string_view kHeader = "\r\nsec-websocket-key:";
+    for (std::size_t pos = 0; pos + kHeader.size() <= request.size(); ++pos) {
+        const auto lower = [](char expected, char actual) {
+            return expected == std::tolower(static_cast<unsigned char>(actual));
+        };
+        const bool match =
+            std::equal(kHeader.begin(), kHeader.end(), request.begin() + pos, lower);
+        if (!match) {
+            continue;
+        }
+        auto value = request.substr(pos + kHeader.size());
+        value = value.substr(0, value.find('\r'));
+        const auto first = value.find_first_not_of(" \t");
+        const auto last = value.find_last_not_of(" \t");
+        return first == std::string_view::npos ? std::string{}
+                                               : std::string{value.substr(first, last - first + 1)};
+    }
+    return {};
+}
+
+/// Appends a server-to-client (unmasked) WebSocket frame header.
+std::size_t websocket_header(std::byte* out, std::uint8_t opcode, std::size_t length) noexcept {
+    out[0] = static_cast<std::byte>(0x80 | opcode);  // FIN
+    if (length < 126) {
+        out[1] = static_cast<std::byte>(length);
+        return 2;
+    }
+    if (length <= 0xFFFF) {
+        out[1] = std::byte{126};
+        out[2] = static_cast<std::byte>(length >> 8);
+        out[3] = static_cast<std::byte>(length & 0xFF);
+        return 4;
+    }
+    out[1] = std::byte{127};
+    for (std::size_t i = 0; i < 8; ++i) {
+        out[2 + i] = static_cast<std::byte>((std::uint64_t{length} >> (56 - 8 * i)) & 0xFF);
+    }
+    return 10;
+}
+
+}  // namespace
+
+/// One WebSocket connection, before and after the upgrade.
+struct SpectrumStreamer::Client {
+    int fd = -1;
+    bool upgraded = false;
+    std::string request;                  // Handshake bytes received so far
+    std::vector<std::byte> input;         // Client frames not yet parsed
+    std::vector<std::byte> output;        // Bytes not yet accepted by the socket
+};
+
+// -----------------------------------------------------------------------------
+// Streamer
+// -----------------------------------------------------------------------------
+
+SpectrumStreamer::SpectrumStreamer(const SpectrumStreamerConfig& config)
+    : config_{config},
+      record_(kFrameHeaderSize + 2 * config.max_values),
+      previous_(config.max_values),
+      current_(config.max_values),
+      queue_{(kFrameHeaderSize + 2 * config.max_values) *
+             std::max<std::size_t>(config.queue_frames, 1)},
+      staging_(queue_.capacity()),
+      packet_(std::max(config.max_packet_bytes, kPacketHeaderSize + record_.size())) {
+    if (config_.encoding != StreamEncoding::UInt8 && config_.encoding != StreamEncoding::UInt16) {
+        throw std::invalid_argument("Unknown stream encoding");
+    }
+    if (!(config_.value_min < config_.value_max)) {
+        throw std::invalid_argument("Stream quantization needs value_min < value_max");
+    }
+    if (config_.max_values == 0 || config_.keyframe_interval == 0) {
+        throw std::invalid_argument("Stream max_values and keyframe_interval must be positive");
+    }
+    if (config_.max_packet_bytes < kPacketHeaderSize + kFrameHeaderSize) {
+        throw std::invalid_argument("Stream packets must hold at least one frame header");
+    }
+    if (config_.send_interval.count() <= 0) {
+        throw std::invalid_argument("Stream send interval must be positive");
+    }
+    if (config_.multicast_ttl < 0 || config_.multicast_ttl > 255) {
+        throw std::invalid_argument("Multicast TTL must be between 0 and 255");
+    }
+    if (config_.udp_address.empty() && !config_.websocket_port) {
+        throw std::invalid_argument("Streamer needs a UDP address or a WebSocket port");
+    }
+
+    Socket udp;
+    if (!config_.udp_address.empty()) {
+        in_addr host{};
+        if (::inet_pton(AF_INET, config_.udp_address.c_str(), &host) != 1) {
+            throw std::invalid_argument("Not an IPv4 address: " + config_.udp_address);
+        }
+        udp_host_ = host.s_addr;
+
+        udp.fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (udp.fd < 0) {
+            throw socket_error("Cannot create UDP socket", errno);
+        }
+        if ((ntohl(host.s_addr) >> 28) == 0xE) {  // 224.0.0.0/4
+            const int ttl = config_.multicast_ttl;
+            const int loop = 1;  // Let dashboards on this machine join too
+            if (::setsockopt(udp.fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0 ||
+                ::setsockopt(udp.fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0) {
+                throw socket_error("Cannot configure multicast", errno);
+            }
+        }
+    }
+
+    Socket listener;
+    if (config_.websocket_port) {
+        listener.fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listener.fd < 0) {
+            throw socket_error("Cannot create WebSocket listener", errno);
+        }
+        const int reuse = 1;
+        ::setsockopt(listener.fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(*config_.websocket_port);
+        auto* generic = reinterpret_cast<sockaddr*>(&address);
+        socklen_t length = sizeof(address);
+        if (::bind(listener.fd, generic, sizeof(address)) != 0 || ::listen(listener.fd, 16) != 0 ||
+            ::getsockname(listener.fd, generic, &length) != 0) {
+            throw socket_error("Cannot listen on WebSocket port " +
+                                   std::to_string(*config_.websocket_port),
+                               errno);
+        }
+        websocket_port_ = ntohs(address.sin_port);
+    }
+
+    udp_fd_ = std::exchange(udp.fd, -1);
+    listen_fd_ = std::exchange(listener.fd, -1);
+    sender_ = std::jthread{[this](const std::stop_token& stop) { send_loop(stop); }};
+}
+
+SpectrumStreamer::~SpectrumStreamer() {
+    close();
+}
+
+bool SpectrumStreamer::publish(const SpectrumData& frame) noexcept {
+    const std::size_t values = frame.magnitudes.size();
+    const std::size_t channels = frame.channel_count;
+    if (values == 0 || values > config_.max_values || channels == 0 || channels > 0xFFFF ||
+        values % channels != 0) {
+        ++frames_dropped_;
+        return false;
+    }
+    if (!origin_) {
+        origin_ = frame.timestamp;
+    }
+
+    const std::uint32_t top = levels(config_.encoding);
+    const float scale = static_cast<float>(top) / (config_.value_max - config_.value_min);
+    for (std::size_t i = 0; i < values; ++i) {
+        const float q = (frame.magnitudes[i] - config_.value_min) * scale;
+        current_[i] = static_cast<std::uint16_t>(
+            q > 0.0f ? (q < static_cast<float>(top) ? std::lround(q) : long{top}) : 0);
+    }
+
+    // Deltas need the receiver to hold the same previous frame
+    const auto width = static_cast<std::size_t>(config_.encoding);
+    const std::size_t raw = values * width;
+    std::byte* payload = record_.data() + kFrameHeaderSize;
+    std::size_t payload_size = 0;
+    if (config_.delta && previous_values_ == values && previous_channels_ == channels &&
+        since_keyframe_ + 1 < config_.keyframe_interval) {
+        payload_size = encode_delta(std::span{current_}.first(values),
+                                    std::span{previous_}.first(values), payload, raw);
+    }
+    const bool delta = payload_size != 0;
+    if (!delta) {
+        for (std::size_t i = 0; i < values; ++i) {
+            if (width == 1) {
+                payload[i] = static_cast<std::byte>(current_[i]);
+            } else {
+                put_le<2>(payload + 2 * i, current_[i]);
+            }
+        }
+        payload_size = raw;
+    }
+
+    const std::size_t size = kFrameHeaderSize + payload_size;
+    if (queue_.available() < size) {
+        ++frames_dropped_;
+        return false;  // The next frame is encoded against the last one queued
+    }
+
+    std::byte* out = record_.data();
+    put_le<4>(out, sequence_);
+    put_le<1>(out + 4, delta ? kDeltaFlag : std::uint8_t{0});
+    put_le<1>(out + 5, static_cast<std::uint8_t>(config_.encoding));
+    put_le<2>(out + 6, channels);
+    put_le<4>(out + 8, values / channels);
+    put_le<4>(out + 12, payload_size);
+    put_le<8>(out + 16, static_cast<std::uint64_t>(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(frame.timestamp -
+                                                                                 *origin_)
+                                .count()));
+    put_f32(out + 24, frame.rms_level);
+    put_f32(out + 28, frame.peak_level);
+
+    // Space was checked above and only this thread produces
+    queue_.try_push(std::span<const std::byte>{record_}.first(size));
+    bytes_queued_ += size;
+    ++frames_published_;
+    if (delta) {
+        ++delta_frames_;
+    }
+    since_keyframe_ = delta ? since_keyframe_ + 1 : 0;
+    previous_.swap(current_);
+    previous_values_ = values;
+    previous_channels_ = channels;
+    ++sequence_;
+    return true;
+}
+
+void SpectrumStreamer::flush() {
+    while (sender_.joinable() && bytes_drained_.load(std::memory_order_acquire) < bytes_queued_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+}
+
+void SpectrumStreamer::close() {
+    if (sender_.joinable()) {
+        sender_.request_stop();
+        sender_.join();
+    }
+    for (auto& client : clients_) {
+        close_client(client);
+    }
+    clients_.clear();
+    for (int* fd : {&udp_fd_, &listen_fd_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void SpectrumStreamer::send_loop(const std::stop_token& stop) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<pollfd> fds;
+    auto next_send = Clock::now() + config_.send_interval;
+
+    while (!stop.stop_requested()) {
+        // Sleep until the next batch is due, waking early for socket events
+        fds.clear();
+        if (listen_fd_ >= 0) {
+            fds.push_back({.fd = listen_fd_, .events = POLLIN, .revents = 0});
+        }
+        for (const auto& client : clients_) {
+            const auto events = client.output.empty() ? POLLIN : POLLIN | POLLOUT;
+            fds.push_back({.fd = client.fd, .events = static_cast<short>(events), .revents = 0});
+        }
+        const auto wait = std::chrono::ceil<std::chrono::milliseconds>(next_send - Clock::now());
+        ::poll(fds.data(), fds.size(), static_cast<int>(std::max<std::int64_t>(wait.count(), 0)));
+
+        std::size_t index = 0;
+        if (listen_fd_ >= 0 && (fds[index++].revents & POLLIN) != 0) {
+            accept_clients();
+        }
+        for (std::size_t i = 0; index < fds.size(); ++i, ++index) {
+            if (fds[index].revents != 0) {
+                service_client(clients_[i], fds[index].revents);
+            }
+        }
+        std::erase_if(clients_, [](const Client& client) { return client.fd < 0; });
+
+        if (const auto now = Clock::now(); now >= next_send) {
+            send_pending();
+            next_send = std::max(next_send + config_.send_interval, now);
+        }
+    }
+    send_pending();  // Whatever was queued before the stop
+}
+
+void SpectrumStreamer::send_pending() {
+    const std::size_t size = queue_.try_pop(std::span{staging_});
+    std::size_t used = kPacketHeaderSize;
+    std::size_t frames = 0;
+
+    const auto emit = [&] {
+        std::byte* out = packet_.data();
+        std::memcpy(out, kMagic, 4);
+        put_le<1>(out + 4, kVersion);
+        put_le<1>(out + 5, frames);
+        put_le<2>(out + 6, 0);
+        put_le<4>(out + 8, packet_sequence_++);
+        put_f32(out + 12, config_.value_min);
+        put_f32(out + 16, config_.value_max);
+        send_packet(std::span<const std::byte>{packet_}.first(used));
+        used = kPacketHeaderSize;
+        frames = 0;
+    };
+
+    // The producer pushes whole records, so the popped bytes end on a frame boundary
+    for (std::size_t pos = 0; pos < size;) {
+        const std::size_t frame = kFrameHeaderSize + get_le<4>(staging_.data() + pos + 12);
+        if (frames > 0 &&
+            (used + frame > config_.max_packet_bytes || frames == kMaxFramesPerPacket)) {
+            emit();
+        }
+        std::memcpy(packet_.data() + used, staging_.data() + pos, frame);
+        used += frame;
+        ++frames;
+        pos += frame;
+    }
+    if (frames > 0) {
+        emit();
+    }
+    bytes_drained_.fetch_add(size, std::memory_order_release);
+}
+
+void SpectrumStreamer::send_packet(std::span<const std::byte> packet) {
+    packets_sent_.fetch_add(1, std::memory_order_relaxed);
+
+    if (udp_fd_ >= 0) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = udp_host_;
+        address.sin_port = htons(config_.udp_port);
+        // Best effort: a full socket buffer or unreachable host loses the datagram
+        (void)::sendto(udp_fd_, packet.data(), packet.size(), MSG_DONTWAIT,
+                       reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    }
+
+    std::array<std::byte, 10> header{};
+    const std::size_t header_size = websocket_header(header.data(), 0x2, packet.size());
+    for (auto& client : clients_) {
+        if (!client.upgraded || client.fd < 0) {
+            continue;
+        }
+        if (client.output.size() + header_size + packet.size() > config_.client_buffer_bytes) {
+            websocket_skipped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        client.output.insert(client.output.end(), header.begin(),
+                             header.begin() + static_cast<std::ptrdiff_t>(header_size));
+        client.output.insert(client.output.end(), packet.begin(), packet.end());
+        flush_client(client);
+    }
+}
+
+void SpectrumStreamer::accept_clients() {
+    for (;;) {
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;  // EAGAIN once the backlog is empty; other errors are transient
+        }
+        if (clients_.size() >= kMaxClients) {
+            ::close(fd);
+            continue;
+        }
+        clients_.push_back(Client{.fd = fd, .upgraded = false, .request = {}, .input = {},
+                                  .output = {}});
+        clients_.back().output.reserve(config_.client_buffer_bytes);
+    }
+}
+
+void SpectrumStreamer::service_client(Client& client, short events) {
+    if ((events & (POLLERR | POLLNVAL)) != 0) {
+        close_client(client);
+        return;
+    }
+    if ((events & (POLLIN | POLLHUP)) != 0) {
+        read_client(client);
+    }
+    if (client.fd >= 0 && (events & POLLOUT) != 0) {
+        flush_client(client);
+    }
+}
+
+void SpectrumStreamer::read_client(Client& client) {
+    std::array<std::byte, 4096> buffer;
+    const auto received = ::recv(client.fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EINTR)) {
+        close_client(client);
+        return;
+    }
+    if (received < 0) {
+        return;
+    }
+    const auto bytes = std::span{buffer}.first(static_cast<std::size_t>(received));
+
+    if (!client.upgraded) {
+        for (const std::byte b : bytes) {
+            client.request += static_cast<char>(b);
+        }
+        const auto end = client.request.find("\r\n\r\n");
+        if (end == std::string::npos) {
+            if (client.request.size() > kMaxRequestBytes) {
+                close_client(client);
+            }
+            return;
+        }
+
+        const auto key = websocket_key(client.request.substr(0, end + 2));
+        std::string response;
+        if (key.empty()) {
+            response = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+        } else {
+            const auto digest = sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+            response =
+                "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                "Connection: Upgrade\r\nSec-WebSocket-Accept: " +
+                base64(digest) + "\r\n\r\n";
+        }
+        for (const char c : response) {
+            client.output.push_back(static_cast<std::byte>(c));
+        }
+        flush_client(client);
+        if (key.empty()) {
+            close_client(client);
+            return;
+        }
+        client.upgraded = true;
+        websocket_clients_.fetch_add(1, std::memory_order_relaxed);
+        client.request.clear();
+        return;
+    }
+
+    // Client frames are masked and carry nothing the stream needs: answer
+    // pings and close requests, discard the rest
+    client.input.insert(client.input.end(), bytes.begin(), bytes.end());
+    while (client.input.size() >= 2) {
+        const auto* in = client.input.data();
+        const auto opcode = std::to_integer<std::uint8_t>(in[0]) & 0x0F;
+        const auto length_code = std::to_integer<std::size_t>(in[1]) & 0x7F;
+        const bool masked = (std::to_integer<std::uint8_t>(in[1]) & 0x80) != 0;
+        const std::size_t extended = length_code == 126 ? 2 : length_code == 127 ? 8 : 0;
+        const std::size_t header = 2 + extended + (masked ? 4 : 0);
+        if (client.input.size() < header) {
+            break;
+        }
+        std::size_t length = length_code;
+        if (extended > 0) {
+            length = 0;
+            for (std::size_t i = 0; i < extended; ++i) {
+                length = (length << 8) | std::to_integer<std::size_t>(in[2 + i]);
+            }
+        }
+        if (length > kMaxClientMessage) {
+            close_client(client);
+            return;
+        }
+        if (client.input.size() < header + length) {
+            break;
+        }
+
+        if (opcode == 0x8 || opcode == 0x9) {
+            // Unmask the payload into a reply of the matching kind
+            std::array<std::byte, 10 + kMaxClientMessage> reply;
+            const auto reply_opcode = opcode == 0x8 ? std::uint8_t{0x8} : std::uint8_t{0xA};
+            const std::size_t reply_header = websocket_header(reply.data(), reply_opcode, length);
+            for (std::size_t i = 0; i < length; ++i) {
+                const auto mask = masked ? in[2 + extended + i % 4] : std::byte{0};
+                reply[reply_header + i] = in[header + i] ^ mask;
+            }
+            if (client.output.size() + reply_header + length <= config_.client_buffer_bytes) {
+                client.output.insert(client.output.end(), reply.begin(),
+                                     reply.begin() +
+                                         static_cast<std::ptrdiff_t>(reply_header + length));
+            }
+            flush_client(client);
+            if (opcode == 0x8) {
+                close_client(client);
+                return;
+            }
+        }
+        client.input.erase(client.input.begin(),
+                           client.input.begin() + static_cast<std::ptrdiff_t>(header + length));
+    }
+}
+
+void SpectrumStreamer::flush_client(Client& client) {
+    std::size_t sent = 0;
+    while (client.fd >= 0 && sent < client.output.size()) {
+        const auto written = ::send(client.fd, client.output.data() + sent,
+                                    client.output.size() - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                close_client(client);
+                return;
+            }
+            break;  // Socket buffer full: the rest waits for POLLOUT
+        }
+        sent += static_cast<std::size_t>(written);
+    }
+    client.output.erase(client.output.begin(),
+                        client.output.begin() + static_cast<std::ptrdiff_t>(sent));
+}
+
+void SpectrumStreamer::close_client(Client& client) noexcept {
+    if (client.fd < 0) {
+        return;
+    }
+    ::close(client.fd);
+    client.fd = -1;
+    client.output.clear();
+    if (client.upgraded) {
+        websocket_clients_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Decoder
+// -----------------------------------------------------------------------------
+
+std::size_t SpectrumStreamDecoder::decode(std::span<const std::byte> packet,
+                                          std::vector<StreamFrame>& frames) {
+    if (packet.size() < kPacketHeaderSize || std::memcmp(packet.data(), kMagic, 4) != 0) {
+        throw std::runtime_error("Not a spectrum stream packet");
+    }
+    if (get_le<1>(packet.data() + 4) != kVersion) {
+        throw std::runtime_error("Unsupported spectrum stream version " +
+                                 std::to_string(get_le<1>(packet.data() + 4)));
+    }
+    const std::size_t count = get_le<1>(packet.data() + 5);
+    const float value_min = get_f32(packet.data() + 12);
+    const float value_max = get_f32(packet.data() + 16);
+
+    const std::byte* in = packet.data() + kPacketHeaderSize;
+    const std::byte* const end = packet.data() + packet.size();
+    std::size_t decoded = 0;
+    for (std::size_t f = 0; f < count; ++f) {
+        if (static_cast<std::size_t>(end - in) < kFrameHeaderSize) {
+            throw std::runtime_error("Truncated spectrum stream frame");
+        }
+        const auto sequence = static_cast<std::uint32_t>(get_le<4>(in));
+        const bool delta = (get_le<1>(in + 4) & kDeltaFlag) != 0;
+        const std::size_t width = get_le<1>(in + 5);
+        const std::size_t channels = get_le<2>(in + 6);
+        const std::size_t bands = get_le<4>(in + 8);
+        const std::size_t payload_size = get_le<4>(in + 12);
+        const std::size_t values = channels * bands;
+        if ((width != 1 && width != 2) || channels == 0 || values == 0 ||
+            values > kMaxDecodedValues ||
+            payload_size > static_cast<std::size_t>(end - in) - kFrameHeaderSize ||
+            (!delta && payload_size != values * width)) {
+            throw std::runtime_error("Malformed spectrum stream frame");
+        }
+        const std::byte* payload = in + kFrameHeaderSize;
+        const std::byte* const payload_end = payload + payload_size;
+
+        StreamFrame frame;
+        frame.sequence = sequence;
+        frame.keyframe = !delta;
+        frame.channel_count = channels;
+        frame.time = std::chrono::nanoseconds{static_cast<std::int64_t>(get_le<8>(in + 16))};
+        frame.rms_level = get_f32(in + 24);
+        frame.peak_level = get_f32(in + 28);
+        in = payload_end;
+
+        if (delta) {
+            if (!sequence_ || *sequence_ + 1 != sequence || values_.size() != values ||
+                channels_ != channels) {
+                ++frames_skipped_;  // Its base frame was lost; wait for a keyframe
+                continue;
+            }
+            sequence_.reset();  // A malformed delta leaves no usable base
+            for (std::size_t i = 0; i < values;) {
+                std::uint32_t code = 0;
+                if (!get_varint(payload, payload_end, code)) {
+                    throw std::runtime_error("Truncated spectrum stream delta");
+                }
+                if (code == 0) {
+                    std::uint32_t run = 0;
+                    if (!get_varint(payload, payload_end, run) || run >= values - i) {
+                        throw std::runtime_error("Malformed spectrum stream delta");
+                    }
+                    i += std::size_t{run} + 1;
+                } else {
+                    const auto change = (code & 1) != 0 ? -static_cast<std::int64_t>(code + 1) / 2
+                                                        : static_cast<std::int64_t>(code / 2);
+                    values_[i] = static_cast<std::uint16_t>(values_[i] + change);
+                    ++i;
+                }
+            }
+        } else {
+            values_.resize(values);
+            for (std::size_t i = 0; i < values; ++i) {
+                values_[i] = static_cast<std::uint16_t>(width == 1 ? get_le<1>(payload + i)
+                                                                   : get_le<2>(payload + 2 * i));
+            }
+        }
+        channels_ = channels;
+        sequence_ = sequence;
+
+        const auto top = static_cast<float>(width == 2 ? 0xFFFF : 0xFF);
+        const float step = (value_max - value_min) / top;
+        frame.magnitudes.resize(values);
+        for (std::size_t i = 0; i < values; ++i) {
+            frame.magnitudes[i] = value_min + static_cast<float>(values_[i]) * step;
+        }
+        frames.push_back(std::move(frame));
+        ++decoded;
+    }
+    return decoded;
+}
+
+}  // namespace audiovis
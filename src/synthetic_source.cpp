@@ -0,0 +1,113 @@
+#include "audiovis/synthetic_source.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace audiovis {
+
+namespace {
+
+std::string describe(const SyntheticConfig& config) {
+    switch (config.waveform) {
+        case Waveform::Sine:
+            return "Sine " + std::to_string(config.frequency) + " Hz";
+        case Waveform::WhiteNoise:
+            return "White noise";
+        case Waveform::Sweep:
+            return "Sweep " + std::to_string(config.frequency) + "-" +
+                   std::to_string(config.end_frequency) + " Hz";
+    }
+    return "Synthetic";
+}
+
+}  // namespace
+
+SyntheticSource::SyntheticSource(const SyntheticConfig& config)
+    : OfflineSource{config.sample_rate, config.channels,
+                    static_cast<std::size_t>(config.ring_buffer_seconds *
+                                             static_cast<float>(config.sample_rate)),
+                    config.block_frames},
+      config_{config},
+      name_{describe(config)},
+      total_frames_{static_cast<std::uint64_t>(
+          std::llround(static_cast<double>(config.duration_seconds) * config.sample_rate))},
+      increment_{static_cast<double>(config.frequency) / config.sample_rate},
+      noise_state_{config.seed} {
+    const float nyquist = static_cast<float>(config.sample_rate) / 2.0f;
+    if (config.frequency <= 0.0f || config.frequency > nyquist) {
+        throw std::invalid_argument("Synthetic frequency must be in (0, Nyquist]");
+    }
+    if (config.duration_seconds < 0.0f) {
+        throw std::invalid_argument("Synthetic duration must not be negative");
+    }
+    if (config.seed == 0) {
+        throw std::invalid_argument("Synthetic noise seed must be non-zero");
+    }
+    if (config.waveform == Waveform::Sweep) {
+        if (config.end_frequency <= 0.0f || config.end_frequency > nyquist) {
+            throw std::invalid_argument("Sweep end frequency must be in (0, Nyquist]");
+        }
+        if (config.sweep_seconds <= 0.0f) {
+            throw std::invalid_argument("Sweep period must be positive");
+        }
+        sweep_samples_ = std::max<std::uint64_t>(
+            1, static_cast<std::uint64_t>(
+                   std::llround(static_cast<double>(config.sweep_seconds) * config.sample_rate)));
+        // f(n) = f0 * ratio^n reaches f1 after one period
+        sweep_ratio_ = std::pow(static_cast<double>(config.end_frequency) /
+                                    static_cast<double>(config.frequency),
+                                1.0 / static_cast<double>(sweep_samples_));
+    }
+}
+
+SyntheticSource::~SyntheticSource() {
+    stop();
+}
+
+float SyntheticSource::next_sample() noexcept {
+    const double amplitude = config_.amplitude;
+
+    if (config_.waveform == Waveform::WhiteNoise) {
+        // xorshift32: cheap, and reproducible across platforms
+        noise_state_ ^= noise_state_ << 13;
+        noise_state_ ^= noise_state_ >> 17;
+        noise_state_ ^= noise_state_ << 5;
+        const double unit = static_cast<double>(noise_state_) / 4294967296.0;  // [0, 1)
+        return static_cast<float>(amplitude * (2.0 * unit - 1.0));
+    }
+
+    const double value = amplitude * std::sin(2.0 * std::numbers::pi * phase_);
+
+    // Accumulate in double so long runs don't drift audibly off pitch
+    phase_ += increment_;
+    phase_ -= std::floor(phase_);
+    if (config_.waveform == Waveform::Sweep) {
+        if ((position_ + 1) % sweep_samples_ == 0) {
+            increment_ = static_cast<double>(config_.frequency) / config_.sample_rate;
+        } else {
+            increment_ *= sweep_ratio_;
+        }
+    }
+    return static_cast<float>(value);
+}
+
+std::size_t SyntheticSource::render(std::span<float> interleaved) {
+    const std::size_t channels = this->channels();
+    std::size_t frames = interleaved.size() / channels;
+    if (total_frames_ != 0) {
+        frames = static_cast<std::size_t>(
+            std::min<std::uint64_t>(frames, total_frames_ - position_));
+    }
+
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        const float sample = next_sample();
+        std::fill_n(interleaved.begin() + static_cast<std::ptrdiff_t>(frame * channels),
+                    channels, sample);
+        ++position_;
+    }
+    return frames;
+}
+
+}  // namespace audiovis
@@ -1,12 +1,32 @@
+#include "audiovis/audio_capture.hpp"
+#include "audiovis/frame_pacer.hpp"
+#include "audiovis/recorder.hpp"
 #include "audiovis/spectrum_analyzer.hpp"
+#include "audiovis/spectrum_streamer.hpp"
+#include "audiovis/thread_policy.hpp"
+#include "audiovis/trace.hpp"
 
+// Wide-character API (cchar_t, mvadd_wchnstr) from ncursesw
+#define NCURSES_WIDECHAR 1
+#include <langinfo.h>
 #include <ncurses.h>
 
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <clocale>
+#include <cmath>
 #include <csignal>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 namespace audiovis {
 
@@ -14,22 +34,75 @@ namespace audiovis {
 ///
 /// Renders a real-time bar graph where each bar represents a frequency band.
 /// Supports color gradients, peak indicators, and adaptive sizing to terminal
-/// dimensions. The render loop targets 60 FPS but gracefully degrades on
-/// slower terminals.
+/// dimensions.
+///
+/// Frames are paced by FramePacer against absolute deadlines at the target
+/// rate (60 FPS by default), backing off when frames keep blowing their
+/// budget. 't' shows frame-time statistics in the header; they can also be
+/// logged once a second as JSON lines.
+///
+/// The renderer remembers what each column currently shows and only redraws
+/// the cells that changed, so output per frame is proportional to how much
+/// the spectrum moved rather than to the terminal area. That keeps frame
+/// times down over SSH and on slow terminals. A full repaint happens only on
+/// start-up, resize or a band count change.
+///
+/// By default the analyzer is asked for one band per drawable column, at
+/// start-up and on every resize, so narrow terminals cost no analysis for
+/// bands that would not fit and wide ones get full detail. The new layout is
+/// built off the analysis thread; frames of the old one are shown meanwhile.
+///
+/// In UTF-8 locales bars are drawn with the U+2581-U+2588 eighth blocks, for
+/// eight times the vertical resolution of whole cells; 'g' toggles back to
+/// plain blocks. Either way every cell is written from prebuilt glyph rows
+/// with the colour baked in, one curses call per changed row of a bar.
 class TerminalRenderer {
 public:
-    TerminalRenderer() : running_{true} { init_ncurses(); }
+    /// Render loop settings.
+    struct Config {
+        PacerConfig pacing;
+        std::string telemetry_path;       // JSON lines once a second; empty to disable
+        bool fit_bands = true;            // Band count follows the terminal width
+    };
+
+    TerminalRenderer() : TerminalRenderer{Config{}} {}
+
+    explicit TerminalRenderer(Config config) : config_{std::move(config)}, running_{true} {
+        if (!config_.telemetry_path.empty()) {
+            telemetry_file_ = std::fopen(config_.telemetry_path.c_str(), "w");
+            if (telemetry_file_ == nullptr) {
+                throw std::runtime_error("Cannot open telemetry file: " + config_.telemetry_path);
+            }
+        }
+        init_ncurses();
+    }
+
+    ~TerminalRenderer() {
+        shutdown_ncurses();
+        if (telemetry_file_ != nullptr) {
+            std::fclose(telemetry_file_);
+        }
+    }
 
-    ~TerminalRenderer() { shutdown_ncurses(); }
+    TerminalRenderer(const TerminalRenderer&) = delete;
+    TerminalRenderer& operator=(const TerminalRenderer&) = delete;
 
     /// Main render loop. Blocks until user quits (q or Ctrl+C).
-    void run(SpectrumAnalyzer& analyzer) {
+    /// Every new frame is also published to `streamer`, if one is given.
+    void run(SpectrumAnalyzer& analyzer, SpectrumStreamer* streamer = nullptr) {
+        fit_bands(analyzer);
         analyzer.start();
 
-        constexpr auto frame_duration = std::chrono::milliseconds(16);  // ~60 FPS
+        using Clock = FramePacer::Clock;
+        constexpr auto kReportInterval = std::chrono::seconds(1);
+
+        FramePacer pacer{config_.pacing};
+        auto window_start = Clock::now();
 
         while (running_) {
-            auto frame_start = std::chrono::steady_clock::now();
+            pacer.wait();
+            const auto frame_start = Clock::now();
+            pacer.begin_frame(frame_start);
 
             // Handle input
             int ch = getch();
@@ -40,19 +113,38 @@ public:
             // Handle terminal resize
             if (ch == KEY_RESIZE) {
                 handle_resize();
+                fit_bands(analyzer);
             }
 
-            // Update spectrum data
-            auto data = analyzer.update();
+            // Toggle sub-cell bars
+            if ((ch == 'g' || ch == 'G') && unicode_) {
+                style_ = style_ == BarStyle::Eighths ? BarStyle::Blocks : BarStyle::Eighths;
+                full_redraw_ = true;
+            }
 
-            // Render frame
-            render(data, analyzer.audio().stats());
+            // Toggle the frame statistics overlay
+            if (ch == 't' || ch == 'T') {
+                show_stats_ = !show_stats_;
+                full_redraw_ = true;  // Swaps the title row
+            }
 
-            // Frame rate limiting
-            auto frame_end = std::chrono::steady_clock::now();
-            auto elapsed = frame_end - frame_start;
-            if (elapsed < frame_duration) {
-                std::this_thread::sleep_for(frame_duration - elapsed);
+            // Update spectrum data (reuses the frame's storage)
+            const auto analysis_start = Clock::now();
+            if (analyzer.update(data_) && streamer != nullptr) {
+                streamer->publish(data_);
+            }
+
+            // Render frame
+            const auto render_start = Clock::now();
+            render(data_, analyzer.audio().stats());
+            const auto frame_end = Clock::now();
+            pacer.end_frame(frame_end, render_start - analysis_start, frame_end - render_start);
+
+            // Publish the finished window
+            if (frame_end - window_start >= kReportInterval) {
+                report(pacer.window());
+                pacer.reset_window();
+                window_start = frame_end;
             }
         }
 
@@ -63,6 +155,11 @@ public:
 
 private:
     void init_ncurses() {
+        // Wide glyphs need the user's locale; eighth blocks only if it is UTF-8
+        std::setlocale(LC_ALL, "");
+        unicode_ = std::strcmp(nl_langinfo(CODESET), "UTF-8") == 0;
+        style_ = unicode_ ? BarStyle::Eighths : BarStyle::Blocks;
+
         initscr();
         cbreak();
         noecho();
@@ -95,159 +192,719 @@ private:
         endwin();
         refresh();
         getmaxyx(stdscr, term_height_, term_width_);
+        full_redraw_ = true;
     }
 
-    void render(const SpectrumData& data, const AudioStats& stats) {
+    /// With fit_bands, asks the analyzer for one band per drawable column.
+    void fit_bands(SpectrumAnalyzer& analyzer) const {
+        const int viz_width = term_width_ - 2;  // As render()
+        if (config_.fit_bands && viz_width >= kMinVizWidth) {
+            analyzer.fit_bands(static_cast<std::size_t>(viz_width));
+        }
+    }
+
+    /// How bars are drawn.
+    enum class BarStyle {
+        Blocks,   // One full block per cell
+        Eighths   // U+2581-U+2588: 8 steps per cell
+    };
+
+    /// What is currently on screen for one bar column.
+    struct Column {
+        int bar = 0;        // Bar height in units (cells, or eighths of a cell)
+        int peak = -1;      // Row of the drawn peak marker, -1 if none
+    };
+
+    static constexpr int kHeaderLines = 2;
+    static constexpr int kFooterLines = 2;
+    static constexpr int kMinVizWidth = 10;  // Narrower shows "Terminal too small"
+    static constexpr int kPeakPair = 6;
+    static constexpr int kLevels = 8;        // Eighths per cell
+    static constexpr int kPeakCell = kLevels + 1;
+
+    [[nodiscard]] int units_per_cell() const noexcept {
+        return style_ == BarStyle::Eighths ? kLevels : 1;
+    }
+
+    /// Returns a `width`-cell row of one glyph in a colour pair.
+    static std::vector<cchar_t> glyph_row(wchar_t glyph, attr_t attrs, short pair, int width) {
+        const std::array<wchar_t, 2> text{glyph, L'\0'};
+        cchar_t cell{};
+        setcchar(&cell, text.data(), attrs, pair, nullptr);
+        return std::vector<cchar_t>(static_cast<std::size_t>(width), cell);
+    }
+
+    /// Same for a line-drawing character, which curses maps for the terminal.
+    static std::vector<cchar_t> glyph_row(const cchar_t* acs, attr_t attrs, short pair,
+                                          int width) {
+        std::array<wchar_t, CCHARW_MAX> text{};
+        attr_t acs_attrs = 0;
+        short acs_pair = 0;
+        getcchar(acs, text.data(), &acs_attrs, &acs_pair, nullptr);
+        cchar_t cell{};
+        setcchar(&cell, text.data(), acs_attrs | attrs, pair, nullptr);
+        return std::vector<cchar_t>(static_cast<std::size_t>(width), cell);
+    }
+
+    /// Prebuilds every row a bar cell can show: blank, each fill level in each
+    /// gradient colour, and the peak marker.
+    void build_glyphs() {
+        blank_row_ = glyph_row(L' ', A_NORMAL, 0, bar_width_);
+        peak_row_ = glyph_row(WACS_HLINE, has_color_ ? A_BOLD : A_NORMAL,
+                              has_color_ ? kPeakPair : 0, bar_width_);
+        for (std::size_t zone = 0; zone < level_rows_.size(); ++zone) {
+            const auto pair = static_cast<short>(has_color_ ? zone + 1 : 0);
+            auto& rows = level_rows_[zone];
+            rows[0] = blank_row_;
+            if (style_ == BarStyle::Eighths) {
+                for (int level = 1; level <= kLevels; ++level) {
+                    rows[static_cast<std::size_t>(level)] = glyph_row(
+                        static_cast<wchar_t>(0x2580 + level), A_NORMAL, pair, bar_width_);
+                }
+            } else {
+                rows[kLevels] = glyph_row(WACS_BLOCK, A_NORMAL, pair, bar_width_);
+            }
+        }
+    }
+
+    /// Clears the screen and draws the static chrome. Every column then
+    /// starts out empty, so the next delta pass paints whole bars.
+    void redraw_frame(std::size_t num_bands, int viz_height, int viz_width) {
         erase();
 
-        // Reserve space for header and footer
-        constexpr int header_lines = 2;
-        constexpr int footer_lines = 2;
-        const int viz_height = term_height_ - header_lines - footer_lines;
+        if (!show_stats_) {
+            attron(A_BOLD);
+            mvprintw(0, (term_width_ - 17) / 2, "SPECTRUM ANALYZER");
+            attroff(A_BOLD);
+        }
+        mvhline(1, 0, ACS_HLINE, term_width_);
+        mvhline(term_height_ - kFooterLines, 0, ACS_HLINE, term_width_);
+        mvprintw(term_height_ - 1, keys_x(), "%s", keys_label());
+
+        // Bar layout, with gaps if we have room
+        const auto total_bar_space = static_cast<std::size_t>(viz_width);
+        bar_width_ = static_cast<int>(std::max(std::size_t{1}, total_bar_space / num_bands));
+        gap_ = 0;
+        if (bar_width_ >= 3) {
+            gap_ = 1;
+            const auto usable_space = total_bar_space - (num_bands - 1);
+            bar_width_ = static_cast<int>(std::max(std::size_t{1}, usable_space / num_bands));
+        }
+
+        // Gradient from blue (quiet) to red (loud) by cell row
+        row_zone_.resize(static_cast<std::size_t>(viz_height));
+        for (int y = 0; y < viz_height; ++y) {
+            const float height_ratio = static_cast<float>(y) / static_cast<float>(viz_height - 1);
+            row_zone_[static_cast<std::size_t>(y)] = height_ratio > 0.9f   ? 4   // Red (loud)
+                                                     : height_ratio > 0.7f ? 3   // Yellow
+                                                     : height_ratio > 0.5f ? 2   // Green
+                                                     : height_ratio > 0.3f ? 1   // Cyan
+                                                                           : 0;  // Blue
+        }
+        build_glyphs();
+
+        columns_.assign(num_bands, Column{});
+        layout_bands_ = num_bands;
+        layout_height_ = viz_height;
+        layout_width_ = term_width_;
+        footer_.clear();
+        stats_shown_.clear();
+        full_redraw_ = false;
+    }
+
+    /// Key help shown at the right of the footer.
+    [[nodiscard]] const char* keys_label() const noexcept {
+        return unicode_ ? "[g] Bars  [t] Stats  [q] Quit" : "[t] Stats  [q] Quit";
+    }
+
+    [[nodiscard]] int keys_x() const noexcept {
+        return term_width_ - 7 - static_cast<int>(std::strlen(keys_label()));
+    }
+
+    /// Shows a centered message in place of the bars.
+    void show_message(int y, const char* message) {
+        erase();
+        mvprintw(y, std::max(0, (term_width_ - static_cast<int>(std::strlen(message))) / 2), "%s",
+                 message);
+        refresh();
+        full_redraw_ = true;  // Bars must be repainted from scratch afterwards
+    }
+
+    [[nodiscard]] int column_x(std::size_t index) const {
+        return 1 + static_cast<int>(index) * (bar_width_ + gap_);
+    }
+
+    /// What one cell of a column shows: a fill level 0..kLevels, or kPeakCell.
+    [[nodiscard]] int cell_content(const Column& column, int row) const noexcept {
+        if (row == column.peak) {
+            return kPeakCell;
+        }
+        const int units = units_per_cell();
+        const int fill = std::clamp(column.bar - row * units, 0, units);
+        return fill * (kLevels / units);  // Whole blocks render as the full level
+    }
+
+    /// Updates only the cells that changed since the previous frame: rows a
+    /// bar grew or shrank through, and old and new peak rows. Each changed
+    /// cell is one mvadd_wchnstr of a prebuilt, pre-coloured glyph row, so no
+    /// attributes are toggled while drawing.
+    void render(const SpectrumData& data, const AudioStats& stats) {
+        AUDIOVIS_TRACE_SCOPE(Render);
+        const int viz_height = term_height_ - kHeaderLines - kFooterLines;
         const int viz_width = term_width_ - 2;  // 1 char margin each side
 
-        if (viz_height < 3 || viz_width < 10) {
-            mvprintw(0, 0, "Terminal too small");
-            refresh();
+        if (viz_height < 3 || viz_width < kMinVizWidth) {
+            show_message(0, "Terminal too small");
             return;
         }
 
-        // Header
-        attron(A_BOLD);
-        mvprintw(0, (term_width_ - 17) / 2, "SPECTRUM ANALYZER");
-        attroff(A_BOLD);
-        mvhline(1, 0, ACS_HLINE, term_width_);
-
-        // Calculate bar width and spacing
-        const auto num_bands = data.magnitudes.size();
+        // Multi-channel frames show the first spectrum
+        const auto magnitudes = data.channel_magnitudes(0);
+        const auto peaks = data.channel_peaks(0);
+        const auto num_bands = data.band_count();
         if (num_bands == 0) {
-            mvprintw(header_lines + viz_height / 2, (term_width_ - 20) / 2, "Waiting for audio...");
-            refresh();
+            show_message(kHeaderLines + viz_height / 2, "Waiting for audio...");
             return;
         }
 
-        // Determine bar layout
-        const auto total_bar_space = static_cast<std::size_t>(viz_width);
-        int bar_width = static_cast<int>(std::max(std::size_t{1}, total_bar_space / num_bands));
-        int gap = 0;
-
-        // Add gaps if we have room
-        if (bar_width >= 3) {
-            gap = 1;
-            const auto usable_space = total_bar_space - (num_bands - 1);
-            bar_width = static_cast<int>(std::max(std::size_t{1}, usable_space / num_bands));
-        }
-
-        // Render bars
-        const int base_y = header_lines + viz_height - 1;
-        int x = 1;  // Start with margin
-
-        for (std::size_t i = 0; i < num_bands && x + bar_width <= term_width_ - 1; ++i) {
-            const float magnitude = std::clamp(data.magnitudes[i], 0.0f, 1.0f);
-            const float peak = std::clamp(data.peaks[i], 0.0f, 1.0f);
-
-            const int bar_height = static_cast<int>(magnitude * static_cast<float>(viz_height - 1));
-            const int peak_y = static_cast<int>(peak * static_cast<float>(viz_height - 1));
-
-            // Draw bar from bottom up
-            for (int y = 0; y < bar_height; ++y) {
-                // Color based on height (gradient from blue to red)
-                int color_pair = 1;
-                if (has_color_) {
-                    const float height_ratio =
-                        static_cast<float>(y) / static_cast<float>(viz_height - 1);
-                    if (height_ratio > 0.9f)
-                        color_pair = 5;  // Red (loud)
-                    else if (height_ratio > 0.7f)
-                        color_pair = 4;  // Yellow
-                    else if (height_ratio > 0.5f)
-                        color_pair = 3;  // Green
-                    else if (height_ratio > 0.3f)
-                        color_pair = 2;  // Cyan
-                    else
-                        color_pair = 1;  // Blue (quiet)
-
-                    attron(COLOR_PAIR(color_pair));
-                }
-
-                // Draw bar segment
-                for (int bx = 0; bx < bar_width; ++bx) {
-                    mvaddch(base_y - y, x + bx, ACS_BLOCK);
-                }
+        if (full_redraw_ || num_bands != layout_bands_ || viz_height != layout_height_ ||
+            term_width_ != layout_width_) {
+            redraw_frame(num_bands, viz_height, viz_width);
+        }
 
-                if (has_color_) {
-                    attroff(COLOR_PAIR(color_pair));
-                }
+        const int units = units_per_cell();
+        const int base_y = kHeaderLines + viz_height - 1;
+        const auto scale = static_cast<float>((viz_height - 1) * units);
+
+        // Columns past the right edge are never drawn
+        for (std::size_t i = 0; i < num_bands && column_x(i) + bar_width_ <= term_width_ - 1;
+             ++i) {
+            const float magnitude = std::clamp(magnitudes[i], 0.0f, 1.0f);
+            const float peak = std::clamp(peaks[i], 0.0f, 1.0f);
+
+            Column now;
+            now.bar = static_cast<int>(magnitude * scale);
+            // A marker shows only clear of the bar, in a cell it leaves empty
+            const int peak_row = static_cast<int>(peak * scale) / units;
+            if (peak_row * units > now.bar && peak_row < viz_height) {
+                now.peak = peak_row;
             }
 
-            // Draw peak indicator
-            if (peak_y > bar_height && peak_y < viz_height) {
-                if (has_color_) {
-                    attron(COLOR_PAIR(6) | A_BOLD);
-                }
-                for (int bx = 0; bx < bar_width; ++bx) {
-                    mvaddch(base_y - peak_y, x + bx, ACS_HLINE);
-                }
-                if (has_color_) {
-                    attroff(COLOR_PAIR(6) | A_BOLD);
+            const Column& old = columns_[i];
+            const int x = column_x(i);
+            const auto update_cell = [&](int row) {
+                const int content = cell_content(now, row);
+                if (row < 0 || row >= viz_height || content == cell_content(old, row)) {
+                    return;
                 }
+                const auto& glyphs =
+                    content == kPeakCell
+                        ? peak_row_
+                        : level_rows_[static_cast<std::size_t>(
+                              row_zone_[static_cast<std::size_t>(row)])]
+                                     [static_cast<std::size_t>(content)];
+                mvadd_wchnstr(base_y - row, x, glyphs.data(), bar_width_);
+            };
+
+            // Rows between the old and new bar tops, then both peak rows
+            const int first = std::min(old.bar, now.bar) / units;
+            const int last = std::min((std::max(old.bar, now.bar) + units - 1) / units,
+                                      viz_height) - 1;
+            for (int row = first; row <= last; ++row) {
+                update_cell(row);
             }
-
-            x += bar_width + gap;
+            if (old.peak >= 0 && (old.peak < first || old.peak > last)) {
+                update_cell(old.peak);
+            }
+            if (now.peak >= 0 && now.peak != old.peak && (now.peak < first || now.peak > last)) {
+                update_cell(now.peak);
+            }
+            columns_[i] = now;
         }
 
-        // Footer separator
-        mvhline(term_height_ - footer_lines, 0, ACS_HLINE, term_width_);
+        render_footer(data, stats);
+        render_stats();
+        AUDIOVIS_TRACE_SCOPE(Draw);
+        refresh();
+    }
+
+    /// Rewrites the footer fields only when their text changed.
+    void render_footer(const SpectrumData& data, const AudioStats& stats) {
+        std::array<char, 160> text{};
+        std::snprintf(
+            text.data(), text.size(),
+            "RMS: %.2f  Peak: %.2f  Captured: %lluk  Overruns: %llu  Interval p99: %lldus",
+            static_cast<double>(data.rms_level), static_cast<double>(data.peak_level),
+            static_cast<unsigned long long>(stats.frames_captured / 1000),
+            static_cast<unsigned long long>(stats.overruns),
+            static_cast<long long>(stats.callback_interval.percentile(0.99).count()));
+
+        // Stop short of the key help
+        update_text(term_height_ - 1, 1, text.data(), keys_x() - 2, footer_);
+    }
+
+    /// Publishes one telemetry window: refreshes the overlay text and appends
+    /// a JSON line to the telemetry file, with per-stage timings when tracing
+    /// is compiled in.
+    void report(const FrameTelemetry& telemetry) {
+        const auto us = [](const LatencyHistogram& histogram, double q) {
+            return static_cast<long long>(histogram.percentile(q).count());
+        };
+        std::array<char, 160> text{};
+        std::snprintf(text.data(), text.size(),
+                      "%.0f fps  Analysis %lld/%lldus  Render %lld/%lldus  Jitter %lld/%lldus  "
+                      "Dropped %llu",
+                      telemetry.fps, us(telemetry.analysis, 0.5), us(telemetry.analysis, 0.99),
+                      us(telemetry.render, 0.5), us(telemetry.render, 0.99),
+                      us(telemetry.jitter, 0.5), us(telemetry.jitter, 0.99),
+                      static_cast<unsigned long long>(telemetry.dropped));
+        stats_text_ = text.data();
+
+        auto json = to_json(telemetry);
+        if constexpr (Tracer::kCompiledIn) {
+            // Rolled every window, so the stage histograms cover the same second
+            json.pop_back();
+            json += ",\"trace\":" + to_json(Tracer::instance().roll()) + "}";
+        }
+        if (telemetry_file_ != nullptr) {
+            std::fprintf(telemetry_file_, "%s\n", json.c_str());
+            std::fflush(telemetry_file_);
+        }
+    }
 
-        // Footer info
-        mvprintw(term_height_ - 1, 1, "RMS: %.2f  Peak: %.2f  Captured: %lluk  Overruns: %llu",
-                 static_cast<double>(data.rms_level), static_cast<double>(data.peak_level),
-                 static_cast<unsigned long long>(stats.frames_captured / 1000),
-                 static_cast<unsigned long long>(stats.overruns));
+    /// Frame statistics (p50/p99) in place of the title, when enabled.
+    void render_stats() {
+        if (show_stats_) {
+            update_text(0, 1, stats_text_.c_str(), term_width_ - 2, stats_shown_);
+        }
+    }
 
-        mvprintw(term_height_ - 1, term_width_ - 15, "[q] Quit");
+    /// Writes `text` at (y, x), clipped to `limit` cells, only if it differs
+    /// from `shown`, padding over whatever longer text was there before.
+    static void update_text(int y, int x, const char* text, int limit, std::string& shown) {
+        const auto cells = static_cast<std::size_t>(std::max(0, limit));
+        std::string line{text, std::min(std::strlen(text), cells)};
+        if (line == shown) {
+            return;
+        }
 
-        refresh();
+        const auto written = line.size();
+        if (shown.size() > written) {
+            line.append(shown.size() - written, ' ');
+        }
+        mvaddstr(y, x, line.c_str());
+        line.resize(written);
+        shown = std::move(line);
     }
 
+    Config config_;
+    std::FILE* telemetry_file_ = nullptr;
     bool running_;
     bool has_color_ = false;
+    SpectrumData data_;
     int term_width_ = 0;
     int term_height_ = 0;
+
+    // What the screen currently shows, so each frame draws only the deltas
+    bool full_redraw_ = true;
+    std::size_t layout_bands_ = 0;
+    int layout_height_ = 0;
+    int layout_width_ = 0;
+    int bar_width_ = 1;
+    int gap_ = 0;
+    std::vector<int> row_zone_;               // Gradient zone of each cell row
+    std::vector<Column> columns_;
+    std::string footer_;
+    std::string stats_shown_;
+
+    // Frame statistics overlay
+    bool show_stats_ = false;
+    std::string stats_text_;                  // Latest window, formatted
+
+    // Sub-cell glyphs
+    bool unicode_ = false;                    // Locale can display eighth blocks
+    BarStyle style_ = BarStyle::Blocks;
+    std::array<std::array<std::vector<cchar_t>, kLevels + 1>, 5> level_rows_;  // [zone][level]
+    std::vector<cchar_t> blank_row_;
+    std::vector<cchar_t> peak_row_;
 };
 
 }  // namespace audiovis
 
 // Global renderer pointer for signal handling
 static audiovis::TerminalRenderer* g_renderer = nullptr;
+static volatile std::sig_atomic_t g_stop_requested = 0;  // For headless recording
 
 static void signal_handler(int /*signum*/) {
+    g_stop_requested = 1;
     if (g_renderer != nullptr) {
         g_renderer->stop();
     }
 }
 
-int main() {
+static void print_usage(const char* program) {
+    std::fprintf(stderr,
+                 "Usage: %s [--fps N] [--telemetry FILE] [--rt-priority N]\n"
+                 "          [--analysis-cpus LIST] [--render-cpus LIST] [--lock-memory]\n"
+                 "          [--publish ADDR:PORT] [--websocket PORT] [--stream-bits 8|16]\n"
+                 "          [--track LIST] [--bands N] [--huge-pages] [--numa-node N]\n"
+                 "          [--trace FILE] [--sample-rate N] [--channels N]\n"
+                 "          [--record PREFIX [--record-seconds N] [--record-mb N]]\n"
+                 "  --fps N                Target frame rate (default 60)\n"
+                 "  --telemetry FILE       Append frame timing as JSON lines, once a second\n"
+                 "  --rt-priority N        Run the analysis thread SCHED_FIFO at priority N\n"
+                 "  --analysis-cpus LIST   Pin the analysis thread, e.g. 2 or 2-3,6\n"
+                 "  --render-cpus LIST     Pin the render thread\n"
+                 "  --lock-memory          Lock all pages into RAM (mlockall)\n"
+                 "  --publish ADDR:PORT    Stream frames over UDP (multicast group or host)\n"
+                 "  --websocket PORT       Serve frames to WebSocket clients on PORT\n"
+                 "  --stream-bits 8|16     Quantization of streamed magnitudes (default 8)\n"
+                 "  --track LIST           Show only these frequencies (Hz), e.g. 50,100,150\n"
+                 "  --bands N              Fixed band count (default: one per column)\n"
+                 "  --huge-pages           Back capture rings and FFT buffers with 2 MiB pages\n"
+                 "  --numa-node N          Bind capture rings and FFT buffers to NUMA node N\n"
+                 "  --trace FILE           Write per-stage timings as Chrome trace JSON on exit\n"
+                 "                         (needs a build with -DAUDIOVIS_ENABLE_TRACING=ON)\n"
+                 "  --sample-rate N        Capture rate in Hz (default 48000)\n"
+                 "  --channels N           Capture channels (default 1)\n"
+                 "  --record PREFIX        Record to PREFIX-0001.wav, ... without the display\n"
+                 "  --record-seconds N     Start a new file every N seconds\n"
+                 "  --record-mb N          Start a new file every N MiB\n",
+                 program);
+}
+
+/// Everything the command line controls.
+struct Options {
+    audiovis::TerminalRenderer::Config renderer;
+    audiovis::ThreadPolicy analysis_policy;
+    audiovis::ThreadPolicy render_policy;
+    bool lock_memory = false;
+    audiovis::SpectrumStreamerConfig stream{.udp_address = ""};
+    std::vector<float> tracked_frequencies;
+    std::size_t num_bands = 64;           // Until the renderer fits them to its width
+    audiovis::BufferPolicy buffers;
+    std::string trace_path;
+    std::uint32_t sample_rate = 48000;
+    std::uint32_t channels = 1;
+    audiovis::RecorderConfig record{.path_prefix = ""};  // Headless when a prefix is given
+};
+
+// Parses a port number 1-65535; false if malformed
+static bool parse_port(const char* text, std::uint16_t& port) {
+    char* end = nullptr;
+    const unsigned long value = std::strtoul(text, &end, 10);
+    if (end == text || *end != '\0' || value == 0 || value > 65535) {
+        return false;
+    }
+    port = static_cast<std::uint16_t>(value);
+    return true;
+}
+
+// Parses "2", "0-3" or "1,4-5" into core indices; false if malformed
+static bool parse_cpu_list(const char* text, std::vector<unsigned>& cpus) {
+    const char* p = text;
+    for (;;) {
+        char* end = nullptr;
+        const unsigned long first = std::strtoul(p, &end, 10);
+        if (end == p || first > 4095) {
+            return false;
+        }
+        unsigned long last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = std::strtoul(p, &end, 10);
+            if (end == p || last < first || last > 4095) {
+                return false;
+            }
+        }
+        for (unsigned long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<unsigned>(cpu));
+        }
+        if (*end == '\0') {
+            return true;
+        }
+        if (*end != ',') {
+            return false;
+        }
+        p = end + 1;
+    }
+}
+
+// Parses "50,100,150.5" into frequencies; false if malformed
+static bool parse_frequency_list(const char* text, std::vector<float>& frequencies) {
+    const char* p = text;
+    for (;;) {
+        char* end = nullptr;
+        const float frequency = std::strtof(p, &end);
+        if (end == p || !(frequency > 0.0f)) {
+            return false;
+        }
+        frequencies.push_back(frequency);
+        if (*end == '\0') {
+            return true;
+        }
+        if (*end != ',') {
+            return false;
+        }
+        p = end + 1;
+    }
+}
+
+// Parses command-line options; false on bad usage
+static bool parse_options(int argc, char** argv, Options& options) {
+    auto& config = options.renderer;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--lock-memory") {
+            options.lock_memory = true;
+            continue;
+        }
+        if (arg == "--huge-pages") {
+            options.buffers.huge_pages = true;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--fps") {
+            char* end = nullptr;
+            const double fps = std::strtod(value, &end);
+            if (end == value || *end != '\0' || !(fps > 0.0) || fps > 1000.0) {
+                return false;
+            }
+            config.pacing.target_fps = fps;
+            config.pacing.min_fps = std::min(config.pacing.min_fps, fps);
+        } else if (arg == "--telemetry") {
+            config.telemetry_path = value;
+        } else if (arg == "--rt-priority") {
+            char* end = nullptr;
+            const long priority = std::strtol(value, &end, 10);
+            if (end == value || *end != '\0' || priority < 1 || priority > 99) {
+                return false;
+            }
+            options.analysis_policy.scheduling = audiovis::SchedulingClass::Fifo;
+            options.analysis_policy.priority = static_cast<int>(priority);
+        } else if (arg == "--analysis-cpus") {
+            if (!parse_cpu_list(value, options.analysis_policy.cpus)) {
+                return false;
+            }
+        } else if (arg == "--render-cpus") {
+            if (!parse_cpu_list(value, options.render_policy.cpus)) {
+                return false;
+            }
+        } else if (arg == "--publish") {
+            const char* colon = std::strrchr(value, ':');
+            if (colon == nullptr || !parse_port(colon + 1, options.stream.udp_port)) {
+                return false;
+            }
+            options.stream.udp_address.assign(value, colon);
+        } else if (arg == "--websocket") {
+            std::uint16_t port = 0;
+            if (!parse_port(value, port)) {
+                return false;
+            }
+            options.stream.websocket_port = port;
+        } else if (arg == "--stream-bits") {
+            const std::string bits = value;
+            if (bits != "8" && bits != "16") {
+                return false;
+            }
+            options.stream.encoding = bits == "8" ? audiovis::StreamEncoding::UInt8
+                                                  : audiovis::StreamEncoding::UInt16;
+        } else if (arg == "--numa-node") {
+            char* end = nullptr;
+            const unsigned long node = std::strtoul(value, &end, 10);
+            if (end == value || *end != '\0' || node > 1023) {
+                return false;
+            }
+            options.buffers.placement = audiovis::MemoryPlacement::Bind;
+            options.buffers.numa_node = static_cast<unsigned>(node);
+        } else if (arg == "--trace") {
+            options.trace_path = value;
+        } else if (arg == "--bands") {
+            char* end = nullptr;
+            const unsigned long bands = std::strtoul(value, &end, 10);
+            if (end == value || *end != '\0' || bands == 0 || bands > 4096) {
+                return false;
+            }
+            options.num_bands = bands;
+            config.fit_bands = false;
+        } else if (arg == "--track") {
+            if (!parse_frequency_list(value, options.tracked_frequencies)) {
+                return false;
+            }
+        } else if (arg == "--sample-rate") {
+            char* end = nullptr;
+            const unsigned long rate = std::strtoul(value, &end, 10);
+            if (end == value || *end != '\0' || rate < 8000 || rate > 384000) {
+                return false;
+            }
+            options.sample_rate = static_cast<std::uint32_t>(rate);
+        } else if (arg == "--channels") {
+            char* end = nullptr;
+            const unsigned long channels = std::strtoul(value, &end, 10);
+            if (end == value || *end != '\0' || channels == 0 || channels > 64) {
+                return false;
+            }
+            options.channels = static_cast<std::uint32_t>(channels);
+        } else if (arg == "--record") {
+            if (*value == '\0') {
+                return false;
+            }
+            options.record.path_prefix = value;
+        } else if (arg == "--record-seconds") {
+            char* end = nullptr;
+            const double seconds = std::strtod(value, &end);
+            if (end == value || *end != '\0' || !(seconds > 0.0) || !std::isfinite(seconds)) {
+                return false;
+            }
+            options.record.max_file_seconds = seconds;
+        } else if (arg == "--record-mb") {
+            char* end = nullptr;
+            const unsigned long mb = std::strtoul(value, &end, 10);
+            if (end == value || *end != '\0' || mb == 0 || mb > 4095) {
+                return false;
+            }
+            options.record.max_file_bytes = std::uint64_t{mb} << 20;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Records the capture stream until SIGINT/SIGTERM, with no display or analysis
+static int run_recorder(Options& options) {
+    // Seconds of capture the broadcast ring holds on top of the recorder's blocks
+    constexpr std::size_t kRingSeconds = 4;
+
+    // Nothing analyzes here, so the callback feeds the broadcast ring alone
+    audiovis::AudioCapture capture{{.sample_rate = options.sample_rate,
+                                     .buffer_frames = 512,
+                                     .channels = options.channels,
+                                     .ring_buffers = options.buffers,
+                                     .channel_rings = false}};
+    const auto& ring = capture.enable_broadcast(kRingSeconds * options.sample_rate);
+    options.record.buffers = options.buffers;
+    audiovis::Recorder recorder{ring, options.sample_rate, options.record};
+
+    if (options.lock_memory) {
+        const auto lock = audiovis::lock_process_memory();
+        std::fprintf(stderr, "Memory: %s\n", lock.locked ? "locked" : lock.notes.c_str());
+    }
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+    capture.start();
+    std::fprintf(stderr, "Recording %u channel(s) at %u Hz from %s to %s; %s, %.1f s buffered\n",
+                 options.channels, options.sample_rate, capture.name().c_str(),
+                 audiovis::Recorder::file_path(options.record.path_prefix, 1).c_str(),
+                 recorder.direct_io() ? "direct I/O" : "buffered I/O",
+                 recorder.buffered_seconds());
+
+    // Losses either side of the broadcast ring: the device dropping input,
+    // and the recorder being lapped
+    const auto report = [&](const char* end) {
+        std::fprintf(stderr,
+                     "\r%.1f s in %llu file(s), %llu input overflows, %llu frames lost, "
+                     "longest write %.1f ms%s",
+                     static_cast<double>(recorder.frames_written()) / options.sample_rate,
+                     static_cast<unsigned long long>(recorder.files()),
+                     static_cast<unsigned long long>(capture.stats().input_overflows),
+                     static_cast<unsigned long long>(recorder.frames_lost()),
+                     static_cast<double>(recorder.max_write_time().count()) / 1000.0, end);
+    };
+    while (g_stop_requested == 0 && !recorder.failed()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{250});
+        report("");
+    }
+
+    capture.stop();
+    recorder.close();  // Throws if a write failed
+    report("\n");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    if (!options.trace_path.empty() && !audiovis::Tracer::kCompiledIn) {
+        std::fprintf(stderr, "--trace needs a build with -DAUDIOVIS_ENABLE_TRACING=ON\n");
+        return 2;
+    }
+
     try {
+        if (!options.record.path_prefix.empty()) {
+            return run_recorder(options);
+        }
+
         // Configure analyzer with reasonable defaults
-        audiovis::AudioConfig audio_cfg{
-            .sample_rate = 48000, .buffer_frames = 512, .channels = 1, .ring_buffer_seconds = 0.5f};
+        audiovis::AudioConfig audio_cfg{.sample_rate = options.sample_rate,
+                                        .buffer_frames = 512,
+                                        .channels = options.channels,
+                                        .ring_buffer_seconds = 0.5f,
+                                        .ring_buffers = options.buffers};
+
+        // Measured plans are cached across launches, so only the first run pays
+        audiovis::load_fftw_wisdom(audiovis::default_wisdom_path());
 
         audiovis::FFTConfig fft_cfg{.fft_size = 2048,
                                     .window = audiovis::WindowFunction::Hann,
                                     .use_magnitude_db = true,
                                     .db_floor = -60.0f,
-                                    .db_ceiling = 0.0f};
+                                    .db_ceiling = 0.0f,
+                                    .planner = audiovis::PlannerRigor::Measure,
+                                    .buffers = options.buffers};
 
-        audiovis::AnalyzerConfig analyzer_cfg{.num_bands = 64,
+        using audiovis::BandWeighting;
+        using audiovis::FrequencyScale;
+        audiovis::AnalyzerConfig analyzer_cfg{.num_bands = options.num_bands,
                                               .min_frequency = 20.0f,
                                               .max_frequency = 16000.0f,
                                               .smoothing_factor = 0.6f,
                                               .peak_decay_rate = 0.92f,
-                                              .logarithmic_frequency = true};
-
+                                              .frequency_scale = FrequencyScale::Logarithmic,
+                                              .band_weighting = BandWeighting::Fractional,
+                                              .hop_size = 512,  // 75% overlap
+                                              .use_worker_thread = true,
+                                              .worker_policy = options.analysis_policy,
+                                              .tracked_frequencies =
+                                                  std::move(options.tracked_frequencies)};
+
+        // Validate both thread policies before anything starts
+        audiovis::validate(options.render_policy);
         audiovis::SpectrumAnalyzer analyzer{audio_cfg, fft_cfg, analyzer_cfg};
-        audiovis::TerminalRenderer renderer;
+        if (options.buffers != audiovis::BufferPolicy{}) {
+            const auto& storage = analyzer.audio().buffer().storage();
+            const std::string notes = storage.notes().empty() ? "" : " (" + storage.notes() + ")";
+            std::fprintf(stderr, "Capture rings: %s%s%s\n",
+                         storage.huge_pages() ? "hugepages" : "ordinary pages",
+                         storage.bound() ? ", NUMA-bound" : "", notes.c_str());
+        }
+
+        // Every ring, FFT buffer and plan exists now; pin them before the
+        // real-time threads start touching them
+        if (options.lock_memory) {
+            const auto lock = audiovis::lock_process_memory();
+            std::fprintf(stderr, "Memory: %s\n", lock.locked ? "locked" : lock.notes.c_str());
+        }
+        analyzer.start();
+        const auto render = audiovis::apply_thread_policy(options.render_policy);
+        std::fprintf(stderr, "Analysis thread: %s\nRender thread: %s\n",
+                     audiovis::describe(analyzer.worker_policy_applied()).c_str(),
+                     audiovis::describe(render).c_str());
+
+        // Open the sockets before ncurses takes the screen, so errors stay readable
+        std::unique_ptr<audiovis::SpectrumStreamer> streamer;
+        if (!options.stream.udp_address.empty() || options.stream.websocket_port) {
+            streamer = std::make_unique<audiovis::SpectrumStreamer>(options.stream);
+        }
+
+        audiovis::TerminalRenderer renderer{std::move(options.renderer)};
+        audiovis::Tracer::instance().set_capture(!options.trace_path.empty());
 
         // Set up signal handling for clean shutdown
         g_renderer = &renderer;
@@ -255,9 +912,12 @@ int main() {
         std::signal(SIGTERM, signal_handler);
 
         // Run until user quits
-        renderer.run(analyzer);
+        renderer.run(analyzer, streamer.get());
 
         g_renderer = nullptr;
+        if (!options.trace_path.empty()) {
+            audiovis::Tracer::instance().write_chrome_trace(options.trace_path);
+        }
         return 0;
 
     } catch (const std::exception& e) {
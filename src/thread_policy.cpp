@@ -0,0 +1,188 @@
+#include "audiovis/thread_policy.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace audiovis {
+
+namespace {
+
+int native_policy(SchedulingClass scheduling) {
+    switch (scheduling) {
+        case SchedulingClass::Fifo:
+            return SCHED_FIFO;
+        case SchedulingClass::RoundRobin:
+            return SCHED_RR;
+        case SchedulingClass::Normal:
+            break;
+    }
+    return SCHED_OTHER;
+}
+
+const char* policy_name(SchedulingClass scheduling) {
+    switch (scheduling) {
+        case SchedulingClass::Fifo:
+            return "SCHED_FIFO";
+        case SchedulingClass::RoundRobin:
+            return "SCHED_RR";
+        case SchedulingClass::Normal:
+            break;
+    }
+    return "SCHED_OTHER";
+}
+
+void append_note(std::string& notes, const std::string& note) {
+    if (!notes.empty()) {
+        notes += "; ";
+    }
+    notes += note;
+}
+
+/// Reads back the scheduling class, priority and affinity of `thread`.
+AppliedThreadPolicy read_back(pthread_t thread) {
+    AppliedThreadPolicy applied;
+
+    int policy = SCHED_OTHER;
+    sched_param param{};
+    if (pthread_getschedparam(thread, &policy, &param) == 0) {
+        applied.scheduling = policy == SCHED_FIFO ? SchedulingClass::Fifo
+                             : policy == SCHED_RR ? SchedulingClass::RoundRobin
+                                                  : SchedulingClass::Normal;
+        applied.priority = applied.scheduling == SchedulingClass::Normal ? 0 : param.sched_priority;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(thread, sizeof(set), &set) == 0) {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                applied.cpus.push_back(cpu);
+            }
+        }
+    }
+    return applied;
+}
+
+}  // namespace
+
+void validate(const ThreadPolicy& policy) {
+    if (policy.scheduling == SchedulingClass::Normal) {
+        if (policy.priority != 0) {
+            throw std::invalid_argument("Thread priority needs a real-time scheduling class");
+        }
+    } else {
+        const int native = native_policy(policy.scheduling);
+        if (policy.priority < sched_get_priority_min(native) ||
+            policy.priority > sched_get_priority_max(native)) {
+            throw std::invalid_argument("Real-time thread priority must be between " +
+                                        std::to_string(sched_get_priority_min(native)) + " and " +
+                                        std::to_string(sched_get_priority_max(native)));
+        }
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        throw std::runtime_error(std::string("Cannot read CPU affinity: ") + std::strerror(errno));
+    }
+    for (std::size_t i = 0; i < policy.cpus.size(); ++i) {
+        const unsigned cpu = policy.cpus[i];
+        if (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed)) {
+            throw std::invalid_argument("CPU " + std::to_string(cpu) +
+                                        " is not available to this process");
+        }
+        if (std::find(policy.cpus.begin(), policy.cpus.begin() + static_cast<std::ptrdiff_t>(i),
+                      cpu) != policy.cpus.begin() + static_cast<std::ptrdiff_t>(i)) {
+            throw std::invalid_argument("CPU " + std::to_string(cpu) + " is listed twice");
+        }
+    }
+}
+
+AppliedThreadPolicy apply_thread_policy(std::thread::native_handle_type thread,
+                                        const ThreadPolicy& policy) {
+    validate(policy);
+    std::string notes;
+
+    if (!policy.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const unsigned cpu : policy.cpus) {
+            CPU_SET(cpu, &set);
+        }
+        if (const int err = pthread_setaffinity_np(thread, sizeof(set), &set); err != 0) {
+            append_note(notes, std::string("CPU affinity refused: ") + std::strerror(err));
+        }
+    }
+
+    // Normal scheduling is the default; only ask for a change when one is wanted
+    if (policy.scheduling != SchedulingClass::Normal) {
+        sched_param param{};
+        param.sched_priority = policy.priority;
+        const int err = pthread_setschedparam(thread, native_policy(policy.scheduling), &param);
+        if (err != 0) {
+            append_note(notes, std::string(policy_name(policy.scheduling)) +
+                                   " refused: " + std::strerror(err));
+        }
+    }
+
+    auto applied = read_back(thread);
+    applied.notes = std::move(notes);
+    return applied;
+}
+
+AppliedThreadPolicy apply_thread_policy(const ThreadPolicy& policy) {
+    return apply_thread_policy(pthread_self(), policy);
+}
+
+AppliedThreadPolicy current_thread_policy() {
+    return read_back(pthread_self());
+}
+
+MemoryLock lock_process_memory() {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        return {.locked = false, .notes = std::string("mlockall refused: ") + std::strerror(errno)};
+    }
+    return {.locked = true, .notes = {}};
+}
+
+std::string describe(const AppliedThreadPolicy& applied) {
+    std::string text = policy_name(applied.scheduling);
+    if (applied.scheduling != SchedulingClass::Normal) {
+        text += " priority " + std::to_string(applied.priority);
+    }
+
+    // Runs of consecutive cores collapse to "first-last"
+    text += applied.cpus.size() == 1 ? ", CPU " : ", CPUs ";
+    for (std::size_t i = 0; i < applied.cpus.size();) {
+        std::size_t end = i + 1;
+        while (end < applied.cpus.size() && applied.cpus[end] == applied.cpus[end - 1] + 1) {
+            ++end;
+        }
+        if (i > 0) {
+            text += ',';
+        }
+        text += std::to_string(applied.cpus[i]);
+        if (end - i > 1) {
+            text += '-' + std::to_string(applied.cpus[end - 1]);
+        }
+        i = end;
+    }
+    if (applied.cpus.empty()) {
+        text += "unknown";
+    }
+
+    if (!applied.notes.empty()) {
+        text += " (" + applied.notes + ")";
+    }
+    return text;
+}
+
+}  // namespace audiovis
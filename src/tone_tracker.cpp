@@ -0,0 +1,172 @@
+#include "audiovis/tone_tracker.hpp"
+
+#include "audiovis/simd_kernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace audiovis {
+
+namespace {
+
+/// Per-sample damping of the running terms; bounds accumulated rounding error.
+constexpr double kDamping = 1.0 - 1e-9;
+
+/// Largest number of cosine terms in a supported window.
+constexpr std::size_t kMaxCosineTerms = 5;
+
+/// A window as w(i) = sum over m of (-1)^m a[m] cos(2 pi m i / N), the same
+/// coefficients window_table() uses.
+struct CosineSum {
+    std::array<double, kMaxCosineTerms> a{};
+    std::size_t count = 1;
+};
+
+CosineSum cosine_sum(WindowFunction window) {
+    switch (window) {
+        case WindowFunction::Hann:
+            return {.a = {0.5, 0.5}, .count = 2};
+        case WindowFunction::Hamming:
+            return {.a = {0.54, 0.46}, .count = 2};
+        case WindowFunction::Blackman:
+            return {.a = {0.42, 0.5, 0.08}, .count = 3};
+        case WindowFunction::FlatTop:
+            return {.a = {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368},
+                    .count = 5};
+        case WindowFunction::Rectangular:
+            break;
+    }
+    return {.a = {1.0}, .count = 1};
+}
+
+}  // namespace
+
+ToneTracker::ToneTracker(const ToneTrackerConfig& config) : config_(config) {
+    if (config_.frequencies.empty()) {
+        throw std::invalid_argument("Tone tracker needs at least one frequency");
+    }
+    if (config_.window_size == 0 || config_.channels == 0) {
+        throw std::invalid_argument("Tone tracker needs a window and at least one channel");
+    }
+    const float nyquist = config_.sample_rate / 2.0f;
+    for (const float frequency : config_.frequencies) {
+        if (!(frequency > 0.0f) || !(frequency < nyquist)) {
+            throw std::invalid_argument("Tracked frequencies must lie between 0 and Nyquist");
+        }
+    }
+
+    // Term k of tone t sits k - (count - 1) bins from it, so each tone's
+    // terms run symmetrically around it
+    const auto window = cosine_sum(config_.window);
+    terms_ = 2 * window.count - 1;
+    const auto n = static_cast<double>(config_.window_size);
+    const double bin = 2.0 * std::numbers::pi / n;
+    const double expiry = std::pow(kDamping, n);
+    for (const float frequency : config_.frequencies) {
+        const double omega = 2.0 * std::numbers::pi * static_cast<double>(frequency) /
+                             static_cast<double>(config_.sample_rate);
+        for (std::size_t k = 0; k < terms_; ++k) {
+            const auto m = k < window.count - 1 ? window.count - 1 - k : k - (window.count - 1);
+            const double w = omega + bin * (static_cast<double>(k) -
+                                            static_cast<double>(window.count - 1));
+            rotate_re_.push_back(kDamping * std::cos(w));
+            rotate_im_.push_back(kDamping * std::sin(w));
+            expire_re_.push_back(expiry * std::cos(w * n));
+            expire_im_.push_back(expiry * std::sin(w * n));
+            // cos(2 pi m i / N) splits evenly between the terms m bins either side
+            const double sign = m % 2 == 0 ? 1.0 : -1.0;
+            weights_.push_back(m == 0 ? window.a[0] : sign * window.a[m] / 2.0);
+        }
+    }
+
+    // Same normalization as FFTProcessor: magnitude * 2 / (n * coherent gain)
+    const auto magnitude_scale = 2.0 / (n * window.a[0]);
+    scale_ = static_cast<float>(magnitude_scale * magnitude_scale);
+
+    state_re_.assign(config_.channels * rotate_re_.size(), 0.0);
+    state_im_.assign(config_.channels * rotate_re_.size(), 0.0);
+    history_.assign(config_.channels * config_.window_size, 0.0f);
+    position_.assign(config_.channels, 0);
+}
+
+void ToneTracker::process(std::span<const float> samples) noexcept {
+    advance(0, samples);
+}
+
+void ToneTracker::process_batch(std::span<const SegmentedInput> inputs) noexcept {
+    for (std::size_t ch = 0; ch < inputs.size(); ++ch) {
+        advance(ch, inputs[ch].head);
+        advance(ch, inputs[ch].tail);
+    }
+}
+
+void ToneTracker::advance(std::size_t channel, std::span<const float> samples) noexcept {
+    const auto count = rotate_re_.size();
+    const auto window = config_.window_size;
+    double* const re = state_re_.data() + channel * count;
+    double* const im = state_im_.data() + channel * count;
+    float* const history = history_.data() + channel * window;
+    auto position = position_[channel];
+
+    for (const float sample : samples) {
+        // Y(n) = x(n) + r e^{jw} Y(n - 1) - r^N e^{jwN} x(n - N)
+        const auto in = static_cast<double>(sample);
+        const auto out = static_cast<double>(history[position]);
+        history[position] = sample;
+        position = position + 1 == window ? 0 : position + 1;
+
+        for (std::size_t k = 0; k < count; ++k) {
+            const double r = re[k];
+            const double i = im[k];
+            re[k] = rotate_re_[k] * r - rotate_im_[k] * i + in - expire_re_[k] * out;
+            im[k] = rotate_re_[k] * i + rotate_im_[k] * r - expire_im_[k] * out;
+        }
+    }
+    position_[channel] = position;
+}
+
+std::size_t ToneTracker::magnitudes(std::span<float> output) const noexcept {
+    const auto tones = tone_count();
+    const auto count = rotate_re_.size();
+
+    // Windowed power of every tone, straight into the output
+    for (std::size_t ch = 0; ch < config_.channels; ++ch) {
+        const double* const re = state_re_.data() + ch * count;
+        const double* const im = state_im_.data() + ch * count;
+        for (std::size_t t = 0; t < tones; ++t) {
+            double sum_re = 0.0;
+            double sum_im = 0.0;
+            for (std::size_t k = t * terms_; k < (t + 1) * terms_; ++k) {
+                sum_re += weights_[k] * re[k];
+                sum_im += weights_[k] * im[k];
+            }
+            output[ch * tones + t] = static_cast<float>(sum_re * sum_re + sum_im * sum_im);
+        }
+    }
+
+    const auto values = output.first(config_.channels * tones);
+    if (config_.use_magnitude_db) {
+        simd::power_to_normalized_db(values, values.data(), scale_, config_.db_floor,
+                                     config_.db_ceiling);
+    } else {
+        simd::power_to_magnitude(values, values.data(), scale_);
+    }
+    return values.size();
+}
+
+std::size_t ToneTracker::compute(std::span<const float> samples, std::span<float> output) noexcept {
+    process(samples);
+    return magnitudes(output);
+}
+
+void ToneTracker::reset() noexcept {
+    std::ranges::fill(state_re_, 0.0);
+    std::ranges::fill(state_im_, 0.0);
+    std::ranges::fill(history_, 0.0f);
+    std::ranges::fill(position_, 0);
+}
+
+}  // namespace audiovis
@@ -0,0 +1,240 @@
+#include "audiovis/trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+namespace audiovis {
+
+namespace {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+/// Events drained from a thread's ring per step.
+constexpr std::size_t kCollectChunk = 256;
+
+}  // namespace
+
+const char* trace_stage_name(TraceStage stage) noexcept {
+    switch (stage) {
+        case TraceStage::AnalyzerUpdate:
+            return "analyzer.update";
+        case TraceStage::AnalyzeFrame:
+            return "analyzer.frame";
+        case TraceStage::Decimate:
+            return "analyzer.decimate";
+        case TraceStage::RingRead:
+            return "ring.read";
+        case TraceStage::FftCompute:
+            return "fft.compute";
+        case TraceStage::Window:
+            return "fft.window";
+        case TraceStage::FftExecute:
+            return "fft.execute";
+        case TraceStage::Magnitude:
+            return "fft.magnitude";
+        case TraceStage::BandMapping:
+            return "bands.map";
+        case TraceStage::Smoothing:
+            return "bands.smooth";
+        case TraceStage::Render:
+            return "render";
+        case TraceStage::Draw:
+            return "render.draw";
+    }
+    return "unknown";
+}
+
+std::string to_json(const TraceWindow& window) {
+    std::string json = "{\"dropped\":" + std::to_string(window.dropped) + ",\"stages\":{";
+    bool first = true;
+    for (std::size_t i = 0; i < kTraceStageCount; ++i) {
+        const auto& stats = window.stages[i];
+        if (stats.count == 0) {
+            continue;
+        }
+        std::array<char, 192> text{};
+        std::snprintf(text.data(), text.size(),
+                      "%s\"%s\":{\"count\":%llu,\"mean_us\":%.2f,\"p50_us\":%lld,"
+                      "\"p99_us\":%lld,\"max_us\":%.2f}",
+                      first ? "" : ",", trace_stage_name(static_cast<TraceStage>(i)),
+                      static_cast<unsigned long long>(stats.count), stats.mean_us(),
+                      static_cast<long long>(stats.histogram.percentile(0.5).count()),
+                      static_cast<long long>(stats.histogram.percentile(0.99).count()),
+                      static_cast<double>(stats.max_ns) / 1e3);
+        json += text.data();
+        first = false;
+    }
+    return json + "}}";
+}
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer() : epoch_{Clock::now()} {}
+
+void Tracer::record(TraceStage stage, Clock::time_point start, Clock::time_point end) noexcept {
+    thread_local const ThreadSlot slot{register_thread()};
+    ThreadBuffer* buffer = slot.buffer;
+    if (buffer == nullptr) {
+        return;  // Registration failed for want of memory
+    }
+
+    const TraceEvent event{
+        .start_ns = static_cast<std::uint64_t>(duration_cast<nanoseconds>(start - epoch_).count()),
+        .duration_ns = static_cast<std::uint64_t>(duration_cast<nanoseconds>(end - start).count()),
+        .thread = buffer->index,
+        .stage = stage};
+    if (!buffer->events.try_push(event)) {
+        buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+    }
+}
+
+Tracer::ThreadBuffer* Tracer::register_thread() noexcept {
+    try {
+        const std::lock_guard lock{mutex_};
+        if (!free_.empty()) {
+            ThreadBuffer* buffer = free_.back();
+            free_.pop_back();
+            return buffer;
+        }
+        const auto index = static_cast<std::uint32_t>(threads_.size());
+        free_.reserve(index + 1);  // So releasing never allocates
+        threads_.push_back(std::make_unique<ThreadBuffer>(index));
+        return threads_.back().get();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void Tracer::release_thread(ThreadBuffer* buffer) noexcept {
+    const std::lock_guard lock{mutex_};
+    if (buffer->events.empty()) {
+        free_.push_back(buffer);
+    } else {
+        buffer->retired = true;  // collect() frees it once its events are in
+    }
+}
+
+Tracer::ThreadSlot::~ThreadSlot() {
+    if (buffer != nullptr) {
+        Tracer::instance().release_thread(buffer);
+    }
+}
+
+std::size_t Tracer::collect() {
+    const std::lock_guard lock{mutex_};
+    return collect_locked();
+}
+
+std::size_t Tracer::collect_locked() {
+    std::array<TraceEvent, kCollectChunk> chunk{};
+    std::size_t drained = 0;
+    for (const auto& thread : threads_) {
+        // Bounded by what is there now, so a busy thread cannot keep us here
+        for (auto pending = thread->events.size(); pending > 0;) {
+            const auto count = thread->events.try_pop(chunk);
+            if (count == 0) {
+                break;
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto& event = chunk[i];
+                auto& stats = window_.stages[static_cast<std::size_t>(event.stage)];
+                ++stats.count;
+                stats.total_ns += event.duration_ns;
+                stats.max_ns = std::max(stats.max_ns, event.duration_ns);
+                stats.histogram.record(duration_cast<microseconds>(nanoseconds{event.duration_ns}));
+                if (capture_) {
+                    if (captured_.size() < kMaxCapturedEvents) {
+                        captured_.push_back(event);
+                    } else {
+                        ++window_.dropped;
+                    }
+                }
+            }
+            pending -= std::min(pending, count);
+            drained += count;
+        }
+        if (thread->retired && thread->events.empty()) {
+            thread->retired = false;
+            free_.push_back(thread.get());
+        }
+    }
+
+    // Fold in what the threads dropped since the last collect
+    std::uint64_t ring_dropped = 0;
+    for (const auto& thread : threads_) {
+        ring_dropped += thread->dropped.load(std::memory_order_relaxed);
+    }
+    window_.dropped += ring_dropped - dropped_reported_;
+    dropped_reported_ = ring_dropped;
+    return drained;
+}
+
+TraceWindow Tracer::roll() {
+    const std::lock_guard lock{mutex_};
+    collect_locked();
+    return std::exchange(window_, TraceWindow{});
+}
+
+void Tracer::set_capture(bool enabled) {
+    const std::lock_guard lock{mutex_};
+    capture_ = enabled;
+}
+
+std::vector<TraceEvent> Tracer::captured() const {
+    const std::lock_guard lock{mutex_};
+    return captured_;
+}
+
+std::string Tracer::chrome_trace_json() {
+    const std::lock_guard lock{mutex_};
+    collect_locked();
+
+    // Complete ("X") events with microsecond timestamps, one track per thread
+    std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    json.reserve(json.size() + captured_.size() * 96);
+    for (std::size_t i = 0; i < captured_.size(); ++i) {
+        const auto& event = captured_[i];
+        std::array<char, 160> text{};
+        std::snprintf(text.data(), text.size(),
+                      "%s{\"name\":\"%s\",\"cat\":\"audiovis\",\"ph\":\"X\",\"pid\":1,"
+                      "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                      i == 0 ? "" : ",\n", trace_stage_name(event.stage), event.thread,
+                      static_cast<double>(event.start_ns) / 1e3,
+                      static_cast<double>(event.duration_ns) / 1e3);
+        json += text.data();
+    }
+    return json + "]}\n";
+}
+
+void Tracer::write_chrome_trace(const std::string& path) {
+    const auto json = chrome_trace_json();
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        throw std::runtime_error("Cannot open trace file: " + path);
+    }
+    const bool written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    if (std::fclose(file) != 0 || !written) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+}
+
+void Tracer::clear() {
+    const std::lock_guard lock{mutex_};
+    const bool capture = capture_;
+    capture_ = false;
+    collect_locked();
+    capture_ = capture;
+    window_ = {};
+    captured_.clear();
+}
+
+}  // namespace audiovis
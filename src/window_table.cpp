@@ -0,0 +1,174 @@
+#include "audiovis/window_table.hpp"
+
+#include <array>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace audiovis {
+
+namespace {
+
+/// cos(2 pi t) for t in [0, 1). A Taylor series when evaluated at compile
+/// time (std::cos is not constexpr), the library cosine otherwise; both are
+/// accurate to double precision, so prebaked and computed tables agree.
+constexpr double cos_turns(double t) {
+    // Fold into [0, 1/4] using the symmetries of the cosine
+    const double folded = t > 0.5 ? 1.0 - t : t;
+    const double sign = folded > 0.25 ? -1.0 : 1.0;
+    const double x = 2.0 * std::numbers::pi * (folded > 0.25 ? 0.5 - folded : folded);
+
+    if (!std::is_constant_evaluated()) {
+        return sign * std::cos(x);
+    }
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1; k <= 12; ++k) {  // x <= pi / 2: the 24th-order term is below 1e-19
+        term *= -x * x / static_cast<double>((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+    return sign * sum;
+}
+
+/// Coefficient `i` of the symmetric `n`-point window.
+constexpr float window_coefficient(WindowFunction function, std::size_t i, std::size_t n) {
+    if (n == 1) {
+        return 1.0f;
+    }
+    // cos(2 pi k i / (n - 1)), reduced exactly in integers first
+    const auto c = [i, n](std::size_t k) {
+        return cos_turns(static_cast<double>(k * i % (n - 1)) / static_cast<double>(n - 1));
+    };
+
+    double w = 1.0;
+    switch (function) {
+        case WindowFunction::Rectangular:
+            break;
+        case WindowFunction::Hann:
+            w = 0.5 - 0.5 * c(1);
+            break;
+        case WindowFunction::Hamming:
+            w = 0.54 - 0.46 * c(1);
+            break;
+        case WindowFunction::Blackman:
+            w = 0.42 - 0.5 * c(1) + 0.08 * c(2);
+            break;
+        case WindowFunction::FlatTop:
+            w = 0.21557895 - 0.41663158 * c(1) + 0.277263158 * c(2) - 0.083578947 * c(3) +
+                0.006947368 * c(4);
+            break;
+    }
+    return static_cast<float>(w);
+}
+
+template <std::size_t N>
+constexpr std::array<float, N> make_window(WindowFunction function) {
+    std::array<float, N> table{};
+    for (std::size_t i = 0; i < N; ++i) {
+        table[i] = window_coefficient(function, i, N);
+    }
+    return table;
+}
+
+// Hann (the default window) at the FFT sizes the renderers and tools use
+constexpr auto kHann512 = make_window<512>(WindowFunction::Hann);
+constexpr auto kHann1024 = make_window<1024>(WindowFunction::Hann);
+constexpr auto kHann2048 = make_window<2048>(WindowFunction::Hann);
+constexpr auto kHann4096 = make_window<4096>(WindowFunction::Hann);
+
+constexpr std::array<std::span<const float>, 4> kPrebakedHann{kHann512, kHann1024, kHann2048,
+                                                              kHann4096};
+
+}  // namespace
+
+WindowTable::WindowTable(WindowFunction function, std::span<const float> coefficients,
+                         bool prebaked)
+    : function_{function}, coefficients_{coefficients}, prebaked_{prebaked} {
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    for (const float coefficient : coefficients_) {
+        const auto w = static_cast<double>(coefficient);
+        sum += w;
+        sum_squares += w * w;
+    }
+    const auto n = static_cast<double>(coefficients_.size());
+    coherent_gain_ = static_cast<float>(sum / n);
+    energy_gain_ = static_cast<float>(sum_squares / n);
+}
+
+/// Process-wide window tables, keyed by (function, size).
+///
+/// Prebaked tables are wrapped once when the cache is created and are looked
+/// up without locking; computed ones are generated under a mutex and never
+/// freed, so references handed out stay valid.
+class WindowCache {
+public:
+    static WindowCache& instance() {
+        static WindowCache cache;
+        return cache;
+    }
+
+    WindowCache(const WindowCache&) = delete;
+    WindowCache& operator=(const WindowCache&) = delete;
+
+    const WindowTable& get(WindowFunction function, std::size_t size) {
+        if (function == WindowFunction::Hann) {
+            for (const auto& table : prebaked_) {
+                if (table->size() == size) {
+                    return *table;
+                }
+            }
+        }
+
+        const std::lock_guard lock{mutex_};
+        auto& entry = computed_[{function, size}];
+        if (!entry.table) {
+            entry.coefficients.resize(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                entry.coefficients[i] = window_coefficient(function, i, size);
+            }
+            entry.table.reset(new WindowTable{function, entry.coefficients, false});
+        }
+        return *entry.table;
+    }
+
+    std::size_t computed_count() {
+        const std::lock_guard lock{mutex_};
+        return computed_.size();
+    }
+
+private:
+    struct Entry {
+        std::vector<float> coefficients;
+        std::unique_ptr<const WindowTable> table;  // Views coefficients
+    };
+
+    WindowCache() {
+        for (std::size_t i = 0; i < kPrebakedHann.size(); ++i) {
+            prebaked_[i].reset(new WindowTable{WindowFunction::Hann, kPrebakedHann[i], true});
+        }
+    }
+
+    std::array<std::unique_ptr<const WindowTable>, kPrebakedHann.size()> prebaked_;
+    std::mutex mutex_;
+    std::map<std::pair<WindowFunction, std::size_t>, Entry> computed_;
+};
+
+const WindowTable& window_table(WindowFunction function, std::size_t size) {
+    if (size == 0) {
+        throw std::invalid_argument("Window size must be positive");
+    }
+    return WindowCache::instance().get(function, size);
+}
+
+std::size_t window_cache_size() {
+    return WindowCache::instance().computed_count();
+}
+
+}  // namespace audiovis
@@ -0,0 +1,112 @@
+#include "audiovis/aligned_buffer.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+std::uintptr_t address(const AlignedBuffer& buffer) {
+    return reinterpret_cast<std::uintptr_t>(buffer.data());
+}
+
+bool all_zero(const AlignedBuffer& buffer) {
+    const auto* bytes = buffer.as<const std::byte>();
+    return std::all_of(bytes, bytes + buffer.size(), [](std::byte b) { return b == std::byte{0}; });
+}
+
+/// Counts the resident pages of a buffer.
+std::size_t resident_pages(const AlignedBuffer& buffer) {
+    const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> residency((buffer.size() + page - 1) / page);
+    if (mincore(buffer.data(), buffer.size(), residency.data()) != 0) {
+        return 0;
+    }
+    return static_cast<std::size_t>(
+        std::count_if(residency.begin(), residency.end(), [](unsigned char r) { return r & 1; }));
+}
+
+TEST(AlignedBufferTest, DefaultIsZeroedAndCacheLineAligned) {
+    for (const std::size_t bytes : {1u, 100u, 4096u, 100000u}) {
+        const AlignedBuffer buffer{bytes};
+        ASSERT_NE(buffer.data(), nullptr);
+        EXPECT_EQ(buffer.size(), bytes);
+        EXPECT_EQ(address(buffer) % 64, 0);
+        EXPECT_TRUE(all_zero(buffer));
+        EXPECT_TRUE(buffer.notes().empty());
+    }
+}
+
+TEST(AlignedBufferTest, HonoursLargerAlignments) {
+    for (const auto placement : {MemoryPlacement::Local, MemoryPlacement::FirstTouch}) {
+        for (const std::size_t alignment : {128u, 4096u, 65536u}) {
+            const AlignedBuffer buffer{3000, {.placement = placement, .alignment = alignment}};
+            EXPECT_EQ(address(buffer) % alignment, 0) << alignment;
+            EXPECT_TRUE(all_zero(buffer));
+        }
+    }
+}
+
+TEST(AlignedBufferTest, FirstTouchLeavesPagesForTheirUser) {
+    constexpr std::size_t kBytes = std::size_t{1} << 20;
+    const AlignedBuffer local{kBytes, {.placement = MemoryPlacement::Bind}};
+    const AlignedBuffer lazy{kBytes, {.placement = MemoryPlacement::FirstTouch}};
+    const auto pages = kBytes / static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+    EXPECT_EQ(resident_pages(local), pages);  // Populated by the zero fill
+    EXPECT_EQ(resident_pages(lazy), 0);
+    lazy.as<float>()[0] = 1.0f;
+    EXPECT_EQ(resident_pages(lazy), 1);
+}
+
+TEST(AlignedBufferTest, HugePagesAreWholeAndAligned) {
+    const AlignedBuffer buffer{3 * AlignedBuffer::kHugePageSize + 5, {.huge_pages = true}};
+    // Explicit or transparent, the block starts on a hugepage boundary
+    EXPECT_EQ(address(buffer) % AlignedBuffer::kHugePageSize, 0);
+    EXPECT_TRUE(all_zero(buffer));
+    buffer.as<std::byte>()[buffer.size() - 1] = std::byte{1};
+
+    // Too small to be worth a hugepage
+    const AlignedBuffer small{4096, {.huge_pages = true}};
+    EXPECT_FALSE(small.huge_pages());
+    EXPECT_FALSE(small.notes().empty());
+}
+
+TEST(AlignedBufferTest, RefusedBindingIsReportedNotThrown) {
+    // No machine has node 1000; the memory is still usable
+    const AlignedBuffer buffer{8192, {.placement = MemoryPlacement::Bind, .numa_node = 1000}};
+    ASSERT_NE(buffer.data(), nullptr);
+    EXPECT_FALSE(buffer.bound());
+    EXPECT_FALSE(buffer.notes().empty());
+    EXPECT_TRUE(all_zero(buffer));
+}
+
+TEST(AlignedBufferTest, MoveTransfersOwnership) {
+    AlignedBuffer first{1024};
+    void* const data = first.data();
+    AlignedBuffer second{std::move(first)};
+    EXPECT_EQ(second.data(), data);
+    EXPECT_EQ(first.data(), nullptr);
+
+    first = AlignedBuffer{64, {.placement = MemoryPlacement::FirstTouch}};
+    second = std::move(first);
+    EXPECT_EQ(second.size(), 64);
+}
+
+TEST(AlignedBufferTest, ValidatesPolicy) {
+    EXPECT_THROW(AlignedBuffer(64, {.alignment = 0}), std::invalid_argument);
+    EXPECT_THROW(AlignedBuffer(64, {.alignment = 96}), std::invalid_argument);
+    EXPECT_THROW(AlignedBuffer(64, {.placement = MemoryPlacement::Bind, .numa_node = 5000}),
+                 std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace audiovis
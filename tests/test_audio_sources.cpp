@@ -0,0 +1,374 @@
+#include "audiovis/audio_source.hpp"
+#include "audiovis/file_source.hpp"
+#include "audiovis/synthetic_source.hpp"
+
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+/// Pops everything left in each channel ring.
+std::vector<std::vector<float>> drain(AudioSource& source) {
+    std::vector<std::vector<float>> out(source.channels());
+    for (std::size_t ch = 0; ch < out.size(); ++ch) {
+        out[ch].resize(source.buffer(ch).size());
+        source.buffer(ch).try_pop(out[ch]);
+    }
+    return out;
+}
+
+/// Pumps an offline source to its end, collecting every channel.
+std::vector<std::vector<float>> read_all(AudioSource& source) {
+    std::vector<std::vector<float>> all(source.channels());
+    while (!source.at_end()) {
+        source.produce(source.buffer().capacity());
+        const auto chunk = drain(source);
+        for (std::size_t ch = 0; ch < all.size(); ++ch) {
+            all[ch].insert(all[ch].end(), chunk[ch].begin(), chunk[ch].end());
+        }
+    }
+    return all;
+}
+
+/// Builds WAV files byte by byte, little-endian.
+class WavBuilder {
+public:
+    void u8(std::uint32_t v) { bytes_ += static_cast<char>(v & 0xFF); }
+    void u16(std::uint32_t v) { u8(v); u8(v >> 8); }
+    void u24(std::uint32_t v) { u16(v); u8(v >> 16); }
+    void u32(std::uint32_t v) { u16(v & 0xFFFF); u16(v >> 16); }
+    void tag(const char* t) { bytes_.append(t, 4); }
+
+    /// Writes a canonical header; `extensible` uses WAVE_FORMAT_EXTENSIBLE.
+    void header(std::uint16_t format, std::uint32_t channels, std::uint32_t rate,
+                std::uint32_t bits, std::uint32_t data_bytes, bool extensible = false) {
+        tag("RIFF");
+        u32(0);  // Readers must not trust this
+        tag("WAVE");
+        tag("LIST");  // An unrelated odd-sized chunk before fmt, padded
+        u32(3);
+        bytes_ += "abc";
+        bytes_ += '\0';
+        tag("fmt ");
+        u32(extensible ? 40 : 16);
+        u16(extensible ? 0xFFFE : format);
+        u16(channels);
+        u32(rate);
+        u32(rate * channels * bits / 8);
+        u16(channels * bits / 8);
+        u16(bits);
+        if (extensible) {
+            u16(22);
+            u16(bits);
+            u32(0);
+            u16(format);  // Sub-format GUID: tag, then the fixed suffix
+            bytes_.append(14, '\x01');
+        }
+        tag("data");
+        u32(data_bytes);
+    }
+
+    [[nodiscard]] std::string write(const std::string& name) const {
+        const auto path = (std::filesystem::temp_directory_path() / name).string();
+        std::ofstream{path, std::ios::binary}.write(bytes_.data(),
+                                                    static_cast<std::streamsize>(bytes_.size()));
+        return path;
+    }
+
+private:
+    std::string bytes_;
+};
+
+TEST(SyntheticSourceTest, IsDeterministic) {
+    const SyntheticConfig config{.waveform = Waveform::WhiteNoise, .duration_seconds = 0.1f};
+    SyntheticSource a{config};
+    SyntheticSource b{config};
+
+    EXPECT_EQ(read_all(a), read_all(b));
+    EXPECT_FALSE(a.is_realtime());
+}
+
+TEST(SyntheticSourceTest, NoiseStaysWithinAmplitude) {
+    SyntheticSource source{{.waveform = Waveform::WhiteNoise, .amplitude = 0.25f,
+                            .duration_seconds = 0.1f}};
+    const auto samples = read_all(source)[0];
+
+    float peak = 0.0f;
+    double sum = 0.0;
+    for (const float s : samples) {
+        peak = std::max(peak, std::abs(s));
+        sum += static_cast<double>(s);
+    }
+    EXPECT_LE(peak, 0.25f);
+    EXPECT_GT(peak, 0.2f);
+    EXPECT_NEAR(sum / static_cast<double>(samples.size()), 0.0, 0.01);
+}
+
+TEST(SyntheticSourceTest, SineHasRequestedFrequency) {
+    SyntheticSource source{{.frequency = 440.0f, .duration_seconds = 1.0f}};
+    const auto samples = read_all(source)[0];
+    ASSERT_EQ(samples.size(), 48000);
+
+    // One upward zero crossing per cycle
+    int crossings = 0;
+    for (std::size_t i = 1; i < samples.size(); ++i) {
+        if (samples[i - 1] < 0.0f && samples[i] >= 0.0f) {
+            ++crossings;
+        }
+    }
+    EXPECT_NEAR(crossings, 440, 1);
+}
+
+TEST(SyntheticSourceTest, FiniteDurationEnds) {
+    SyntheticSource source{{.duration_seconds = 0.25f, .block_frames = 1000}};
+    EXPECT_EQ(source.total_frames(), 12000);
+
+    const auto samples = read_all(source);
+    EXPECT_EQ(samples[0].size(), 12000);
+    EXPECT_TRUE(source.at_end());
+    EXPECT_EQ(source.produce(100), 0);
+    EXPECT_EQ(source.stats().frames_captured, 12000);
+}
+
+TEST(SyntheticSourceTest, AppliesBackpressure) {
+    SyntheticSource source{{.ring_buffer_seconds = 0.01f}};  // Endless
+    const auto capacity = source.buffer().capacity();
+
+    EXPECT_EQ(source.produce(capacity * 4), capacity);
+    EXPECT_EQ(source.produce(1), 0);  // Full, nothing dropped
+    EXPECT_EQ(source.stats().overruns, 0);
+    EXPECT_FALSE(source.at_end());
+}
+
+TEST(SyntheticSourceTest, ChannelsStayAligned) {
+    SyntheticSource source{{.channels = 3, .waveform = Waveform::Sweep,
+                            .duration_seconds = 0.2f}};
+    const auto samples = read_all(source);
+
+    ASSERT_EQ(samples.size(), 3);
+    EXPECT_EQ(samples[0], samples[1]);
+    EXPECT_EQ(samples[0], samples[2]);
+}
+
+TEST(SyntheticSourceTest, ProducerThreadRunsToEnd) {
+    SyntheticSource source{{.duration_seconds = 2.0f, .ring_buffer_seconds = 0.1f}};
+    source.start();
+
+    std::size_t received = 0;
+    std::vector<float> scratch(4096);
+    while (!source.at_end() || !source.buffer().empty()) {
+        received += source.buffer().try_pop(scratch);
+    }
+    source.stop();
+
+    EXPECT_EQ(received, 96000);
+    EXPECT_FALSE(source.is_running());
+}
+
+TEST(SyntheticSourceTest, BroadcastsInterleavedFramesToEveryReader) {
+    SyntheticSource source{{.channels = 2, .waveform = Waveform::Sweep,
+                            .duration_seconds = 0.05f}};
+    auto& ring = source.enable_broadcast(4096);
+    EXPECT_EQ(source.broadcast(), &ring);
+    EXPECT_THROW(source.enable_broadcast(4096), std::logic_error);
+
+    BroadcastRing<float>::Reader recorder{ring};
+    BroadcastRing<float>::Reader publisher{ring};
+    const auto samples = read_all(source);
+    EXPECT_EQ(ring.frames_written(), samples[0].size());
+
+    std::vector<float> frames(2 * ring.capacity());
+    for (auto* reader : {&recorder, &publisher}) {
+        ASSERT_EQ(reader->read(frames), samples[0].size());
+        for (std::size_t i = 0; i < samples[0].size(); ++i) {
+            EXPECT_EQ(frames[2 * i], samples[0][i]);
+            EXPECT_EQ(frames[2 * i + 1], samples[1][i]);
+        }
+    }
+}
+
+TEST(SyntheticSourceTest, RejectsInvalidConfig) {
+    EXPECT_THROW(SyntheticSource({.frequency = 0.0f}), std::invalid_argument);
+    EXPECT_THROW(SyntheticSource({.frequency = 30000.0f}), std::invalid_argument);
+    EXPECT_THROW(SyntheticSource({.channels = 0}), std::invalid_argument);
+    EXPECT_THROW(SyntheticSource({.seed = 0}), std::invalid_argument);
+    EXPECT_THROW(SyntheticSource({.waveform = Waveform::Sweep, .sweep_seconds = 0.0f}),
+                 std::invalid_argument);
+}
+
+/// A source fed by hand, as a capture callback would feed it.
+class PushedSource final : public AudioSource {
+public:
+    PushedSource(std::uint32_t channels, std::size_t ring_capacity, bool channel_rings = true)
+        : AudioSource{48000, channels, ring_capacity, {}, channel_rings} {}
+
+    bool push(std::span<const float> interleaved) { return push_interleaved(interleaved); }
+
+    void start() override {}
+    void stop() override {}
+    [[nodiscard]] bool is_running() const noexcept override { return false; }
+    [[nodiscard]] bool is_realtime() const noexcept override { return true; }
+    [[nodiscard]] AudioStats stats() const noexcept override { return {}; }
+    [[nodiscard]] const std::string& name() const noexcept override { return name_; }
+
+private:
+    std::string name_ = "pushed";
+};
+
+/// Frames `first` to `first + count - 1`, each sample holding its frame index.
+std::vector<float> numbered_frames(std::size_t first, std::size_t count) {
+    std::vector<float> samples(2 * count);
+    for (std::size_t f = 0; f < count; ++f) {
+        samples[2 * f] = samples[2 * f + 1] = static_cast<float>(first + f);
+    }
+    return samples;
+}
+
+TEST(AudioSourceTest, OverrunKeepsChannelsAligned) {
+    PushedSource source{2, 8};
+    ASSERT_EQ(source.buffer(0).capacity(), 8);
+    ASSERT_TRUE(source.push(numbered_frames(0, 6)));
+
+    // The consumer has committed its read of ring 0 but not yet of ring 1
+    std::vector<float> out(4);
+    ASSERT_EQ(source.buffer(0).try_pop(out), 4);
+    EXPECT_FALSE(source.push(numbered_frames(6, 6)));  // Only two frames fit both rings
+    ASSERT_EQ(source.buffer(1).try_pop(out), 4);
+
+    const auto rings = drain(source);
+    ASSERT_EQ(rings[0].size(), 4);
+    EXPECT_EQ(rings[0], rings[1]);
+    EXPECT_EQ(rings[0], (std::vector<float>{4.0f, 5.0f, 6.0f, 7.0f}));
+}
+
+TEST(AudioSourceTest, BroadcastOnlySourceLeavesChannelRingsAlone) {
+    PushedSource source{2, 8, false};
+    EXPECT_FALSE(source.has_channel_rings());
+    auto& ring = source.enable_broadcast(64);
+    BroadcastRing<float>::Reader reader{ring};
+
+    // Far more than the channel rings could hold, and nothing reads them
+    for (std::size_t block = 0; block < 4; ++block) {
+        EXPECT_TRUE(source.push(numbered_frames(block * 10, 10)));
+    }
+    EXPECT_TRUE(source.buffer(0).empty());
+    EXPECT_TRUE(source.buffer(1).empty());
+
+    std::vector<float> frames(2 * 64);
+    ASSERT_EQ(reader.read(frames), 40);
+    EXPECT_EQ(frames[2 * 39], 39.0f);
+    EXPECT_EQ(reader.frames_skipped(), 0);
+}
+
+TEST(FileSourceTest, ReadsInt16Wav) {
+    WavBuilder wav;
+    wav.header(1, 2, 44100, 16, 0xFFFFFFFF);  // Streaming writer: unknown length
+    for (const std::uint32_t v : {0x0000u, 0x4000u, 0x8000u, 0x7FFFu, 0xC000u, 0x0001u}) {
+        wav.u16(v);
+    }
+    FileSource source{{.path = wav.write("audiovis_int16.wav")}};
+
+    EXPECT_EQ(source.sample_rate(), 44100);
+    EXPECT_EQ(source.channels(), 2);
+    EXPECT_EQ(source.total_frames(), 3);
+
+    const auto samples = read_all(source);
+    EXPECT_EQ(samples[0], (std::vector<float>{0.0f, -1.0f, -0.5f}));
+    EXPECT_EQ(samples[1], (std::vector<float>{0.5f, 32767.0f / 32768.0f, 1.0f / 32768.0f}));
+}
+
+TEST(FileSourceTest, ReadsZeroSizedDataChunkToEnd) {
+    WavBuilder wav;
+    wav.header(1, 1, 8000, 16, 0);  // Streaming writer that never went back
+    for (const std::uint32_t v : {0x4000u, 0xC000u}) {
+        wav.u16(v);
+    }
+    FileSource source{{.path = wav.write("audiovis_zero_size.wav")}};
+
+    EXPECT_EQ(source.total_frames(), 2);
+    EXPECT_EQ(read_all(source)[0], (std::vector<float>{0.5f, -0.5f}));
+}
+
+TEST(FileSourceTest, ReadsInt24Wav) {
+    WavBuilder wav;
+    wav.header(1, 1, 48000, 24, 9);
+    wav.u24(0x400000);
+    wav.u24(0xC00000);
+    wav.u24(0x800000);
+    FileSource source{{.path = wav.write("audiovis_int24.wav")}};
+
+    const auto samples = read_all(source);
+    EXPECT_EQ(samples[0], (std::vector<float>{0.5f, -0.5f, -1.0f}));
+}
+
+TEST(FileSourceTest, ReadsExtensibleFloatWav) {
+    const std::vector<float> values{0.25f, -0.75f, 1.5f, 0.0f};
+    WavBuilder wav;
+    wav.header(3, 1, 96000, 32, 16, true);
+    for (const float v : values) {
+        wav.u32(std::bit_cast<std::uint32_t>(v));
+    }
+    FileSource source{{.path = wav.write("audiovis_float.wav")}};
+
+    EXPECT_EQ(source.sample_rate(), 96000);
+    EXPECT_DOUBLE_EQ(source.duration_seconds(), 4.0 / 96000.0);
+    EXPECT_EQ(read_all(source)[0], values);
+}
+
+TEST(FileSourceTest, ReadsRawFloat) {
+    std::vector<float> values(10000);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<float>(i) / 10000.0f;
+    }
+    WavBuilder raw;
+    for (const float v : values) {
+        raw.u32(std::bit_cast<std::uint32_t>(v));
+    }
+    FileSource source{{.path = raw.write("audiovis_raw.f32"), .sample_rate = 8000,
+                       .channels = 2, .block_frames = 333, .ring_buffer_seconds = 0.1f}};
+
+    EXPECT_EQ(source.sample_rate(), 8000);
+    EXPECT_EQ(source.total_frames(), 5000);
+
+    const auto samples = read_all(source);
+    ASSERT_EQ(samples[0].size(), 5000);
+    EXPECT_FLOAT_EQ(samples[0][1234], values[2468]);
+    EXPECT_FLOAT_EQ(samples[1][4999], values[9999]);
+}
+
+TEST(FileSourceTest, RejectsBadFiles) {
+    EXPECT_THROW(FileSource({.path = "/nonexistent/audiovis.wav"}), std::runtime_error);
+
+    WavBuilder garbage;
+    garbage.tag("RIFF");
+    garbage.u32(4);
+    garbage.tag("WAVE");
+    EXPECT_THROW(FileSource({.path = garbage.write("audiovis_empty.wav")}), std::runtime_error);
+    EXPECT_THROW(FileSource({.path = garbage.write("audiovis_forced.wav"),
+                             .format = FileFormat::Wav}),
+                 std::runtime_error);
+
+    WavBuilder unsupported;
+    unsupported.header(1, 1, 48000, 8, 0);  // 8-bit PCM
+    EXPECT_THROW(FileSource({.path = unsupported.write("audiovis_8bit.wav")}),
+                 std::runtime_error);
+
+    WavBuilder raw;
+    raw.u32(0);
+    EXPECT_THROW(FileSource({.path = raw.write("audiovis_raw0.f32"), .channels = 0}),
+                 std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace audiovis
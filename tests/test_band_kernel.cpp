@@ -0,0 +1,123 @@
+#include "audiovis/band_kernel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+constexpr std::size_t kFFTSize = 2048;
+constexpr float kSampleRate = 48000.0f;
+
+/// Two tones, shifted a little every frame so the spectrum keeps moving.
+std::vector<float> two_tones(std::size_t frame) {
+    std::vector<float> samples(kFFTSize);
+    const float step = 2.0f * std::numbers::pi_v<float> / kSampleRate;
+    const float low = step * (220.0f + 30.0f * static_cast<float>(frame));
+    const float high = step * 5000.0f;
+    const float level = frame % 2 == 0 ? 0.3f : 0.05f;
+    for (std::size_t i = 0; i < kFFTSize; ++i) {
+        const auto t = static_cast<float>(i);
+        samples[i] = 0.5f * std::sin(low * t) + level * std::sin(high * t);
+    }
+    return samples;
+}
+
+/// Band state for `bands` bands, one vector per quantity.
+struct State {
+    explicit State(std::size_t bands)
+        : smoothed(bands), peaks(bands), magnitudes_out(bands), peaks_out(bands) {}
+
+    BandLanes lanes() { return {smoothed, peaks, magnitudes_out, peaks_out}; }
+
+    std::vector<float> smoothed;
+    std::vector<float> peaks;
+    std::vector<float> magnitudes_out;
+    std::vector<float> peaks_out;
+};
+
+TEST(BandKernelTest, FusedMatchesSeparatePasses) {
+    const BandSmoothing smoothing{.smoothing_factor = 0.6f, .peak_decay_rate = 0.9f};
+    for (const bool db : {true, false}) {
+        for (const auto weighting :
+             {BandWeighting::Rectangular, BandWeighting::Fractional, BandWeighting::Triangular}) {
+            FFTProcessor fft{{.fft_size = kFFTSize, .use_magnitude_db = db}};
+            const BandMatrix matrix{{.num_bands = 96, .weighting = weighting}, fft.bin_count(),
+                                    kFFTSize, kSampleRate};
+            State separate{matrix.band_count()};
+            State fused{matrix.band_count()};
+            std::vector<float> magnitudes(fft.bin_count());
+            std::vector<float> raw(matrix.band_count());
+            std::vector<float> scratch(fft.bin_count());
+
+            // Several frames, so smoothing and peak decay are exercised too
+            for (std::size_t frame = 0; frame < 4; ++frame) {
+                const auto samples = two_tones(frame);
+                const SegmentedInput input{.head = samples, .tail = {}};
+
+                fft.compute_batch({&input, 1}, magnitudes);
+                matrix.apply(magnitudes, raw);
+                smooth_bands(raw, smoothing, separate.lanes());
+
+                fft.transform_batch({&input, 1});
+                fused_bands(fft, 0, matrix, smoothing, scratch, fused.lanes());
+
+                for (std::size_t b = 0; b < matrix.band_count(); ++b) {
+                    EXPECT_NEAR(fused.magnitudes_out[b], separate.magnitudes_out[b], 1e-5f) << b;
+                    EXPECT_NEAR(fused.peaks_out[b], separate.peaks_out[b], 1e-5f) << b;
+                    EXPECT_EQ(fused.smoothed[b], fused.magnitudes_out[b]);
+                }
+            }
+        }
+    }
+}
+
+TEST(BandKernelTest, SkipsBinsNoBandReads) {
+    FFTProcessor fft{{.fft_size = kFFTSize}};
+    const BandMatrix matrix{{.num_bands = 16, .min_frequency = 1000.0f, .max_frequency = 4000.0f},
+                            fft.bin_count(), kFFTSize, kSampleRate};
+    const auto samples = two_tones(0);
+    const SegmentedInput input{.head = samples, .tail = {}};
+    fft.transform_batch({&input, 1});
+
+    std::vector<float> scratch(fft.bin_count(), std::numeric_limits<float>::quiet_NaN());
+    State state{matrix.band_count()};
+    fused_bands(fft, 0, matrix, {}, scratch, state.lanes());
+
+    const auto columns = matrix.columns();
+    const auto first = columns.front();
+    const auto last = columns.back();
+    EXPECT_GT(first, 0);
+    EXPECT_LT(last, fft.bin_count() - 1);
+    for (std::size_t k = 0; k < scratch.size(); ++k) {
+        EXPECT_EQ(std::isnan(scratch[k]), k < first || k > last) << k;
+    }
+    for (const float value : state.magnitudes_out) {
+        EXPECT_GE(value, 0.0f);
+        EXPECT_LE(value, 1.0f);
+    }
+}
+
+TEST(BandKernelTest, SmoothBandsHoldsAndDecaysPeaks) {
+    const BandSmoothing smoothing{.smoothing_factor = 0.5f, .peak_decay_rate = 0.8f};
+    State state{2};
+    const std::vector<float> loud{1.0f, 0.2f};
+    const std::vector<float> quiet{0.0f, 0.2f};
+
+    smooth_bands(loud, smoothing, state.lanes());
+    EXPECT_FLOAT_EQ(state.magnitudes_out[0], 0.5f);
+    EXPECT_FLOAT_EQ(state.peaks_out[0], 0.5f);  // Rising: the peak follows
+
+    smooth_bands(quiet, smoothing, state.lanes());
+    EXPECT_FLOAT_EQ(state.magnitudes_out[0], 0.25f);
+    EXPECT_FLOAT_EQ(state.peaks_out[0], 0.4f);  // Falling: the peak decays instead
+    EXPECT_FLOAT_EQ(state.magnitudes_out[1], 0.15f);
+    EXPECT_FLOAT_EQ(state.peaks_out[1], 0.15f);
+}
+
+}  // namespace
+}  // namespace audiovis
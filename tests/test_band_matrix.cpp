@@ -0,0 +1,155 @@
+#include "audiovis/band_matrix.hpp"
+#include "audiovis/fft_processor.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+constexpr std::size_t kFFTSize = 2048;
+constexpr std::size_t kBinCount = kFFTSize / 2 + 1;
+constexpr float kSampleRate = 48000.0f;
+
+BandMatrix make_matrix(BandWeighting weighting, FrequencyScale scale, std::size_t bands = 64) {
+    return BandMatrix{{.num_bands = bands, .scale = scale, .weighting = weighting},
+                      kBinCount, kFFTSize, kSampleRate};
+}
+
+/// Bin k holds the value k, so each band reports the weighted mean bin it reads.
+std::vector<float> bin_ramp() {
+    std::vector<float> bins(kBinCount);
+    for (std::size_t k = 0; k < kBinCount; ++k) {
+        bins[k] = static_cast<float>(k);
+    }
+    return bins;
+}
+
+TEST(BandMatrixTest, ScaleConversionsRoundTrip) {
+    for (const auto scale : {FrequencyScale::Linear, FrequencyScale::Logarithmic,
+                             FrequencyScale::Mel, FrequencyScale::ERB}) {
+        for (const float hz : {20.0f, 440.0f, 1000.0f, 16000.0f}) {
+            EXPECT_NEAR(scale_to_hz(hz_to_scale(hz, scale), scale), hz, hz * 1e-4f);
+        }
+    }
+    EXPECT_NEAR(hz_to_scale(1000.0f, FrequencyScale::Mel), 1000.0f, 1.0f);  // By definition
+}
+
+TEST(BandMatrixTest, RectangularMatchesLogBandRanges) {
+    const auto matrix = make_matrix(BandWeighting::Rectangular, FrequencyScale::Logarithmic);
+    const auto ranges = compute_log_bands(kBinCount, 64, 20.0f, 20000.0f, kSampleRate, kFFTSize);
+
+    ASSERT_EQ(matrix.band_count(), ranges.size());
+    const auto offsets = matrix.row_offsets();
+    for (std::size_t b = 0; b < ranges.size(); ++b) {
+        const auto [lo, hi] = ranges[b];
+        ASSERT_EQ(offsets[b + 1] - offsets[b], hi - lo) << "band " << b;
+        EXPECT_EQ(matrix.columns()[offsets[b]], lo);
+        EXPECT_FLOAT_EQ(matrix.weights()[offsets[b]], 1.0f / static_cast<float>(hi - lo));
+    }
+}
+
+TEST(BandMatrixTest, RowsAreNormalizedConsecutiveRuns) {
+    for (const auto weighting :
+         {BandWeighting::Rectangular, BandWeighting::Fractional, BandWeighting::Triangular}) {
+        for (const auto scale : {FrequencyScale::Linear, FrequencyScale::Logarithmic,
+                                 FrequencyScale::Mel, FrequencyScale::ERB}) {
+            const auto matrix = make_matrix(weighting, scale, 200);
+            const auto offsets = matrix.row_offsets();
+            ASSERT_EQ(offsets.size(), matrix.band_count() + 1);
+            EXPECT_EQ(offsets.back(), matrix.nonzeros());
+
+            for (std::size_t b = 0; b < matrix.band_count(); ++b) {
+                ASSERT_GT(offsets[b + 1], offsets[b]) << "empty band " << b;
+                float sum = 0.0f;
+                for (auto i = offsets[b]; i < offsets[b + 1]; ++i) {
+                    EXPECT_LT(matrix.columns()[i], kBinCount);
+                    EXPECT_GT(matrix.weights()[i], 0.0f);
+                    if (i > offsets[b]) {
+                        EXPECT_EQ(matrix.columns()[i], matrix.columns()[i - 1] + 1);
+                    }
+                    sum += matrix.weights()[i];
+                }
+                EXPECT_NEAR(sum, 1.0f, 1e-5f) << "band " << b;
+            }
+        }
+    }
+}
+
+TEST(BandMatrixTest, FractionalKeepsLowBandsDistinct) {
+    const auto bins = bin_ramp();
+    std::vector<float> bands(64);
+
+    // Whole-bin averaging snaps several low bands onto the same bin
+    make_matrix(BandWeighting::Rectangular, FrequencyScale::Logarithmic).apply(bins, bands);
+    std::size_t repeats = 0;
+    for (std::size_t b = 1; b < bands.size(); ++b) {
+        if (bands[b] == bands[b - 1]) {
+            ++repeats;
+        }
+    }
+    EXPECT_GT(repeats, 0u);
+
+    // Interpolated weights give every band its own, rising, centre frequency
+    for (const auto weighting : {BandWeighting::Fractional, BandWeighting::Triangular}) {
+        make_matrix(weighting, FrequencyScale::Logarithmic).apply(bins, bands);
+        for (std::size_t b = 1; b < bands.size(); ++b) {
+            EXPECT_GT(bands[b], bands[b - 1]) << "band " << b;
+        }
+    }
+}
+
+TEST(BandMatrixTest, TriangularResponsePeaksAtNearestBand) {
+    const auto matrix = make_matrix(BandWeighting::Triangular, FrequencyScale::Mel, 40);
+    const auto edges = matrix.band_edges();
+
+    std::vector<float> bins(kBinCount, 0.0f);
+    std::vector<float> bands(matrix.band_count());
+    const std::size_t spike = 200;  // ~4.7 kHz
+    bins[spike] = 1.0f;
+    matrix.apply(bins, bands);
+
+    std::size_t loudest = 0;
+    for (std::size_t b = 1; b < bands.size(); ++b) {
+        loudest = bands[b] > bands[loudest] ? b : loudest;
+    }
+    const float hz = static_cast<float>(spike) * kSampleRate / static_cast<float>(kFFTSize);
+    EXPECT_LE(edges[loudest], hz);
+    EXPECT_GE(edges[loudest + 1], hz);
+}
+
+TEST(BandMatrixTest, ApplyMatchesDenseProduct) {
+    const auto matrix = make_matrix(BandWeighting::Triangular, FrequencyScale::ERB, 96);
+    std::vector<float> bins(kBinCount);
+    for (std::size_t k = 0; k < kBinCount; ++k) {
+        bins[k] = std::sin(0.01f * static_cast<float>(k * k));
+    }
+    std::vector<float> bands(matrix.band_count());
+    matrix.apply(bins, bands);
+
+    const auto offsets = matrix.row_offsets();
+    for (std::size_t b = 0; b < matrix.band_count(); ++b) {
+        float expected = 0.0f;
+        for (auto i = offsets[b]; i < offsets[b + 1]; ++i) {
+            expected += matrix.weights()[i] * bins[matrix.columns()[i]];
+        }
+        EXPECT_NEAR(bands[b], expected, 1e-5f);
+    }
+}
+
+TEST(BandMatrixTest, RejectsInvalidLayout) {
+    EXPECT_THROW((BandMatrix{{.num_bands = 0}, kBinCount, kFFTSize, kSampleRate}),
+                 std::invalid_argument);
+    EXPECT_THROW((BandMatrix{{.min_frequency = 0.0f}, kBinCount, kFFTSize, kSampleRate}),
+                 std::invalid_argument);
+    EXPECT_THROW(
+        (BandMatrix{{.min_frequency = 500.0f, .max_frequency = 100.0f}, kBinCount, kFFTSize,
+                    kSampleRate}),
+        std::invalid_argument);
+    EXPECT_THROW((BandMatrix{{}, 0, kFFTSize, kSampleRate}), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace audiovis
@@ -0,0 +1,177 @@
+#include "audiovis/broadcast_ring.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+using Ring = BroadcastRing<float>;
+
+std::vector<float> iota(std::size_t count, float first = 0.0f) {
+    std::vector<float> values(count);
+    std::iota(values.begin(), values.end(), first);
+    return values;
+}
+
+TEST(BroadcastRingTest, RoundsCapacityToPowerOfTwo) {
+    const Ring ring{10, 2};
+    EXPECT_EQ(ring.capacity(), 16);
+    EXPECT_EQ(ring.stride(), 2);
+    EXPECT_EQ(ring.frames_written(), 0);
+}
+
+TEST(BroadcastRingTest, EveryReaderSeesTheWholeStream) {
+    Ring ring{64};
+    Ring::Reader fast{ring};
+    Ring::Reader slow{ring};
+
+    const auto data = iota(48);
+    ring.push(std::span<const float>{data}.first(20));
+
+    std::vector<float> out(64);
+    EXPECT_EQ(fast.read(std::span<float>{out}.first(8)), 8);
+    EXPECT_EQ(fast.read(out), 12);
+    EXPECT_EQ(out[11], 19.0f);
+
+    ring.push(std::span<const float>{data}.subspan(20));
+    EXPECT_EQ(slow.lag(), 48);
+    EXPECT_EQ(slow.read(out), 48);
+    EXPECT_EQ(std::vector<float>(out.begin(), out.begin() + 48), data);
+    EXPECT_EQ(fast.read(out), 28);
+    EXPECT_EQ(out[0], 20.0f);
+
+    for (const Ring::Reader* reader : {&fast, &slow}) {
+        EXPECT_EQ(reader->lag(), 0);
+        EXPECT_EQ(reader->frames_read(), 48);
+        EXPECT_EQ(reader->overruns(), 0);
+    }
+}
+
+TEST(BroadcastRingTest, ReaderStartsAtNewestFrame) {
+    Ring ring{16};
+    ring.push(iota(10));
+
+    Ring::Reader late{ring};
+    std::vector<float> out(16);
+    EXPECT_EQ(late.read(out), 0);
+    ring.push(iota(3, 100.0f));
+    EXPECT_EQ(late.read(out), 3);
+    EXPECT_EQ(out[0], 100.0f);
+}
+
+TEST(BroadcastRingTest, LappedReaderSkipsToOldestIntactFrame) {
+    Ring ring{16};
+    Ring::Reader reader{ring};
+
+    // The producer never waits: three laps go in regardless
+    ring.push(iota(40));
+    EXPECT_EQ(reader.lag(), 40);
+
+    std::vector<float> out(64);
+    EXPECT_EQ(reader.read(out), 16);
+    EXPECT_EQ(out[0], 24.0f);
+    EXPECT_EQ(out[15], 39.0f);
+    EXPECT_EQ(reader.overruns(), 1);
+    EXPECT_EQ(reader.frames_skipped(), 24);
+    EXPECT_EQ(reader.lag(), 0);
+}
+
+TEST(BroadcastRingTest, SkippingKeepsFramesWhole) {
+    Ring ring{4, 3};  // Frames of three interleaved samples
+    Ring::Reader reader{ring};
+
+    ring.push(iota(7 * 3));
+    std::vector<float> out(4 * 3);
+    EXPECT_EQ(reader.read(out), 4);
+    EXPECT_EQ(out[0], 9.0f);  // Frame 3 starts at sample 9
+    EXPECT_EQ(out[11], 20.0f);
+    EXPECT_EQ(reader.frames_skipped(), 3);
+
+    // A short output takes whole frames only
+    ring.push(iota(2 * 3, 100.0f));
+    EXPECT_EQ(reader.read(std::span<float>{out}.first(5)), 1);
+    EXPECT_EQ(reader.lag(), 1);
+}
+
+TEST(BroadcastRingTest, SkipToNewestDropsBacklogWithoutCountingIt) {
+    Ring ring{16};
+    Ring::Reader reader{ring};
+    ring.push(iota(12));
+    reader.skip_to_newest();
+    EXPECT_EQ(reader.lag(), 0);
+    EXPECT_EQ(reader.frames_skipped(), 0);
+}
+
+// One producer racing three readers, one of them too slow to keep up. Every
+// frame a reader gets must be intact and in order; reads plus skips must
+// account for the whole stream.
+TEST(BroadcastRingTest, ConcurrentReadersNeverSeeTornFrames) {
+    constexpr std::size_t kFrames = 200000;
+    constexpr std::size_t kBlock = 37;
+    Ring ring{256, 2};
+
+    std::vector<std::unique_ptr<Ring::Reader>> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.push_back(std::make_unique<Ring::Reader>(ring));
+    }
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    std::vector<std::uint8_t> ordered(readers.size(), 1);  // Not vector<bool>: one byte each
+    for (std::size_t i = 0; i < readers.size(); ++i) {
+        threads.emplace_back([&, i] {
+            std::vector<float> out(2 * 64);
+            float last = -1.0f;
+            for (;;) {
+                const bool finished = done.load(std::memory_order_acquire);
+                const auto count = readers[i]->read(out);
+                for (std::size_t f = 0; f < count; ++f) {
+                    // Both halves of a frame carry its index
+                    if (out[2 * f] != out[2 * f + 1] || !(out[2 * f] > last)) {
+                        ordered[i] = 0;
+                    }
+                    last = out[2 * f];
+                }
+                if (finished && count == 0) {
+                    return;
+                }
+                if (i == 2) {
+                    std::this_thread::sleep_for(std::chrono::microseconds{200});
+                }
+            }
+        });
+    }
+
+    std::vector<float> block(2 * kBlock);
+    for (std::size_t frame = 0; frame < kFrames;) {
+        const auto count = std::min(kBlock, kFrames - frame);
+        for (std::size_t f = 0; f < count; ++f) {
+            block[2 * f] = block[2 * f + 1] = static_cast<float>(frame + f);
+        }
+        ring.push(std::span<const float>{block}.first(2 * count));
+        frame += count;
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (std::size_t i = 0; i < readers.size(); ++i) {
+        EXPECT_EQ(ordered[i], 1) << "reader " << i;
+        EXPECT_EQ(readers[i]->frames_read() + readers[i]->frames_skipped(), kFrames);
+        EXPECT_EQ(readers[i]->lag(), 0);
+    }
+}
+
+}  // namespace
+}  // namespace audiovis
@@ -4,7 +4,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <filesystem>
 #include <numbers>
+#include <tuple>
 #include <vector>
 
 namespace audiovis {
@@ -160,6 +162,21 @@ TEST_F(FFTProcessorTest, DecibelConversion) {
     EXPECT_GT(magnitudes[peak_bin], 0.8f);
 }
 
+TEST_F(FFTProcessorTest, WindowGainIsCompensated) {
+    // A bin-centred unit sinusoid reads amplitude 1 whichever window is used
+    const float frequency = 64.0f * kSampleRate / static_cast<float>(kDefaultFFTSize);
+    const auto samples = generate_sine(frequency, kSampleRate, kDefaultFFTSize);
+
+    for (const auto window : {WindowFunction::Rectangular, WindowFunction::Hann,
+                              WindowFunction::Blackman, WindowFunction::FlatTop}) {
+        FFTProcessor proc{{.fft_size = kDefaultFFTSize, .window = window,
+                           .use_magnitude_db = false}};
+        std::vector<float> magnitudes(proc.bin_count());
+        proc.compute(samples, magnitudes);
+        EXPECT_NEAR(magnitudes[64], 1.0f, 0.01f) << static_cast<int>(window);
+    }
+}
+
 TEST_F(FFTProcessorTest, SilenceProducesLowMagnitudes) {
     FFTConfig config{.fft_size = kDefaultFFTSize,
                      .window = WindowFunction::Hann,
@@ -228,6 +245,134 @@ TEST_F(FFTProcessorTest, ZeroPadsShortInput) {
     EXPECT_EQ(proc.compute(samples, magnitudes), proc.bin_count());
 }
 
+TEST_F(FFTProcessorTest, SplitInputMatchesContiguousInput) {
+    FFTProcessor proc{{.fft_size = kDefaultFFTSize, .use_magnitude_db = false}};
+
+    auto samples = generate_sine(1500.0f, kSampleRate, kDefaultFFTSize + 100);
+    std::vector<float> expected(proc.bin_count());
+    proc.compute(samples, expected);
+
+    // Same signal presented as two segments, as from a wrapped ring buffer
+    const std::span<const float> all{samples};
+    std::vector<float> actual(proc.bin_count());
+    proc.compute(all.first(300), all.subspan(300), actual);
+
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_FLOAT_EQ(actual[i], expected[i]);
+    }
+}
+
+TEST_F(FFTProcessorTest, SameSizeInstancesSharePlan) {
+    FFTProcessor first{{.fft_size = 4096}};
+    const auto plans = fftw_cached_plan_count();
+
+    FFTProcessor second{{.fft_size = 4096}};
+    EXPECT_EQ(fftw_cached_plan_count(), plans);
+
+    // Both instances compute independently on their own buffers
+    auto low = generate_sine(500.0f, kSampleRate, 4096);
+    auto high = generate_sine(5000.0f, kSampleRate, 4096);
+    std::vector<float> low_mags(first.bin_count());
+    std::vector<float> high_mags(second.bin_count());
+    first.compute(low, low_mags);
+    second.compute(high, high_mags);
+
+    EXPECT_NEAR(first.bin_to_frequency(find_peak_bin(low_mags), kSampleRate), 500.0f, 12.0f);
+    EXPECT_NEAR(second.bin_to_frequency(find_peak_bin(high_mags), kSampleRate), 5000.0f, 12.0f);
+}
+
+TEST_F(FFTProcessorTest, MeasuredPlanDetectsSine) {
+    FFTProcessor proc{{.fft_size = 256,
+                       .window = WindowFunction::Hann,
+                       .use_magnitude_db = false,
+                       .planner = PlannerRigor::Measure}};
+
+    auto samples = generate_sine(3000.0f, kSampleRate, 256);
+    std::vector<float> magnitudes(proc.bin_count());
+    proc.compute(samples, magnitudes);
+
+    const float resolution = kSampleRate / 256.0f;
+    EXPECT_NEAR(proc.bin_to_frequency(find_peak_bin(magnitudes), kSampleRate), 3000.0f,
+                resolution);
+}
+
+TEST_F(FFTProcessorTest, MeasuredPlanWritesWisdomFile) {
+    const auto path = std::filesystem::temp_directory_path() / "audiovis_test_fftw_wisdom";
+    std::filesystem::remove(path);
+
+    // Missing file: nothing imported, but new measurements get saved there.
+    // No other test plans this size, so it is guaranteed to be planned fresh.
+    EXPECT_FALSE(load_fftw_wisdom(path.string()));
+    FFTProcessor proc{{.fft_size = 128, .planner = PlannerRigor::Measure}};
+    EXPECT_TRUE(std::filesystem::exists(path));
+
+    // A later launch picks it up again
+    EXPECT_TRUE(load_fftw_wisdom(path.string()));
+
+    load_fftw_wisdom("");
+    std::filesystem::remove(path);
+}
+
+TEST_F(FFTProcessorTest, BatchMatchesPerChannelCompute) {
+    FFTProcessor mono{{.fft_size = kDefaultFFTSize}};
+    FFTProcessor stereo{{.fft_size = kDefaultFFTSize, .channels = 2}};
+    EXPECT_EQ(stereo.channels(), 2);
+
+    auto left = generate_sine(700.0f, kSampleRate, kDefaultFFTSize);
+    auto right = generate_sine(6000.0f, kSampleRate, kDefaultFFTSize);
+
+    // Right channel arrives wrapped, as from a ring buffer
+    const std::span<const float> r{right};
+    const std::vector<SegmentedInput> inputs{{.head = left, .tail = {}},
+                                             {.head = r.first(100), .tail = r.subspan(100)}};
+    const auto bins = stereo.bin_count();
+    std::vector<float> batch(2 * bins);
+    EXPECT_EQ(stereo.compute_batch(inputs, batch), 2 * bins);
+
+    std::vector<float> expected(bins);
+    const std::span<const float> out{batch};
+    for (const auto& [channel, freq, samples] :
+         {std::tuple{0u, 700.0f, &left}, std::tuple{1u, 6000.0f, &right}}) {
+        mono.compute(*samples, expected);
+        const auto spectrum = out.subspan(channel * bins, bins);
+        for (std::size_t i = 0; i < bins; ++i) {
+            EXPECT_NEAR(spectrum[i], expected[i], 1e-5f);
+        }
+        EXPECT_NEAR(stereo.bin_to_frequency(find_peak_bin(spectrum), kSampleRate), freq, 50.0f);
+    }
+}
+
+TEST_F(FFTProcessorTest, ConvertBinsMatchesComputeBatch) {
+    for (const bool db : {true, false}) {
+        FFTProcessor fft{{.fft_size = kDefaultFFTSize, .use_magnitude_db = db, .channels = 2}};
+        const auto left = generate_sine(700.0f, kSampleRate, kDefaultFFTSize);
+        const auto right = generate_sine(9000.0f, kSampleRate, kDefaultFFTSize, 0.25f);
+        const std::vector<SegmentedInput> inputs{{.head = left, .tail = {}},
+                                                 {.head = right, .tail = {}}};
+        const auto bins = fft.bin_count();
+        std::vector<float> expected(2 * bins);
+        fft.compute_batch(inputs, expected);
+
+        // Any sub-range, including the DC and Nyquist ends, converts alike
+        fft.transform_batch(inputs);
+        EXPECT_EQ(fft.spectrum(1).size(), 2 * bins);
+        std::vector<float> converted(bins);
+        for (std::size_t channel = 0; channel < 2; ++channel) {
+            const std::span<float> out{converted};
+            fft.convert_bins(channel, 0, out.first(7));
+            fft.convert_bins(channel, 7, out.subspan(7, 100));
+            fft.convert_bins(channel, 107, out.subspan(107));
+            for (std::size_t i = 0; i < bins; ++i) {
+                EXPECT_NEAR(converted[i], expected[channel * bins + i], 1e-5f) << i;
+            }
+        }
+    }
+}
+
+TEST_F(FFTProcessorTest, RejectsZeroChannels) {
+    EXPECT_THROW(FFTProcessor({.channels = 0}), std::invalid_argument);
+}
+
 TEST_F(FFTProcessorTest, LogBandMappingCoversBins) {
     constexpr std::size_t fft_size = 2048;
     constexpr std::size_t bin_count = fft_size / 2 + 1;
@@ -266,5 +411,23 @@ TEST_F(FFTProcessorTest, ConfigUpdatePreservesCorrectness) {
     EXPECT_NEAR(detected, 500.0f, 50.0f);  // Within reasonable tolerance
 }
 
+TEST_F(FFTProcessorTest, BufferPolicyDoesNotChangeResult) {
+    const auto samples = generate_sine(1000.0f, kSampleRate, kDefaultFFTSize);
+    FFTProcessor plain{{.fft_size = kDefaultFFTSize}};
+    std::vector<float> expected(plain.bin_count());
+    plain.compute(samples, expected);
+
+    // Untouched pages, an unusual alignment and a reallocating set_config()
+    FFTProcessor lazy{{.fft_size = kDefaultFFTSize,
+                       .buffers = {.placement = MemoryPlacement::FirstTouch, .alignment = 4096}}};
+    std::vector<float> actual(lazy.bin_count());
+    lazy.compute(samples, actual);
+    EXPECT_EQ(actual, expected);
+
+    lazy.set_config({.fft_size = kDefaultFFTSize, .buffers = {.alignment = 256}});
+    lazy.compute(samples, actual);
+    EXPECT_EQ(actual, expected);
+}
+
 }  // namespace
 }  // namespace audiovis
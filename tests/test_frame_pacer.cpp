@@ -0,0 +1,114 @@
+#include "audiovis/frame_pacer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace audiovis {
+namespace {
+
+using Clock = FramePacer::Clock;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+constexpr Clock::time_point kStart{};
+
+TEST(FramePacerTest, RejectsInvalidConfig) {
+    EXPECT_THROW(FramePacer({.target_fps = 0.0}, kStart), std::invalid_argument);
+    EXPECT_THROW(FramePacer({.target_fps = 30.0, .min_fps = 60.0}, kStart),
+                 std::invalid_argument);
+    EXPECT_THROW(FramePacer({.budget_fraction = 1.5}, kStart), std::invalid_argument);
+}
+
+TEST(FramePacerTest, DeadlinesAreAbsolute) {
+    FramePacer pacer{{.target_fps = 100.0}, kStart};
+    EXPECT_EQ(pacer.deadline(), kStart + milliseconds(10));
+
+    // Waking late does not push later deadlines back
+    pacer.begin_frame(kStart + milliseconds(13));
+    pacer.end_frame(kStart + milliseconds(14), microseconds(100), microseconds(500));
+    EXPECT_EQ(pacer.deadline(), kStart + milliseconds(20));
+    EXPECT_EQ(pacer.window().jitter.max_us, 3000u);
+    EXPECT_EQ(pacer.total_dropped(), 0u);
+}
+
+TEST(FramePacerTest, SkipsMissedDeadlinesAsDropped) {
+    FramePacer pacer{{.target_fps = 100.0, .backoff_frames = 1000}, kStart};
+
+    // One 35 ms frame runs through the deadlines at 20, 30 and 40 ms
+    pacer.begin_frame(kStart + milliseconds(10));
+    pacer.end_frame(kStart + milliseconds(45), microseconds(0), milliseconds(35));
+    EXPECT_EQ(pacer.deadline(), kStart + milliseconds(50));
+    EXPECT_EQ(pacer.window().dropped, 3u);
+    EXPECT_EQ(pacer.total_dropped(), 3u);
+    EXPECT_EQ(pacer.total_frames(), 1u);
+}
+
+TEST(FramePacerTest, BacksOffAndRecovers) {
+    FramePacer pacer{{.target_fps = 60.0,
+                      .min_fps = 20.0,
+                      .backoff_frames = 4,
+                      .recover_frames = 8},
+                     kStart};
+
+    const auto run = [&](int frames, Clock::duration work) {
+        for (int i = 0; i < frames; ++i) {
+            const auto start = pacer.deadline();
+            pacer.begin_frame(start);
+            pacer.end_frame(start + work, microseconds(0), work);
+        }
+    };
+
+    // Frames needing 20 ms cannot fit 60 fps; the rate steps down to fit
+    run(4, milliseconds(20));
+    EXPECT_DOUBLE_EQ(pacer.fps(), 45.0);
+    run(40, milliseconds(20));
+    EXPECT_GE(pacer.fps(), 20.0);
+    EXPECT_LT(pacer.fps(), 45.0);
+
+    // Never below the floor
+    run(200, milliseconds(100));
+    EXPECT_DOUBLE_EQ(pacer.fps(), 20.0);
+
+    // Cheap frames climb back to the target, and no further
+    run(200, milliseconds(1));
+    EXPECT_DOUBLE_EQ(pacer.fps(), 60.0);
+    EXPECT_EQ(pacer.period(), std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double>(1.0 / 60.0)));
+}
+
+TEST(FramePacerTest, WindowResetKeepsTotals) {
+    FramePacer pacer{{.target_fps = 100.0}, kStart};
+    pacer.begin_frame(kStart + milliseconds(10));
+    pacer.end_frame(kStart + milliseconds(11), microseconds(200), microseconds(300));
+    EXPECT_EQ(pacer.window().frames, 1u);
+    EXPECT_EQ(pacer.window().render.total(), 1u);
+
+    pacer.reset_window();
+    EXPECT_EQ(pacer.window().frames, 0u);
+    EXPECT_EQ(pacer.window().analysis.total(), 0u);
+    EXPECT_DOUBLE_EQ(pacer.window().fps, 100.0);
+    EXPECT_EQ(pacer.total_frames(), 1u);
+}
+
+TEST(FramePacerTest, TelemetryFormatsAsJson) {
+    FrameTelemetry telemetry;
+    telemetry.fps = 60.0;
+    telemetry.frames = 60;
+    telemetry.dropped = 2;
+    telemetry.render.record(microseconds(300));  // Bucket [256, 512)
+    telemetry.jitter.record(microseconds(40));
+
+    const std::string json = to_json(telemetry);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find("\"fps\":60.00"), std::string::npos);
+    EXPECT_NE(json.find("\"dropped\":2"), std::string::npos);
+    EXPECT_NE(json.find("\"render_us\":{\"p50\":512,\"p99\":512}"), std::string::npos);
+    EXPECT_NE(json.find("\"max\":40"), std::string::npos);
+}
+
+}  // namespace
+}  // namespace audiovis
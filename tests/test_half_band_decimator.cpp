@@ -0,0 +1,122 @@
+#include "audiovis/half_band_decimator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+constexpr auto kPassband = static_cast<double>(HalfBandDecimator::kPassband);
+
+/// RMS of the decimated tone after the filter has settled, relative to the
+/// input's, for a frequency given as a fraction of the input rate.
+double gain_at(double cycles_per_sample) {
+    constexpr std::size_t kInput = 8192;
+    std::vector<float> input(kInput);
+    for (std::size_t i = 0; i < kInput; ++i) {
+        input[i] = static_cast<float>(
+            std::sin(2.0 * std::numbers::pi * cycles_per_sample * static_cast<double>(i)));
+    }
+
+    HalfBandDecimator decimator;
+    std::vector<float> output(HalfBandDecimator::output_size(kInput));
+    const auto written = decimator.process(input, output);
+
+    double sum = 0.0;
+    const std::size_t settle = HalfBandDecimator::kTaps;
+    for (std::size_t i = settle; i < written; ++i) {
+        sum += static_cast<double>(output[i]) * static_cast<double>(output[i]);
+    }
+    const double rms = std::sqrt(sum / static_cast<double>(written - settle));
+    return rms / std::sqrt(0.5);
+}
+
+TEST(HalfBandDecimatorTest, HalvesTheSampleCount) {
+    HalfBandDecimator decimator;
+    std::vector<float> input(101, 1.0f);
+    std::vector<float> output(HalfBandDecimator::output_size(input.size()));
+    EXPECT_EQ(decimator.process(input, output), 50u);
+
+    // The leftover odd sample completes a pair in the next block
+    EXPECT_EQ(decimator.process(std::span<const float>{input}.first(1), output), 1u);
+}
+
+TEST(HalfBandDecimatorTest, HasUnityGainAtDc) {
+    HalfBandDecimator decimator;
+    std::vector<float> input(256, 0.25f);
+    std::vector<float> output(128);
+    decimator.process(input, output);
+    EXPECT_NEAR(output.back(), 0.25f, 1e-6f);
+}
+
+TEST(HalfBandDecimatorTest, CoefficientsAreHalfBand) {
+    HalfBandDecimator decimator;
+    float sum = 0.5f;
+    for (std::size_t j = 0; j < HalfBandDecimator::kSideTaps; ++j) {
+        sum += 2.0f * decimator.side_tap(j);
+    }
+    EXPECT_NEAR(sum, 1.0f, 1e-6f);
+    EXPECT_GT(decimator.side_tap(0), 0.3f);  // sinc main lobe
+    EXPECT_LT(decimator.side_tap(1), 0.0f);
+}
+
+TEST(HalfBandDecimatorTest, PassesThePassband) {
+    // Up to kPassband of the output Nyquist (a quarter of the input rate)
+    for (const double f : {0.01, 0.1, 0.25 * kPassband}) {
+        EXPECT_NEAR(gain_at(f), 1.0, 1e-3) << "f = " << f;
+    }
+}
+
+TEST(HalfBandDecimatorTest, RejectsWhatWouldAliasIntoThePassband) {
+    // Images of the passband: 0.5 - f for f in the passband
+    for (const double f : {0.5 - 0.25 * kPassband, 0.4, 0.49}) {
+        EXPECT_LT(20.0 * std::log10(gain_at(f)), -70.0) << "f = " << f;
+    }
+}
+
+TEST(HalfBandDecimatorTest, OutputIsIndependentOfBlockSize) {
+    std::vector<float> input(1000);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        const auto t = static_cast<float>(i);
+        input[i] = std::sin(0.05f * t) + 0.3f * std::cos(1.3f * t);
+    }
+
+    HalfBandDecimator whole;
+    std::vector<float> expected(500);
+    ASSERT_EQ(whole.process(input, expected), 500u);
+
+    HalfBandDecimator split;
+    std::vector<float> actual(500);
+    std::size_t written = 0;
+    std::size_t offset = 0;
+    for (const std::size_t block : {std::size_t{1}, std::size_t{7}, std::size_t{64},
+                                    std::size_t{3}, std::size_t{925}}) {
+        written += split.process(std::span<const float>{input}.subspan(offset, block),
+                                 std::span<float>{actual}.subspan(written));
+        offset += block;
+    }
+    ASSERT_EQ(written, 500u);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_FLOAT_EQ(actual[i], expected[i]) << i;
+    }
+}
+
+TEST(HalfBandDecimatorTest, ResetClearsHistory) {
+    HalfBandDecimator decimator;
+    std::vector<float> loud(64, 1.0f);
+    std::vector<float> output(32);
+    decimator.process(loud, output);
+
+    decimator.reset();
+    std::vector<float> silence(64, 0.0f);
+    decimator.process(silence, output);
+    EXPECT_TRUE(std::all_of(output.begin(), output.end(), [](float s) { return s == 0.0f; }));
+}
+
+}  // namespace
+}  // namespace audiovis
@@ -0,0 +1,202 @@
+#include "audiovis/recorder.hpp"
+
+#include "audiovis/file_source.hpp"
+#include "audiovis/synthetic_source.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr std::uint32_t kSampleRate = 48000;
+
+/// A fresh directory for one test's files, removed afterwards.
+class RecorderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        dir_ = std::filesystem::temp_directory_path() /
+               (std::string{"audiovis_recorder_"} + info->name());
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+    void TearDown() override { std::filesystem::remove_all(dir_); }
+
+    [[nodiscard]] std::string prefix() const { return (dir_ / "take").string(); }
+
+    std::filesystem::path dir_;
+};
+
+/// Noise source with a broadcast ring, pumped by hand.
+struct Feed {
+    Feed(std::uint32_t channels, std::size_t ring_frames)
+        : source{{.sample_rate = kSampleRate,
+                  .channels = channels,
+                  .waveform = Waveform::WhiteNoise,
+                  .block_frames = 1000}},
+          ring{source.enable_broadcast(ring_frames)},
+          reference{ring} {}
+
+    /// Produces `frames` frames, keeping a copy of them in `expected`.
+    void produce(std::size_t frames) {
+        while (frames > 0) {
+            // No more than the ring holds, or the reference copy itself laps
+            const auto made = source.produce(std::min(frames, ring.capacity()));
+            for (std::size_t ch = 0; ch < source.channels(); ++ch) {
+                source.buffer(ch).discard(made);  // Only the broadcast ring matters here
+            }
+            const auto start = expected.size();
+            expected.resize(start + made * ring.stride());
+            EXPECT_EQ(reference.read({expected.data() + start, made * ring.stride()}), made);
+            frames -= made;
+        }
+    }
+
+    SyntheticSource source;
+    const BroadcastRing<float>& ring;
+    BroadcastRing<float>::Reader reference;
+    std::vector<float> expected;
+};
+
+std::vector<float> read_back(const std::string& path, std::uint32_t channels) {
+    const FileSource file{{.path = path}};
+    EXPECT_EQ(file.sample_rate(), kSampleRate);
+    EXPECT_EQ(file.channels(), channels);
+    std::vector<float> samples(file.total_frames() * channels);
+    EXPECT_EQ(file.read_frames(0, samples), file.total_frames());
+    return samples;
+}
+
+TEST_F(RecorderTest, WritesEveryFrameAsFloatWav) {
+    // Three channels: 12-byte frames do not divide a page
+    Feed feed{3, 1 << 17};
+    Recorder recorder{feed.ring, kSampleRate,
+                      {.path_prefix = prefix(), .block_bytes = 4096, .blocks = 4,
+                       .poll_interval = 1ms}};
+    EXPECT_EQ(recorder.block_bytes() % 4096, 0);
+    EXPECT_EQ(recorder.block_bytes() % 12, 0);
+    EXPECT_EQ(recorder.files(), 1);
+
+    feed.produce(kSampleRate + 123);
+    recorder.close();
+    recorder.close();  // Idempotent
+
+    EXPECT_EQ(recorder.frames_written(), kSampleRate + 123);
+    EXPECT_EQ(recorder.frames_lost(), 0);
+    EXPECT_EQ(recorder.files(), 1);
+    EXPECT_FALSE(recorder.failed());
+    EXPECT_GT(recorder.buffered_seconds(), 2.7);  // 2^17 ring frames alone
+    EXPECT_EQ(read_back(Recorder::file_path(prefix(), 1), 3), feed.expected);
+
+    // The data is truncated back to whole frames after the padded last write
+    EXPECT_EQ(std::filesystem::file_size(Recorder::file_path(prefix(), 1)),
+              4096 + (kSampleRate + 123) * 12);
+}
+
+TEST_F(RecorderTest, RotatesOnDurationAndSize) {
+    Feed feed{2, 1 << 17};
+    {
+        // A quarter second per file; the last one holds the remainder
+        Recorder recorder{feed.ring, kSampleRate,
+                          {.path_prefix = prefix() + "_time", .block_bytes = 16384,
+                           .blocks = 3, .max_file_seconds = 0.25, .poll_interval = 1ms}};
+        feed.produce(4 * kSampleRate / 4 + 100);
+        recorder.close();
+        EXPECT_EQ(recorder.files(), 5);
+        EXPECT_EQ(recorder.frames_written(), kSampleRate + 100);
+    }
+    const auto per_file = std::size_t{kSampleRate / 4} * 2;
+    for (std::uint64_t i = 1; i <= 5; ++i) {
+        const auto samples = read_back(Recorder::file_path(prefix() + "_time", i), 2);
+        ASSERT_EQ(samples.size(), i < 5 ? per_file : 200) << i;
+        const auto first = feed.expected.begin() + static_cast<std::ptrdiff_t>((i - 1) * per_file);
+        EXPECT_TRUE(std::equal(samples.begin(), samples.end(), first)) << i;
+    }
+
+    // A byte limit that is not a whole number of frames rounds down
+    Recorder recorder{feed.ring, kSampleRate,
+                      {.path_prefix = prefix() + "_size", .block_bytes = 4096, .blocks = 2,
+                       .max_file_bytes = 10000 * 8 + 3, .poll_interval = 1ms}};
+    feed.produce(25000);
+    recorder.close();
+    EXPECT_EQ(recorder.files(), 3);
+    for (const std::uint64_t i : {1u, 2u}) {
+        EXPECT_EQ(FileSource{{.path = Recorder::file_path(prefix() + "_size", i)}}.total_frames(),
+                  10000);
+    }
+    EXPECT_FALSE(std::filesystem::exists(Recorder::file_path(prefix() + "_size", 4)));
+}
+
+TEST_F(RecorderTest, SkipsWhatItCannotBufferInsteadOfStalling) {
+    // A writer that sleeps through the whole burst: two blocks plus a small
+    // ring is all that can be kept
+    Feed feed{2, 2048};
+    Recorder recorder{feed.ring, kSampleRate,
+                      {.path_prefix = prefix(), .block_bytes = 8192, .blocks = 2,
+                       .poll_interval = 200ms}};
+    constexpr std::size_t kFrames = 100'000;
+    const auto start = std::chrono::steady_clock::now();
+    feed.produce(kFrames);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 200ms);  // Never waited for the disk
+    recorder.close();
+
+    EXPECT_GT(recorder.frames_lost(), 0);
+    EXPECT_EQ(recorder.frames_written() + recorder.frames_lost(), kFrames);
+    EXPECT_EQ(FileSource{{.path = Recorder::file_path(prefix(), 1)}}.total_frames(),
+              recorder.frames_written());
+}
+
+TEST_F(RecorderTest, BufferedWritesMatchDirectOnes) {
+    Feed feed{1, 1 << 16};
+    Recorder direct{feed.ring, kSampleRate, {.path_prefix = prefix() + "_direct",
+                                             .poll_interval = 1ms}};
+    Recorder buffered{feed.ring, kSampleRate, {.path_prefix = prefix() + "_buffered",
+                                               .direct_io = false, .poll_interval = 1ms}};
+    EXPECT_FALSE(buffered.direct_io());
+    feed.produce(5000);
+    direct.close();
+    buffered.close();
+
+    for (const auto* name : {"_direct", "_buffered"}) {
+        EXPECT_EQ(read_back(Recorder::file_path(prefix() + name, 1), 1), feed.expected) << name;
+    }
+}
+
+TEST_F(RecorderTest, HugeDurationsLeaveTheSizeLimit) {
+    const BroadcastRing<float> ring{1024, 2};
+    for (const double seconds : {std::numeric_limits<double>::infinity(), 1e300}) {
+        Recorder recorder{ring, kSampleRate,
+                          {.path_prefix = prefix(), .max_file_seconds = seconds}};
+        recorder.close();
+        EXPECT_EQ(recorder.files(), 1) << seconds;
+        EXPECT_FALSE(recorder.failed()) << seconds;
+    }
+}
+
+TEST_F(RecorderTest, RejectsBadConfiguration) {
+    const BroadcastRing<float> ring{1024, 2};
+    EXPECT_THROW((Recorder{ring, 0, {.path_prefix = prefix()}}), std::invalid_argument);
+    EXPECT_THROW((Recorder{ring, kSampleRate, {.path_prefix = prefix(), .blocks = 1}}),
+                 std::invalid_argument);
+    EXPECT_THROW((Recorder{ring, kSampleRate, {.path_prefix = prefix(), .max_file_bytes = 7}}),
+                 std::invalid_argument);
+    EXPECT_THROW((Recorder{ring, kSampleRate, {.path_prefix = prefix(), .max_file_seconds = -1}}),
+                 std::invalid_argument);
+    EXPECT_THROW((Recorder{ring, kSampleRate, {.path_prefix = (dir_ / "missing/take").string()}}),
+                 std::runtime_error);
+}
+
+}  // namespace
+}  // namespace audiovis
@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <cstdint>
 #include <thread>
 #include <vector>
 
@@ -185,6 +186,122 @@ TEST_F(RingBufferTest, PushOverwriteDropsOldData) {
     EXPECT_FLOAT_EQ(value, 1.0f);  // 0 was dropped
 }
 
+TEST_F(RingBufferTest, ReadRegionIsContiguousBeforeWrap) {
+    RingBuffer<float> buf{8};
+    std::array<float, 5> data = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    buf.try_push(data);
+
+    const auto region = buf.acquire_read(3);
+    EXPECT_EQ(region.size(), 3);
+    ASSERT_EQ(region.first.size(), 3);
+    EXPECT_TRUE(region.second.empty());
+    EXPECT_FLOAT_EQ(region.first[0], 1.0f);
+    EXPECT_FLOAT_EQ(region.first[2], 3.0f);
+
+    // Acquiring does not consume
+    EXPECT_EQ(buf.size(), 5);
+}
+
+TEST_F(RingBufferTest, ReadRegionSplitsAtWrapPoint) {
+    RingBuffer<float> buf{4};
+
+    for (int i = 0; i < 4; ++i) {
+        buf.try_push(static_cast<float>(i));
+    }
+    buf.discard(3);
+    buf.try_push(10.0f);
+    buf.try_push(11.0f);
+
+    // Logical contents: 3, 10, 11 - the last two live at the array start
+    const auto region = buf.acquire_read(16);
+    EXPECT_EQ(region.size(), 3);
+    ASSERT_EQ(region.first.size(), 1);
+    ASSERT_EQ(region.second.size(), 2);
+    EXPECT_FLOAT_EQ(region.first[0], 3.0f);
+    EXPECT_FLOAT_EQ(region.second[0], 10.0f);
+    EXPECT_FLOAT_EQ(region.second[1], 11.0f);
+}
+
+TEST_F(RingBufferTest, PartialCommitReadKeepsRemainder) {
+    RingBuffer<float> buf{kDefaultCapacity};
+
+    for (int i = 0; i < 8; ++i) {
+        buf.try_push(static_cast<float>(i));
+    }
+
+    const auto region = buf.acquire_read(8);
+    EXPECT_EQ(region.size(), 8);
+    buf.commit_read(2);  // Keep 6 samples of overlap
+
+    EXPECT_EQ(buf.size(), 6);
+    const auto next = buf.acquire_read(1);
+    EXPECT_FLOAT_EQ(next.first[0], 2.0f);
+}
+
+TEST_F(RingBufferTest, WriteRegionLimitedByFreeSpace) {
+    RingBuffer<float> buf{4};
+    buf.try_push(1.0f);
+
+    const auto region = buf.acquire_write(10);
+    EXPECT_EQ(region.size(), 3);
+
+    // Nothing published until commit
+    EXPECT_EQ(buf.size(), 1);
+}
+
+TEST_F(RingBufferTest, WriteRegionCommitPublishesInPlaceWrites) {
+    RingBuffer<float> buf{4};
+
+    for (int i = 0; i < 3; ++i) {
+        buf.try_push(static_cast<float>(i));
+    }
+    buf.discard(3);
+
+    // Write position sits at index 3, so a 3-slot region wraps
+    auto region = buf.acquire_write(3);
+    ASSERT_EQ(region.first.size(), 1);
+    ASSERT_EQ(region.second.size(), 2);
+    region.first[0] = 20.0f;
+    region.second[0] = 21.0f;
+    region.second[1] = 22.0f;
+    buf.commit_write(region.size());
+
+    std::array<float, 3> out{};
+    EXPECT_EQ(buf.try_pop(out), 3);
+    EXPECT_FLOAT_EQ(out[0], 20.0f);
+    EXPECT_FLOAT_EQ(out[1], 21.0f);
+    EXPECT_FLOAT_EQ(out[2], 22.0f);
+}
+
+TEST_F(RingBufferTest, SpanOperationsWrapAround) {
+    RingBuffer<float> buf{8};
+    std::array<float, 6> first = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    buf.try_push(first);
+    buf.discard(5);
+
+    std::array<float, 6> second = {6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f};
+    EXPECT_EQ(buf.try_push(second), 6);
+
+    std::array<float, 7> out{};
+    EXPECT_EQ(buf.peek(out), 7);
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        EXPECT_FLOAT_EQ(out[i], static_cast<float>(i + 5));
+    }
+}
+
+TEST_F(RingBufferTest, StorageFollowsBufferPolicy) {
+    RingBuffer<float> buf{1 << 20, {.placement = MemoryPlacement::FirstTouch, .alignment = 4096}};
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(buf.storage().data()) % 4096, 0);
+    EXPECT_EQ(buf.storage().size(), buf.capacity() * sizeof(float));
+
+    // Untouched pages still read as an ordinary ring
+    std::array<float, 3> in = {1.0f, 2.0f, 3.0f};
+    EXPECT_EQ(buf.try_push(in), 3);
+    std::array<float, 3> out{};
+    EXPECT_EQ(buf.try_pop(out), 3);
+    EXPECT_EQ(out, in);
+}
+
 // Stress test for thread safety
 TEST_F(RingBufferTest, ConcurrentProducerConsumer) {
     constexpr std::size_t kNumItems = 100000;
@@ -0,0 +1,122 @@
+#include "audiovis/latency_histogram.hpp"
+#include "audiovis/seqlock.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+using std::chrono::microseconds;
+
+/// Spans several words so a torn read would be visible.
+struct Snapshot {
+    std::uint64_t sequence = 0;
+    std::array<std::uint64_t, 14> copies{};  // All equal to sequence when consistent
+    float level = 0.0f;
+};
+
+TEST(SeqLockTest, LoadsInitialValue) {
+    SeqLock<int> lock{7};
+    EXPECT_EQ(lock.load(), 7);
+    EXPECT_EQ(lock.version(), 1);
+}
+
+TEST(SeqLockTest, DefaultConstructsValue) {
+    SeqLock<Snapshot> lock;
+    const auto value = lock.load();
+    EXPECT_EQ(value.sequence, 0);
+    EXPECT_FLOAT_EQ(value.level, 0.0f);
+}
+
+TEST(SeqLockTest, LoadReturnsLatestStore) {
+    SeqLock<Snapshot> lock;
+    Snapshot value;
+    value.sequence = 42;
+    value.copies.fill(42);
+    value.level = 0.5f;
+
+    lock.store(value);
+
+    const auto loaded = lock.load();
+    EXPECT_EQ(loaded.sequence, 42);
+    EXPECT_EQ(loaded.copies.back(), 42);
+    EXPECT_FLOAT_EQ(loaded.level, 0.5f);
+    EXPECT_EQ(lock.version(), 2);
+}
+
+TEST(SeqLockTest, ConcurrentReadersNeverSeeTornValues) {
+    constexpr std::uint64_t kStores = 200'000;
+    SeqLock<Snapshot> lock;
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> torn{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            std::uint64_t last = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                const auto value = lock.load();
+                for (const auto copy : value.copies) {
+                    if (copy != value.sequence) {
+                        torn.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                // Snapshots never go back in time
+                if (value.sequence < last) {
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                }
+                last = value.sequence;
+            }
+        });
+    }
+
+    Snapshot value;
+    for (std::uint64_t i = 1; i <= kStores; ++i) {
+        value.sequence = i;
+        value.copies.fill(i);
+        lock.store(value);
+    }
+    done.store(true, std::memory_order_release);
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(lock.load().sequence, kStores);
+}
+
+TEST(LatencyHistogramTest, BucketsArePowersOfTwo) {
+    EXPECT_EQ(LatencyHistogram::bucket_for(microseconds{0}), 0);
+    EXPECT_EQ(LatencyHistogram::bucket_for(microseconds{1}), 1);
+    EXPECT_EQ(LatencyHistogram::bucket_for(microseconds{3}), 2);
+    EXPECT_EQ(LatencyHistogram::bucket_for(microseconds{4}), 3);
+    EXPECT_EQ(LatencyHistogram::bucket_for(microseconds{5333}), 13);  // 256 frames @ 48 kHz
+    EXPECT_EQ(LatencyHistogram::bucket_for(microseconds{-5}), 0);
+    EXPECT_EQ(LatencyHistogram::bucket_for(std::chrono::hours{1}), LatencyHistogram::kBuckets - 1);
+}
+
+TEST(LatencyHistogramTest, PercentileReportsBucketUpperBound) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(0.99), microseconds{0});
+
+    for (int i = 0; i < 99; ++i) {
+        histogram.record(microseconds{5300});
+    }
+    histogram.record(microseconds{20000});  // One late callback
+
+    EXPECT_EQ(histogram.total(), 100);
+    EXPECT_EQ(histogram.max_us, 20000);
+    EXPECT_EQ(histogram.percentile(0.5), microseconds{8192});
+    EXPECT_EQ(histogram.percentile(0.98), microseconds{8192});
+    EXPECT_EQ(histogram.percentile(1.0), microseconds{32768});
+}
+
+}  // namespace
+}  // namespace audiovis
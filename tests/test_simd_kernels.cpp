@@ -0,0 +1,142 @@
+#include "audiovis/simd_kernels.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace audiovis::simd {
+namespace {
+
+// Odd length so every vector path also exercises its scalar tail
+constexpr std::size_t kLength = 1027;
+
+std::vector<float> make_ramp(std::size_t n, float start, float step) {
+    std::vector<float> values(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        values[i] = start + step * static_cast<float>(i);
+    }
+    return values;
+}
+
+TEST(SimdKernelsTest, ReportsActiveIsa) {
+    const Isa isa = active_isa();
+    EXPECT_STRNE(isa_name(isa), "");
+    EXPECT_EQ(active_isa(), isa);  // Stable across calls
+}
+
+TEST(SimdKernelsTest, FastLog2MatchesStdLog2) {
+    for (float x = 1e-18f; x < 1e6f; x *= 1.37f) {
+        EXPECT_NEAR(fast_log2(x), std::log2(x), 1e-5f) << "x = " << x;
+    }
+    EXPECT_NEAR(fast_log2(1.0f), 0.0f, 1e-6f);
+    EXPECT_NEAR(fast_log2(1024.0f), 10.0f, 1e-6f);
+}
+
+TEST(SimdKernelsTest, ApplyWindowMultipliesElementwise) {
+    const auto in = make_ramp(kLength, -1.0f, 0.002f);
+    const auto window = make_ramp(kLength, 0.25f, 0.001f);
+    std::vector<float> out(kLength);
+
+    apply_window(in, window.data(), out.data());
+
+    for (std::size_t i = 0; i < kLength; ++i) {
+        EXPECT_FLOAT_EQ(out[i], in[i] * window[i]);
+    }
+}
+
+TEST(SimdKernelsTest, ApplyWindowInPlace) {
+    auto data = make_ramp(kLength, 1.0f, 0.5f);
+    const auto original = data;
+    const std::vector<float> window(kLength, 2.0f);
+
+    apply_window(data, window.data(), data.data());
+
+    for (std::size_t i = 0; i < kLength; ++i) {
+        EXPECT_FLOAT_EQ(data[i], original[i] * 2.0f);
+    }
+}
+
+TEST(SimdKernelsTest, PowerSpectrumMatchesReference) {
+    const auto complex = make_ramp(2 * kLength, -3.0f, 0.0037f);
+    std::vector<float> out(kLength);
+
+    power_spectrum(complex.data(), out);
+
+    for (std::size_t i = 0; i < kLength; ++i) {
+        const float re = complex[2 * i];
+        const float im = complex[2 * i + 1];
+        EXPECT_NEAR(out[i], re * re + im * im, 1e-5f) << "bin " << i;
+    }
+}
+
+TEST(SimdKernelsTest, NormalizedDbMatchesReference) {
+    constexpr float kFloor = -80.0f;
+    constexpr float kCeiling = 0.0f;
+    constexpr float kScale = 0.5f;
+
+    // Powers spanning well below the floor to above the ceiling
+    std::vector<float> power(kLength);
+    for (std::size_t i = 0; i < kLength; ++i) {
+        power[i] = std::pow(10.0f, -12.0f + 0.0125f * static_cast<float>(i));
+    }
+    std::vector<float> out(kLength);
+
+    power_to_normalized_db(power, out.data(), kScale, kFloor, kCeiling);
+
+    for (std::size_t i = 0; i < kLength; ++i) {
+        const float db = std::clamp(10.0f * std::log10(power[i] * kScale), kFloor, kCeiling);
+        const float expected = (db - kFloor) / (kCeiling - kFloor);
+        EXPECT_NEAR(out[i], expected, 1e-5f) << "power " << power[i];
+        EXPECT_GE(out[i], 0.0f);
+        EXPECT_LE(out[i], 1.0f);
+    }
+}
+
+TEST(SimdKernelsTest, NormalizedDbHandlesSilence) {
+    const std::vector<float> power(kLength, 0.0f);
+    std::vector<float> out(kLength, -1.0f);
+
+    power_to_normalized_db(power, out.data(), 1.0f, -60.0f, 0.0f);
+
+    for (const float value : out) {
+        EXPECT_FLOAT_EQ(value, 0.0f);
+    }
+}
+
+TEST(SimdKernelsTest, MagnitudeIsScaledSquareRoot) {
+    const auto power = make_ramp(kLength, 0.0f, 0.25f);
+    std::vector<float> out(kLength);
+
+    power_to_magnitude(power, out.data(), 4.0f);
+
+    for (std::size_t i = 0; i < kLength; ++i) {
+        EXPECT_FLOAT_EQ(out[i], std::sqrt(power[i] * 4.0f));
+    }
+}
+
+TEST(SimdKernelsTest, DotMatchesReference) {
+    const auto a = make_ramp(kLength, -1.0f, 0.002f);
+    const auto b = make_ramp(kLength, 0.5f, 0.001f);
+
+    // Every length up to a few vectors, covering all tail sizes
+    for (std::size_t n = 0; n < 40; ++n) {
+        double expected = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            expected += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+        }
+        const float actual = dot(std::span{a}.first(n), b.data());
+        EXPECT_NEAR(actual, expected, 1e-5) << "n = " << n;
+    }
+
+    double expected = 0.0;
+    for (std::size_t i = 0; i < kLength; ++i) {
+        expected += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+    }
+    EXPECT_NEAR(dot(a, b.data()), expected, 1e-3);
+}
+
+}  // namespace
+}  // namespace audiovis::simd
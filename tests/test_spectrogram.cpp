@@ -0,0 +1,141 @@
+#include "audiovis/file_source.hpp"
+#include "audiovis/spectrogram.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+
+std::vector<float> generate_sine(float frequency, std::size_t num_samples) {
+    std::vector<float> samples(num_samples);
+    const float omega = 2.0f * std::numbers::pi_v<float> * frequency / kSampleRate;
+    for (std::size_t i = 0; i < num_samples; ++i) {
+        samples[i] = 0.5f * std::sin(omega * static_cast<float>(i));
+    }
+    return samples;
+}
+
+/// A sine whose frequency steps up every 4096 samples, so frames differ.
+std::vector<float> generate_steps(std::size_t num_samples) {
+    std::vector<float> samples(num_samples);
+    double phase = 0.0;
+    for (std::size_t i = 0; i < num_samples; ++i) {
+        const double frequency = 200.0 * static_cast<double>(1 + i / 4096);
+        phase += frequency / static_cast<double>(kSampleRate);
+        samples[i] = static_cast<float>(0.5 * std::sin(2.0 * std::numbers::pi * phase));
+    }
+    return samples;
+}
+
+TEST(SpectrogramTest, FrameCountDropsPartialWindow) {
+    const SpectrogramEngine engine{{.fft = {.fft_size = 1024}, .hop_size = 256}};
+    const auto samples = generate_sine(1000.0f, 10000);
+
+    const auto result = engine.compute(samples, kSampleRate);
+    EXPECT_EQ(result.frames, (10000 - 1024) / 256 + 1);
+    EXPECT_EQ(result.columns, 64);
+    EXPECT_EQ(result.values.size(), result.frames * result.columns);
+    EXPECT_EQ(result.edges.size(), result.columns + 1);
+    EXPECT_DOUBLE_EQ(result.frame_time(3), 768.0 / 48000.0);
+
+    EXPECT_EQ(engine.compute(std::span{samples}.first(1000), kSampleRate).frames, 0);
+}
+
+TEST(SpectrogramTest, BinsMatchFFTProcessor) {
+    const SpectrogramEngine engine{{.fft = {.fft_size = 512},
+                                    .hop_size = 100,
+                                    .resolution = SpectrogramResolution::Bins,
+                                    .threads = 3,
+                                    .chunk_frames = 5}};
+    const auto samples = generate_steps(20000);
+    const auto result = engine.compute(samples, kSampleRate);
+
+    ASSERT_EQ(result.columns, 257);
+    EXPECT_FLOAT_EQ(result.edges[1], 0.5f * kSampleRate / 512.0f);
+    EXPECT_FLOAT_EQ(result.edges.back(), kSampleRate / 2.0f);
+
+    FFTProcessor fft{{.fft_size = 512}};
+    std::vector<float> expected(fft.bin_count());
+    for (const std::size_t frame : {std::size_t{0}, std::size_t{77}, result.frames - 1}) {
+        fft.compute(std::span<const float>{samples}.subspan(frame * 100, 512), expected);
+        const auto row = result.frame(frame);
+        EXPECT_TRUE(std::equal(row.begin(), row.end(), expected.begin())) << "frame " << frame;
+    }
+}
+
+TEST(SpectrogramTest, ThreadCountDoesNotChangeResult) {
+    const auto samples = generate_steps(100000);
+    const SpectrogramEngine serial{{.fft = {.fft_size = 2048}, .hop_size = 256, .threads = 1}};
+    const SpectrogramEngine parallel{
+        {.fft = {.fft_size = 2048}, .hop_size = 256, .threads = 8, .chunk_frames = 3}};
+    EXPECT_EQ(parallel.thread_count(), 8);
+
+    const auto a = serial.compute(samples, kSampleRate);
+    const auto b = parallel.compute(samples, kSampleRate);
+    EXPECT_EQ(a.frames, b.frames);
+    EXPECT_EQ(a.values, b.values);
+}
+
+TEST(SpectrogramTest, SinePeaksInItsBand) {
+    const SpectrogramEngine engine{{.hop_size = 1024}};
+    const auto result = engine.compute(generate_sine(2500.0f, 48000), kSampleRate);
+
+    const auto upper = std::upper_bound(result.edges.begin(), result.edges.end(), 2500.0f);
+    const auto expected = static_cast<std::size_t>(upper - result.edges.begin()) - 1;
+    for (std::size_t frame = 0; frame < result.frames; ++frame) {
+        const auto row = result.frame(frame);
+        const auto peak = std::max_element(row.begin(), row.end()) - row.begin();
+        ASSERT_EQ(static_cast<std::size_t>(peak), expected) << "frame " << frame;
+    }
+}
+
+TEST(SpectrogramTest, FileIsMixedDownToMono) {
+    // Stereo raw float: left carries the signal, right is silent
+    const auto signal = generate_steps(30000);
+    std::vector<float> interleaved;
+    for (const float s : signal) {
+        interleaved.push_back(s);
+        interleaved.push_back(0.0f);
+    }
+    const auto path =
+        (std::filesystem::temp_directory_path() / "audiovis_spectrogram.f32").string();
+    std::ofstream{path, std::ios::binary}.write(
+        reinterpret_cast<const char*>(interleaved.data()),
+        static_cast<std::streamsize>(interleaved.size() * sizeof(float)));
+
+    const FileSource file{{.path = path, .channels = 2}};
+    const SpectrogramEngine engine{{.hop_size = 700, .threads = 4, .chunk_frames = 2}};
+
+    std::vector<float> mono(signal.size());
+    std::transform(signal.begin(), signal.end(), mono.begin(), [](float s) { return 0.5f * s; });
+
+    const auto from_file = engine.compute(file);
+    const auto from_memory = engine.compute(mono, kSampleRate);
+    EXPECT_GT(from_file.frames, 0);
+    EXPECT_EQ(from_file.frames, from_memory.frames);
+    EXPECT_EQ(from_file.values, from_memory.values);
+}
+
+TEST(SpectrogramTest, RejectsInvalidConfig) {
+    EXPECT_THROW(SpectrogramEngine({.hop_size = 0}), std::invalid_argument);
+    EXPECT_THROW(SpectrogramEngine({.chunk_frames = 0}), std::invalid_argument);
+
+    const SpectrogramEngine engine;
+    const std::vector<float> samples(4096);
+    EXPECT_THROW(static_cast<void>(engine.compute(samples, 0.0f)), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace audiovis
@@ -0,0 +1,239 @@
+#include "audiovis/spectrogram.hpp"
+#include "audiovis/spectrogram_file.hpp"
+#include "audiovis/spectrum_analyzer.hpp"
+#include "audiovis/synthetic_source.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+
+std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+SpectrogramInfo small_info() {
+    return SpectrogramInfo{.sample_rate = 48000.0f,
+                           .fft_size = 1024,
+                           .hop_size = 256,
+                           .channels = 2,
+                           .edges = {20.0f, 200.0f, 2000.0f, 20000.0f}};
+}
+
+/// Frame i holds values i * 0.01 + j * 0.1 for j in 0..5 (all within 0..1).
+std::vector<float> frame_values(std::size_t i) {
+    std::vector<float> values(6);
+    for (std::size_t j = 0; j < values.size(); ++j) {
+        values[j] = static_cast<float>(i) * 0.01f + static_cast<float>(j) * 0.1f;
+    }
+    return values;
+}
+
+/// Writes 50 frames 10 ms apart with the given encoding.
+std::string write_frames(const std::string& name, SpectrogramEncoding encoding) {
+    const auto path = temp_path(name);
+    SpectrogramWriter writer{path, small_info(), {.encoding = encoding}};
+    EXPECT_EQ(writer.frame_stride(), 16 + 6 * (encoding == SpectrogramEncoding::Float32   ? 4
+                                               : encoding == SpectrogramEncoding::Float16 ? 2
+                                                                                          : 1));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < 50; ++i) {
+        SpectrumData data;
+        data.magnitudes = frame_values(i);
+        data.channel_count = 2;
+        data.rms_level = static_cast<float>(i);
+        data.peak_level = 2.0f * static_cast<float>(i);
+        data.timestamp = start + milliseconds{10 * static_cast<std::int64_t>(i)};
+        EXPECT_TRUE(writer.append(data));
+    }
+    writer.close();
+    EXPECT_EQ(writer.frames_queued(), 50);
+    EXPECT_EQ(writer.frames_dropped(), 0);
+    return path;
+}
+
+TEST(SpectrogramFileTest, Float32RoundTripsExactly) {
+    const SpectrogramReader reader{write_frames("audiovis_f32.avsg", SpectrogramEncoding::Float32)};
+
+    EXPECT_EQ(reader.frame_count(), 50);
+    EXPECT_EQ(reader.encoding(), SpectrogramEncoding::Float32);
+    EXPECT_FLOAT_EQ(reader.info().sample_rate, 48000.0f);
+    EXPECT_EQ(reader.info().fft_size, 1024);
+    EXPECT_EQ(reader.info().hop_size, 256);
+    EXPECT_EQ(reader.info().channels, 2);
+    EXPECT_EQ(reader.info().edges, small_info().edges);
+
+    std::vector<float> values(6);
+    for (const std::size_t i : {std::size_t{0}, std::size_t{17}, std::size_t{49}}) {
+        const auto meta = reader.read(i, values);
+        EXPECT_EQ(values, frame_values(i));
+        EXPECT_EQ(meta.time, milliseconds{10 * static_cast<std::int64_t>(i)});
+        EXPECT_FLOAT_EQ(meta.rms_level, static_cast<float>(i));
+        EXPECT_FLOAT_EQ(meta.peak_level, 2.0f * static_cast<float>(i));
+    }
+}
+
+TEST(SpectrogramFileTest, QuantizedEncodingsStayClose) {
+    const SpectrogramReader half{write_frames("audiovis_f16.avsg", SpectrogramEncoding::Float16)};
+    const SpectrogramReader byte{write_frames("audiovis_u8.avsg", SpectrogramEncoding::UInt8)};
+    ASSERT_EQ(half.frame_count(), 50);
+    ASSERT_EQ(byte.frame_count(), 50);
+
+    std::vector<float> values(6);
+    for (std::size_t i = 0; i < 50; ++i) {
+        const auto expected = frame_values(i);
+        half.read(i, values);
+        for (std::size_t j = 0; j < values.size(); ++j) {
+            EXPECT_NEAR(values[j], expected[j], 1e-3f * expected[j] + 1e-6f);
+        }
+        byte.read(i, values);
+        for (std::size_t j = 0; j < values.size(); ++j) {
+            EXPECT_NEAR(values[j], expected[j], 0.5f / 255.0f + 1e-6f);
+        }
+    }
+}
+
+TEST(SpectrogramFileTest, Float16HandlesSpecialValues) {
+    const auto path = temp_path("audiovis_f16_special.avsg");
+    const SpectrogramInfo info{.sample_rate = 8000.0f, .edges = {0.0f, 1.0f, 2.0f, 3.0f,
+                                                                4.0f, 5.0f, 6.0f}};
+    const std::vector<float> written{0.0f, -2.5f, 65504.0f, 1e6f, 1e-6f, 1e-9f};
+    {
+        SpectrogramWriter writer{path, info, {.encoding = SpectrogramEncoding::Float16}};
+        ASSERT_TRUE(writer.append(written, {}));
+    }
+
+    const SpectrogramReader reader{path};
+    std::vector<float> values(6);
+    reader.read(0, values);
+    EXPECT_EQ(values[0], 0.0f);
+    EXPECT_EQ(values[1], -2.5f);
+    EXPECT_EQ(values[2], 65504.0f);                                // Largest half
+    EXPECT_EQ(values[3], std::numeric_limits<float>::infinity());  // Overflow
+    EXPECT_NEAR(values[4], 1e-6f, 3e-8f);                          // Subnormal
+    EXPECT_EQ(values[5], 0.0f);                                    // Underflow
+}
+
+TEST(SpectrogramFileTest, FindsFramesByTime) {
+    const SpectrogramReader reader{write_frames("audiovis_find.avsg", SpectrogramEncoding::UInt8)};
+
+    EXPECT_EQ(reader.find(nanoseconds{0}), 0);
+    EXPECT_EQ(reader.find(milliseconds{95}), 9);
+    EXPECT_EQ(reader.find(milliseconds{100}), 10);
+    EXPECT_EQ(reader.find(std::chrono::hours{1}), 49);
+    EXPECT_EQ(reader.frame(10).time, milliseconds{100});
+}
+
+TEST(SpectrogramFileTest, IgnoresTruncatedTrailingRecord) {
+    const auto path = write_frames("audiovis_truncated.avsg", SpectrogramEncoding::Float32);
+    const auto size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 5);
+
+    const SpectrogramReader reader{path};
+    EXPECT_EQ(reader.frame_count(), 49);
+}
+
+TEST(SpectrogramFileTest, RoundTripsOfflineSpectrogram) {
+    std::vector<float> samples(24000);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = std::sin(0.05f * static_cast<float>(i));
+    }
+    const SpectrogramEngine engine{{.hop_size = 1000}};
+    const auto spectrogram = engine.compute(samples, 48000.0f);
+
+    const auto path = temp_path("audiovis_offline.avsg");
+    write_spectrogram(path, spectrogram, {.encoding = SpectrogramEncoding::Float32});
+
+    const SpectrogramReader reader{path};
+    ASSERT_EQ(reader.frame_count(), spectrogram.frames);
+    EXPECT_EQ(reader.info().edges, spectrogram.edges);
+    EXPECT_EQ(reader.info().hop_size, 1000);
+
+    std::vector<float> values(reader.info().values_per_frame());
+    const auto last = spectrogram.frames - 1;
+    const auto meta = reader.read(last, values);
+    const auto expected = spectrogram.frame(last);
+    EXPECT_TRUE(std::equal(values.begin(), values.end(), expected.begin()));
+    EXPECT_EQ(meta.time,
+              nanoseconds{static_cast<std::int64_t>(last) * 1000 * 1'000'000'000 / 48000});
+}
+
+TEST(SpectrogramFileTest, DescribesAnalyzerFrames) {
+    SpectrumAnalyzer analyzer{std::make_unique<SyntheticSource>(SyntheticConfig{.channels = 2}),
+                              {.fft_size = 4096},
+                              {.num_bands = 32, .hop_size = 1024}};
+    const auto info = spectrogram_info(analyzer);
+
+    EXPECT_EQ(info.fft_size, 4096);
+    EXPECT_EQ(info.hop_size, 1024);
+    EXPECT_EQ(info.channels, 2);
+    EXPECT_EQ(info.bands(), 32);
+    EXPECT_EQ(info.values_per_frame(), 64);
+    EXPECT_FLOAT_EQ(info.edges.front(), 20.0f);
+}
+
+TEST(SpectrogramFileTest, RejectsBadInput) {
+    const auto path = temp_path("audiovis_bad.avsg");
+    EXPECT_THROW(SpectrogramWriter(path, SpectrogramInfo{}), std::invalid_argument);
+    EXPECT_THROW(SpectrogramWriter(path, small_info(), {.encoding = SpectrogramEncoding::UInt8,
+                                                        .value_min = 1.0f, .value_max = 1.0f}),
+                 std::invalid_argument);
+    // Header fields are 32 bits; larger values must not be truncated
+    auto wide = small_info();
+    wide.fft_size = std::size_t{1} << 32;
+    EXPECT_THROW(SpectrogramWriter(path, wide), std::invalid_argument);
+
+    {
+        SpectrogramWriter writer{path, small_info()};
+        EXPECT_FALSE(writer.append(std::vector<float>(5), {}));  // Wrong size
+        EXPECT_EQ(writer.frames_dropped(), 1);
+    }
+
+    std::ofstream{temp_path("audiovis_garbage.avsg")} << "definitely not a spectrogram file at all"
+                                                         " but long enough to hold a header";
+    EXPECT_THROW(SpectrogramReader(temp_path("audiovis_garbage.avsg")), std::runtime_error);
+    EXPECT_THROW(SpectrogramReader("/nonexistent/audiovis.avsg"), std::runtime_error);
+
+    // Band counts whose sizes wrap in 32 bits, with a header size to match the wrap
+    for (const std::uint32_t bands : {0xFFFFFFFFu, 0x40000000u}) {
+        std::vector<char> header(64, 0);
+        const auto put_u32 = [&](std::size_t offset, std::uint32_t value) {
+            for (std::size_t i = 0; i < 4; ++i) {
+                header[offset + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+        };
+        header[0] = 'A';
+        header[1] = 'V';
+        header[2] = 'S';
+        header[3] = 'G';
+        header[4] = 1;                                     // Version
+        put_u32(8, 48 + 4 * (bands + 1));                  // Header size, as it wraps
+        put_u32(12, 16 + 4 * 2);                           // Stride
+        put_u32(28, 1);                                    // Channels
+        put_u32(32, bands);
+        const auto crafted = temp_path("audiovis_huge_bands.avsg");
+        std::ofstream{crafted, std::ios::binary}.write(header.data(),
+                                                       static_cast<std::streamsize>(header.size()));
+        EXPECT_THROW(SpectrogramReader{crafted}, std::runtime_error) << bands;
+    }
+}
+
+}  // namespace
+}  // namespace audiovis
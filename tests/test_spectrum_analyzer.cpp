@@ -0,0 +1,416 @@
+#include "audiovis/spectrum_analyzer.hpp"
+#include "audiovis/synthetic_source.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+constexpr std::size_t kFftSize = 2048;
+
+std::unique_ptr<AudioSource> sine(float frequency, float seconds, std::uint32_t channels = 1) {
+    return std::make_unique<SyntheticSource>(SyntheticConfig{
+        .channels = channels, .frequency = frequency, .duration_seconds = seconds});
+}
+
+/// Returns the band whose edges contain `frequency` for the analyzer's layout.
+std::size_t band_of(const AnalyzerConfig& config, std::size_t bins, float frequency) {
+    const BandMatrix matrix{{.num_bands = config.num_bands,
+                             .min_frequency = config.min_frequency,
+                             .max_frequency = config.max_frequency,
+                             .scale = config.frequency_scale,
+                             .weighting = config.band_weighting},
+                            bins, kFftSize, 48000.0f};
+    const auto edges = matrix.band_edges();
+    const auto upper = std::upper_bound(edges.begin(), edges.end(), frequency);
+    return static_cast<std::size_t>(std::distance(edges.begin(), upper)) - 1;
+}
+
+std::size_t loudest(std::span<const float> bands) {
+    return static_cast<std::size_t>(
+        std::distance(bands.begin(), std::max_element(bands.begin(), bands.end())));
+}
+
+TEST(SpectrumAnalyzerTest, RejectsNullSource) {
+    EXPECT_THROW(SpectrumAnalyzer(std::unique_ptr<AudioSource>{}), std::invalid_argument);
+}
+
+TEST(SpectrumAnalyzerTest, AnalyzeAllEmitsEveryHop) {
+    constexpr std::size_t kHop = 512;
+    const AnalyzerConfig config{.hop_size = kHop};
+    SpectrumAnalyzer analyzer{sine(1000.0f, 1.0f), {.fft_size = kFftSize}, config};
+
+    std::size_t callbacks = 0;
+    const auto frames = analyzer.analyze_all([&](const SpectrumData&) { ++callbacks; });
+
+    // Trailing partial window is dropped
+    EXPECT_EQ(frames, (48000 - kFftSize) / kHop + 1);
+    EXPECT_EQ(callbacks, frames);
+    EXPECT_TRUE(analyzer.audio().at_end());
+}
+
+TEST(SpectrumAnalyzerTest, SinePeaksInItsBand) {
+    const AnalyzerConfig config{.smoothing_factor = 0.0f, .hop_size = 1024};
+    SpectrumAnalyzer analyzer{sine(3000.0f, 0.5f), {.fft_size = kFftSize}, config};
+
+    SpectrumData last;
+    analyzer.analyze_all([&](const SpectrumData& frame) { last = frame; });
+
+    ASSERT_EQ(last.magnitudes.size(), config.num_bands);
+    EXPECT_EQ(loudest(last.magnitudes), band_of(config, kFftSize / 2 + 1, 3000.0f));
+    EXPECT_GT(last.rms_level, 0.3f);  // 0.5 amplitude sine: 0.354
+}
+
+TEST(SpectrumAnalyzerTest, MidSideCancelsIdenticalChannels) {
+    const AnalyzerConfig config{.smoothing_factor = 0.0f, .hop_size = 2048,
+                                .channel_mode = ChannelMode::MidSide};
+    SpectrumAnalyzer analyzer{sine(500.0f, 0.25f, 2), {.fft_size = kFftSize}, config};
+    EXPECT_EQ(analyzer.channels(), 2);
+
+    SpectrumData last;
+    ASSERT_GT(analyzer.analyze_all([&](const SpectrumData& frame) { last = frame; }), 0);
+
+    const auto mid = last.channel_magnitudes(0);
+    const auto side = last.channel_magnitudes(1);
+    EXPECT_GT(*std::max_element(mid.begin(), mid.end()), 0.1f);
+    EXPECT_FLOAT_EQ(*std::max_element(side.begin(), side.end()), 0.0f);
+}
+
+TEST(SpectrumAnalyzerTest, MidSideRequiresStereo) {
+    EXPECT_THROW(SpectrumAnalyzer(sine(500.0f, 0.1f), {},
+                                  {.channel_mode = ChannelMode::MidSide}),
+                 std::invalid_argument);
+}
+
+TEST(SpectrumAnalyzerTest, UpdateAnalyzesNewestWindow) {
+    auto owned = sine(3000.0f, 1.0f);
+    auto& source = *owned;
+    SpectrumAnalyzer analyzer{std::move(owned), {.fft_size = kFftSize}, {.smoothing_factor = 0.0f}};
+
+    SpectrumData data;
+    EXPECT_FALSE(analyzer.update(data));  // Nothing buffered yet
+    EXPECT_EQ(data.magnitudes.size(), 64);
+
+    source.produce(4 * kFftSize);
+    EXPECT_TRUE(analyzer.update(data));
+    EXPECT_EQ(analyzer.audio().buffer().size(), 0);  // Older samples skipped
+    EXPECT_EQ(loudest(data.magnitudes), band_of(analyzer.config(), kFftSize / 2 + 1, 3000.0f));
+}
+
+TEST(SpectrumAnalyzerTest, StreamingUpdateRunsDueFrames) {
+    auto owned = sine(3000.0f, 1.0f);
+    auto& source = *owned;
+    SpectrumAnalyzer analyzer{std::move(owned), {.fft_size = kFftSize}, {.hop_size = 256}};
+
+    source.produce(kFftSize + 3 * 256);
+    SpectrumData data;
+    EXPECT_TRUE(analyzer.update(data));
+    EXPECT_EQ(analyzer.audio().buffer().size(), kFftSize - 256);  // History kept
+    EXPECT_FALSE(analyzer.update(data));
+}
+
+TEST(SpectrumAnalyzerTest, AnalyzeAllRejectsRunningSource) {
+    SpectrumAnalyzer analyzer{sine(1000.0f, 5.0f)};
+    analyzer.start();
+    EXPECT_THROW(analyzer.analyze_all(nullptr), std::logic_error);
+    analyzer.stop();
+}
+
+TEST(SpectrumAnalyzerTest, MultiResolutionValidatesTiers) {
+    EXPECT_THROW(SpectrumAnalyzer(sine(500.0f, 0.1f), {}, {.hop_size = 512, .resolution_tiers = 0}),
+                 std::invalid_argument);
+    EXPECT_THROW(SpectrumAnalyzer(sine(500.0f, 0.1f), {}, {.hop_size = 512, .resolution_tiers = 9}),
+                 std::invalid_argument);
+    EXPECT_THROW(SpectrumAnalyzer(sine(500.0f, 0.1f), {}, {.resolution_tiers = 2}),
+                 std::invalid_argument);  // Needs a streaming hop
+}
+
+TEST(SpectrumAnalyzerTest, MultiResolutionGivesLowBandsToDeeperTiers) {
+    const AnalyzerConfig config{.num_bands = 128, .hop_size = 512, .resolution_tiers = 4};
+    SpectrumAnalyzer analyzer{sine(500.0f, 0.1f), {.fft_size = kFftSize}, config};
+
+    const auto first = analyzer.tier_first_bands();
+    ASSERT_EQ(first.size(), 4);
+    EXPECT_EQ(first.back(), 0);
+    const auto edges = analyzer.band_edges();
+    for (std::size_t tier = 1; tier < first.size(); ++tier) {
+        EXPECT_LT(first[tier], first[tier - 1]);
+        // Every band of the tier lies inside its alias-free range
+        const float limit = HalfBandDecimator::kPassband * 48000.0f /
+                            static_cast<float>(std::size_t{2} << tier);
+        EXPECT_LE(edges[first[tier - 1]], limit);
+    }
+
+    // A single tier serves everything
+    analyzer.set_config({.num_bands = 128, .hop_size = 512});
+    EXPECT_EQ(analyzer.tier_first_bands(), std::vector<std::size_t>{0});
+}
+
+/// Bands within 6 dB of the loudest, over a 0..1 normalized dB scale.
+std::size_t bands_near_peak(std::span<const float> bands, float db_floor) {
+    const float peak = *std::max_element(bands.begin(), bands.end());
+    const float threshold = peak - 6.0f / -db_floor;
+    return static_cast<std::size_t>(std::count_if(
+        bands.begin(), bands.end(), [&](float value) { return value >= threshold; }));
+}
+
+TEST(SpectrumAnalyzerTest, MultiResolutionSharpensBass) {
+    // 23 Hz bins smear a 60 Hz tone over many narrow low bands; three
+    // decimated tiers resolve it 8x finer
+    const AnalyzerConfig single{.num_bands = 128, .smoothing_factor = 0.0f, .hop_size = 512};
+    AnalyzerConfig multi = single;
+    multi.resolution_tiers = 4;
+
+    const auto analyze = [&](const AnalyzerConfig& config) {
+        SpectrumAnalyzer analyzer{sine(60.0f, 1.0f), {.fft_size = kFftSize}, config};
+        SpectrumData last;
+        analyzer.analyze_all([&](const SpectrumData& frame) { last = frame; });
+        return last;
+    };
+    const auto coarse = analyze(single);
+    const auto fine = analyze(multi);
+
+    const auto band = band_of(single, kFftSize / 2 + 1, 60.0f);
+    EXPECT_EQ(loudest(fine.magnitudes), band);
+    EXPECT_LT(bands_near_peak(fine.magnitudes, -80.0f),
+              bands_near_peak(coarse.magnitudes, -80.0f) / 2);
+}
+
+TEST(SpectrumAnalyzerTest, MultiResolutionKeepsHighBands) {
+    const AnalyzerConfig config{.smoothing_factor = 0.0f, .hop_size = 512, .resolution_tiers = 3};
+    SpectrumAnalyzer analyzer{sine(3000.0f, 0.5f), {.fft_size = kFftSize}, config};
+
+    SpectrumData last;
+    analyzer.analyze_all([&](const SpectrumData& frame) { last = frame; });
+    EXPECT_EQ(loudest(last.magnitudes), band_of(config, kFftSize / 2 + 1, 3000.0f));
+}
+
+TEST(SpectrumAnalyzerTest, DecimationValidatesFactor) {
+    const AnalyzerConfig low{.max_frequency = 2000.0f, .hop_size = 128};
+    for (const std::size_t factor : {std::size_t{3}, std::size_t{256}, std::size_t{16}}) {
+        AnalyzerConfig config = low;
+        config.decimation = factor;  // 16 puts max_frequency above the passband
+        EXPECT_THROW(SpectrumAnalyzer(sine(500.0f, 0.1f), {.fft_size = 256}, config),
+                     std::invalid_argument);
+    }
+
+    EXPECT_EQ(auto_decimation(20000.0f, 48000.0f), 1);
+    EXPECT_EQ(auto_decimation(2000.0f, 48000.0f), 8);
+    EXPECT_EQ(auto_decimation(10.0f, 48000.0f), 128);
+
+    AnalyzerConfig config = low;
+    config.decimation = 0;
+    const SpectrumAnalyzer analyzer{sine(500.0f, 0.1f), {.fft_size = 256}, config};
+    EXPECT_EQ(analyzer.decimation(), 8);
+    EXPECT_FLOAT_EQ(analyzer.analysis_rate(), 6000.0f);
+}
+
+TEST(SpectrumAnalyzerTest, DecimationKeepsResolutionWithSmallerFft) {
+    // 2048 bins at 48 kHz and 256 at 6 kHz are both 23.4 Hz wide
+    const AnalyzerConfig full{.max_frequency = 2000.0f, .smoothing_factor = 0.0f,
+                              .hop_size = 1024};
+    AnalyzerConfig decimated = full;
+    decimated.hop_size = 128;
+    decimated.decimation = 8;
+
+    const auto analyze = [&](const AnalyzerConfig& config, std::size_t fft_size) {
+        SpectrumAnalyzer analyzer{sine(440.0f, 0.5f), {.fft_size = fft_size}, config};
+        std::vector<SpectrumData> frames;
+        analyzer.analyze_all([&](const SpectrumData& frame) { frames.push_back(frame); });
+        return frames;
+    };
+    const auto reference = analyze(full, kFftSize);
+    const auto frames = analyze(decimated, kFftSize / 8);
+
+    ASSERT_FALSE(frames.empty());
+    EXPECT_EQ(loudest(frames.back().magnitudes), loudest(reference.back().magnitudes));
+    EXPECT_GT(frames.back().rms_level, 0.3f);
+    // Hops count decimated samples: 3000 of them in half a second
+    EXPECT_EQ(frames.size(), (24000 / 8 - kFftSize / 8) / 128 + 1);
+}
+
+TEST(SpectrumAnalyzerTest, TrackedFrequenciesBecomeBands) {
+    // Assigned rather than designated: GCC 12 -O3 then flags the later vector
+    // members as maybe-uninitialized in the initializer's cleanup path
+    AnalyzerConfig config{.smoothing_factor = 0.0f, .hop_size = 256};
+    config.tracked_frequencies = {50.0f, 60.0f, 440.0f, 1000.0f};
+    SpectrumAnalyzer analyzer{sine(440.0f, 0.5f), {.fft_size = kFftSize}, config};
+
+    EXPECT_EQ(analyzer.config().num_bands, 4);
+    const auto edges = analyzer.band_edges();
+    ASSERT_EQ(edges.size(), 5);
+    for (std::size_t b = 0; b < 4; ++b) {
+        EXPECT_LT(edges[b], config.tracked_frequencies[b]);
+        EXPECT_GT(edges[b + 1], config.tracked_frequencies[b]);
+    }
+
+    SpectrumData last;
+    const auto frames = analyzer.analyze_all([&](const SpectrumData& frame) { last = frame; });
+    // Every hop is a frame: the tracker needs no window of history
+    EXPECT_EQ(frames, 24000 / 256);
+    ASSERT_EQ(last.magnitudes.size(), 4);
+    EXPECT_EQ(loudest(last.magnitudes), 2);
+    EXPECT_LT(last.magnitudes[1], 0.1f);
+    EXPECT_GT(last.rms_level, 0.3f);
+}
+
+TEST(SpectrumAnalyzerTest, TrackedFrequenciesAreValidated) {
+    const auto make = [](std::vector<float> tones, std::size_t tiers = 1) {
+        return SpectrumAnalyzer(sine(440.0f, 0.1f), {},
+                                {.hop_size = 512,
+                                 .resolution_tiers = tiers,
+                                 .tracked_frequencies = std::move(tones)});
+    };
+    EXPECT_THROW(make({440.0f, 60.0f}), std::invalid_argument);  // Not ascending
+    EXPECT_THROW(make({60.0f, 60.0f}), std::invalid_argument);
+    EXPECT_THROW(make({0.0f, 60.0f}), std::invalid_argument);
+    EXPECT_THROW(make({60.0f, 24000.0f}), std::invalid_argument);  // Nyquist
+    EXPECT_THROW(make({60.0f, 440.0f}, 2), std::invalid_argument);
+    EXPECT_NO_THROW(make({60.0f}));
+}
+
+/// Returns the centre frequency of the analyzer band holding the spectrum's peak.
+float peak_frequency(const SpectrumAnalyzer& analyzer, std::span<const float> bands) {
+    const auto edges = analyzer.band_edges();
+    const auto band = loudest(bands);
+    return 0.5f * (edges[band] + edges[band + 1]);
+}
+
+/// Streams `source` through the analyzer one hop at a time until the last
+/// reconfigure() is in effect, then for one more window. Returns the last frame.
+SpectrumData stream_until_adopted(SpectrumAnalyzer& analyzer, SyntheticSource& source) {
+    SpectrumData last;
+    const auto keep = [&](const SpectrumData& frame) { last = frame; };
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (analyzer.reconfigure_pending() && std::chrono::steady_clock::now() < deadline) {
+        source.produce(512);
+        analyzer.process_pending(keep);
+        std::this_thread::yield();
+    }
+    source.produce(analyzer.fft_size());
+    analyzer.process_pending(keep);
+    return last;
+}
+
+TEST(SpectrumAnalyzerTest, ReconfigureChangesFftSizeBetweenFrames) {
+    auto owned = std::make_unique<SyntheticSource>(
+        SyntheticConfig{.frequency = 3000.0f, .block_frames = 512});
+    auto& source = *owned;
+    const AnalyzerConfig config{.smoothing_factor = 0.0f, .hop_size = 512};
+    SpectrumAnalyzer analyzer{std::move(owned), {.fft_size = kFftSize}, config};
+    source.produce(kFftSize);
+    ASSERT_EQ(analyzer.process_pending(nullptr), 1);
+
+    analyzer.reconfigure({.fft_size = 4 * kFftSize}, config);
+    EXPECT_EQ(analyzer.fft_size(), kFftSize);  // Nothing adopted outside a frame boundary
+    stream_until_adopted(analyzer, source);
+    ASSERT_FALSE(analyzer.reconfigure_pending());
+    EXPECT_EQ(analyzer.fft_size(), 4 * kFftSize);
+    EXPECT_EQ(analyzer.fft_config().fft_size, 4 * kFftSize);
+
+    // History in the capture ring carries over, so the longer window fills
+    SpectrumData last;
+    source.produce(4 * kFftSize);
+    ASSERT_GT(analyzer.process_pending([&](const SpectrumData& frame) { last = frame; }), 0);
+    EXPECT_NEAR(peak_frequency(analyzer, last.magnitudes), 3000.0f, 300.0f);
+}
+
+TEST(SpectrumAnalyzerTest, ReconfigureValidatesBeforeBuilding) {
+    SpectrumAnalyzer analyzer{sine(500.0f, 0.1f), {.fft_size = kFftSize}, {.hop_size = 512}};
+    EXPECT_THROW(analyzer.reconfigure({.fft_size = 3000}, {.hop_size = 512}),
+                 std::invalid_argument);
+    EXPECT_THROW(analyzer.reconfigure({.fft_size = kFftSize}, {.num_bands = 0}),
+                 std::invalid_argument);
+    EXPECT_THROW(analyzer.set_fft_config({.fft_size = 1 << 16}), std::invalid_argument);
+    EXPECT_FALSE(analyzer.reconfigure_pending());
+    EXPECT_FALSE(analyzer.fit_bands(analyzer.config().num_bands));  // Nothing recorded
+    EXPECT_EQ(analyzer.fft_size(), kFftSize);
+}
+
+TEST(SpectrumAnalyzerTest, ReconfigureLatestRequestWins) {
+    auto owned = std::make_unique<SyntheticSource>(SyntheticConfig{.block_frames = 512});
+    auto& source = *owned;
+    SpectrumAnalyzer analyzer{std::move(owned), {.fft_size = kFftSize}, {.hop_size = 512}};
+
+    analyzer.reconfigure({.fft_size = kFftSize}, {.num_bands = 32, .hop_size = 512});
+    analyzer.reconfigure({.fft_size = 1024}, {.num_bands = 48, .hop_size = 256});
+    const auto last = stream_until_adopted(analyzer, source);
+    EXPECT_EQ(analyzer.config().num_bands, 48);
+    EXPECT_EQ(analyzer.fft_size(), 1024);
+    EXPECT_EQ(last.magnitudes.size(), 48);
+}
+
+TEST(SpectrumAnalyzerTest, FitBandsResamplesStateOntoNewLayout) {
+    auto owned = std::make_unique<SyntheticSource>(
+        SyntheticConfig{.frequency = 3000.0f, .block_frames = 512});
+    auto& source = *owned;
+    SpectrumAnalyzer analyzer{std::move(owned),
+                              {.fft_size = kFftSize},
+                              {.num_bands = 32, .smoothing_factor = 0.9f, .hop_size = 512}};
+    SpectrumData before;
+    source.produce(kFftSize + 80 * 512);
+    ASSERT_GT(analyzer.process_pending([&](const SpectrumData& frame) { before = frame; }), 0);
+    const auto old_band = loudest(before.magnitudes);
+
+    EXPECT_TRUE(analyzer.fit_bands(96));
+    EXPECT_FALSE(analyzer.fit_bands(96));  // Already requested
+    const auto after = stream_until_adopted(analyzer, source);
+    ASSERT_EQ(analyzer.config().num_bands, 96);
+    ASSERT_EQ(after.magnitudes.size(), 96);
+
+    // Slow smoothing would still be far from the tone had it restarted from silence
+    const auto new_band = loudest(after.magnitudes);
+    EXPECT_NEAR(peak_frequency(analyzer, after.magnitudes), 3000.0f, 300.0f);
+    EXPECT_GT(after.magnitudes[new_band], 0.8f * before.magnitudes[old_band]);
+    EXPECT_GT(after.peaks[new_band], 0.8f * before.peaks[old_band]);
+}
+
+TEST(SpectrumAnalyzerTest, FitBandsLeavesTrackedTonesAlone) {
+    AnalyzerConfig config{.hop_size = 256};
+    config.tracked_frequencies = {440.0f, 880.0f};
+    SpectrumAnalyzer analyzer{sine(440.0f, 0.1f), {.fft_size = kFftSize}, config};
+    EXPECT_FALSE(analyzer.fit_bands(120));
+    EXPECT_FALSE(analyzer.reconfigure_pending());
+    EXPECT_EQ(analyzer.config().num_bands, 2);
+    EXPECT_THROW(analyzer.fit_bands(0), std::invalid_argument);
+}
+
+TEST(SpectrumAnalyzerTest, SetConfigHandsOverToRunningWorker) {
+    auto owned = std::make_unique<SyntheticSource>(SyntheticConfig{.block_frames = 512});
+    SpectrumAnalyzer analyzer{std::move(owned),
+                              {.fft_size = kFftSize},
+                              {.hop_size = 512, .use_worker_thread = true}};
+    analyzer.start();
+    ASSERT_TRUE(analyzer.is_worker_running());
+
+    analyzer.set_config({.num_bands = 32, .hop_size = 512, .use_worker_thread = true});
+    analyzer.set_fft_config({.fft_size = 2 * kFftSize});
+    EXPECT_TRUE(analyzer.is_worker_running());  // Never stopped for the change
+
+    SpectrumData data;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    bool fresh = false;
+    while (!fresh && std::chrono::steady_clock::now() < deadline) {
+        fresh = analyzer.update(data);
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    analyzer.stop();
+
+    EXPECT_TRUE(fresh);
+    EXPECT_EQ(data.magnitudes.size(), 32);
+    EXPECT_EQ(analyzer.config().num_bands, 32);
+    EXPECT_EQ(analyzer.fft_size(), 2 * kFftSize);
+}
+
+}  // namespace
+}  // namespace audiovis
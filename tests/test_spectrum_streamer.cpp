@@ -0,0 +1,442 @@
+#include "audiovis/spectrum_analyzer.hpp"
+#include "audiovis/spectrum_streamer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+using Packet = std::vector<std::byte>;
+using std::chrono::milliseconds;
+
+/// Frame t of a slowly moving two-channel spectrum, 10 ms apart.
+SpectrumData moving_frame(std::size_t t, std::size_t bands = 32) {
+    SpectrumData data;
+    data.channel_count = 2;
+    data.magnitudes.resize(2 * bands);
+    for (std::size_t i = 0; i < data.magnitudes.size(); ++i) {
+        data.magnitudes[i] = 0.5f + 0.4f * std::sin(static_cast<float>(i) * 0.2f +
+                                                    static_cast<float>(t) * 0.002f);
+    }
+    data.rms_level = 0.01f * static_cast<float>(t);
+    data.peak_level = 0.5f;
+    data.timestamp = std::chrono::steady_clock::time_point{} + milliseconds{10 * (t + 100)};
+    return data;
+}
+
+/// A UDP socket on loopback collecting the streamer's datagrams.
+class UdpReceiver {
+public:
+    UdpReceiver() : fd_{::socket(AF_INET, SOCK_DGRAM, 0)} {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(0x7F000001);
+        auto* generic = reinterpret_cast<sockaddr*>(&address);
+        socklen_t length = sizeof(address);
+        const int buffer = 4 << 20;
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+        if (::bind(fd_, generic, sizeof(address)) != 0 ||
+            ::getsockname(fd_, generic, &length) != 0) {
+            throw std::runtime_error("Cannot bind test receiver");
+        }
+        port_ = ntohs(address.sin_port);
+    }
+
+    ~UdpReceiver() { ::close(fd_); }
+
+    UdpReceiver(const UdpReceiver&) = delete;
+    UdpReceiver& operator=(const UdpReceiver&) = delete;
+
+    [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+
+    /// Returns every datagram that arrives until the socket has been quiet for 100 ms.
+    std::vector<Packet> receive_all() {
+        std::vector<Packet> packets;
+        pollfd fd{.fd = fd_, .events = POLLIN, .revents = 0};
+        while (::poll(&fd, 1, 100) > 0) {
+            Packet packet(65536);
+            const auto size = ::recv(fd_, packet.data(), packet.size(), 0);
+            if (size <= 0) {
+                break;
+            }
+            packet.resize(static_cast<std::size_t>(size));
+            packets.push_back(std::move(packet));
+        }
+        return packets;
+    }
+
+private:
+    int fd_;
+    std::uint16_t port_ = 0;
+};
+
+SpectrumStreamerConfig udp_config(const UdpReceiver& receiver) {
+    return SpectrumStreamerConfig{.udp_address = "127.0.0.1", .udp_port = receiver.port()};
+}
+
+std::vector<StreamFrame> decode_all(const std::vector<Packet>& packets,
+                                    SpectrumStreamDecoder& decoder) {
+    std::vector<StreamFrame> frames;
+    for (const auto& packet : packets) {
+        decoder.decode(packet, frames);
+    }
+    return frames;
+}
+
+std::size_t total_bytes(const std::vector<Packet>& packets) {
+    std::size_t bytes = 0;
+    for (const auto& packet : packets) {
+        bytes += packet.size();
+    }
+    return bytes;
+}
+
+TEST(SpectrumStreamerTest, RoundTripsWithinQuantizationStep) {
+    for (const auto encoding : {StreamEncoding::UInt8, StreamEncoding::UInt16}) {
+        UdpReceiver receiver;
+        auto config = udp_config(receiver);
+        config.encoding = encoding;
+        SpectrumStreamer streamer{config};
+
+        constexpr std::size_t kFrames = 80;
+        for (std::size_t t = 0; t < kFrames; ++t) {
+            ASSERT_TRUE(streamer.publish(moving_frame(t)));
+        }
+        streamer.close();
+        EXPECT_EQ(streamer.frames_published(), kFrames);
+        EXPECT_GT(streamer.delta_frames(), 0u);
+
+        SpectrumStreamDecoder decoder;
+        const auto frames = decode_all(receiver.receive_all(), decoder);
+        ASSERT_EQ(frames.size(), kFrames);
+        EXPECT_EQ(decoder.frames_skipped(), 0u);
+
+        const float step = encoding == StreamEncoding::UInt8 ? 1.0f / 255.0f : 1.0f / 65535.0f;
+        for (std::size_t t = 0; t < kFrames; ++t) {
+            const auto expected = moving_frame(t);
+            const auto& frame = frames[t];
+            EXPECT_EQ(frame.sequence, t);
+            EXPECT_EQ(frame.keyframe, t % config.keyframe_interval == 0) << t;
+            EXPECT_EQ(frame.channel_count, 2u);
+            EXPECT_EQ(frame.band_count(), 32u);
+            EXPECT_EQ(frame.time, milliseconds{10 * t});
+            EXPECT_FLOAT_EQ(frame.rms_level, expected.rms_level);
+            ASSERT_EQ(frame.magnitudes.size(), expected.magnitudes.size());
+            for (std::size_t i = 0; i < frame.magnitudes.size(); ++i) {
+                ASSERT_NEAR(frame.magnitudes[i], expected.magnitudes[i], 0.51f * step)
+                    << "frame " << t << " value " << i;
+            }
+        }
+    }
+}
+
+TEST(SpectrumStreamerTest, BatchesFramesIntoPackets) {
+    UdpReceiver receiver;
+    auto config = udp_config(receiver);
+    config.delta = false;
+    config.send_interval = milliseconds{200};  // Everything is queued before the first send
+    SpectrumStreamer streamer{config};
+
+    // Frames of 32 + 64 bytes: fourteen fit a 1400-byte packet after its header
+    for (std::size_t t = 0; t < 32; ++t) {
+        ASSERT_TRUE(streamer.publish(moving_frame(t)));
+    }
+    streamer.close();
+
+    const auto packets = receiver.receive_all();
+    ASSERT_EQ(packets.size(), 3u);
+    EXPECT_EQ(packets[0].size(), 20u + 14u * 96u);
+    EXPECT_EQ(packets[2].size(), 20u + 4u * 96u);
+    EXPECT_EQ(streamer.packets_sent(), 3u);
+
+    SpectrumStreamDecoder decoder;
+    EXPECT_EQ(decode_all(packets, decoder).size(), 32u);
+}
+
+TEST(SpectrumStreamerTest, DeltasShrinkSlowlyMovingSpectra) {
+    const auto stream = [](bool delta, std::size_t& delta_frames) {
+        UdpReceiver receiver;
+        auto config = udp_config(receiver);
+        config.encoding = StreamEncoding::UInt16;
+        config.delta = delta;
+        SpectrumStreamer streamer{config};
+        for (std::size_t t = 0; t < 64; ++t) {
+            streamer.publish(moving_frame(t / 4, 256));  // Each spectrum held for four frames
+        }
+        streamer.close();
+        delta_frames = streamer.delta_frames();
+        return receiver.receive_all();
+    };
+
+    std::size_t keyframe_only_deltas = 0;
+    std::size_t deltas = 0;
+    const auto full = stream(false, keyframe_only_deltas);
+    const auto compact = stream(true, deltas);
+    EXPECT_EQ(keyframe_only_deltas, 0u);
+    EXPECT_GT(deltas, 48u);
+    EXPECT_LT(total_bytes(compact), total_bytes(full) / 2);
+
+    // The compact stream reconstructs exactly the same quantized values
+    SpectrumStreamDecoder full_decoder;
+    SpectrumStreamDecoder compact_decoder;
+    const auto expected = decode_all(full, full_decoder);
+    const auto actual = decode_all(compact, compact_decoder);
+    ASSERT_EQ(actual.size(), 64u);
+    ASSERT_EQ(expected.size(), 64u);
+    for (std::size_t t = 0; t < actual.size(); ++t) {
+        ASSERT_EQ(actual[t].magnitudes, expected[t].magnitudes) << t;
+    }
+}
+
+TEST(SpectrumStreamerTest, DecoderResynchronisesAtKeyframe) {
+    UdpReceiver receiver;
+    auto config = udp_config(receiver);
+    config.keyframe_interval = 4;
+    config.max_packet_bytes = 64;  // One frame per packet
+    SpectrumStreamer streamer{config};
+    for (std::size_t t = 0; t < 8; ++t) {
+        SpectrumData frame = moving_frame(0, 4);
+        frame.magnitudes[0] = 0.1f * static_cast<float>(t);  // Only one value moves
+        ASSERT_TRUE(streamer.publish(frame));
+    }
+    streamer.close();
+
+    auto packets = receiver.receive_all();
+    ASSERT_EQ(packets.size(), 8u);
+    packets.erase(packets.begin() + 1);  // Lose a delta frame
+
+    SpectrumStreamDecoder decoder;
+    const auto frames = decode_all(packets, decoder);
+    EXPECT_EQ(decoder.frames_skipped(), 2u);  // Frames 2 and 3 had no base
+    ASSERT_EQ(frames.size(), 5u);
+    EXPECT_EQ(frames[0].sequence, 0u);
+    EXPECT_EQ(frames[1].sequence, 4u);
+    EXPECT_TRUE(frames[1].keyframe);
+    EXPECT_EQ(frames.back().sequence, 7u);
+}
+
+TEST(SpectrumStreamerTest, DropsWhenQueueIsFull) {
+    UdpReceiver receiver;
+    auto config = udp_config(receiver);
+    config.max_values = 8;
+    config.queue_frames = 1;
+    config.send_interval = milliseconds{100};
+    SpectrumStreamer streamer{config};
+
+    ASSERT_TRUE(streamer.publish(moving_frame(0, 4)));
+    EXPECT_FALSE(streamer.publish(moving_frame(1, 4)));  // Sender still asleep
+    EXPECT_FALSE(streamer.publish(moving_frame(0, 8)));  // Over max_values
+    EXPECT_EQ(streamer.frames_dropped(), 2u);
+    streamer.flush();
+    auto next = moving_frame(0, 4);
+    next.magnitudes[3] = 0.9f;
+    ASSERT_TRUE(streamer.publish(next));
+    streamer.close();
+
+    // The frame after the drop is encoded against the last one sent
+    SpectrumStreamDecoder decoder;
+    const auto frames = decode_all(receiver.receive_all(), decoder);
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[1].sequence, 1u);
+    EXPECT_FALSE(frames[1].keyframe);
+    for (std::size_t i = 0; i < next.magnitudes.size(); ++i) {
+        EXPECT_NEAR(frames[1].magnitudes[i], next.magnitudes[i], 0.51f / 255.0f);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// WebSocket
+// -----------------------------------------------------------------------------
+
+/// A blocking loopback TCP client speaking just enough WebSocket for the tests.
+class WebSocketClient {
+public:
+    explicit WebSocketClient(std::uint16_t port, int receive_buffer = 0)
+        : fd_{::socket(AF_INET, SOCK_STREAM, 0)} {
+        if (receive_buffer > 0) {
+            ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+        }
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(0x7F000001);
+        address.sin_port = htons(port);
+        if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            throw std::runtime_error("Cannot connect to streamer");
+        }
+        timeval timeout{.tv_sec = 2, .tv_usec = 0};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    ~WebSocketClient() { ::close(fd_); }
+
+    WebSocketClient(const WebSocketClient&) = delete;
+    WebSocketClient& operator=(const WebSocketClient&) = delete;
+
+    void send(std::string_view bytes) const {
+        ASSERT_EQ(::send(fd_, bytes.data(), bytes.size(), MSG_NOSIGNAL),
+                  static_cast<ssize_t>(bytes.size()));
+    }
+
+    /// Reads the HTTP response up to its blank line.
+    std::string read_response() {
+        std::string response;
+        char c = 0;
+        while (response.find("\r\n\r\n") == std::string::npos && ::recv(fd_, &c, 1, 0) == 1) {
+            response += c;
+        }
+        return response;
+    }
+
+    /// Reads one server frame; returns its opcode, or -1 on timeout or EOF.
+    int read_message(Packet& payload) {
+        std::byte header[10];
+        if (!read_exact(header, 2)) {
+            return -1;
+        }
+        std::size_t length = std::to_integer<std::size_t>(header[1]) & 0x7F;
+        const std::size_t extended = length == 126 ? 2 : length == 127 ? 8 : 0;
+        if (extended > 0) {
+            if (!read_exact(header + 2, extended)) {
+                return -1;
+            }
+            length = 0;
+            for (std::size_t i = 0; i < extended; ++i) {
+                length = (length << 8) | std::to_integer<std::size_t>(header[2 + i]);
+            }
+        }
+        payload.resize(length);
+        if (!read_exact(payload.data(), length)) {
+            return -1;
+        }
+        return std::to_integer<int>(header[0]) & 0x0F;
+    }
+
+private:
+    bool read_exact(std::byte* out, std::size_t size) {
+        while (size > 0) {
+            const auto received = ::recv(fd_, out, size, 0);
+            if (received <= 0) {
+                return false;
+            }
+            out += received;
+            size -= static_cast<std::size_t>(received);
+        }
+        return true;
+    }
+
+    int fd_;
+};
+
+void wait_for_clients(const SpectrumStreamer& streamer, std::size_t clients) {
+    for (int i = 0; i < 2000 && streamer.websocket_clients() != clients; ++i) {
+        std::this_thread::sleep_for(milliseconds{1});
+    }
+    ASSERT_EQ(streamer.websocket_clients(), clients);
+}
+
+constexpr std::string_view kUpgradeRequest =
+    "GET /spectrum HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+    "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+    "Sec-WebSocket-Version: 13\r\n\r\n";
+
+TEST(SpectrumStreamerTest, ServesWebSocketClients) {
+    SpectrumStreamer streamer{{.udp_address = "", .websocket_port = 0}};
+    ASSERT_NE(streamer.websocket_port(), 0);
+
+    WebSocketClient client{streamer.websocket_port()};
+    client.send(kUpgradeRequest);
+    const auto response = client.read_response();
+    EXPECT_EQ(response.rfind("HTTP/1.1 101", 0), 0u) << response;
+    // The accept value for this key is given in RFC 6455, section 1.3
+    EXPECT_NE(response.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n"),
+              std::string::npos)
+        << response;
+    wait_for_clients(streamer, 1);
+
+    for (std::size_t t = 0; t < 10; ++t) {
+        ASSERT_TRUE(streamer.publish(moving_frame(t)));
+    }
+    streamer.flush();
+
+    SpectrumStreamDecoder decoder;
+    std::vector<StreamFrame> frames;
+    Packet payload;
+    while (frames.size() < 10) {
+        ASSERT_EQ(client.read_message(payload), 0x2);
+        decoder.decode(payload, frames);
+    }
+    EXPECT_EQ(frames.back().sequence, 9u);
+
+    // A masked close frame is answered with a close frame
+    client.send(std::string_view{"\x88\x80\x01\x02\x03\x04", 6});
+    ASSERT_EQ(client.read_message(payload), 0x8);
+    wait_for_clients(streamer, 0);
+}
+
+TEST(SpectrumStreamerTest, RejectsRequestsWithoutKey) {
+    SpectrumStreamer streamer{{.udp_address = "", .websocket_port = 0}};
+    WebSocketClient client{streamer.websocket_port()};
+    client.send("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    EXPECT_EQ(client.read_response().rfind("HTTP/1.1 400", 0), 0u);
+    EXPECT_EQ(streamer.websocket_clients(), 0u);
+}
+
+TEST(SpectrumStreamerTest, SlowClientMissesPacketsWithoutStallingPublisher) {
+    SpectrumStreamer streamer{{.udp_address = "",
+                               .websocket_port = 0,
+                               .encoding = StreamEncoding::UInt16,
+                               .delta = false,
+                               .client_buffer_bytes = 16 * 1024}};
+    WebSocketClient stalled{streamer.websocket_port(), 4096};
+    stalled.send(kUpgradeRequest);
+    stalled.read_response();
+    wait_for_clients(streamer, 1);
+
+    // About 8 MB of frames against a client that never reads
+    constexpr std::size_t kFrames = 4000;
+    for (std::size_t t = 0; t < kFrames; ++t) {
+        ASSERT_TRUE(streamer.publish(moving_frame(t, 512)));
+        if (t % 32 == 31) {
+            streamer.flush();  // Pace to the sender so no frame is dropped
+        }
+    }
+    streamer.flush();
+    EXPECT_EQ(streamer.frames_dropped(), 0u);
+    EXPECT_GT(streamer.websocket_skipped(), 0u);
+    EXPECT_EQ(streamer.websocket_clients(), 1u);
+}
+
+TEST(SpectrumStreamerTest, ValidatesConfig) {
+    EXPECT_THROW(SpectrumStreamer({.udp_address = ""}), std::invalid_argument);
+    EXPECT_THROW(SpectrumStreamer({.udp_address = "localhost"}), std::invalid_argument);
+    EXPECT_THROW(SpectrumStreamer({.udp_address = "127.0.0.1", .value_min = 1.0f}),
+                 std::invalid_argument);
+    EXPECT_THROW(SpectrumStreamer({.udp_address = "127.0.0.1", .keyframe_interval = 0}),
+                 std::invalid_argument);
+    EXPECT_THROW(SpectrumStreamer({.udp_address = "127.0.0.1", .max_packet_bytes = 40}),
+                 std::invalid_argument);
+
+    SpectrumStreamDecoder decoder;
+    std::vector<StreamFrame> frames;
+    const Packet garbage(32, std::byte{0x41});
+    EXPECT_THROW(decoder.decode(garbage, frames), std::runtime_error);
+}
+
+}  // namespace
+}  // namespace audiovis
@@ -0,0 +1,94 @@
+#include "audiovis/spectrum_analyzer.hpp"
+#include "audiovis/synthetic_source.hpp"
+#include "audiovis/thread_policy.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+/// A core this process may run on.
+unsigned any_allowed_cpu() {
+    const auto current = current_thread_policy();
+    return current.cpus.empty() ? 0 : current.cpus.front();
+}
+
+TEST(ThreadPolicyTest, ValidateRejectsBadPriorities) {
+    EXPECT_NO_THROW(validate(ThreadPolicy{}));
+    EXPECT_THROW(validate({.priority = 5}), std::invalid_argument);
+    EXPECT_THROW(validate({.scheduling = SchedulingClass::Fifo, .priority = 0}),
+                 std::invalid_argument);
+    EXPECT_THROW(validate({.scheduling = SchedulingClass::RoundRobin, .priority = 100}),
+                 std::invalid_argument);
+    EXPECT_NO_THROW(validate({.scheduling = SchedulingClass::Fifo, .priority = 50}));
+}
+
+TEST(ThreadPolicyTest, ValidateRejectsUnavailableCpus) {
+    const unsigned cpu = any_allowed_cpu();
+    EXPECT_NO_THROW(validate({.cpus = {cpu}}));
+    EXPECT_THROW(validate({.cpus = {cpu, cpu}}), std::invalid_argument);
+    EXPECT_THROW(validate({.cpus = {100000}}), std::invalid_argument);
+}
+
+TEST(ThreadPolicyTest, PinsThreadToRequestedCpu) {
+    const unsigned cpu = any_allowed_cpu();
+    std::jthread thread{[](const std::stop_token& stop) {
+        while (!stop.stop_requested()) {
+            std::this_thread::yield();
+        }
+    }};
+
+    const auto applied = apply_thread_policy(thread.native_handle(), {.cpus = {cpu}});
+    EXPECT_EQ(applied.cpus, std::vector<unsigned>{cpu});
+    EXPECT_EQ(applied.scheduling, SchedulingClass::Normal);
+    EXPECT_TRUE(applied.notes.empty()) << applied.notes;
+}
+
+TEST(ThreadPolicyTest, ReportsWhatRealTimeRequestGot) {
+    std::jthread thread{[](const std::stop_token& stop) {
+        while (!stop.stop_requested()) {
+            std::this_thread::yield();
+        }
+    }};
+    const auto applied = apply_thread_policy(
+        thread.native_handle(), {.scheduling = SchedulingClass::RoundRobin, .priority = 1});
+
+    // Granted or refused depends on privileges; either way the report is truthful
+    if (applied.notes.empty()) {
+        EXPECT_EQ(applied.scheduling, SchedulingClass::RoundRobin);
+        EXPECT_EQ(applied.priority, 1);
+    } else {
+        EXPECT_EQ(applied.scheduling, SchedulingClass::Normal);
+        EXPECT_NE(applied.notes.find("SCHED_RR"), std::string::npos);
+    }
+}
+
+TEST(ThreadPolicyTest, DescribeCollapsesCoreRuns) {
+    EXPECT_EQ(describe({.scheduling = SchedulingClass::Fifo, .priority = 70, .cpus = {0, 1, 2, 5}}),
+              "SCHED_FIFO priority 70, CPUs 0-2,5");
+    EXPECT_EQ(describe({.cpus = {3}, .notes = "SCHED_FIFO refused: Operation not permitted"}),
+              "SCHED_OTHER, CPU 3 (SCHED_FIFO refused: Operation not permitted)");
+}
+
+TEST(ThreadPolicyTest, AnalyzerAppliesWorkerPolicy) {
+    const unsigned cpu = any_allowed_cpu();
+    const AnalyzerConfig config{.hop_size = 512,
+                                .use_worker_thread = true,
+                                .worker_policy = {.cpus = {cpu}}};
+    SpectrumAnalyzer analyzer{std::make_unique<SyntheticSource>(SyntheticConfig{}), {}, config};
+    analyzer.start();
+    EXPECT_EQ(analyzer.worker_policy_applied().cpus, std::vector<unsigned>{cpu});
+    analyzer.stop();
+
+    EXPECT_THROW(SpectrumAnalyzer(std::make_unique<SyntheticSource>(SyntheticConfig{}), {},
+                                  {.worker_policy = {.cpus = {100000}}}),
+                 std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace audiovis
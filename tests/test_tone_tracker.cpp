@@ -0,0 +1,166 @@
+#include "audiovis/tone_tracker.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+constexpr std::size_t kWindow = 2048;
+
+std::vector<float> sine(float frequency, std::size_t count, float amplitude = 1.0f) {
+    std::vector<float> samples(count);
+    const double omega = 2.0 * std::numbers::pi * static_cast<double>(frequency) /
+                         static_cast<double>(kSampleRate);
+    for (std::size_t i = 0; i < count; ++i) {
+        samples[i] = amplitude * static_cast<float>(std::sin(omega * static_cast<double>(i)));
+    }
+    return samples;
+}
+
+/// A deterministic mix of tones and pseudo-random noise.
+std::vector<float> test_signal(std::size_t count) {
+    auto samples = sine(440.0f, count, 0.4f);
+    const auto other = sine(3150.0f, count, 0.2f);
+    unsigned state = 12345;
+    for (std::size_t i = 0; i < count; ++i) {
+        state = state * 1664525u + 1013904223u;
+        const float noise = static_cast<float>(state >> 8) / 16777216.0f - 0.5f;
+        samples[i] += other[i] + 0.1f * noise;
+    }
+    return samples;
+}
+
+TEST(ToneTrackerTest, MatchesFftAtBinCentres) {
+    const std::vector<std::size_t> bins{10, 19, 67, 300};
+    ToneTrackerConfig config{.window_size = kWindow, .window = WindowFunction::Rectangular,
+                             .use_magnitude_db = false};
+    for (const auto bin : bins) {
+        config.frequencies.push_back(static_cast<float>(bin) * kSampleRate /
+                                     static_cast<float>(kWindow));
+    }
+    ToneTracker tracker{config};
+    FFTProcessor fft{{.fft_size = kWindow, .window = WindowFunction::Rectangular,
+                      .use_magnitude_db = false}};
+
+    // More than a window, so samples have already slid out
+    const auto signal = test_signal(3 * kWindow + 100);
+    std::vector<float> tones(bins.size());
+    tracker.compute(signal, tones);
+    std::vector<float> spectrum(fft.bin_count());
+    fft.compute(signal, spectrum);
+
+    for (std::size_t t = 0; t < bins.size(); ++t) {
+        EXPECT_NEAR(tones[t], spectrum[bins[t]], 1e-4f) << "bin " << bins[t];
+    }
+}
+
+TEST(ToneTrackerTest, FullScaleSineReadsFullScaleThroughAnyWindow) {
+    for (const auto window : {WindowFunction::Rectangular, WindowFunction::Hann,
+                              WindowFunction::Hamming, WindowFunction::Blackman,
+                              WindowFunction::FlatTop}) {
+        // Off any bin centre: the tracker evaluates exactly at the frequency
+        ToneTracker tracker{{.frequencies = {1013.7f}, .window_size = kWindow, .window = window,
+                             .use_magnitude_db = false}};
+        float magnitude = 0.0f;
+        tracker.compute(sine(1013.7f, 2 * kWindow, 0.5f), std::span<float>{&magnitude, 1});
+        EXPECT_NEAR(magnitude, 0.5f, 0.005f) << static_cast<int>(window);
+    }
+}
+
+TEST(ToneTrackerTest, WindowRejectsNeighbouringTones) {
+    ToneTracker tracker{{.frequencies = {1000.0f, 1500.0f, 6000.0f}, .window_size = kWindow}};
+    std::vector<float> tones(3);
+    tracker.compute(sine(1000.0f, 2 * kWindow, 0.5f), tones);
+
+    EXPECT_NEAR(tones[0], 1.0f - 6.02f / 80.0f, 0.01f);  // -6 dB over an 80 dB range
+    EXPECT_LT(tones[1], 0.1f);
+    EXPECT_LT(tones[2], 0.1f);
+}
+
+TEST(ToneTrackerTest, ChunkingDoesNotChangeResult) {
+    const ToneTrackerConfig config{.frequencies = {60.0f, 440.0f, 3150.0f}, .window_size = 1000};
+    const auto signal = test_signal(5000);
+
+    ToneTracker whole{config};
+    std::vector<float> expected(3);
+    whole.compute(signal, expected);
+
+    ToneTracker pieces{config};
+    std::size_t pos = 0;
+    for (std::size_t chunk = 1; pos < signal.size(); chunk = chunk * 3 % 997 + 1) {
+        const auto count = std::min(chunk, signal.size() - pos);
+        pieces.process(std::span<const float>{signal}.subspan(pos, count));
+        pos += count;
+    }
+    std::vector<float> actual(3);
+    pieces.magnitudes(actual);
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(ToneTrackerTest, StaysAccurateOverLongRuns) {
+    // Two million samples later the recurrence still equals a fresh window
+    const ToneTrackerConfig config{.frequencies = {440.0f, 3150.0f, 9000.0f},
+                                   .window_size = kWindow, .use_magnitude_db = false};
+    const auto signal = test_signal(2'000'000);
+
+    ToneTracker running{config};
+    std::vector<float> actual(3);
+    running.compute(signal, actual);
+
+    ToneTracker fresh{config};
+    std::vector<float> expected(3);
+    fresh.compute(std::span<const float>{signal}.last(kWindow), expected);
+
+    for (std::size_t t = 0; t < 3; ++t) {
+        EXPECT_NEAR(actual[t], expected[t], 1e-3f * expected[t] + 1e-6f);
+    }
+}
+
+TEST(ToneTrackerTest, TracksChannelsIndependently) {
+    ToneTracker tracker{{.frequencies = {500.0f, 2000.0f}, .window_size = kWindow,
+                         .channels = 2}};
+    const auto left = sine(500.0f, kWindow);
+    const auto right = sine(2000.0f, kWindow);
+    // The right channel arrives split, as from a wrapped ring
+    const std::vector<SegmentedInput> inputs{
+        {.head = left, .tail = {}},
+        {.head = std::span<const float>{right}.first(700),
+         .tail = std::span<const float>{right}.subspan(700)}};
+    tracker.process_batch(inputs);
+
+    std::vector<float> tones(4);
+    EXPECT_EQ(tracker.magnitudes(tones), 4);
+    EXPECT_GT(tones[0], tones[1]);
+    EXPECT_GT(tones[3], tones[2]);
+}
+
+TEST(ToneTrackerTest, ResetForgetsHistory) {
+    ToneTracker tracker{{.frequencies = {1000.0f}, .window_size = kWindow,
+                         .use_magnitude_db = false}};
+    float magnitude = 0.0f;
+    tracker.compute(sine(1000.0f, kWindow), std::span<float>{&magnitude, 1});
+    EXPECT_GT(magnitude, 0.9f);
+    tracker.reset();
+    tracker.magnitudes(std::span<float>{&magnitude, 1});
+    EXPECT_EQ(magnitude, 0.0f);
+}
+
+TEST(ToneTrackerTest, ValidatesConfig) {
+    EXPECT_THROW(ToneTracker{}, std::invalid_argument);  // No frequencies
+    EXPECT_THROW(ToneTracker({.frequencies = {0.0f}}), std::invalid_argument);
+    EXPECT_THROW(ToneTracker({.frequencies = {24000.0f}}), std::invalid_argument);
+    EXPECT_THROW(ToneTracker({.frequencies = {100.0f}, .window_size = 0}), std::invalid_argument);
+    EXPECT_THROW(ToneTracker({.frequencies = {100.0f}, .channels = 0}), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace audiovis
@@ -0,0 +1,138 @@
+#include "audiovis/trace.hpp"
+
+#include "audiovis/spectrum_analyzer.hpp"
+#include "audiovis/synthetic_source.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+using namespace std::chrono_literals;
+
+class TracerTest : public ::testing::Test {
+protected:
+    void SetUp() override { tracer().clear(); }
+    void TearDown() override {
+        tracer().set_capture(false);
+        tracer().clear();
+    }
+
+    static Tracer& tracer() { return Tracer::instance(); }
+};
+
+TEST_F(TracerTest, ScopedTraceTimesItsScope) {
+    {
+        const ScopedTrace trace{TraceStage::FftExecute};
+        std::this_thread::sleep_for(2ms);
+    }
+    const auto window = tracer().roll();
+    const auto& stats = window[TraceStage::FftExecute];
+    EXPECT_EQ(stats.count, 1);
+    EXPECT_GE(stats.total_ns, 2'000'000);
+    EXPECT_EQ(stats.max_ns, stats.total_ns);
+    EXPECT_GE(stats.histogram.percentile(0.5), 2ms);
+    EXPECT_EQ(window[TraceStage::Window].count, 0);
+
+    // Rolling starts an empty window
+    EXPECT_EQ(tracer().roll()[TraceStage::FftExecute].count, 0);
+}
+
+TEST_F(TracerTest, CollectsEveryThread) {
+    constexpr int kThreads = 4;
+    constexpr int kEvents = 500;
+    tracer().set_capture(true);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < kEvents; ++i) {
+                const ScopedTrace trace{TraceStage::Smoothing};
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(tracer().collect(), kThreads * kEvents);
+    const auto events = tracer().captured();
+    ASSERT_EQ(events.size(), kThreads * kEvents);
+    std::set<std::uint32_t> ids;
+    for (const auto& event : events) {
+        ids.insert(event.thread);
+        EXPECT_EQ(event.stage, TraceStage::Smoothing);
+    }
+    EXPECT_EQ(ids.size(), kThreads);
+    EXPECT_EQ(tracer().roll()[TraceStage::Smoothing].count, kThreads * kEvents);
+}
+
+TEST_F(TracerTest, ExitedThreadsHandTheirBuffersOn) {
+    tracer().set_capture(true);
+    for (int round = 0; round < 8; ++round) {
+        std::thread{[] { const ScopedTrace trace{TraceStage::Decimate}; }}.join();
+        EXPECT_EQ(tracer().collect(), 1);  // Drained, so the next thread may have it
+    }
+
+    // One thread at a time: every round reused the same ring
+    std::set<std::uint32_t> ids;
+    for (const auto& event : tracer().captured()) {
+        ids.insert(event.thread);
+    }
+    EXPECT_EQ(ids.size(), 1);
+}
+
+TEST_F(TracerTest, FullThreadBufferDropsInsteadOfWaiting) {
+    const auto now = Tracer::Clock::now();
+    for (std::size_t i = 0; i < Tracer::kThreadCapacity + 10; ++i) {
+        tracer().record(TraceStage::Render, now, now + 1us);
+    }
+    const auto window = tracer().roll();
+    EXPECT_EQ(window[TraceStage::Render].count, Tracer::kThreadCapacity);
+    EXPECT_EQ(window.dropped, 10);
+}
+
+TEST_F(TracerTest, ExportsChromeTraceAndJsonWindows) {
+    tracer().set_capture(true);
+    const auto now = Tracer::Clock::now();
+    tracer().record(TraceStage::Draw, now, now + 1500ns);
+
+    const auto trace = tracer().chrome_trace_json();
+    EXPECT_NE(trace.find("\"traceEvents\":["), std::string::npos);
+    EXPECT_NE(trace.find("\"name\":\"render.draw\""), std::string::npos);
+    EXPECT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(trace.find("\"dur\":1.500"), std::string::npos);
+
+    const auto json = to_json(tracer().roll());
+    EXPECT_NE(json.find("\"render.draw\":{\"count\":1,"), std::string::npos);
+    EXPECT_EQ(json.find("fft.execute"), std::string::npos);  // Stages that never ran are left out
+}
+
+TEST_F(TracerTest, PipelineStagesAreTracedOnlyWhenCompiledIn) {
+    SpectrumAnalyzer analyzer{
+        std::make_unique<SyntheticSource>(SyntheticConfig{.duration_seconds = 0.25f}),
+        {.fft_size = 1024}, {.num_bands = 32, .hop_size = 256}};
+    const auto frames = analyzer.analyze_all({});
+    ASSERT_GT(frames, 0);
+
+    const auto window = tracer().roll();
+    // Band mapping, smoothing and peaks run fused, straight off the FFT output
+    for (const auto stage : {TraceStage::AnalyzeFrame, TraceStage::RingRead,
+                             TraceStage::FftCompute, TraceStage::FftExecute,
+                             TraceStage::BandMapping}) {
+        EXPECT_EQ(window[stage].count, Tracer::kCompiledIn ? frames : 0)
+            << trace_stage_name(stage);
+    }
+    EXPECT_EQ(window[TraceStage::Magnitude].count, 0);
+}
+
+}  // namespace
+}  // namespace audiovis
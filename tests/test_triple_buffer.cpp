@@ -0,0 +1,123 @@
+#include "audiovis/triple_buffer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace audiovis {
+namespace {
+
+TEST(TripleBufferTest, NoValueBeforeFirstPublish) {
+    TripleBuffer<int> buf{7};
+    EXPECT_FALSE(buf.update());
+    EXPECT_EQ(buf.read_buffer(), 7);  // Initial value
+}
+
+TEST(TripleBufferTest, ReaderSeesPublishedValue) {
+    TripleBuffer<int> buf{0};
+
+    buf.write_buffer() = 42;
+    buf.publish();
+
+    EXPECT_TRUE(buf.update());
+    EXPECT_EQ(buf.read_buffer(), 42);
+}
+
+TEST(TripleBufferTest, UpdateReportsOnlyFreshValues) {
+    TripleBuffer<int> buf{0};
+
+    buf.write_buffer() = 1;
+    buf.publish();
+    EXPECT_TRUE(buf.update());
+    EXPECT_FALSE(buf.update());  // Nothing new since
+    EXPECT_EQ(buf.read_buffer(), 1);
+}
+
+TEST(TripleBufferTest, ReaderGetsNewestOfSeveralPublishes) {
+    TripleBuffer<int> buf{0};
+
+    for (int i = 1; i <= 5; ++i) {
+        buf.write_buffer() = i;
+        buf.publish();
+    }
+
+    EXPECT_TRUE(buf.update());
+    EXPECT_EQ(buf.read_buffer(), 5);
+}
+
+TEST(TripleBufferTest, WriterNeverReceivesReaderSlot) {
+    TripleBuffer<int> buf{0};
+
+    buf.write_buffer() = 1;
+    buf.publish();
+    ASSERT_TRUE(buf.update());
+
+    // Writer keeps going while the reader holds on to "1"
+    for (int i = 2; i <= 10; ++i) {
+        buf.write_buffer() = i;
+        buf.publish();
+        EXPECT_EQ(buf.read_buffer(), 1);
+    }
+}
+
+TEST(TripleBufferTest, ResetDropsUnreadValue) {
+    TripleBuffer<int> buf{0};
+
+    buf.write_buffer() = 3;
+    buf.publish();
+    buf.reset(9);
+
+    EXPECT_FALSE(buf.update());
+    EXPECT_EQ(buf.read_buffer(), 9);
+}
+
+// Stress test: the reader must only ever observe complete, monotonic frames
+TEST(TripleBufferTest, ConcurrentWriterReader) {
+    constexpr std::uint64_t kNumFrames = 200000;
+    constexpr std::size_t kFrameSize = 32;
+
+    TripleBuffer<std::vector<std::uint64_t>> buf{std::vector<std::uint64_t>(kFrameSize, 0)};
+    std::atomic<bool> done{false};
+
+    std::thread writer{[&]() {
+        for (std::uint64_t frame = 1; frame <= kNumFrames; ++frame) {
+            auto& slot = buf.write_buffer();
+            for (auto& value : slot) {
+                value = frame;
+            }
+            buf.publish();
+        }
+        done.store(true, std::memory_order_release);
+    }};
+
+    std::uint64_t last_seen = 0;
+    bool torn = false;
+    bool regressed = false;
+
+    while (true) {
+        const bool finished = done.load(std::memory_order_acquire);
+        if (!buf.update()) {
+            if (finished) {
+                break;
+            }
+            continue;
+        }
+        const auto& frame = buf.read_buffer();
+        for (const auto value : frame) {
+            torn = torn || value != frame.front();
+        }
+        regressed = regressed || frame.front() < last_seen;
+        last_seen = frame.front();
+    }
+
+    writer.join();
+    EXPECT_FALSE(torn);
+    EXPECT_FALSE(regressed);
+    EXPECT_EQ(last_seen, kNumFrames);
+}
+
+}  // namespace
+}  // namespace audiovis
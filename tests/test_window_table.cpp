@@ -0,0 +1,92 @@
+#include "audiovis/fft_processor.hpp"
+#include "audiovis/window_table.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <stdexcept>
+
+namespace audiovis {
+namespace {
+
+double hann(std::size_t i, std::size_t n) {
+    return 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * static_cast<double>(i) /
+                                static_cast<double>(n - 1));
+}
+
+TEST(WindowTableTest, PrebakedHannMatchesFormula) {
+    for (const std::size_t n : {std::size_t{512}, std::size_t{1024}, std::size_t{2048},
+                                std::size_t{4096}}) {
+        const auto& table = window_table(WindowFunction::Hann, n);
+        ASSERT_TRUE(table.prebaked());
+        ASSERT_EQ(table.size(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_NEAR(table.coefficients()[i], hann(i, n), 1e-7) << "n=" << n << " i=" << i;
+        }
+    }
+}
+
+TEST(WindowTableTest, ComputedTablesMatchFormula) {
+    constexpr std::size_t kSize = 1000;
+    const auto& table = window_table(WindowFunction::Hann, kSize);
+    EXPECT_FALSE(table.prebaked());
+    for (std::size_t i = 0; i < kSize; ++i) {
+        ASSERT_NEAR(table.coefficients()[i], hann(i, kSize), 1e-7);
+    }
+
+    const auto& blackman = window_table(WindowFunction::Blackman, kSize);
+    for (std::size_t i = 0; i < kSize; i += 37) {
+        const double x =
+            2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(kSize - 1);
+        EXPECT_NEAR(blackman.coefficients()[i], 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2 * x),
+                    1e-7);
+    }
+}
+
+TEST(WindowTableTest, TablesAreSymmetric) {
+    for (const auto function : {WindowFunction::Hamming, WindowFunction::FlatTop}) {
+        const auto w = window_table(function, 777).coefficients();
+        for (std::size_t i = 0; i < w.size() / 2; ++i) {
+            ASSERT_FLOAT_EQ(w[i], w[w.size() - 1 - i]);
+        }
+    }
+}
+
+TEST(WindowTableTest, LookupsShareOneTable) {
+    const auto& first = window_table(WindowFunction::Hamming, 4096);
+    const auto cached = window_cache_size();
+    EXPECT_EQ(&window_table(WindowFunction::Hamming, 4096), &first);
+    EXPECT_EQ(window_cache_size(), cached);
+    EXPECT_NE(&window_table(WindowFunction::Hamming, 2048), &first);
+
+    const FFTProcessor a{{.fft_size = 4096, .window = WindowFunction::Hamming}};
+    const FFTProcessor b{{.fft_size = 4096, .window = WindowFunction::Hamming, .channels = 2}};
+    EXPECT_EQ(&a.window(), &first);
+    EXPECT_EQ(&b.window(), &first);
+}
+
+TEST(WindowTableTest, ReportsGains) {
+    const auto& rectangular = window_table(WindowFunction::Rectangular, 2048);
+    EXPECT_FLOAT_EQ(rectangular.coherent_gain(), 1.0f);
+    EXPECT_FLOAT_EQ(rectangular.energy_gain(), 1.0f);
+    EXPECT_FLOAT_EQ(rectangular.noise_bandwidth(), 1.0f);
+
+    const auto& hann = window_table(WindowFunction::Hann, 2048);
+    EXPECT_NEAR(hann.coherent_gain(), 0.5f, 1e-3f);
+    EXPECT_NEAR(hann.energy_gain(), 0.375f, 1e-3f);
+    EXPECT_NEAR(hann.noise_bandwidth(), 1.5f, 1e-2f);
+
+    const auto& flat_top = window_table(WindowFunction::FlatTop, 2048);
+    EXPECT_NEAR(flat_top.coherent_gain(), 0.2156f, 1e-3f);
+    EXPECT_NEAR(flat_top.noise_bandwidth(), 3.77f, 2e-2f);
+}
+
+TEST(WindowTableTest, HandlesDegenerateSizes) {
+    EXPECT_THROW((void)window_table(WindowFunction::Hann, 0), std::invalid_argument);
+    EXPECT_FLOAT_EQ(window_table(WindowFunction::Blackman, 1).coefficients()[0], 1.0f);
+}
+
+}  // namespace
+}  // namespace audiovis